@@ -0,0 +1,158 @@
+#include "GameAnalyticsGzip.h"
+#include "GameAnalyticsJson.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Number of events sent for the same id per aggregation window.
+	const int WindowEvents = 10000;
+
+	// Loopback transport keeping the decompressed body of the last events request, so summaries can be compared with the values sent.
+	class SummaryTransport : public LoopbackTransport
+	{
+	public:
+		void Post(const TransportRequest & request, const Callback & callback) override
+		{
+			if (request.url.find("/events") != std::string::npos)
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+
+				if (!request.compressed
+					|| !GzipDecompress(reinterpret_cast<const uint8_t *>(request.body.data()), request.body.size(), this->body))
+				{
+					this->body = request.body;
+				}
+			}
+
+			LoopbackTransport::Post(request, callback);
+		}
+
+		// Gets the value of the summary design event with the specified id in the last events request, or NaN if there is none.
+		double GetSummary(const std::string & eventId)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+
+			std::vector<std::string> events;
+			Json::TryGetElements(this->body, events);
+
+			for (auto & event : events)
+			{
+				std::string id;
+				double value;
+
+				if (Json::TryGetMember(event, "event_id", id) && id == "\"" + eventId + "\"" && Json::TryGetNumber(event, "value", value))
+				{
+					return value;
+				}
+			}
+
+			return std::nan("");
+		}
+
+	private:
+		std::mutex mutex;
+		std::string body;
+	};
+}
+
+
+// Sends 10000 design events per aggregation window for the same id, with values spread over orders of magnitude like damage or latencies,
+// and flushes them at the end of the window. Aggregation sends seven summary events per window instead, estimating quantiles by a sketch.
+// Reports uploaded bytes and requests per window, and the largest relative error of the P50, P90 and P99 summaries, which is 0 without aggregation.
+static void BM_Aggregation(benchmark::State & state)
+{
+	auto aggregate = state.range(0) != 0;
+
+	std::mt19937 random(42);
+	std::lognormal_distribution<float> distribution(3.0f, 1.5f);
+	std::vector<float> values(WindowEvents);
+
+	for (auto & value : values)
+	{
+		value = distribution(random);
+	}
+
+	std::vector<float> sorted(values);
+	std::sort(sorted.begin(), sorted.end());
+
+	auto backend = std::make_shared<SummaryTransport>();
+	backend->SetSecretKey(TestSecretKey);
+
+	TestDirectory directory;
+	auto clock = std::make_shared<ManualClock>();
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(backend, directory.GetPath(), clock));
+	core->SetMaxPendingEvents(WindowEvents);
+	core->SetAggregationInterval(60);
+
+	if (aggregate)
+	{
+		core->AggregateEvents("Kill:");
+	}
+
+	core->Init([](const InitResult &) {});
+	core->Flush();
+
+	auto before = backend->GetStatistics();
+	double maxError = 0;
+
+	for (auto _ : state)
+	{
+		for (auto value : values)
+		{
+			core->SendDesignEvent("Kill:Orc", value);
+		}
+
+		clock->Advance(60 * 1000);
+		core->Flush();
+
+		if (aggregate)
+		{
+			state.PauseTiming();
+
+			const double quantiles[] = { 0.5, 0.9, 0.99 };
+			const char * const names[] = { "Kill:Orc:P50", "Kill:Orc:P90", "Kill:Orc:P99" };
+
+			for (auto i = 0; i < 3; ++i)
+			{
+				auto exact = static_cast<double>(sorted[static_cast<size_t>(quantiles[i] * (sorted.size() - 1))]);
+				auto error = std::abs(backend->GetSummary(names[i]) - exact) / exact;
+
+				// NaN if the summary is missing.
+				maxError = std::isnan(error) ? error : std::max(maxError, error);
+			}
+
+			state.ResumeTiming();
+		}
+	}
+
+	auto statistics = backend->GetStatistics();
+	auto windows = static_cast<double>(state.iterations());
+
+	if (statistics.rejectedRequests > 0 || std::isnan(maxError))
+	{
+		state.SkipWithError("Summaries are missing or have been rejected.");
+	}
+
+	state.SetItemsProcessed(state.iterations() * WindowEvents);
+	state.counters["bytes_per_window"] = benchmark::Counter(static_cast<double>(statistics.bytesReceived - before.bytesReceived) / windows);
+	state.counters["requests_per_window"] = benchmark::Counter(static_cast<double>(statistics.eventsRequests - before.eventsRequests) / windows);
+	state.counters["quantile_error"] = benchmark::Counter(maxError);
+}
+
+BENCHMARK(BM_Aggregation)->ArgName("aggregate")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
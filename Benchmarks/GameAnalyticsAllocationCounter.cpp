@@ -0,0 +1,96 @@
+#include "GameAnalyticsAllocationCounter.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Size of the header storing the size of each allocation, keeping the alignment of malloc.
+	const size_t HeaderSize = alignof(std::max_align_t);
+
+	thread_local uint64_t Allocations = 0;
+	thread_local int64_t AllocatedBytes = 0;
+	thread_local uint64_t TotalAllocatedBytes = 0;
+
+	void * Allocate(const size_t size)
+	{
+		auto memory = static_cast<unsigned char *>(std::malloc(size + HeaderSize));
+
+		if (memory == nullptr)
+		{
+			return nullptr;
+		}
+
+		*reinterpret_cast<size_t *>(memory) = size;
+
+		++Allocations;
+		AllocatedBytes += static_cast<int64_t>(size);
+		TotalAllocatedBytes += size;
+
+		return memory + HeaderSize;
+	}
+
+	void Free(void * pointer)
+	{
+		if (pointer == nullptr)
+		{
+			return;
+		}
+
+		auto memory = static_cast<unsigned char *>(pointer) - HeaderSize;
+		AllocatedBytes -= static_cast<int64_t>(*reinterpret_cast<size_t *>(memory));
+
+		std::free(memory);
+	}
+}
+
+
+uint64_t AllocationCounter::GetAllocations()
+{
+	return Allocations;
+}
+
+int64_t AllocationCounter::GetAllocatedBytes()
+{
+	return AllocatedBytes;
+}
+
+uint64_t AllocationCounter::GetTotalAllocatedBytes()
+{
+	return TotalAllocatedBytes;
+}
+
+void * operator new(size_t size)
+{
+	auto pointer = Allocate(size);
+
+	if (pointer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void * operator new(size_t size, const std::nothrow_t &) noexcept
+{
+	return Allocate(size);
+}
+
+void operator delete(void * pointer) noexcept
+{
+	Free(pointer);
+}
+
+void operator delete(void * pointer, size_t) noexcept
+{
+	Free(pointer);
+}
+
+void operator delete(void * pointer, const std::nothrow_t &) noexcept
+{
+	Free(pointer);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace GameAnalytics
+{
+	// Counts the heap allocations of the calling thread, by replacing the global operator new and delete of the benchmarks.
+	// Memory freed by another thread than the one allocating it is counted for the freeing thread.
+	struct AllocationCounter
+	{
+		// Gets the number of allocations of the calling thread so far.
+		static uint64_t GetAllocations();
+
+		// Gets the number of bytes allocated by the calling thread so far, minus the number of bytes freed by it.
+		static int64_t GetAllocatedBytes();
+
+		// Gets the number of bytes allocated by the calling thread so far, whether freed since or not.
+		static uint64_t GetTotalAllocatedBytes();
+	};
+}
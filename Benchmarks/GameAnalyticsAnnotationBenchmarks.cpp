@@ -0,0 +1,94 @@
+#include "GameAnalyticsJsonWriter.h"
+#include "GameAnalyticsStaticDeviceInfo.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const char * const SdkVersion = "uwp_cpp 2.0.0";
+	const char * const UserId = "f8b6b08d-ba04-4f2a-9f6b-a3b8f71d9d55";
+	const char * const SessionId = "0e9bd8ca-2a5e-4bfb-b6ef-6a2c8f1b7f3d";
+
+	// Writes the fields of a design event, which the core writes for every event in any case.
+	void WriteEventFields(JsonWriter & writer, const int64_t index)
+	{
+		writer.WriteMember("category", "design");
+		writer.WriteMember("client_ts", static_cast<int64_t>(1700000000 + index / 100));
+		writer.WriteMember("event_id", "Kill:Sword:Robot");
+		writer.WriteMember("value", static_cast<double>(index));
+	}
+
+	// Writes the annotations shared by all players, querying the device info again, like building each event did before annotations were cached.
+	void WriteSharedAnnotations(JsonWriter & writer, const DeviceInfo & deviceInfo)
+	{
+		writer.WriteMember("device", deviceInfo.GetDeviceModel());
+		writer.WriteMember("v", static_cast<int64_t>(2));
+		writer.WriteMember("sdk_version", SdkVersion);
+		writer.WriteMember("os_version", deviceInfo.GetOSVersion());
+		writer.WriteMember("manufacturer", deviceInfo.GetManufacturer());
+		writer.WriteMember("platform", deviceInfo.GetPlatform());
+		writer.WriteMember("build", deviceInfo.GetAppVersion());
+	}
+
+	// Writes the annotations of the session of the local user.
+	void WriteUserAnnotations(JsonWriter & writer)
+	{
+		writer.WriteMember("user_id", UserId);
+		writer.WriteMember("session_id", SessionId);
+		writer.WriteMember("session_num", static_cast<int64_t>(1));
+	}
+}
+
+
+// Serializes design events with all session annotations into a reused buffer, either building the annotations for each event,
+// or splicing the fragments built once per session, like the core does since annotations are cached.
+static void BM_WriteEventAnnotations(benchmark::State & state)
+{
+	const auto cached = state.range(0) != 0;
+	StaticDeviceInfo deviceInfo("windows", "windows 10.0.10586", "pc", "unknown", "1.0", "test-hardware-id");
+
+	// Build the fragments once, like the core does on initialization.
+	JsonWriter fragment;
+	WriteSharedAnnotations(fragment, deviceInfo);
+	auto shared = fragment.GetString();
+
+	fragment.Clear();
+	WriteUserAnnotations(fragment);
+	auto user = fragment.GetString();
+
+	JsonWriter writer;
+	int64_t index = 0;
+
+	for (auto _ : state)
+	{
+		writer.Clear();
+		writer.BeginObject();
+		WriteEventFields(writer, index);
+
+		if (cached)
+		{
+			writer.WriteMembers(shared);
+			writer.WriteMembers(user);
+		}
+		else
+		{
+			WriteSharedAnnotations(writer, deviceInfo);
+			WriteUserAnnotations(writer);
+		}
+
+		writer.EndObject();
+		benchmark::DoNotOptimize(writer.GetString().data());
+		++index;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(writer.GetString().size()));
+}
+
+BENCHMARK(BM_WriteEventAnnotations)->ArgName("cached")->Arg(0)->Arg(1);
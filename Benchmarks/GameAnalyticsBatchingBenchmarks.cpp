@@ -0,0 +1,83 @@
+#include "GameAnalyticsHttpCollector.h"
+#include "GameAnalyticsHttpTransport.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Number of events sent per iteration, however many of them are sent per request.
+	const uint64_t ThroughputEvents = 4096;
+}
+
+
+// Sends 4096 design events over HTTP to the collector, which verifies signatures and validates events, flushing after every
+// specified number of events and waiting for the collector to receive them before sending the next ones.
+// Flushing after every event is the path of sending each event by a request of its own, like before events were queued.
+// Reports events and requests per second.
+static void BM_EventThroughput(benchmark::State & state)
+{
+	auto eventsPerRequest = static_cast<uint64_t>(state.range(0));
+
+	auto backend = std::make_shared<LoopbackTransport>();
+	backend->SetSecretKey(TestSecretKey);
+
+	HttpCollector collector(backend);
+	TestDirectory directory;
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(std::make_shared<HttpTransport>(collector.GetPort()), directory.GetPath()));
+
+	core->SetMaxPendingEvents(ThroughputEvents);
+	core->Init([](const InitResult &) {});
+
+	while (!core->IsInitialized())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	auto requestsBefore = backend->GetStatistics().eventsRequests;
+	uint64_t received = 0;
+
+	for (auto _ : state)
+	{
+		for (uint64_t i = 0; i < ThroughputEvents; ++i)
+		{
+			core->SendDesignEvent("Kill:Sword:Robot", static_cast<float>(i));
+
+			if ((i + 1) % eventsPerRequest == 0)
+			{
+				received += eventsPerRequest;
+
+				while (backend->GetStatistics().eventsReceived < received)
+				{
+					core->Flush();
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+	auto statistics = backend->GetStatistics();
+
+	if (statistics.unauthorizedRequests > 0 || statistics.rejectedRequests > 0)
+	{
+		state.SkipWithError("Collector has refused requests.");
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ThroughputEvents));
+	state.counters["requests"] = benchmark::Counter(static_cast<double>(statistics.eventsRequests - requestsBefore), benchmark::Counter::kIsRate);
+
+	core.reset();
+}
+
+BENCHMARK(BM_EventThroughput)->ArgName("events_per_request")->Arg(1)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond)->UseRealTime();
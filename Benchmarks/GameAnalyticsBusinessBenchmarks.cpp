@@ -0,0 +1,75 @@
+#include "GameAnalyticsFileKeyValueStore.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsMemoryKeyValueStore.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const char * const StoreNames[] = { "memory", "file" };
+}
+
+
+// Sends business events, each of which takes a transaction number, with the worker thread flushing events and reserving
+// numbers in the background. Stores counters in memory only, or in a file that is replaced whenever a range is reserved.
+static void BM_BusinessEvent(benchmark::State & state)
+{
+	state.SetLabel(StoreNames[state.range(0)]);
+
+	TestDirectory directory;
+
+	auto environment = CreateTestEnvironment(std::make_shared<LoopbackTransport>(), directory.GetPath());
+
+	if (state.range(0) != 0)
+	{
+		environment.keyValueStore = std::make_shared<FileKeyValueStore>(directory.GetPath() / "settings");
+	}
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, environment);
+	core->Init([](const InitResult &) {});
+
+	while (!core->IsInitialized())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	core->StartWorker();
+
+	for (auto _ : state)
+	{
+		core->SendBusinessEvent("Weapons:SwordOfFire", "USD", 99);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+
+	core->StopWorker();
+	core.reset();
+}
+
+BENCHMARK(BM_BusinessEvent)->ArgName("store")->Arg(0)->Arg(1)->UseRealTime();
+
+// Takes transaction numbers like before the persistent counter, reading, incrementing and committing the stored number every time.
+static void BM_TransactionNumberPerCall(benchmark::State & state)
+{
+	TestDirectory directory;
+	FileKeyValueStore store(directory.GetPath() / "settings");
+
+	for (auto _ : state)
+	{
+		auto number = store.GetInt32OrDefault("GameAnalytics::Transaction") + 1;
+		store.SetInt32("GameAnalytics::Transaction", number);
+		store.Commit();
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_TransactionNumberPerCall)->UseRealTime();
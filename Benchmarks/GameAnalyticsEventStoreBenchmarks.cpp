@@ -0,0 +1,132 @@
+#include "GameAnalyticsEventStore.h"
+#include "GameAnalyticsTestDirectory.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const uint64_t MaxSegmentBytes = 4 * 1024 * 1024;
+	const uint64_t MaxTotalBytes = 4ull * 1024 * 1024 * 1024;
+
+	// Typical serialized design event, of about 250 bytes.
+	std::string GetEvent(const int64_t index)
+	{
+		return "{\"category\":\"design\",\"event_id\":\"Kill:Sword:Robot\",\"value\":" + std::to_string(index)
+			+ ",\"v\":2,\"user_id\":\"f8b6b08d-ba04-4f2a-9f6b-a3b8f71d9d55\",\"client_ts\":1700000000,\"sdk_version\":\"uwp_cpp 2.0.0\""
+			+ ",\"os_version\":\"windows 10.0.10586\",\"manufacturer\":\"unknown\",\"device\":\"pc\",\"platform\":\"windows\",\"session_num\":1}";
+	}
+
+	EventBatch GetBatch(const int64_t first, const int64_t count)
+	{
+		EventBatch batch;
+
+		for (auto i = first; i < first + count; ++i)
+		{
+			auto event = GetEvent(i);
+			batch.Add(event.data(), event.size());
+		}
+
+		return batch;
+	}
+}
+
+
+// Appends batches of the specified number of events, optionally syncing after each batch, as the core does when flushing.
+static void BM_EventStoreAppend(benchmark::State & state)
+{
+	auto batchEvents = state.range(0);
+	auto sync = state.range(1) != 0;
+
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+
+	auto batch = GetBatch(0, batchEvents);
+
+	for (auto _ : state)
+	{
+		store.Append(batch);
+
+		if (sync)
+		{
+			store.Sync();
+		}
+
+		// Keep the log from growing without bounds.
+		if (store.GetSize() > 256 * 1024 * 1024)
+		{
+			state.PauseTiming();
+			store.SetMaxTotalBytes(0);
+			store.SetMaxTotalBytes(MaxTotalBytes);
+			state.ResumeTiming();
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * batchEvents);
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(batch.GetSize()));
+}
+
+BENCHMARK(BM_EventStoreAppend)->ArgNames({ "events", "sync" })->Args({ 1, 0 })->Args({ 64, 0 })->Args({ 64, 1 })->Args({ 1024, 1 })->UseRealTime();
+
+// Replays a log of the specified number of events in batches of 512 events, as sent after connectivity returns,
+// and acknowledges each batch. Reports the time to open the log, which checks the last segment, as well.
+static void BM_EventStoreReplay(benchmark::State & state)
+{
+	auto events = state.range(0);
+
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+
+		for (int64_t i = 0; i < events; i += 4096)
+		{
+			store.Append(GetBatch(i, std::min<int64_t>(4096, events - i)));
+		}
+
+		store.Sync();
+	}
+
+	double openSeconds = 0;
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+
+		// Replay a copy, since replaying deletes the events.
+		TestDirectory copy;
+		std::filesystem::copy(directory.GetPath(), copy.GetPath(), std::filesystem::copy_options::recursive);
+
+		state.ResumeTiming();
+
+		auto start = std::chrono::steady_clock::now();
+		EventStore store(copy.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		openSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		std::string batch;
+		EventStore::Position end;
+		int64_t replayed = 0;
+
+		while (auto count = store.ReadBatch(store.GetAcknowledged(), 512, 1024 * 1024, batch, end))
+		{
+			store.Acknowledge(end);
+			replayed += static_cast<int64_t>(count);
+		}
+
+		if (replayed != events)
+		{
+			state.SkipWithError("Not all events have been replayed.");
+			break;
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * events);
+	state.counters["open_ms"] = benchmark::Counter(openSeconds * 1000 / static_cast<double>(state.iterations()));
+}
+
+BENCHMARK(BM_EventStoreReplay)->ArgName("events")->Arg(1 << 20)->Arg(4 << 20)->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(2);
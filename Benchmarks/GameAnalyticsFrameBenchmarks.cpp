@@ -0,0 +1,151 @@
+#include "GameAnalyticsHttpCollector.h"
+#include "GameAnalyticsHttpTransport.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Ways of doing the work of the core in a game loop.
+	enum class FrameMode
+	{
+		// Update every frame, which does all work due at once.
+		Update,
+
+		// Pump with a share of the frame budget every frame.
+		Pump,
+
+		// Worker thread, with the game thread only sending events.
+		Worker
+	};
+
+	const char * const FrameModeNames[] = { "update", "pump", "worker" };
+
+	// Game loop sending events at a steady rate, with a burst, e.g. of a level ending, in the middle of the run.
+	const double RunSeconds = 3.0;
+	const int EventsPerSecond = 3000;
+	const int BurstEvents = 5000;
+
+	// Budget of Pump per frame, in microseconds.
+	int64_t GetPumpBudget(const int framesPerSecond)
+	{
+		return framesPerSecond <= 60 ? 1000 : 400;
+	}
+}
+
+
+// Runs a game loop at the specified frame rate for three seconds, sending 3000 design events per second, and a burst of 5000 events
+// after 1.5 seconds. Events are sent over HTTP to a collector answering after 20 ms, so checking them isn't counted as work of the game thread.
+// Measures the time the SDK takes on the game thread per frame, for sending events and doing its work by Update, Pump or a worker thread,
+// and reports the maximum and 99th percentile in microseconds. Frames sleep until the next one is due, so flushes and responses happen in real time.
+static void BM_PumpFrame(benchmark::State & state)
+{
+	auto mode = static_cast<FrameMode>(state.range(0));
+	auto framesPerSecond = static_cast<int>(state.range(1));
+
+	state.SetLabel(FrameModeNames[state.range(0)]);
+
+	auto frameTime = std::chrono::nanoseconds(1000000000 / framesPerSecond);
+	auto frames = static_cast<int>(RunSeconds * framesPerSecond);
+	auto eventsPerFrame = EventsPerSecond / framesPerSecond;
+
+	std::vector<double> frameMicroseconds;
+	frameMicroseconds.reserve(static_cast<size_t>(frames));
+
+	for (auto _ : state)
+	{
+		auto backend = std::make_shared<LoopbackTransport>();
+		backend->SetLatency(std::chrono::milliseconds(20));
+
+		HttpCollector collector(backend);
+		TestDirectory directory;
+
+		auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+			CreateTestEnvironment(std::make_shared<HttpTransport>(collector.GetPort()), directory.GetPath()));
+		core->SetFlushInterval(1);
+		core->SetMaxPendingEvents(1 << 16);
+
+		if (mode == FrameMode::Worker)
+		{
+			core->StartWorker();
+		}
+
+		core->Init([](const InitResult &) {});
+
+		while (!core->IsInitialized())
+		{
+			core->Update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		frameMicroseconds.clear();
+
+		char eventId[64];
+		uint64_t sent = 0;
+		auto nextFrame = std::chrono::steady_clock::now();
+
+		for (auto frame = 0; frame < frames; ++frame)
+		{
+			auto events = frame == frames / 2 ? eventsPerFrame + BurstEvents : eventsPerFrame;
+			auto start = std::chrono::steady_clock::now();
+
+			for (auto i = 0; i < events; ++i)
+			{
+				std::snprintf(eventId, sizeof(eventId), "Level%d:Enemy%d:Kill", static_cast<int>(sent % 13), static_cast<int>(sent % 97));
+				core->SendDesignEvent(eventId, static_cast<float>(sent));
+				++sent;
+			}
+
+			switch (mode)
+			{
+			case FrameMode::Update:
+				core->Update();
+				break;
+
+			case FrameMode::Pump:
+				core->Pump(GetPumpBudget(framesPerSecond));
+				break;
+
+			case FrameMode::Worker:
+				break;
+			}
+
+			frameMicroseconds.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+			nextFrame += frameTime;
+			std::this_thread::sleep_until(nextFrame);
+		}
+
+		core->StopWorker();
+		core.reset();
+	}
+
+	std::sort(frameMicroseconds.begin(), frameMicroseconds.end());
+
+	auto sum = 0.0;
+
+	for (auto microseconds : frameMicroseconds)
+	{
+		sum += microseconds;
+	}
+
+	state.counters["max_us"] = benchmark::Counter(frameMicroseconds.back());
+	state.counters["p99_us"] = benchmark::Counter(frameMicroseconds[frameMicroseconds.size() * 99 / 100]);
+	state.counters["mean_us"] = benchmark::Counter(sum / static_cast<double>(frameMicroseconds.size()));
+}
+
+BENCHMARK(BM_PumpFrame)->ArgNames({ "mode", "hz" })->ArgsProduct({ { 0, 1, 2 }, { 60, 144 } })
+	->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(1);
@@ -0,0 +1,104 @@
+#include "GameAnalyticsEventLimiter.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+
+using namespace GameAnalytics;
+
+
+// Checks the limits of a design event, without any limits set, with the limit of its category, and with limits per id.
+static void BM_LimiterTryAcquire(benchmark::State & state)
+{
+	EventLimiter limiter;
+
+	if (state.range(0) > 0)
+	{
+		limiter.SetRateLimit(EventCategory::Design, 1e9, 1000000);
+	}
+
+	if (state.range(0) > 1)
+	{
+		limiter.SetEventIdRateLimit(1e9, 1000000);
+	}
+
+	int64_t now = 0;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Sword:Robot", ++now));
+	}
+}
+
+BENCHMARK(BM_LimiterTryAcquire)->ArgName("limits")->Arg(0)->Arg(1)->Arg(2);
+
+// Raises the same error, or one of 100 distinct errors, 60 times per simulated frame for ten simulated minutes,
+// and reports how many of them are sent per second. Errors are limited to 10 per second and repetitions counted by default.
+static void BM_ErrorFlood(benchmark::State & state)
+{
+	const auto frames = 60 * 60 * 10;
+	const auto errorsPerFrame = 60;
+	const int64_t frameMilliseconds = 16;
+
+	auto distinctMessages = static_cast<int>(state.range(0));
+
+	std::string messages[100];
+
+	for (auto i = 0; i < distinctMessages; ++i)
+	{
+		messages[i] = "NullReferenceException at Enemy.Update() in enemy " + std::to_string(i);
+	}
+
+	uint64_t queuedEvents = 0;
+	uint64_t sentErrors = 0;
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+
+		TestDirectory directory;
+		auto transport = std::make_shared<LoopbackTransport>();
+		auto clock = std::make_shared<ManualClock>();
+		auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath(), clock));
+		core->Init([](const InitResult &) {});
+
+		auto queuedBefore = core->GetMetrics().queuedEvents;
+
+		state.ResumeTiming();
+
+		for (auto frame = 0; frame < frames; ++frame)
+		{
+			for (auto i = 0; i < errorsPerFrame; ++i)
+			{
+				core->SendErrorEvent(messages[(frame * errorsPerFrame + i) % distinctMessages], Severity::Error);
+			}
+
+			clock->Advance(frameMilliseconds);
+			core->Update();
+		}
+
+		state.PauseTiming();
+
+		core->Flush();
+
+		queuedEvents += core->GetMetrics().queuedEvents - queuedBefore;
+		sentErrors += transport->GetStatistics().eventsReceived;
+
+		core.reset();
+
+		state.ResumeTiming();
+	}
+
+	auto simulatedSeconds = static_cast<double>(state.iterations()) * frames * frameMilliseconds / 1000;
+
+	state.SetItemsProcessed(state.iterations() * frames * errorsPerFrame);
+	state.counters["raised_per_second"] = benchmark::Counter(static_cast<double>(state.iterations()) * frames * errorsPerFrame / simulatedSeconds);
+	state.counters["queued_per_second"] = benchmark::Counter(static_cast<double>(queuedEvents) / simulatedSeconds);
+	state.counters["received_per_second"] = benchmark::Counter(static_cast<double>(sentErrors) / simulatedSeconds);
+}
+
+BENCHMARK(BM_ErrorFlood)->ArgName("messages")->Arg(1)->Arg(100)->Unit(benchmark::kMillisecond)->Iterations(1);
@@ -0,0 +1,66 @@
+#include "GameAnalyticsLatencyHistogram.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	constexpr DesignEventId KillId("Kill:Sword:Robot");
+}
+
+
+// Sends design events by typed id, the cheapest way of sending them, with metrics disabled or enabled,
+// so the difference is the cost of measuring latencies per event. Counters are kept either way.
+// Queued events are flushed every 4096 events without timing it.
+static void BM_SendDesignEvent(benchmark::State & state)
+{
+	TestDirectory directory;
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(std::make_shared<LoopbackTransport>(), directory.GetPath(), std::make_shared<ManualClock>()));
+	core->SetMetricsEnabled(state.range(0) != 0);
+	core->Init([](const InitResult &) {});
+
+	uint64_t sent = 0;
+
+	for (auto _ : state)
+	{
+		core->SendDesignEvent(KillId, 1.0f);
+
+		if (++sent % 4096 == 0)
+		{
+			state.PauseTiming();
+			core->Flush();
+			state.ResumeTiming();
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SendDesignEvent)->ArgName("metrics")->Arg(0)->Arg(1);
+
+// Records a single duration in a latency histogram, as done for each measured stage.
+static void BM_RecordLatency(benchmark::State & state)
+{
+	LatencyHistogram histogram;
+	uint64_t nanoseconds = 100;
+
+	for (auto _ : state)
+	{
+		histogram.Record(nanoseconds);
+		nanoseconds = (nanoseconds * 13) % 100003;
+	}
+
+	benchmark::DoNotOptimize(histogram.GetSummary());
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_RecordLatency);
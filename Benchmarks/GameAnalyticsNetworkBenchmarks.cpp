@@ -0,0 +1,141 @@
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Network simulated by the loopback transport. Settings switch to the next profile after the specified time, if any.
+	struct NetworkProfile
+	{
+		const char * name;
+		int latency;
+		uint64_t bandwidth;
+		int timeout;
+		size_t maxRequestBytes;
+
+		const NetworkProfile * next;
+		double nextAfterSeconds;
+	};
+
+	const NetworkProfile Mobile = { "mobile", 300, 100 * 1000, 5000, 0, nullptr, 0 };
+
+	const NetworkProfile Profiles[] =
+	{
+		{ "fibre", 5, 50 * 1000 * 1000, 10000, 0, nullptr, 0 },
+		{ "mobile", 300, 100 * 1000, 5000, 0, nullptr, 0 },
+		{ "2g", 600, 8 * 1000, 5000, 0, nullptr, 0 },
+		{ "limited", 20, 5 * 1000 * 1000, 10000, 16 * 1024, nullptr, 0 },
+		{ "fibre_to_mobile", 5, 50 * 1000 * 1000, 10000, 0, &Mobile, 1.0 }
+	};
+
+	void Apply(LoopbackTransport & transport, const NetworkProfile & profile)
+	{
+		transport.SetLatency(std::chrono::milliseconds(profile.latency));
+		transport.SetBandwidth(profile.bandwidth);
+		transport.SetTimeout(std::chrono::milliseconds(profile.timeout));
+		transport.SetMaxRequestBytes(profile.maxRequestBytes);
+	}
+}
+
+
+// Sends a backlog of 20000 design events, e.g. buffered while offline, over a simulated network, and measures how long it takes
+// until all of them have been received. Compares adaptive batches with fixed batches of 64 KB. Profiles are fibre, a mobile connection,
+// 2G, a backend refusing requests above 16 KB with status code 413, and fibre getting as slow as mobile after a second.
+static void BM_DrainBacklog(benchmark::State & state)
+{
+	const uint64_t events = 20000;
+	const double maxSeconds = 120;
+
+	auto & profile = Profiles[state.range(0)];
+	auto adaptive = state.range(1) != 0;
+
+	state.SetLabel(std::string(profile.name) + (adaptive ? "/adaptive" : "/fixed"));
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+
+		TestDirectory directory;
+		auto transport = std::make_shared<LoopbackTransport>();
+		transport->SetSecretKey(TestSecretKey);
+		Apply(*transport, profile);
+
+		auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+		core->SetMetricsEnabled(true);
+		core->SetFlushInterval(1);
+		core->SetMaxStoreBytes(1ull << 30);
+		core->SetMaxPendingEvents(1 << 20);
+
+		if (!adaptive)
+		{
+			core->SetMaxPayloadBytes(64 * 1024);
+			core->SetMaxUploadLatency(1 << 30);
+		}
+
+		// Events sent before initialization are buffered, and sent all at once afterwards.
+		char eventId[64];
+
+		for (uint64_t i = 0; i < events; ++i)
+		{
+			std::snprintf(eventId, sizeof(eventId), "Level%d:Enemy%d:Kill", static_cast<int>(i % 13), static_cast<int>(i % 97));
+			core->SendDesignEvent(eventId, static_cast<float>(i));
+		}
+
+		state.ResumeTiming();
+
+		auto start = std::chrono::steady_clock::now();
+		auto changed = false;
+		core->Init([](const InitResult &) {});
+
+		while (transport->GetStatistics().eventsReceived < events || core->GetMetrics().inFlightBatches > 0)
+		{
+			auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (profile.next != nullptr && !changed && seconds > profile.nextAfterSeconds)
+			{
+				Apply(*transport, *profile.next);
+				changed = true;
+			}
+
+			if (seconds > maxSeconds)
+			{
+				state.SkipWithError("Backlog has not been sent within two minutes.");
+				break;
+			}
+
+			core->Update();
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+
+		state.PauseTiming();
+
+		auto metrics = core->GetMetrics();
+		auto statistics = transport->GetStatistics();
+
+		state.counters["requests"] = benchmark::Counter(static_cast<double>(metrics.requests));
+		state.counters["failed"] = benchmark::Counter(static_cast<double>(metrics.failedRequests));
+		state.counters["timeouts"] = benchmark::Counter(static_cast<double>(statistics.timedOutRequests));
+		state.counters["largest_request"] = benchmark::Counter(static_cast<double>(statistics.largestRequestBytes));
+		state.counters["batch_bytes"] = benchmark::Counter(static_cast<double>(metrics.batchBytes));
+		state.counters["upload_p99_ms"] = benchmark::Counter(metrics.upload.p99 / 1000);
+
+		core.reset();
+
+		state.ResumeTiming();
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(events));
+}
+
+BENCHMARK(BM_DrainBacklog)->ArgNames({ "profile", "adaptive" })->ArgsProduct({ { 0, 1, 2, 3, 4 }, { 0, 1 } })
+	->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(1);
@@ -0,0 +1,257 @@
+#include "GameAnalyticsAllocationCounter.h"
+#include "GameAnalyticsGzip.h"
+#include "GameAnalyticsHttpCollector.h"
+#include "GameAnalyticsHttpTransport.h"
+#include "GameAnalyticsJsonWriter.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsSha256.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Writes a typical design event with all annotations, like the core does when flushing.
+	void WriteEvent(JsonWriter & writer, const int64_t index)
+	{
+		writer.BeginObject();
+		writer.WriteMember("category", "design");
+		writer.WriteMember("event_id", "Kill:Sword:Robot");
+		writer.WriteMember("value", static_cast<double>(index));
+		writer.WriteMember("v", static_cast<int64_t>(2));
+		writer.WriteMember("user_id", "f8b6b08d-ba04-4f2a-9f6b-a3b8f71d9d55");
+		writer.WriteMember("session_id", "0e9bd8ca-2a5e-4bfb-b6ef-6a2c8f1b7f3d");
+		writer.WriteMember("session_num", static_cast<int64_t>(1));
+		writer.WriteMember("client_ts", static_cast<int64_t>(1700000000 + index / 100));
+		writer.WriteMember("sdk_version", "uwp_cpp 2.0.0");
+		writer.WriteMember("os_version", "windows 10.0.10586");
+		writer.WriteMember("manufacturer", "unknown");
+		writer.WriteMember("device", "pc");
+		writer.WriteMember("platform", "windows");
+		writer.EndObject();
+	}
+
+	// Gets an events request body of at least the specified size.
+	std::string GetBody(const size_t bytes)
+	{
+		JsonWriter writer;
+		writer.BeginArray();
+
+		for (int64_t i = 0; writer.GetString().size() < bytes; ++i)
+		{
+			WriteEvent(writer, i);
+		}
+
+		writer.EndArray();
+		return writer.GetString();
+	}
+
+	// Starts a core sending events to a loopback transport, with a clock advanced by the benchmark.
+	std::shared_ptr<GameAnalyticsCore> StartCore(const TestDirectory & directory)
+	{
+		auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+			CreateTestEnvironment(std::make_shared<LoopbackTransport>(), directory.GetPath(), std::make_shared<ManualClock>()));
+
+		core->Init([](const InitResult &) {});
+		return core;
+	}
+}
+
+
+// Stages of sending an event, one after another: building and queueing, serializing, signing, compressing, and uploading.
+// Storing events is measured by BM_EventStoreAppend, and queueing from many threads at once by BM_EnqueueContention.
+
+// Sends design events by string id, which checks, limits, builds and queues their records, with metrics disabled or enabled.
+// Queued events are flushed every 4096 events without timing it.
+static void BM_BuildEvent(benchmark::State & state)
+{
+	TestDirectory directory;
+	auto core = StartCore(directory);
+	core->SetMetricsEnabled(state.range(0) != 0);
+
+	auto value = 0.0f;
+
+	for (auto _ : state)
+	{
+		core->SendDesignEvent("Kill:Sword:Robot", value);
+		value += 1.0f;
+
+		if (static_cast<int64_t>(value) % 4096 == 0)
+		{
+			state.PauseTiming();
+			core->Flush();
+			state.ResumeTiming();
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_BuildEvent)->ArgName("metrics")->Arg(0)->Arg(1);
+
+// Serializes batches of the specified number of design events into a reused buffer, and reports the heap allocations and bytes per event.
+// The first batch grows the buffer without timing it, like the first flush of a session.
+static void BM_SerializeBatch(benchmark::State & state)
+{
+	auto events = state.range(0);
+
+	JsonWriter writer;
+	writer.BeginArray();
+
+	for (int64_t i = 0; i < events; ++i)
+	{
+		WriteEvent(writer, i);
+	}
+
+	size_t bytes = 0;
+	auto allocations = AllocationCounter::GetAllocations();
+	auto allocatedBytes = AllocationCounter::GetTotalAllocatedBytes();
+
+	for (auto _ : state)
+	{
+		writer.Clear();
+		writer.BeginArray();
+
+		for (int64_t i = 0; i < events; ++i)
+		{
+			WriteEvent(writer, i);
+		}
+
+		writer.EndArray();
+
+		bytes = writer.GetString().size();
+		benchmark::DoNotOptimize(writer.GetString().data());
+	}
+
+	auto serialized = static_cast<double>(state.iterations() * events);
+
+	state.SetItemsProcessed(state.iterations() * events);
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+	state.counters["allocs_per_event"] = benchmark::Counter(static_cast<double>(AllocationCounter::GetAllocations() - allocations) / serialized);
+	state.counters["allocated_bytes_per_event"] = benchmark::Counter(static_cast<double>(AllocationCounter::GetTotalAllocatedBytes() - allocatedBytes) / serialized);
+}
+
+BENCHMARK(BM_SerializeBatch)->ArgName("events")->Arg(64)->Arg(512);
+
+// Computes the Authorization header of request bodies of the specified size, with the key prepared once.
+static void BM_SignBody(benchmark::State & state)
+{
+	auto body = GetBody(static_cast<size_t>(state.range(0)));
+
+	HmacSha256 signer(TestSecretKey);
+	uint8_t mac[Sha256::DigestSize];
+
+	for (auto _ : state)
+	{
+		signer.Update(body.data(), body.size());
+		signer.Finish(mac);
+		signer.Reset();
+
+		benchmark::DoNotOptimize(mac);
+	}
+
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(body.size()));
+}
+
+BENCHMARK(BM_SignBody)->ArgName("bytes")->Arg(4 * 1024)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+// Compresses request bodies of the specified size, reusing the buffers of the compressor.
+static void BM_CompressBody(benchmark::State & state)
+{
+	auto body = GetBody(static_cast<size_t>(state.range(0)));
+
+	GzipCompressor compressor;
+	size_t compressedBytes = 0;
+
+	for (auto _ : state)
+	{
+		compressor.Reset();
+		compressor.Write(body.data(), body.size());
+		compressedBytes = compressor.Finish().size();
+	}
+
+	state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(body.size()));
+	state.counters["ratio"] = benchmark::Counter(static_cast<double>(body.size()) / static_cast<double>(compressedBytes));
+}
+
+BENCHMARK(BM_CompressBody)->ArgName("bytes")->Arg(4 * 1024)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+// Sends the specified number of design events and flushes them, until the collector has received them all over HTTP.
+// Includes serializing, storing, signing, compressing and uploading them, with the collector verifying signatures and validating events.
+// The collector answers after 20 ms, like a nearby data center, and the core keeps the specified number of batches in flight at most.
+// Reports requests per iteration, and the 99th percentile of the time between sending a batch and receiving its response in milliseconds.
+static void BM_Upload(benchmark::State & state)
+{
+	auto events = static_cast<uint64_t>(state.range(0));
+	auto window = static_cast<size_t>(state.range(1));
+
+	auto backend = std::make_shared<LoopbackTransport>();
+	backend->SetSecretKey(TestSecretKey);
+	backend->SetLatency(std::chrono::milliseconds(20));
+
+	HttpCollector collector(backend);
+	TestDirectory directory;
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(std::make_shared<HttpTransport>(collector.GetPort()), directory.GetPath()));
+
+	core->SetMaxInFlightBatches(window);
+	core->SetMaxPendingEvents(events);
+	core->SetMetricsEnabled(true);
+	core->Init([](const InitResult &) {});
+
+	while (!core->IsInitialized())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	uint64_t received = 0;
+
+	for (auto _ : state)
+	{
+		for (uint64_t i = 0; i < events; ++i)
+		{
+			core->SendDesignEvent("Kill:Sword:Robot", static_cast<float>(i));
+		}
+
+		received += events;
+
+		// Responses arrive on the threads of the transport, and make room for sending the next batches.
+		while (backend->GetStatistics().eventsReceived < received)
+		{
+			core->Flush();
+			std::this_thread::yield();
+		}
+	}
+
+	auto statistics = backend->GetStatistics();
+	auto metrics = core->GetMetrics();
+
+	if (statistics.unauthorizedRequests > 0 || statistics.rejectedRequests > 0)
+	{
+		state.SkipWithError("Collector has refused requests.");
+	}
+
+	if (statistics.maxPendingRequests > window)
+	{
+		state.SkipWithError("Core has sent more batches than allowed by its window.");
+	}
+
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(events));
+	state.SetBytesProcessed(static_cast<int64_t>(statistics.bytesReceived));
+	state.counters["requests"] = benchmark::Counter(static_cast<double>(statistics.eventsRequests) / static_cast<double>(state.iterations()));
+	state.counters["upload_p99_ms"] = benchmark::Counter(metrics.upload.p99 / 1000);
+
+	core.reset();
+}
+
+BENCHMARK(BM_Upload)->ArgNames({ "events", "window" })->Args({ 1, 4 })->Args({ 512, 4 })
+	->ArgsProduct({ { 8192 }, { 1, 2, 4, 8, 16 } })->Unit(benchmark::kMillisecond)->UseRealTime();
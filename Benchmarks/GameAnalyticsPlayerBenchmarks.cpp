@@ -0,0 +1,93 @@
+#include "GameAnalyticsAllocationCounter.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace GameAnalytics;
+
+
+// Starts sessions for the specified number of players on one core, like a dedicated game server, and reports the heap memory per player context.
+// Then sends design events on behalf of random players, and reports events per second.
+// Queued events are flushed to a loopback transport verifying signatures every 4096 events without timing it.
+static void BM_PlayerSessions(benchmark::State & state)
+{
+	auto playerCount = static_cast<size_t>(state.range(0));
+
+	auto backend = std::make_shared<LoopbackTransport>();
+	backend->SetSecretKey(TestSecretKey);
+
+	TestDirectory directory;
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(backend, directory.GetPath(), std::make_shared<ManualClock>()));
+	core->Init([](const InitResult &) {});
+
+	std::vector<std::string> userIds;
+	userIds.reserve(playerCount);
+
+	for (size_t i = 0; i < playerCount; ++i)
+	{
+		userIds.push_back("player-" + std::to_string(i));
+	}
+
+	std::vector<PlayerContext> players;
+	players.reserve(playerCount);
+
+	auto allocatedBytes = AllocationCounter::GetAllocatedBytes();
+
+	for (auto & userId : userIds)
+	{
+		players.push_back(core->StartPlayerSession(userId, 1));
+	}
+
+	auto bytesPerPlayer = static_cast<double>(AllocationCounter::GetAllocatedBytes() - allocatedBytes) / static_cast<double>(playerCount);
+
+	// Linear congruential generator, so picking players costs next to nothing.
+	uint32_t random = 12345;
+	uint64_t sent = 0;
+
+	for (auto _ : state)
+	{
+		random = random * 1664525 + 1013904223;
+
+		{
+			PlayerScope scope(*core, players[random % playerCount]);
+			core->SendDesignEvent("Kill:Sword:Robot", static_cast<float>(sent));
+		}
+
+		if (++sent % 4096 == 0)
+		{
+			state.PauseTiming();
+			core->Flush();
+			state.ResumeTiming();
+		}
+	}
+
+	core->Flush();
+
+	auto statistics = backend->GetStatistics();
+
+	if (statistics.unauthorizedRequests > 0 || statistics.rejectedRequests > 0)
+	{
+		state.SkipWithError("Loopback transport has refused requests.");
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["bytes_per_player"] = benchmark::Counter(bytesPerPlayer);
+
+	for (auto & player : players)
+	{
+		core->EndPlayerSession(player);
+	}
+
+	core.reset();
+}
+
+BENCHMARK(BM_PlayerSessions)->ArgName("players")->Arg(10000);
@@ -0,0 +1,199 @@
+#include "GameAnalyticsAllocationCounter.h"
+#include "GameAnalyticsEventBatch.h"
+#include "GameAnalyticsEventRing.h"
+#include "GameAnalyticsJsonWriter.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Core shared by all threads of the running benchmark.
+	std::unique_ptr<TestDirectory> SharedDirectory;
+	std::shared_ptr<GameAnalyticsCore> SharedCore;
+
+	void StartSharedCore()
+	{
+		SharedDirectory.reset(new TestDirectory());
+
+		auto transport = std::make_shared<LoopbackTransport>();
+		SharedCore = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, SharedDirectory->GetPath()));
+		SharedCore->Init([](const InitResult &) {});
+		SharedCore->StartWorker();
+	}
+
+	void StopSharedCore(benchmark::State & state)
+	{
+		SharedCore->StopWorker();
+
+		auto metrics = SharedCore->GetMetrics();
+		state.counters["dropped"] = benchmark::Counter(static_cast<double>(metrics.droppedEvents));
+
+		SharedCore.reset();
+		SharedDirectory.reset();
+	}
+
+	// Event ids of the pending events, cycled through.
+	const char * const PendingEventIds[] = { "Kill:Sword:Robot", "Kill:Bow:Robot", "Level:Start", "Level:Complete", "Item:Pickup:Potion", "Item:Pickup:Coin", "Menu:Open", "Menu:Close" };
+	const size_t PendingEventIdCount = sizeof(PendingEventIds) / sizeof(PendingEventIds[0]);
+
+	// Gets the record of the pending design event with the specified index.
+	EventRecord GetPendingRecord(const size_t index)
+	{
+		EventRecord record = {};
+		record.category = EventCategory::Design;
+		record.fields = EventField::Value;
+		record.timestamp = 1700000000000 + static_cast<int64_t>(index);
+		record.value = static_cast<double>(index);
+		record.eventId = PendingEventIds[index % PendingEventIdCount];
+		return record;
+	}
+
+	// Serializes the specified pending design event with all annotations, like events were queued before typed records.
+	void WritePendingEvent(JsonWriter & writer, const size_t index)
+	{
+		writer.Clear();
+		writer.BeginObject();
+		writer.WriteMember("category", "design");
+		writer.WriteMember("client_ts", static_cast<int64_t>(1700000000 + index / 1000));
+		writer.WriteMember("event_id", PendingEventIds[index % PendingEventIdCount]);
+		writer.WriteMember("value", static_cast<double>(index));
+		writer.WriteMember("device", "pc");
+		writer.WriteMember("v", static_cast<int64_t>(2));
+		writer.WriteMember("sdk_version", "uwp_cpp 2.0.0");
+		writer.WriteMember("os_version", "windows 10.0.10586");
+		writer.WriteMember("manufacturer", "unknown");
+		writer.WriteMember("platform", "windows");
+		writer.WriteMember("build", "1.0");
+		writer.WriteMember("user_id", "f8b6b08d-ba04-4f2a-9f6b-a3b8f71d9d55");
+		writer.WriteMember("session_id", "0e9bd8ca-2a5e-4bfb-b6ef-6a2c8f1b7f3d");
+		writer.WriteMember("session_num", static_cast<int64_t>(1));
+		writer.EndObject();
+	}
+
+	// Reports quantiles of the specified enqueue latencies of a single thread, averaged over all threads.
+	void ReportLatencies(benchmark::State & state, std::vector<uint64_t> & latencies)
+	{
+		if (latencies.empty())
+		{
+			return;
+		}
+
+		auto quantile = [&latencies](const double q)
+		{
+			auto nth = latencies.begin() + static_cast<ptrdiff_t>(q * (latencies.size() - 1));
+			std::nth_element(latencies.begin(), nth, latencies.end());
+			return static_cast<double>(*nth);
+		};
+
+		state.counters["p50_ns"] = benchmark::Counter(quantile(0.5), benchmark::Counter::kAvgThreads);
+		state.counters["p99_ns"] = benchmark::Counter(quantile(0.99), benchmark::Counter::kAvgThreads);
+		state.counters["p999_ns"] = benchmark::Counter(quantile(0.999), benchmark::Counter::kAvgThreads);
+		state.counters["max_ns"] = benchmark::Counter(quantile(1.0), benchmark::Counter::kAvgThreads);
+	}
+}
+
+
+// Sends design events from 1 to 64 threads at once, while the worker thread of the core takes and stores them.
+// Each call is timed on its own, including the clock reads of about 20 ns.
+static void BM_EnqueueContention(benchmark::State & state)
+{
+	if (state.thread_index() == 0)
+	{
+		StartSharedCore();
+	}
+
+	std::vector<uint64_t> latencies;
+	latencies.reserve(static_cast<size_t>(state.max_iterations));
+
+	auto value = 0.0f;
+
+	for (auto _ : state)
+	{
+		auto start = std::chrono::steady_clock::now();
+		SharedCore->SendDesignEvent("Benchmark:Contention:Design", value);
+		auto end = std::chrono::steady_clock::now();
+
+		latencies.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+		value += 1.0f;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	ReportLatencies(state, latencies);
+
+	if (state.thread_index() == 0)
+	{
+		StopSharedCore(state);
+	}
+}
+
+BENCHMARK(BM_EnqueueContention)->ThreadRange(1, 64)->UseRealTime()->Iterations(100000);
+
+const char * const PendingQueueNames[] = { "serialized", "ring" };
+
+// Queues the specified number of design events, either serialized with their annotations into a batch, like the queue did before,
+// or as typed records into a ring growing by doubling, like the queue of each thread does now. Reports the heap bytes per pending event.
+static void BM_PendingEvents(benchmark::State & state)
+{
+	const auto ring = state.range(0) != 0;
+	const auto events = static_cast<size_t>(state.range(1));
+	state.SetLabel(PendingQueueNames[state.range(0)]);
+
+	JsonWriter writer;
+	int64_t bytes = 0;
+
+	for (auto _ : state)
+	{
+		if (ring)
+		{
+			auto before = AllocationCounter::GetAllocatedBytes();
+			EventRing records(64);
+
+			for (size_t i = 0; i < events; ++i)
+			{
+				if (records.GetCount() == records.GetCapacity())
+				{
+					records.Reserve(records.GetCapacity() * 2);
+				}
+
+				records.TryPush(GetPendingRecord(i), 0);
+			}
+
+			bytes = AllocationCounter::GetAllocatedBytes() - before;
+			benchmark::DoNotOptimize(records.GetCount());
+		}
+		else
+		{
+			auto before = AllocationCounter::GetAllocatedBytes();
+			EventBatch batch;
+
+			for (size_t i = 0; i < events; ++i)
+			{
+				// The writer is reused, so only the copies kept by the batch count.
+				auto buffer = AllocationCounter::GetAllocatedBytes();
+				WritePendingEvent(writer, i);
+				before += AllocationCounter::GetAllocatedBytes() - buffer;
+
+				batch.Add(writer.GetString().data(), writer.GetString().size());
+			}
+
+			bytes = AllocationCounter::GetAllocatedBytes() - before;
+			benchmark::DoNotOptimize(batch.GetCount());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * state.range(1));
+	state.counters["bytes_per_event"] = benchmark::Counter(static_cast<double>(bytes) / static_cast<double>(events));
+}
+
+BENCHMARK(BM_PendingEvents)->ArgNames({ "ring", "events" })->ArgsProduct({ { 0, 1 }, { 1024, 65536 } });
@@ -0,0 +1,82 @@
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Round trip of the init request, in milliseconds, long enough for everything measured to happen before the response.
+	const int InitLatency = 200;
+
+	// Creates a core sending events to a loopback transport answering after the init latency.
+	std::shared_ptr<GameAnalyticsCore> CreateCore(const TestDirectory & directory)
+	{
+		auto backend = std::make_shared<LoopbackTransport>();
+		backend->SetLatency(std::chrono::milliseconds(InitLatency));
+
+		return std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+			CreateTestEnvironment(backend, directory.GetPath()));
+	}
+}
+
+
+// Startup of the game thread: creating the core, which opens the event store, and calling Init, which must not wait for the backend.
+// Destroying the core is not timed.
+static void BM_Startup(benchmark::State & state)
+{
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+		TestDirectory directory;
+		state.ResumeTiming();
+
+		auto core = CreateCore(directory);
+		core->Init([](const InitResult &) {});
+
+		state.PauseTiming();
+		core.reset();
+		state.ResumeTiming();
+	}
+}
+
+BENCHMARK(BM_Startup)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Sends design events after Init and before the init response has arrived, which buffers them until initialization has completed.
+// The buffer is bounded, so the core is created again every 4096 events without timing it.
+static void BM_SendBeforeInit(benchmark::State & state)
+{
+	const auto bufferedEvents = 4096;
+
+	std::unique_ptr<TestDirectory> directory;
+	std::shared_ptr<GameAnalyticsCore> core;
+	auto sent = 0;
+
+	for (auto _ : state)
+	{
+		if (sent % bufferedEvents == 0)
+		{
+			state.PauseTiming();
+			core.reset();
+			directory = std::make_unique<TestDirectory>();
+			core = CreateCore(*directory);
+			core->SetMaxPendingEvents(bufferedEvents);
+			core->Init([](const InitResult &) {});
+			state.ResumeTiming();
+		}
+
+		core->SendDesignEvent("Kill:Sword:Robot", static_cast<float>(sent));
+		++sent;
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	core.reset();
+}
+
+BENCHMARK(BM_SendBeforeInit);
@@ -0,0 +1,274 @@
+#include "GameAnalyticsAllocationCounter.h"
+#include "GameAnalyticsEventSchema.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+#include "GameAnalyticsUtf8.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Ways of passing the id of a design event.
+	enum class IdOverload
+	{
+		Literal,
+		String,
+		StringView,
+		EventId,
+		TypedEventId,
+
+		// Wide string converted into a reused buffer, like the Windows Runtime interface does.
+		WideString
+	};
+
+	const char * const IdOverloadNames[] = { "literal", "string", "string_view", "event_id", "typed_event_id", "wide_string" };
+
+	constexpr DesignEventId TypedKillId("Kill:Sword:Robot:Hit");
+
+	// Mixes of event ids sent: a few ids sent over and over, a long tail of ids hardly ever sent twice,
+	// or both, with 90% of events having one of the few ids, like a game sending kills per weapon and progression per level.
+	enum class IdMix
+	{
+		LowCardinality,
+		HighCardinality,
+		Realistic
+	};
+
+	const char * const IdMixNames[] = { "low_cardinality", "high_cardinality", "realistic" };
+
+	// Number of ids sent over and over, and of the long tail, which doesn't fit into the registry of 4096 ids.
+	const size_t HotIdCount = 32;
+	const size_t TailIdCount = 65536;
+
+	// Gets the indexes of the ids of the specified number of events of the specified mix, with the tail following the hot ids.
+	std::vector<size_t> GetIdSequence(const IdMix mix, const size_t count)
+	{
+		std::mt19937 random(42);
+		std::uniform_int_distribution<size_t> hot(0, HotIdCount - 1);
+		std::uniform_int_distribution<size_t> tail(HotIdCount, HotIdCount + TailIdCount - 1);
+		std::uniform_int_distribution<int> percent(0, 99);
+
+		std::vector<size_t> sequence(count);
+
+		for (auto & index : sequence)
+		{
+			switch (mix)
+			{
+			case IdMix::LowCardinality:
+				index = hot(random);
+				break;
+
+			case IdMix::HighCardinality:
+				index = tail(random);
+				break;
+
+			case IdMix::Realistic:
+				index = percent(random) < 90 ? hot(random) : tail(random);
+				break;
+			}
+		}
+
+		return sequence;
+	}
+
+	std::string_view ToUtf8Buffer(const std::wstring_view & s)
+	{
+		thread_local std::string buffer;
+		ToUtf8(s, buffer);
+		return buffer;
+	}
+}
+
+
+// Sends design events with a 20 character id passed by each overload family, and reports the heap allocations per call.
+// Queued events are flushed every 4096 events without timing it, and without counting its allocations.
+static void BM_SendDesignEventOverload(benchmark::State & state)
+{
+	auto overload = static_cast<IdOverload>(state.range(0));
+	state.SetLabel(IdOverloadNames[state.range(0)]);
+
+	TestDirectory directory;
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(std::make_shared<LoopbackTransport>(), directory.GetPath(), std::make_shared<ManualClock>()));
+	core->Init([](const InitResult &) {});
+
+	const std::string stringId("Kill:Sword:Robot:Hit");
+	const std::string_view viewId(stringId);
+	const std::wstring wideId(L"Kill:Sword:Robot:Hit");
+	auto eventId = core->RegisterEventId(viewId);
+
+	// Let the first calls allocate the reused buffers.
+	core->SendDesignEvent(ToUtf8Buffer(wideId), 0.0f);
+	core->Flush();
+
+	uint64_t flushAllocations = 0;
+	auto allocations = AllocationCounter::GetAllocations();
+	auto value = 0.0f;
+
+	for (auto _ : state)
+	{
+		switch (overload)
+		{
+		case IdOverload::Literal:
+			core->SendDesignEvent("Kill:Sword:Robot:Hit", value);
+			break;
+
+		case IdOverload::String:
+			core->SendDesignEvent(stringId, value);
+			break;
+
+		case IdOverload::StringView:
+			core->SendDesignEvent(viewId, value);
+			break;
+
+		case IdOverload::EventId:
+			core->SendDesignEvent(eventId, value);
+			break;
+
+		case IdOverload::TypedEventId:
+			core->SendDesignEvent(TypedKillId, value);
+			break;
+
+		case IdOverload::WideString:
+			core->SendDesignEvent(ToUtf8Buffer(wideId), value);
+			break;
+		}
+
+		value += 1.0f;
+
+		if (static_cast<int64_t>(value) % 4096 == 0)
+		{
+			state.PauseTiming();
+			auto before = AllocationCounter::GetAllocations();
+			core->Flush();
+			flushAllocations += AllocationCounter::GetAllocations() - before;
+			state.ResumeTiming();
+		}
+	}
+
+	auto callAllocations = AllocationCounter::GetAllocations() - allocations - flushAllocations;
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["allocs_per_call"] = benchmark::Counter(static_cast<double>(callAllocations) / static_cast<double>(state.iterations()));
+}
+
+BENCHMARK(BM_SendDesignEventOverload)->ArgName("overload")->DenseRange(0, 5);
+
+// Converts a wide string of 40 characters to UTF-8, into a reused string or a new one, and reports the heap allocations per call.
+static void BM_ToUtf8(benchmark::State & state)
+{
+	auto reuse = state.range(0) != 0;
+	state.SetLabel(reuse ? "reused" : "new");
+
+	const std::wstring message(L"NullReferenceException at Enemy.Update()");
+	std::string buffer;
+	ToUtf8(message, buffer);
+
+	auto allocations = AllocationCounter::GetAllocations();
+
+	for (auto _ : state)
+	{
+		if (reuse)
+		{
+			ToUtf8(message, buffer);
+			benchmark::DoNotOptimize(buffer.data());
+		}
+		else
+		{
+			auto result = ToUtf8(message);
+			benchmark::DoNotOptimize(result.data());
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["allocs_per_call"] = benchmark::Counter(static_cast<double>(AllocationCounter::GetAllocations() - allocations) / static_cast<double>(state.iterations()));
+}
+
+BENCHMARK(BM_ToUtf8)->ArgName("reuse")->Arg(0)->Arg(1);
+
+// Sends design events with ids of the specified mix, either all as strings, or with the ids sent over and over registered and passed by handle.
+// Reports the heap allocations per call. Queued events are flushed every 4096 events without timing it, and without counting its allocations.
+static void BM_EventIdMix(benchmark::State & state)
+{
+	auto mix = static_cast<IdMix>(state.range(0));
+	auto registered = state.range(1) != 0;
+	state.SetLabel(IdMixNames[state.range(0)]);
+
+	TestDirectory directory;
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(std::make_shared<LoopbackTransport>(), directory.GetPath(), std::make_shared<ManualClock>()));
+	core->Init([](const InitResult &) {});
+
+	std::vector<std::string> ids;
+	std::vector<EventId> handles(HotIdCount + TailIdCount);
+
+	for (size_t i = 0; i < HotIdCount; ++i)
+	{
+		ids.push_back("Kill:Weapon" + std::to_string(i) + ":Robot");
+
+		if (registered)
+		{
+			handles[i] = core->RegisterEventId(ids.back());
+		}
+	}
+
+	for (size_t i = 0; i < TailIdCount; ++i)
+	{
+		ids.push_back("Progression:Level" + std::to_string(i) + ":Checkpoint");
+	}
+
+	auto sequence = GetIdSequence(mix, 1 << 16);
+	size_t next = 0;
+
+	// Let the first calls allocate the reused buffers.
+	core->SendDesignEvent(ids[0], 0.0f);
+	core->Flush();
+
+	uint64_t flushAllocations = 0;
+	auto allocations = AllocationCounter::GetAllocations();
+	auto value = 0.0f;
+
+	for (auto _ : state)
+	{
+		auto index = sequence[next++ & (sequence.size() - 1)];
+
+		if (handles[index].IsValid())
+		{
+			core->SendDesignEvent(handles[index], value);
+		}
+		else
+		{
+			core->SendDesignEvent(ids[index], value);
+		}
+
+		value += 1.0f;
+
+		if (static_cast<int64_t>(value) % 4096 == 0)
+		{
+			state.PauseTiming();
+			auto before = AllocationCounter::GetAllocations();
+			core->Flush();
+			flushAllocations += AllocationCounter::GetAllocations() - before;
+			state.ResumeTiming();
+		}
+	}
+
+	auto callAllocations = AllocationCounter::GetAllocations() - allocations - flushAllocations;
+
+	state.SetItemsProcessed(state.iterations());
+	state.counters["allocs_per_call"] = benchmark::Counter(static_cast<double>(callAllocations) / static_cast<double>(state.iterations()));
+}
+
+BENCHMARK(BM_EventIdMix)->ArgNames({ "mix", "registered" })->ArgsProduct({ { 0, 1, 2 }, { 0, 1 } });
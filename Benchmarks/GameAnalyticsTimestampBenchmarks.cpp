@@ -0,0 +1,57 @@
+#include "GameAnalyticsServerClock.h"
+#include "GameAnalyticsSteadyClock.h"
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+using namespace GameAnalytics;
+
+
+// Timestamps each event gets when it is built. The server offset is only applied when events are serialized.
+
+// Gets the local time in milliseconds, like every event sent, from the steady clock used on platforms without a native counter.
+static void BM_EventTimestamp(benchmark::State & state)
+{
+	ServerClock clock(std::make_shared<SteadyClock>());
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(clock.GetLocalMilliseconds());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventTimestamp);
+
+// Gets the local time of an event and converts it to server time, like serializing every event does.
+static void BM_EventServerTimestamp(benchmark::State & state)
+{
+	ServerClock clock(std::make_shared<SteadyClock>());
+	clock.Synchronize(1700000000000, 1000, 0, 20);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(clock.ToServerMilliseconds(clock.GetLocalMilliseconds()));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_EventServerTimestamp);
+
+// Gets the system time in milliseconds since the epoch, for comparison with reading the wall clock for every event.
+static void BM_SystemClockTimestamp(benchmark::State & state)
+{
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SystemClockTimestamp);
@@ -0,0 +1,198 @@
+#include "GameAnalyticsEventSchema.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Typical ids of increasing length, followed by ids the backend would reject.
+	const char * const EventIds[] =
+	{
+		"Kill",
+		"PickedUpAmmo:Shotgun",
+		"Level3:Enemy42:Kill",
+		"World1:Chapter2:Level3:Wave4:Boss",
+		"Kill::Enemy",
+		"Kill/Enemy:Orc"
+	};
+
+	// Malformed design event ids: too many parts, characters to escape, and empty parts.
+	const char * const InvalidEventIds[] =
+	{
+		"Kill:Enemy:Orc:Sword:Fire:Critical",
+		"Kill/Enemy",
+		"Kill::Orc",
+		"Kill:\"Orc\"",
+		""
+	};
+
+	std::shared_ptr<GameAnalyticsCore> StartCore(const std::shared_ptr<LoopbackTransport> & transport, const TestDirectory & directory)
+	{
+		transport->SetSecretKey(TestSecretKey);
+
+		auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+		core->SetMetricsEnabled(true);
+		core->SetMaxPendingEvents(1 << 17);
+		core->Init([](const InitResult &) {});
+		return core;
+	}
+}
+
+
+// Checks the specified event id against the rules of all categories in a single pass.
+static void BM_ValidateEventId(benchmark::State & state)
+{
+	std::string_view eventId = EventIds[state.range(0)];
+	state.SetLabel(std::string(eventId));
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(eventId);
+		benchmark::DoNotOptimize(EventSchema::GetValidCategories(eventId));
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_ValidateEventId)->ArgName("id")->DenseRange(0, 5);
+
+// Sends design events by string id, which is checked and hashed for each event, by typed id, which has been checked
+// and hashed at compile time, and by registered id, which has been checked when registering it.
+// Queued events are flushed every 4096 events without timing it.
+static void BM_SendCheckedDesignEvent(benchmark::State & state)
+{
+	static const char * const Labels[] = { "string", "typed", "registered" };
+	state.SetLabel(Labels[state.range(0)]);
+
+	TestDirectory directory;
+	auto core = StartCore(std::make_shared<LoopbackTransport>(), directory);
+
+	std::string_view eventId = "Level3:Enemy42:Kill";
+	constexpr DesignEventId typedEventId("Level3:Enemy42:Kill");
+	auto registeredEventId = core->RegisterEventId(eventId);
+
+	int64_t sent = 0;
+
+	for (auto _ : state)
+	{
+		switch (state.range(0))
+		{
+		case 0:
+			core->SendDesignEvent(eventId, 1.0f);
+			break;
+
+		case 1:
+			core->SendDesignEvent(typedEventId, 1.0f);
+			break;
+
+		default:
+			core->SendDesignEvent(registeredEventId, 1.0f);
+			break;
+		}
+
+		if (++sent % 4096 == 0)
+		{
+			state.PauseTiming();
+			core->Flush();
+			state.ResumeTiming();
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_SendCheckedDesignEvent)->ArgName("by")->DenseRange(0, 2);
+
+// Sends 20000 design events, the specified share of them malformed, through the whole pipeline to a loopback transport
+// rejecting batches with malformed events like the backend does, and counts the requests rejected.
+static void BM_RejectionRate(benchmark::State & state)
+{
+	const int events = 20000;
+	const double maxSeconds = 60;
+
+	auto invalidShare = static_cast<double>(state.range(0)) / 1000;
+
+	for (auto _ : state)
+	{
+		state.PauseTiming();
+
+		TestDirectory directory;
+		auto transport = std::make_shared<LoopbackTransport>();
+		auto core = StartCore(transport, directory);
+
+		state.ResumeTiming();
+
+		std::mt19937 random(42);
+		std::uniform_real_distribution<> distribution(0, 1);
+
+		uint64_t valid = 0;
+		char eventId[64];
+
+		for (auto i = 0; i < events; ++i)
+		{
+			if (distribution(random) < invalidShare)
+			{
+				core->SendDesignEvent(InvalidEventIds[i % 5], 1.0f);
+			}
+			else
+			{
+				std::snprintf(eventId, sizeof(eventId), "Level%d:Enemy%d:Kill", i % 13, i % 97);
+				core->SendDesignEvent(eventId, 1.0f);
+				++valid;
+			}
+
+			if (i % 500 == 499)
+			{
+				core->Flush();
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		while (transport->GetStatistics().eventsReceived < valid || core->GetMetrics().inFlightBatches > 0)
+		{
+			if (std::chrono::steady_clock::now() - start > std::chrono::duration<double>(maxSeconds))
+			{
+				state.SkipWithError("Valid events have not been sent within a minute.");
+				break;
+			}
+
+			core->Flush();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		state.PauseTiming();
+
+		auto statistics = transport->GetStatistics();
+		auto metrics = core->GetMetrics();
+
+		state.counters["requests"] = benchmark::Counter(static_cast<double>(statistics.eventsRequests));
+		state.counters["rejected"] = benchmark::Counter(static_cast<double>(statistics.rejectedRequests));
+		state.counters["rejected_share"] = benchmark::Counter(
+			static_cast<double>(statistics.rejectedRequests) / static_cast<double>(std::max<uint64_t>(statistics.eventsRequests, 1)));
+		state.counters["delivered"] = benchmark::Counter(static_cast<double>(statistics.eventsReceived));
+		state.counters["invalid"] = benchmark::Counter(static_cast<double>(metrics.invalidEvents));
+
+		core.reset();
+
+		state.ResumeTiming();
+	}
+
+	state.SetItemsProcessed(state.iterations() * events);
+}
+
+BENCHMARK(BM_RejectionRate)->ArgName("invalid_per_mille")->Arg(0)->Arg(1)->Arg(10)->Arg(100)
+	->Unit(benchmark::kMillisecond)->UseRealTime()->Iterations(3);
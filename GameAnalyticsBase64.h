@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace GameAnalytics
+{
+	// Encodes the specified data as Base64 (RFC 4648), with padding.
+	inline std::string Base64Encode(const uint8_t * data, const size_t length)
+	{
+		static const char Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+		std::string result;
+		result.reserve((length + 2) / 3 * 4);
+
+		size_t i = 0;
+
+		for (; i + 2 < length; i += 3)
+		{
+			auto triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+			result.push_back(Alphabet[(triple >> 18) & 0x3F]);
+			result.push_back(Alphabet[(triple >> 12) & 0x3F]);
+			result.push_back(Alphabet[(triple >> 6) & 0x3F]);
+			result.push_back(Alphabet[triple & 0x3F]);
+		}
+
+		if (i + 1 == length)
+		{
+			auto triple = data[i] << 16;
+			result.push_back(Alphabet[(triple >> 18) & 0x3F]);
+			result.push_back(Alphabet[(triple >> 12) & 0x3F]);
+			result.append("==");
+		}
+		else if (i + 2 == length)
+		{
+			auto triple = (data[i] << 16) | (data[i + 1] << 8);
+			result.push_back(Alphabet[(triple >> 18) & 0x3F]);
+			result.push_back(Alphabet[(triple >> 12) & 0x3F]);
+			result.push_back(Alphabet[(triple >> 6) & 0x3F]);
+			result.push_back('=');
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,151 @@
+#include "pch.h"
+
+#include "GameAnalyticsBatchSizer.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Size of the first batch, in bytes.
+	const size_t InitialBatchBytes = 64 * 1024;
+
+	// Growth of batches after the first reduction, in bytes.
+	const size_t GrowthStepBytes = 16 * 1024;
+
+	// Size of the largest request sent by default, in bytes.
+	const size_t DefaultMaxPayloadBytes = 1024 * 1024;
+
+	// Time to get the response to a batch by default, in milliseconds.
+	const int64_t DefaultMaxLatency = 2000;
+
+	// Weight of the latest batch in the moving average of the throughput.
+	const double ThroughputWeight = 0.25;
+}
+
+
+BatchSizer::BatchSizer()
+	: batchBytes(InitialBatchBytes),
+	growthThreshold(std::numeric_limits<size_t>::max()),
+	maxPayloadBytes(DefaultMaxPayloadBytes),
+	payloadLimitBytes(std::numeric_limits<size_t>::max()),
+	maxLatency(DefaultMaxLatency),
+	throughput(0),
+	adjustmentTime(std::numeric_limits<int64_t>::min())
+{
+}
+
+size_t BatchSizer::GetBatchBytes() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return std::min(this->batchBytes, this->GetLimitBytes());
+}
+
+uint64_t BatchSizer::GetThroughput() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return static_cast<uint64_t>(this->throughput * 1000);
+}
+
+void BatchSizer::Complete(const size_t bytes, const int64_t sendTime, const int64_t now, const UploadResult result)
+{
+	auto roundTrip = std::max<int64_t>(now - sendTime, 1);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	switch (result)
+	{
+	case UploadResult::Accepted:
+		if (roundTrip > this->maxLatency)
+		{
+			this->Reduce(sendTime, now);
+		}
+		else if (2 * bytes >= this->batchBytes)
+		{
+			// Only batches limited by their size tell whether larger ones would still be fast enough.
+			auto throughput = static_cast<double>(bytes) / roundTrip;
+			this->throughput = this->throughput > 0 ? this->throughput + ThroughputWeight * (throughput - this->throughput) : throughput;
+
+			this->Grow(sendTime, now);
+		}
+		break;
+
+	case UploadResult::TooLarge:
+		// The backend's limit is somewhere below this batch.
+		this->payloadLimitBytes = std::max(MinBatchBytes, std::min(this->payloadLimitBytes, bytes / 2));
+		break;
+
+	case UploadResult::ServerError:
+		this->Reduce(sendTime, now);
+		break;
+
+	case UploadResult::NetworkError:
+		// Failing fast means being offline, rather than the batch being too large for the connection.
+		if (roundTrip >= this->maxLatency)
+		{
+			this->Reduce(sendTime, now);
+		}
+		break;
+
+	case UploadResult::Rejected:
+	case UploadResult::Unauthorized:
+		break;
+	}
+
+	// Don't grow beyond what can be sent.
+	this->batchBytes = std::min(this->batchBytes, this->GetLimitBytes());
+}
+
+void BatchSizer::SetMaxPayloadBytes(const size_t maxPayloadBytes)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->maxPayloadBytes = maxPayloadBytes;
+	this->payloadLimitBytes = std::numeric_limits<size_t>::max();
+}
+
+void BatchSizer::SetMaxLatency(const int64_t maxLatency)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->maxLatency = maxLatency;
+}
+
+size_t BatchSizer::GetLimitBytes() const
+{
+	auto limitBytes = std::min(this->maxPayloadBytes, this->payloadLimitBytes);
+
+	if (this->throughput > 0)
+	{
+		auto throughputBytes = static_cast<size_t>(this->throughput * static_cast<double>(this->maxLatency));
+		limitBytes = std::min(limitBytes, std::max(MinBatchBytes, throughputBytes));
+	}
+
+	return limitBytes;
+}
+
+void BatchSizer::Grow(const int64_t sendTime, const int64_t now)
+{
+	// Batches in flight at the same time tend to succeed together. Grow once for all of them.
+	if (sendTime < this->adjustmentTime)
+	{
+		return;
+	}
+
+	this->batchBytes = this->batchBytes < this->growthThreshold ? 2 * this->batchBytes : this->batchBytes + GrowthStepBytes;
+	this->adjustmentTime = now;
+}
+
+void BatchSizer::Reduce(const int64_t sendTime, const int64_t now)
+{
+	// Batches in flight at the same time tend to fail together. Reduce once for all of them.
+	if (sendTime < this->adjustmentTime)
+	{
+		return;
+	}
+
+	this->batchBytes = std::max(MinBatchBytes, this->batchBytes / 2);
+	this->growthThreshold = this->batchBytes;
+	this->adjustmentTime = now;
+}
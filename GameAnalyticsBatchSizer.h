@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "GameAnalyticsUploadScheduler.h"
+
+namespace GameAnalytics
+{
+	// Adapts the size of the batches sent to the GameAnalytics backend to the network, like TCP adapts its congestion window.
+	// Doubles batches while they are answered within the latency ceiling, grows them by a fixed step after the first reduction,
+	// and halves them when a batch takes too long, times out or fails with a server error. Changes the size at most once per round trip.
+	// The latency ceiling applies to each request, from sending the batch until its response, not to how long its events have been waiting.
+	// Batches never exceed the maximum payload, nor the size the measured throughput allows to send within the latency ceiling.
+	// Can be used by any number of threads at the same time.
+	class BatchSizer
+	{
+	public:
+		// Smallest size batches are reduced to, in bytes.
+		static constexpr size_t MinBatchBytes = 4 * 1024;
+
+		BatchSizer();
+
+		// Gets the maximum size of the next batch, in bytes before compression.
+		size_t GetBatchBytes() const;
+
+		// Gets the throughput measured for batches limited by their size, in bytes before compression per second. 0 if none has been sent yet.
+		uint64_t GetThroughput() const;
+
+		// Adapts the batch size to the result of sending a batch of the specified size, sent and answered at the specified times in milliseconds.
+		void Complete(const size_t bytes, const int64_t sendTime, const int64_t now, const UploadResult result);
+
+		// Sets the size of the largest batch the backend accepts, in bytes before compression.
+		void SetMaxPayloadBytes(const size_t maxPayloadBytes);
+
+		// Sets how long it may take to get the response to a batch, in milliseconds.
+		void SetMaxLatency(const int64_t maxLatency);
+
+	private:
+		mutable std::mutex mutex;
+
+		size_t batchBytes;
+
+		// Size up to which batches are doubled, rather than grown by a fixed step.
+		size_t growthThreshold;
+
+		// Configured maximum payload, and size below the smallest batch refused as too large.
+		size_t maxPayloadBytes;
+		size_t payloadLimitBytes;
+
+		int64_t maxLatency;
+
+		// Moving average of the throughput, in bytes per millisecond.
+		double throughput;
+
+		// Time of the last change of the batch size. Batches sent before can't tell whether it has been right.
+		int64_t adjustmentTime;
+
+		// Gets the largest batch size allowed by the payload limits and the throughput.
+		size_t GetLimitBytes() const;
+
+		// Doubles the batch size, or grows it by a fixed step after the first reduction, unless the specified batch has been sent before the last change.
+		void Grow(const int64_t sendTime, const int64_t now);
+
+		// Halves the batch size, unless the specified batch has been sent before the last change.
+		void Reduce(const int64_t sendTime, const int64_t now);
+	};
+}
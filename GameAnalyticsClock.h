@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace GameAnalytics
+{
+	// Provides a monotonic high-resolution time source.
+	class Clock
+	{
+	public:
+		virtual ~Clock() {}
+
+		// Gets the current value of the counter, in ticks.
+		virtual int64_t GetTicks() const = 0;
+
+		// Gets the frequency of the counter, in ticks per second.
+		virtual int64_t GetTicksPerSecond() const = 0;
+	};
+}
@@ -0,0 +1,2202 @@
+#include "pch.h"
+
+#include "GameAnalyticsCore.h"
+#include "GameAnalyticsBase64.h"
+#include "GameAnalyticsGzip.h"
+#include "GameAnalyticsJson.h"
+#include "GameAnalyticsJsonWriter.h"
+#include "GameAnalyticsMetrics.h"
+#include "GameAnalyticsSha256.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Fixed size of serialized events without strings and annotations, for estimating the size of queued events.
+	const size_t EventOverheadBytes = 128;
+
+	// Local time in nanoseconds never passed, for doing all work due at once.
+	const int64_t NoDeadline = std::numeric_limits<int64_t>::max();
+
+	// Check the time only after serializing so many events, which takes a few microseconds.
+	const uint32_t DeadlineCheckInterval = 16;
+
+	// Initial guess and weight of new measurements of the time for reading stored events.
+	const double InitialReadNanosecondsPerByte = 10.0;
+	const double ReadTimeWeight = 0.25;
+
+	// Time the worker thread works at a time, in microseconds, so it rarely holds locks the game is waiting for,
+	// and time it waits between slices if all work due has been done.
+	const int64_t WorkerSliceMicroseconds = 1000;
+	const std::chrono::milliseconds WorkerInterval(100);
+
+	// Measure queueing only for every so many events of each thread, so measuring costs next to nothing per event.
+	const uint32_t EnqueueMeasureInterval = 64;
+
+	// Records the time from its construction to its destruction in the specified histogram, if any.
+	class LatencyTimer
+	{
+	public:
+		LatencyTimer(const ServerClock & clock, LatencyHistogram * histogram)
+			: clock(clock),
+			histogram(histogram),
+			start(histogram != nullptr ? clock.GetLocalNanoseconds() : 0)
+		{
+		}
+
+		~LatencyTimer()
+		{
+			if (this->histogram != nullptr)
+			{
+				this->histogram->Record(static_cast<uint64_t>(this->clock.GetLocalNanoseconds() - this->start));
+			}
+		}
+
+	private:
+		const ServerClock & clock;
+		LatencyHistogram * histogram;
+		int64_t start;
+	};
+
+	// Gets the number of events queued by the calling thread, for deciding which ones to measure.
+	uint32_t & GetEnqueueCount()
+	{
+		thread_local uint32_t count = 0;
+		return count;
+	}
+
+	// Gets the cleared buffer for joining event id parts on the calling thread.
+	// Reused for all events sent from the same thread, so sending events doesn't allocate memory.
+	std::string & GetEventIdBuffer()
+	{
+		thread_local std::string buffer;
+		buffer.clear();
+		return buffer;
+	}
+
+	// Player the calling thread sends events for, and the core it belongs to.
+	struct CurrentPlayerScope
+	{
+		const GameAnalyticsCore * core;
+		uint32_t player;
+	};
+
+	thread_local CurrentPlayerScope CurrentPlayer = { nullptr, PlayerRegistry::None };
+
+	// Gets the indices of the events within the request rejected by the backend from the errors in the body of its response, in ascending order.
+	// Returns false if the body is malformed, or doesn't tell for every error which event it belongs to.
+	bool TryGetRejectedEvents(const std::string & body, std::vector<size_t> & rejectedEvents)
+	{
+		std::vector<std::string> errors;
+
+		if (!Json::TryGetElements(body, errors) || errors.empty())
+		{
+			return false;
+		}
+
+		for (auto & error : errors)
+		{
+			auto index = 0.0;
+
+			if (!Json::TryGetNumber(error, "index", index) || index < 0 || index != static_cast<double>(static_cast<size_t>(index)))
+			{
+				return false;
+			}
+
+			rejectedEvents.push_back(static_cast<size_t>(index));
+		}
+
+		std::sort(rejectedEvents.begin(), rejectedEvents.end());
+		rejectedEvents.erase(std::unique(rejectedEvents.begin(), rejectedEvents.end()), rejectedEvents.end());
+		return true;
+	}
+}
+
+
+GameAnalyticsCore::GameAnalyticsCore(const std::string & gameKey, const std::string & secretKey, const Environment & environment)
+	: gameKey(gameKey),
+	secretKey(secretKey),
+	signer(secretKey),
+	environment(environment),
+	initialized(false),
+	serverClock(environment.clock),
+	initializationTime(0),
+	initPending(false),
+	initTimeout(5),
+	enabledBefore(false),
+	eventQueue(100, 64 * 1024, memoryBudget),
+	lastFlushTime(0),
+	flushRequested(false),
+	flushInterval(8),
+	compressionThreshold(1024),
+	eventIds(4096),
+	progressions(4096),
+	flushing(false),
+	flushEvents(nullptr),
+	flushGeneration(0),
+	flushTime(0),
+	eventStore(new EventStore(environment.storeDirectory, 1024 * 1024, 10 * 1024 * 1024)),
+	uploads(*eventStore, 4),
+	sending(false),
+	sendAgain(false),
+	uploadBatchId(0),
+	uploadReservedBytes(0),
+	readNanosecondsPerByte(InitialReadNanosecondsPerByte),
+	pumped(false),
+	metricsEnabled(false),
+	storedEvents(0),
+	unstoredEvents(0),
+	requests(0),
+	failedRequests(0),
+	sentBytes(0),
+	uncompressedBytes(0),
+	invalidEvents(0),
+	metricsInterval(0),
+	lastMetricsTime(0),
+	build(environment.deviceInfo->GetAppVersion()),
+	sessionId(this->GenerateSessionId()),
+	sessionNumber(0),
+	transactionCounter(environment.keyValueStore, "GameAnalytics::Transaction", 100),
+	userId(environment.deviceInfo->GetHardwareId()),
+	progression(EventIdRegistry::None),
+	birthYear(-1),
+	gender(Gender::Unknown),
+	annotationsGeneration(0),
+	annotationsSize(0)
+{
+	this->limiter.SetUser(this->userId);
+
+	// Load transaction counter, so business events can be sent before initialization.
+	this->transactionCounter.Load();
+}
+
+GameAnalyticsCore::~GameAnalyticsCore()
+{
+	this->StopWorker();
+}
+
+void GameAnalyticsCore::Init(const InitCallback & callback)
+{
+	this->initializationTime = this->serverClock.GetLocalMilliseconds();
+
+	// Cache device info, which doesn't change during the session.
+	auto & deviceInfo = this->environment.deviceInfo;
+
+	this->deviceModel = deviceInfo->GetDeviceModel();
+	this->manufacturer = deviceInfo->GetManufacturer();
+	this->osVersion = deviceInfo->GetOSVersion();
+	this->platform = deviceInfo->GetPlatform();
+
+	// Increase session counter. Committed with the init response, so starting the session doesn't wait for the disk.
+	auto & keyValueStore = this->environment.keyValueStore;
+
+	this->sessionNumber = keyValueStore->GetInt32OrDefault("GameAnalytics::Session");
+	++this->sessionNumber;
+	keyValueStore->SetInt32("GameAnalytics::Session", this->sessionNumber);
+
+	this->enabledBefore = keyValueStore->GetInt32OrDefault("GameAnalytics::Enabled") != 0;
+
+	// Build session annotations added to every event.
+	// Drop older ones, so events buffered before fall back to these, which include device info and session number.
+	{
+		std::lock_guard<std::mutex> lock(this->annotationsMutex);
+		this->annotations.clear();
+		this->UpdateAnnotations();
+	}
+
+	// Build event object.
+	JsonWriter jsonObject;
+
+	jsonObject.BeginObject();
+	jsonObject.WriteMember("platform", this->platform);
+	jsonObject.WriteMember("os_version", this->osVersion);
+	jsonObject.WriteMember("sdk_version", this->GetSDKVersion());
+	jsonObject.EndObject();
+
+	// Send event.
+	this->initCallback = callback;
+	this->initPending = true;
+
+	std::weak_ptr<GameAnalyticsCore> weakThis = this->shared_from_this();
+	auto requestTime = this->initializationTime.load();
+
+	this->environment.transport->Post(this->BuildRequest("init", jsonObject.GetString()), [weakThis, requestTime](const TransportResponse & response)
+	{
+		auto core = weakThis.lock();
+
+		if (core)
+		{
+			core->OnInitResponse(response, requestTime);
+		}
+	});
+}
+
+bool GameAnalyticsCore::IsInitialized() const
+{
+	return this->initialized;
+}
+
+void GameAnalyticsCore::Update()
+{
+	this->DoWork(NoDeadline, true);
+}
+
+bool GameAnalyticsCore::Pump(const int64_t maxMicroseconds)
+{
+	// Leave all further work to the next call from now on.
+	this->pumped = true;
+
+	// Never wait for the disk within the frame. Stored events survive the app being terminated anyway.
+	return this->DoWork(this->serverClock.GetLocalNanoseconds() + maxMicroseconds * 1000, false);
+}
+
+void GameAnalyticsCore::StartWorker()
+{
+	std::lock_guard<std::mutex> lock(this->workerMutex);
+
+	if (this->worker)
+	{
+		return;
+	}
+
+	this->pumped = true;
+
+	// Don't keep the core alive by its own worker.
+	std::weak_ptr<GameAnalyticsCore> weakThis = this->shared_from_this();
+
+	this->worker.reset(new Worker([weakThis]()
+	{
+		auto core = weakThis.lock();
+		return !core || core->DoWork(core->serverClock.GetLocalNanoseconds() + WorkerSliceMicroseconds * 1000, true);
+	}, WorkerInterval));
+}
+
+void GameAnalyticsCore::StopWorker()
+{
+	std::unique_ptr<Worker> stopped;
+
+	{
+		std::lock_guard<std::mutex> lock(this->workerMutex);
+
+		stopped = std::move(this->worker);
+		this->pumped = false;
+	}
+
+	// Wait for the current slice outside the lock, because it may wake the worker.
+	stopped.reset();
+}
+
+void GameAnalyticsCore::Flush()
+{
+	// Keep buffering events until their timestamps can be converted to server time.
+	if (!this->initialized)
+	{
+		return;
+	}
+
+	// Store events first, so they don't get lost if the device is offline or the app is terminated.
+	{
+		std::lock_guard<std::mutex> lock(this->flushMutex);
+
+		// Complete a flush started by Pump before, which doesn't include events queued by threads whose events it has already taken.
+		if (this->flushing)
+		{
+			this->ContinueFlush(NoDeadline, false);
+		}
+
+		this->ContinueFlush(NoDeadline, true);
+	}
+
+	// Send all stored events, including those of previous sessions.
+	this->SendStoredEvents(NoDeadline);
+}
+
+void GameAnalyticsCore::AggregateEvents(const std::string_view & eventIdPrefix)
+{
+	this->aggregator.AddPrefix(eventIdPrefix);
+}
+
+EventId GameAnalyticsCore::RegisterEventId(const std::string_view & eventId)
+{
+	return this->eventIds.Register(eventId);
+}
+
+Metrics GameAnalyticsCore::GetMetrics() const
+{
+	Metrics metrics = {};
+
+	// Read stored events first, so they don't exceed queued events read later.
+	auto takenEvents = this->storedEvents.load();
+	auto unstoredEvents = this->unstoredEvents.load();
+
+	metrics.storedEvents = takenEvents - unstoredEvents;
+	metrics.queuedEvents = this->eventQueue.GetEnqueuedEvents();
+	metrics.droppedEvents = this->eventQueue.GetDroppedEvents() + unstoredEvents;
+	metrics.pendingEvents = metrics.queuedEvents - takenEvents;
+	metrics.invalidEvents = this->invalidEvents;
+
+	for (auto category = EventCategory::Business; category <= EventCategory::User; category = static_cast<EventCategory::EventCategory>(category + 1))
+	{
+		metrics.limitedEvents += this->limiter.GetDroppedEvents(category);
+	}
+
+	metrics.storeBytes = this->eventStore->GetSize();
+	metrics.requests = this->requests;
+	metrics.failedRequests = this->failedRequests;
+	metrics.sentBytes = this->sentBytes;
+	metrics.uncompressedBytes = this->uncompressedBytes;
+	metrics.inFlightBatches = this->uploads.GetInFlightBatches();
+	metrics.batchBytes = this->batchSizer.GetBatchBytes();
+	metrics.throughput = this->batchSizer.GetThroughput();
+	metrics.memoryBytes = this->memoryBudget.GetUsedBytes();
+	metrics.memoryHighWaterBytes = this->memoryBudget.GetHighWaterBytes();
+	metrics.memoryBudgetBytes = this->memoryBudget.GetLimitBytes();
+
+	metrics.enqueue = this->enqueueLatency.GetSummary();
+	metrics.serialize = this->serializeLatency.GetSummary();
+	metrics.sign = this->signLatency.GetSummary();
+	metrics.compress = this->compressLatency.GetSummary();
+	metrics.upload = this->uploadLatency.GetSummary();
+
+	return metrics;
+}
+
+PlayerContext GameAnalyticsCore::StartPlayerSession(const std::string_view & userId, const int sessionNumber)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	auto handle = this->players.Add(userId);
+	auto & player = this->players.Get(handle);
+
+	player.userHash = EventLimiter::HashUser(userId);
+	player.sessionStart = this->serverClock.GetLocalMilliseconds();
+	player.sessionId = this->GenerateSessionId();
+	player.sessionNumber = sessionNumber;
+
+	this->UpdatePlayerAnnotations(player);
+
+	return PlayerContext(handle);
+}
+
+void GameAnalyticsCore::EndPlayerSession(const PlayerContext & player)
+{
+	if (!player.IsValid())
+	{
+		throw std::invalid_argument("Invalid player context.");
+	}
+
+	// Send session end event of the player.
+	{
+		PlayerScope scope(*this, player);
+
+		auto record = this->BuildEventRecord(EventCategory::SessionEnd);
+		record.value = static_cast<double>((this->serverClock.GetLocalMilliseconds() - this->players.Get(player.handle).sessionStart) / 1000);
+
+		this->EnqueueEvent(record);
+	}
+
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+	this->players.Remove(player.handle);
+}
+
+void GameAnalyticsCore::SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Business, eventId) && EventSchema::IsValidCurrency(currency)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildBusinessEventRecord(currency, amount);
+	this->SetEventId(record, eventId);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Business, eventId) && EventSchema::IsValidCurrency(currency) && EventSchema::IsValidCartType(cartType)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildBusinessEventRecord(currency, amount);
+	this->SetEventId(record, eventId);
+
+	record.cartType = cartType;
+	record.fields |= EventField::CartType;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Business, eventId) && EventSchema::IsValidCurrency(currency)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildBusinessEventRecord(currency, amount);
+	this->SetEventId(record, eventId);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Business, eventId) && EventSchema::IsValidCurrency(currency) && EventSchema::IsValidCartType(cartType)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildBusinessEventRecord(currency, amount);
+	this->SetEventId(record, eventId);
+
+	record.cartType = cartType;
+	record.fields |= EventField::CartType;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidCurrency(currency)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildBusinessEventRecord(currency, amount);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidCurrency(currency) && EventSchema::IsValidCartType(cartType)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildBusinessEventRecord(currency, amount);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	record.cartType = cartType;
+	record.fields |= EventField::CartType;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendDesignEvent(const std::string_view & eventId)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Design, eventId)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Design);
+	this->SetEventId(record, eventId);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendDesignEvent(const std::string_view & eventId, const float value)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Design, eventId)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Design);
+	this->SetEventId(record, eventId);
+
+	record.value = value;
+	record.fields |= EventField::Value;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendDesignEvent(const EventId & eventId)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Design, eventId)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Design);
+	this->SetEventId(record, eventId);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendDesignEvent(const EventId & eventId, const float value)
+{
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Design, eventId)))
+	{
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Design);
+	this->SetEventId(record, eventId);
+
+	record.value = value;
+	record.fields |= EventField::Value;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendDesignEvent(const DesignEventId & eventId)
+{
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Design);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendDesignEvent(const DesignEventId & eventId, const float value)
+{
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Design);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	record.value = value;
+	record.fields |= EventField::Value;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendErrorEvent(const std::string_view & message, const Severity::Severity severity)
+{
+	// Verify severity.
+	Severity::ToString(severity);
+
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::Error);
+	record.message = message;
+	record.subtype = static_cast<uint8_t>(severity);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId)
+{
+	// Drop events the backend would reject, keeping the progression status.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Progression, eventId)))
+	{
+		return;
+	}
+
+	// Update progression status.
+	if (status == ProgressionStatus::ProgressionStatus::Start)
+	{
+		this->SetProgression(this->RegisterProgression(eventId));
+	}
+	else
+	{
+		this->SetProgression(EventIdRegistry::None);
+	}
+
+	// Build event record.
+	auto record = this->BuildProgressionEventRecord(status);
+	this->SetEventId(record, eventId);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId, const int score)
+{
+	// Drop events the backend would reject, keeping the progression status.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Progression, eventId)))
+	{
+		return;
+	}
+
+	if (status == ProgressionStatus::ProgressionStatus::Start)
+	{
+		// Update progression status.
+		this->SetProgression(this->RegisterProgression(eventId));
+	}
+
+	// Build event record.
+	auto record = this->BuildProgressionEventRecord(status);
+	this->SetEventId(record, eventId);
+
+	record.value = score;
+	record.fields |= EventField::Value;
+
+	// Send event.
+	this->EnqueueEvent(record);
+
+	if (status != ProgressionStatus::ProgressionStatus::Start)
+	{
+		// Reset progression status.
+		this->SetProgression(EventIdRegistry::None);
+	}
+}
+
+void GameAnalyticsCore::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId)
+{
+	// Drop events the backend would reject, keeping the progression status.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Progression, eventId)))
+	{
+		return;
+	}
+
+	// Update progression status.
+	if (status == ProgressionStatus::ProgressionStatus::Start)
+	{
+		this->SetProgression(this->RegisterProgression(this->eventIds.Get(eventId.handle)));
+	}
+	else
+	{
+		this->SetProgression(EventIdRegistry::None);
+	}
+
+	// Build event record.
+	auto record = this->BuildProgressionEventRecord(status);
+	this->SetEventId(record, eventId);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId, const int score)
+{
+	// Drop events the backend would reject, keeping the progression status.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Progression, eventId)))
+	{
+		return;
+	}
+
+	if (status == ProgressionStatus::ProgressionStatus::Start)
+	{
+		// Update progression status.
+		this->SetProgression(this->RegisterProgression(this->eventIds.Get(eventId.handle)));
+	}
+
+	// Build event record.
+	auto record = this->BuildProgressionEventRecord(status);
+	this->SetEventId(record, eventId);
+
+	record.value = score;
+	record.fields |= EventField::Value;
+
+	// Send event.
+	this->EnqueueEvent(record);
+
+	if (status != ProgressionStatus::ProgressionStatus::Start)
+	{
+		// Reset progression status.
+		this->SetProgression(EventIdRegistry::None);
+	}
+}
+
+void GameAnalyticsCore::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId)
+{
+	// Update progression status.
+	if (status == ProgressionStatus::ProgressionStatus::Start)
+	{
+		this->SetProgression(this->RegisterProgression(eventId.GetValue()));
+	}
+	else
+	{
+		this->SetProgression(EventIdRegistry::None);
+	}
+
+	// Build event record.
+	auto record = this->BuildProgressionEventRecord(status);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId, const int score)
+{
+	if (status == ProgressionStatus::ProgressionStatus::Start)
+	{
+		// Update progression status.
+		this->SetProgression(this->RegisterProgression(eventId.GetValue()));
+	}
+
+	// Build event record.
+	auto record = this->BuildProgressionEventRecord(status);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	record.value = score;
+	record.fields |= EventField::Value;
+
+	// Send event.
+	this->EnqueueEvent(record);
+
+	if (status != ProgressionStatus::ProgressionStatus::Start)
+	{
+		// Reset progression status.
+		this->SetProgression(EventIdRegistry::None);
+	}
+}
+
+void GameAnalyticsCore::SendResourceEvent(const FlowType::FlowType flowType, const std::string_view & ingameCurrency, const std::string_view & itemType, const std::string_view & itemId, const float amount)
+{
+	// Verify flow type.
+	FlowType::ToString(flowType);
+
+	// Build event record. The flow type is added when the event is serialized.
+	auto record = this->BuildEventRecord(EventCategory::Resource);
+
+	auto & eventId = GetEventIdBuffer();
+	eventId.append(ingameCurrency);
+	eventId.push_back(':');
+	eventId.append(itemType);
+	eventId.push_back(':');
+	eventId.append(itemId);
+
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Resource, eventId)))
+	{
+		return;
+	}
+
+	this->SetEventId(record, eventId);
+
+	record.subtype = static_cast<uint8_t>(flowType);
+	record.value = amount;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendResourceEvent(const FlowType::FlowType flowType, const EventId & eventId, const float amount)
+{
+	// Verify flow type.
+	FlowType::ToString(flowType);
+
+	// Drop events the backend would reject.
+	if (!this->CheckEvent(this->IsValidEventId(EventCategory::Resource, eventId)))
+	{
+		return;
+	}
+
+	// Build event record. The flow type is added when the event is serialized.
+	auto record = this->BuildEventRecord(EventCategory::Resource);
+	this->SetEventId(record, eventId);
+
+	record.subtype = static_cast<uint8_t>(flowType);
+	record.value = amount;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendResourceEvent(const FlowType::FlowType flowType, const ResourceEventId & eventId, const float amount)
+{
+	// Verify flow type.
+	FlowType::ToString(flowType);
+
+	// Build event record. The flow type is added when the event is serialized.
+	auto record = this->BuildEventRecord(EventCategory::Resource);
+	this->SetEventId(record, eventId.GetValue(), eventId.GetHash());
+
+	record.subtype = static_cast<uint8_t>(flowType);
+	record.value = amount;
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SendSessionEndEvent()
+{
+	// End session of the current player, if any.
+	auto player = this->GetCurrentPlayer();
+
+	if (player != PlayerRegistry::None)
+	{
+		this->EndPlayerSession(PlayerContext(player));
+		return;
+	}
+
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::SessionEnd);
+	record.value = static_cast<double>(this->GetTimeSinceInit());
+
+	// Send summaries of aggregated events and repeated errors of the session.
+	this->EmitAggregates(true);
+	this->EmitRepeatedErrors(true);
+
+	// Send event, and all events queued before.
+	this->EnqueueEvent(record);
+
+	if (this->pumped)
+	{
+		this->RequestFlush();
+	}
+	else
+	{
+		this->Flush();
+	}
+}
+
+void GameAnalyticsCore::SendUserEvent()
+{
+	// Build event record.
+	auto record = this->BuildEventRecord(EventCategory::User);
+
+	// Send event.
+	this->EnqueueEvent(record);
+}
+
+void GameAnalyticsCore::SetAggregationInterval(const int aggregationInterval)
+{
+	this->aggregator.SetWindow(aggregationInterval * 1000ll);
+}
+
+void GameAnalyticsCore::SetBirthYear(const int birthYear)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	auto player = this->GetCurrentPlayer();
+
+	if (player != PlayerRegistry::None)
+	{
+		auto & state = this->players.Get(player);
+		state.birthYear = birthYear;
+		this->UpdatePlayerAnnotations(state);
+		return;
+	}
+
+	this->birthYear = birthYear;
+	this->UpdateAnnotations();
+}
+
+void GameAnalyticsCore::SetBuild(const std::string_view & build)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	this->build = build;
+	this->UpdateAnnotations();
+}
+
+void GameAnalyticsCore::SetCompressionThreshold(const size_t compressionThreshold)
+{
+	this->compressionThreshold = compressionThreshold;
+}
+
+void GameAnalyticsCore::SetEventIdRateLimit(const double eventsPerSecond, const int burst)
+{
+	this->limiter.SetEventIdRateLimit(eventsPerSecond, burst);
+}
+
+void GameAnalyticsCore::SetFacebookId(const std::string_view & facebookId)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	auto player = this->GetCurrentPlayer();
+
+	if (player != PlayerRegistry::None)
+	{
+		auto & state = this->players.Get(player);
+		state.facebookId = facebookId;
+		this->UpdatePlayerAnnotations(state);
+		return;
+	}
+
+	this->facebookId = facebookId;
+	this->UpdateAnnotations();
+}
+
+void GameAnalyticsCore::SetFlushInterval(const int flushInterval)
+{
+	this->flushInterval = flushInterval;
+}
+
+void GameAnalyticsCore::SetGender(const Gender::Gender gender)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	auto player = this->GetCurrentPlayer();
+
+	if (player != PlayerRegistry::None)
+	{
+		auto & state = this->players.Get(player);
+		state.gender = gender;
+		this->UpdatePlayerAnnotations(state);
+		return;
+	}
+
+	this->gender = gender;
+	this->UpdateAnnotations();
+}
+
+void GameAnalyticsCore::SetGooglePlusId(const std::string_view & googlePlusId)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	auto player = this->GetCurrentPlayer();
+
+	if (player != PlayerRegistry::None)
+	{
+		auto & state = this->players.Get(player);
+		state.googlePlusId = googlePlusId;
+		this->UpdatePlayerAnnotations(state);
+		return;
+	}
+
+	this->googlePlusId = googlePlusId;
+	this->UpdateAnnotations();
+}
+
+void GameAnalyticsCore::SetInitTimeout(const int initTimeout)
+{
+	this->initTimeout = initTimeout;
+}
+
+void GameAnalyticsCore::SetMaxBatchBytes(const size_t maxBatchBytes)
+{
+	this->eventQueue.SetMaxBatchBytes(maxBatchBytes);
+}
+
+void GameAnalyticsCore::SetMaxBatchEvents(const size_t maxBatchEvents)
+{
+	this->eventQueue.SetMaxBatchEvents(maxBatchEvents);
+}
+
+void GameAnalyticsCore::SetMaxBatchRetries(const int maxBatchRetries)
+{
+	this->uploads.SetMaxRetries(maxBatchRetries);
+}
+
+void GameAnalyticsCore::SetMaxPendingEvents(const size_t maxPendingEvents)
+{
+	this->eventQueue.SetMaxPendingEvents(maxPendingEvents);
+}
+
+void GameAnalyticsCore::SetMaxInFlightBatches(const size_t maxInFlightBatches)
+{
+	this->uploads.SetMaxInFlightBatches(maxInFlightBatches);
+	this->environment.transport->SetMaxConcurrentRequests(maxInFlightBatches);
+}
+
+void GameAnalyticsCore::SetMaxPayloadBytes(const size_t maxPayloadBytes)
+{
+	this->batchSizer.SetMaxPayloadBytes(maxPayloadBytes);
+}
+
+void GameAnalyticsCore::SetMaxStoreBytes(const uint64_t maxStoreBytes)
+{
+	this->eventStore->SetMaxTotalBytes(maxStoreBytes);
+}
+
+void GameAnalyticsCore::SetMaxUploadLatency(const int maxUploadLatency)
+{
+	this->batchSizer.SetMaxLatency(maxUploadLatency);
+}
+
+void GameAnalyticsCore::SetMemoryBudget(const size_t memoryBudget)
+{
+	this->memoryBudget.SetLimitBytes(memoryBudget);
+}
+
+void GameAnalyticsCore::SetMetricsEnabled(const bool metricsEnabled)
+{
+	this->metricsEnabled = metricsEnabled;
+}
+
+void GameAnalyticsCore::SetMetricsFile(const std::filesystem::path & metricsPath, const int metricsInterval)
+{
+	std::lock_guard<std::mutex> lock(this->metricsMutex);
+
+	this->metricsPath = metricsPath;
+	this->metricsInterval = metricsInterval * 1000ll;
+}
+
+void GameAnalyticsCore::SetRateLimit(const EventCategory::EventCategory category, const double eventsPerSecond, const int burst)
+{
+	this->limiter.SetRateLimit(category, eventsPerSecond, burst);
+}
+
+void GameAnalyticsCore::SetRepeatedErrorInterval(const int repeatedErrorInterval)
+{
+	this->limiter.SetRepeatedErrorInterval(repeatedErrorInterval * 1000ll);
+}
+
+void GameAnalyticsCore::SetSamplingRate(const EventCategory::EventCategory category, const double samplingRate)
+{
+	this->limiter.SetSamplingRate(category, samplingRate);
+}
+
+void GameAnalyticsCore::SetUserId(const std::string_view & userId)
+{
+	std::lock_guard<std::mutex> lock(this->annotationsMutex);
+
+	this->userId = userId;
+	this->UpdateAnnotations();
+
+	this->limiter.SetUser(userId);
+}
+
+EventRecord GameAnalyticsCore::BuildBusinessEventRecord(const std::string_view & currency, const int amount)
+{
+	auto record = this->BuildEventRecord(EventCategory::Business);
+
+	record.currency = currency;
+	record.value = amount;
+	record.transactionNumber = this->GetNextTransactionNumber();
+
+	return record;
+}
+
+EventRecord GameAnalyticsCore::BuildEventRecord(const EventCategory::EventCategory category) const
+{
+	EventRecord record = {};
+
+	// Set category.
+	record.category = category;
+
+	// Set timestamp.
+	record.timestamp = this->GetTimestamp();
+
+	// Set progression.
+	auto progression = this->GetProgression();
+
+	if (progression != EventIdRegistry::None)
+	{
+		record.progression = this->progressions.Get(progression);
+		record.fields |= EventField::Progression;
+	}
+
+	// Refer to current session annotations and player.
+	record.annotations = this->annotationsGeneration;
+	record.player = this->GetCurrentPlayer();
+	record.registeredEventId = EventIdRegistry::None;
+
+	return record;
+}
+
+EventRecord GameAnalyticsCore::BuildProgressionEventRecord(const ProgressionStatus::ProgressionStatus status) const
+{
+	// Verify status.
+	ProgressionStatus::ToString(status);
+
+	auto record = this->BuildEventRecord(EventCategory::Progression);
+	record.subtype = static_cast<uint8_t>(status);
+
+	// TODO: Add current attempt number.
+
+	return record;
+}
+
+TransportRequest GameAnalyticsCore::BuildRequest(const std::string & route, const std::string & body)
+{
+	// Sandbox URL: http://sandbox-api.gameanalytics.com/v2/
+	// Production URL: http://api.gameanalytics.com/v2/
+	RequestBuilder builder("http://api.gameanalytics.com/v2/" + this->gameKey + "/" + route, body, this->signer,
+		body.size() >= this->compressionThreshold, this->metricsEnabled ? &this->serverClock : nullptr);
+
+	while (!builder.Continue())
+	{
+	}
+
+	this->CountRequest(builder);
+	return std::move(builder.GetRequest());
+}
+
+void GameAnalyticsCore::CompleteInit(const InitResult & result)
+{
+	if (!this->initPending.exchange(false))
+	{
+		return;
+	}
+
+	if (result.success)
+	{
+		this->lastFlushTime = this->serverClock.GetLocalMilliseconds();
+		this->initialized = true;
+
+		// Send events buffered before with the next update, unless flushed with the init response anyway.
+		if (result.cached)
+		{
+			this->RequestFlush();
+		}
+	}
+
+	this->initCallback(result);
+}
+
+bool GameAnalyticsCore::ContinueFlush(const int64_t deadline, const bool sync)
+{
+	if (!this->flushing)
+	{
+		this->lastFlushTime = this->serverClock.GetLocalMilliseconds();
+		this->flushTime = 0;
+
+		// Queue summaries of aggregated events and repeated errors, if their interval has passed.
+		this->EmitAggregates(false);
+		this->EmitRepeatedErrors(false);
+
+		std::lock_guard<std::mutex> annotationsLock(this->annotationsMutex);
+
+		// Players ended before are released when all their events have been serialized.
+		this->players.BeginFlush();
+		this->flushGeneration = this->annotationsGeneration;
+
+		this->flushing = true;
+	}
+
+	// Store the events serialized so far, so they don't get lost if the device is offline or the app is terminated.
+	auto store = [this]()
+	{
+		// Events that couldn't be stored, e.g. because the disk is full, are dropped.
+		auto count = this->flushBatch.GetCount();
+		auto stored = this->eventStore->Append(this->flushBatch);
+
+		this->unstoredEvents += count - stored;
+		this->storedEvents += count;
+		this->flushBatch.Clear();
+	};
+
+	// Serialize events of all threads, one thread at a time.
+	auto sliceStart = this->serverClock.GetLocalNanoseconds();
+	auto completed = true;
+
+	{
+		std::lock_guard<std::mutex> annotationsLock(this->annotationsMutex);
+
+		EventRecord record;
+		uint32_t serialized = 0;
+
+		while (true)
+		{
+			if (this->flushEvents == nullptr)
+			{
+				this->flushEvents = this->eventQueue.TakeNextEvents();
+
+				if (this->flushEvents == nullptr)
+				{
+					break;
+				}
+			}
+
+			// Storing takes about as long as serializing, so store while checking the time, if any.
+			if (++serialized % DeadlineCheckInterval == 0 && deadline != NoDeadline)
+			{
+				store();
+
+				if (this->serverClock.GetLocalNanoseconds() >= deadline)
+				{
+					completed = false;
+					break;
+				}
+			}
+
+			if (!this->flushEvents->TryPop(record))
+			{
+				this->eventQueue.ReleaseEvents();
+				this->flushEvents = nullptr;
+				continue;
+			}
+
+			this->flushWriter.Clear();
+			this->WriteEvent(this->flushWriter, record);
+
+			auto & json = this->flushWriter.GetString();
+			this->flushBatch.Add(json.data(), json.size());
+		}
+
+		if (completed)
+		{
+			// Older annotations are no longer referred to by any queued event.
+			while (this->annotations.size() > static_cast<uint16_t>(this->annotationsGeneration - this->flushGeneration) + 1u)
+			{
+				this->annotations.pop_front();
+			}
+
+			this->players.EndFlush();
+		}
+	}
+
+	store();
+
+	this->flushTime += this->serverClock.GetLocalNanoseconds() - sliceStart;
+
+	if (!completed)
+	{
+		return false;
+	}
+
+	if (sync)
+	{
+		this->eventStore->Sync();
+	}
+
+	if (this->metricsEnabled)
+	{
+		this->serializeLatency.Record(static_cast<uint64_t>(this->flushTime));
+	}
+
+	// Reserve transaction numbers here rather than when sending business events.
+	this->transactionCounter.ReserveAhead();
+
+	this->flushing = false;
+	return true;
+}
+
+void GameAnalyticsCore::CountRequest(RequestBuilder & builder)
+{
+	++this->requests;
+	this->sentBytes += builder.GetRequest().body.size();
+	this->uncompressedBytes += builder.GetBodySize();
+
+	if (this->metricsEnabled)
+	{
+		this->signLatency.Record(static_cast<uint64_t>(builder.GetSignTime()));
+
+		if (builder.GetCompressTime() > 0)
+		{
+			this->compressLatency.Record(static_cast<uint64_t>(builder.GetCompressTime()));
+		}
+	}
+}
+
+bool GameAnalyticsCore::DoWork(const int64_t deadline, const bool sync)
+{
+	auto now = this->serverClock.GetLocalMilliseconds();
+
+	// Write metrics file, if configured.
+	{
+		std::lock_guard<std::mutex> lock(this->metricsMutex);
+
+		if (!this->metricsPath.empty() && now - this->lastMetricsTime >= this->metricsInterval)
+		{
+			this->lastMetricsTime = now;
+			WriteMetricsFile(this->metricsPath, this->GetMetrics());
+		}
+	}
+
+	if (!this->initialized)
+	{
+		// Continue as in the previous session if the backend takes too long to respond.
+		if (this->initPending && this->enabledBefore && now - this->initializationTime >= this->initTimeout * 1000ll)
+		{
+			InitResult result;
+			result.success = true;
+			result.cached = true;
+			result.error = "Timed out initializing GameAnalytics.";
+
+			this->CompleteInit(result);
+		}
+
+		return true;
+	}
+
+	if (this->flushing || this->flushRequested.exchange(false) || now - this->lastFlushTime >= this->flushInterval * 1000ll)
+	{
+		std::lock_guard<std::mutex> lock(this->flushMutex);
+
+		if (!this->ContinueFlush(deadline, sync))
+		{
+			return false;
+		}
+	}
+	else if (!this->sendAgain && !this->uploads.IsRetryDue(now))
+	{
+		// Nothing to send: no new events, no responses to fill the window again after, and no failed batches to send again after their backoff.
+		return true;
+	}
+
+	return this->SendStoredEvents(deadline);
+}
+
+void GameAnalyticsCore::EnqueueEvent(const EventRecord & record)
+{
+	auto measure = this->metricsEnabled.load(std::memory_order_relaxed) && ++GetEnqueueCount() % EnqueueMeasureInterval == 0;
+	LatencyTimer timer(this->serverClock, measure ? &this->enqueueLatency : nullptr);
+
+	// Drop events with values JSON can't represent, e.g. a design value computed by dividing by zero, before they distort aggregates.
+	if (!this->CheckEvent(std::isfinite(record.value)))
+	{
+		return;
+	}
+
+	// Sample players by their own user id.
+	auto sampled = record.player != PlayerRegistry::None
+		? this->limiter.IsSampled(record.category, this->players.Get(record.player).userHash)
+		: this->limiter.IsSampled(record.category);
+
+	if (!sampled)
+	{
+		return;
+	}
+
+	// Count repeated error messages instead of sending each of them, and always when running out of memory.
+	if (record.category == EventCategory::Error)
+	{
+		if (this->limiter.TryAcquireError(static_cast<Severity::Severity>(record.subtype), record.message, record.timestamp, this->memoryBudget.IsUnderPressure()))
+		{
+			this->QueueEvent(record);
+		}
+
+		return;
+	}
+
+	auto eventId = (record.fields & EventField::RegisteredEventId) ? std::string_view(this->eventIds.Get(record.registeredEventId)) : record.eventId;
+
+	// Aggregate chatty events instead of sending each of them.
+	if (record.category == EventCategory::Design || record.category == EventCategory::Resource)
+	{
+		auto hasValue = record.category == EventCategory::Resource || (record.fields & EventField::Value) != 0;
+
+		if (this->aggregator.TryAdd(record.category, record.subtype, eventId, record.value, hasValue))
+		{
+			return;
+		}
+	}
+
+	if (this->limiter.TryAcquire(record.category, record.subtype, eventId, record.timestamp))
+	{
+		this->QueueEvent(record);
+	}
+}
+
+void GameAnalyticsCore::EmitAggregates(const bool force)
+{
+	// Summaries of all players are sent by the local user.
+	PlayerScope scope(*this, PlayerContext());
+
+	auto now = this->serverClock.GetLocalMilliseconds();
+
+	if (!force && !this->aggregator.IsWindowElapsed(now))
+	{
+		return;
+	}
+
+	std::string eventId;
+
+	this->aggregator.TakeAggregates(now, [this, &eventId](EventCategory::EventCategory category, uint8_t subtype, const std::string & aggregatedEventId, const EventAggregate & aggregate)
+	{
+		if (category == EventCategory::Resource)
+		{
+			// Send total amount per flow type.
+			auto record = this->BuildEventRecord(category);
+			record.eventId = aggregatedEventId;
+			record.subtype = subtype;
+			record.value = aggregate.sum;
+
+			this->QueueEvent(record);
+			return;
+		}
+
+		// Send statistics as design events with the name of the statistic appended to the event id.
+		auto queueStatistic = [this, &eventId, &aggregatedEventId](const char * name, const double value)
+		{
+			eventId.assign(aggregatedEventId);
+			eventId.push_back(':');
+			eventId.append(name);
+
+			// Drop summaries of ids with too many parts to append the name of the statistic, and sums that have overflowed.
+			if (!this->CheckEvent(EventSchema::IsValidEventId(EventCategory::Design, eventId) && std::isfinite(value)))
+			{
+				return;
+			}
+
+			auto record = this->BuildEventRecord(EventCategory::Design);
+			record.eventId = eventId;
+			record.value = value;
+			record.fields |= EventField::Value;
+
+			this->QueueEvent(record);
+		};
+
+		queueStatistic("Count", static_cast<double>(aggregate.count));
+
+		if (aggregate.hasValue)
+		{
+			queueStatistic("Sum", aggregate.sum);
+			queueStatistic("Min", aggregate.min);
+			queueStatistic("Max", aggregate.max);
+			queueStatistic("P50", aggregate.quantiles.GetQuantile(0.5));
+			queueStatistic("P90", aggregate.quantiles.GetQuantile(0.9));
+			queueStatistic("P99", aggregate.quantiles.GetQuantile(0.99));
+		}
+	});
+}
+
+void GameAnalyticsCore::EmitRepeatedErrors(const bool force)
+{
+	// Repetitions of all players are sent by the local user.
+	PlayerScope scope(*this, PlayerContext());
+
+	std::string message;
+
+	this->limiter.TakeRepeatedErrors(this->serverClock.GetLocalMilliseconds(), force, [this, &message](Severity::Severity severity, const std::string & repeatedMessage, uint64_t repetitions)
+	{
+		message.assign(repeatedMessage);
+		message.append(" (repeated ");
+		message.append(std::to_string(repetitions));
+		message.append(" times)");
+
+		auto record = this->BuildEventRecord(EventCategory::Error);
+		record.message = message;
+		record.subtype = static_cast<uint8_t>(severity);
+
+		this->QueueEvent(record);
+	});
+}
+
+void GameAnalyticsCore::QueueEvent(const EventRecord & record)
+{
+	// Estimate serialized size for the byte budget of the queue.
+	auto size = EventOverheadBytes + this->annotationsSize
+		+ record.eventId.size() + record.currency.size() + record.cartType.size() + record.progression.size() + record.message.size();
+
+	if (record.fields & EventField::RegisteredEventId)
+	{
+		size += this->eventIds.GetEscaped(record.registeredEventId).size();
+	}
+
+	// Never block the calling thread. The event is dropped if the thread has queued too many events since the last flush.
+	auto full = false;
+	this->eventQueue.TryEnqueue(record, size, full);
+
+	// Let the next update send the queue.
+	if (full)
+	{
+		this->RequestFlush();
+	}
+}
+
+std::string GameAnalyticsCore::GenerateSessionId() const
+{
+	// Generate random (version 4) GUID.
+	std::random_device randomDevice;
+	std::mt19937_64 random((static_cast<uint64_t>(randomDevice()) << 32) ^ randomDevice());
+
+	auto high = random();
+	auto low = random();
+
+	high = (high & 0xFFFFFFFFFFFF0FFFull) | 0x0000000000004000ull;
+	low = (low & 0x3FFFFFFFFFFFFFFFull) | 0x8000000000000000ull;
+
+	char guid[37];
+	snprintf(guid, sizeof(guid), "%08x-%04x-%04x-%04x-%012llx",
+		static_cast<unsigned int>(high >> 32),
+		static_cast<unsigned int>((high >> 16) & 0xFFFF),
+		static_cast<unsigned int>(high & 0xFFFF),
+		static_cast<unsigned int>(low >> 48),
+		static_cast<unsigned long long>(low & 0xFFFFFFFFFFFFull));
+
+	return std::string(guid);
+}
+
+uint32_t GameAnalyticsCore::GetCurrentPlayer() const
+{
+	return CurrentPlayer.core == this ? CurrentPlayer.player : PlayerRegistry::None;
+}
+
+int GameAnalyticsCore::GetNextTransactionNumber()
+{
+	auto number = this->transactionCounter.Next();
+
+	// Have the next range reserved by the flush before it is needed, so sending business events doesn't write to the store.
+	if (this->transactionCounter.IsLow())
+	{
+		this->RequestFlush();
+	}
+
+	return number;
+}
+
+std::string GameAnalyticsCore::GetSDKVersion() const
+{
+	return "rest api v2";
+}
+
+uint16_t GameAnalyticsCore::GetProgression() const
+{
+	auto player = this->GetCurrentPlayer();
+	return player != PlayerRegistry::None ? this->players.Get(player).progression.load() : this->progression.load();
+}
+
+int64_t GameAnalyticsCore::GetTimeSinceInit() const
+{
+	return (this->serverClock.GetLocalMilliseconds() - this->initializationTime) / 1000;
+}
+
+int64_t GameAnalyticsCore::GetTimestamp() const
+{
+	return this->serverClock.GetLocalMilliseconds();
+}
+
+void GameAnalyticsCore::OnInitResponse(const TransportResponse & response, const int64_t requestTime)
+{
+	InitResult result;
+	result.success = false;
+	result.cached = false;
+	result.response = response.body;
+
+	// Verify response.
+	auto enabled = false;
+	auto serverTimestamp = 0.0;
+
+	if (response.statusCode == 0)
+	{
+		result.error = "Unable to reach GameAnalytics backend.";
+	}
+	else if (response.statusCode < 200 || response.statusCode >= 300)
+	{
+		result.error = "Error initializing GameAnalytics: " + response.body;
+	}
+	else if (!Json::TryGetBoolean(response.body, "enabled", enabled) || !enabled)
+	{
+		result.error = "Error initializing GameAnalytics.";
+	}
+	else if (!Json::TryGetNumber(response.body, "server_ts", serverTimestamp))
+	{
+		result.error = "Invalid server timestamp.";
+	}
+	else
+	{
+		// Set server time. Timestamps have a precision of one second.
+		this->serverClock.Synchronize(static_cast<int64_t>(serverTimestamp) * 1000, 1000, requestTime, this->serverClock.GetLocalMilliseconds());
+		result.success = true;
+	}
+
+	if (response.statusCode < 200 || response.statusCode >= 300)
+	{
+		++this->failedRequests;
+	}
+
+	auto & keyValueStore = this->environment.keyValueStore;
+
+	if (response.statusCode == 0)
+	{
+		// Continue as in the previous session if offline.
+		result.success = this->enabledBefore;
+		result.cached = this->enabledBefore;
+	}
+	else
+	{
+		// Remember the decision of the backend for the next session.
+		keyValueStore->SetInt32("GameAnalytics::Enabled", result.success ? 1 : 0);
+
+		// The backend may disable sending events after having timed out.
+		if (!result.success)
+		{
+			this->initialized = false;
+		}
+	}
+
+	// Store the session number as well.
+	keyValueStore->Commit();
+
+	this->CompleteInit(result);
+
+	if (result.success && !result.cached)
+	{
+		// Keys might have changed since the backend has refused them.
+		this->uploads.Resume();
+
+		// Send events buffered before, now that their timestamps can be converted to server time.
+		if (this->pumped)
+		{
+			this->RequestFlush();
+		}
+		else
+		{
+			this->Flush();
+		}
+	}
+}
+
+void GameAnalyticsCore::OnEventsResponse(const TransportResponse & response, const int64_t requestNanoseconds, const uint64_t batchId, const size_t batchBytes)
+{
+	auto nowNanoseconds = this->serverClock.GetLocalNanoseconds();
+	auto now = nowNanoseconds / 1000000;
+	auto requestTime = requestNanoseconds / 1000000;
+
+	// Keep server time in sync during long sessions.
+	if (response.serverTime > 0)
+	{
+		this->serverClock.Synchronize(response.serverTime * 1000, 1000, requestTime, now);
+	}
+
+	UploadResult result;
+
+	if (response.statusCode >= 200 && response.statusCode < 300)
+	{
+		result = UploadResult::Accepted;
+	}
+	else if (response.statusCode == 400)
+	{
+		// Events rejected by the backend won't be accepted when sending them again.
+		result = UploadResult::Rejected;
+	}
+	else if (response.statusCode == 413)
+	{
+		result = UploadResult::TooLarge;
+	}
+	else if (response.statusCode == 401 || response.statusCode == 403)
+	{
+		result = UploadResult::Unauthorized;
+	}
+	else if (response.statusCode == 0)
+	{
+		// Probably offline.
+		result = UploadResult::NetworkError;
+	}
+	else
+	{
+		// Includes 408 Request Timeout, 429 Too Many Requests and all 5xx codes.
+		result = UploadResult::ServerError;
+	}
+
+	// Update metrics.
+	if (result != UploadResult::Accepted)
+	{
+		++this->failedRequests;
+	}
+
+	if (this->metricsEnabled)
+	{
+		this->uploadLatency.Record(static_cast<uint64_t>(nowNanoseconds - requestNanoseconds));
+	}
+
+	// Drop exactly the events the backend has rejected, or isolate them by splitting the batch if it doesn't tell which ones.
+	std::vector<size_t> rejectedEvents;
+
+	if (result == UploadResult::Rejected && TryGetRejectedEvents(response.body, rejectedEvents))
+	{
+		this->uploads.Complete(batchId, rejectedEvents);
+	}
+	else
+	{
+		this->uploads.Complete(batchId, result, now);
+	}
+
+	this->batchSizer.Complete(batchBytes, requestTime, now, result);
+
+	// Write the acknowledged position on the thread receiving responses, outside the locks of the scheduler and the store,
+	// so neither the game thread nor appending events waits for the disk.
+	this->eventStore->SaveCursor();
+
+	// Fill the window again.
+	this->SendStoredEventsSoon();
+}
+
+bool GameAnalyticsCore::SendStoredEvents(const int64_t deadline)
+{
+	// Only one thread fills the window at a time. Others just make sure it checks again.
+	// Loops instead of recursing if the transport calls back synchronously.
+	this->sendAgain = true;
+
+	while (!this->sending.exchange(true))
+	{
+		this->sendAgain = false;
+
+		UploadScheduler::Batch batch;
+		auto now = this->serverClock.GetLocalMilliseconds();
+
+		while (true)
+		{
+			if (!this->upload)
+			{
+				// Batches are sized to the network, but leave room for queued events in the memory budget.
+				auto maxBatchBytes = this->batchSizer.GetBatchBytes();
+				auto memoryLimit = this->memoryBudget.GetLimitBytes();
+
+				if (memoryLimit > 0)
+				{
+					maxBatchBytes = std::min(maxBatchBytes, memoryLimit / 4);
+				}
+
+				// Reading can't be continued later, so read no more than fits into the time left, but at least the smallest batch.
+				// Leave further batches to the next call if out of time.
+				if (deadline != NoDeadline)
+				{
+					auto timeLeft = deadline - this->serverClock.GetLocalNanoseconds();
+
+					if (timeLeft <= 0)
+					{
+						this->sendAgain = true;
+						this->sending = false;
+						return false;
+					}
+
+					auto fittingBytes = static_cast<size_t>(timeLeft / this->readNanosecondsPerByte);
+					maxBatchBytes = std::min(maxBatchBytes, std::max(fittingBytes, BatchSizer::MinBatchBytes));
+				}
+
+				// Reserve memory for the body read from disk and the request. A single batch may use half of the budget, so stored events keep being sent.
+				auto reservedBytes = 2 * maxBatchBytes;
+				auto priority = this->uploads.GetInFlightBatches() > 0 ? MemoryPriority::Normal : MemoryPriority::High;
+
+				if (!this->memoryBudget.TryReserve(reservedBytes, priority))
+				{
+					break;
+				}
+
+				auto readStart = this->serverClock.GetLocalNanoseconds();
+
+				if (!this->uploads.TryNextBatch(std::numeric_limits<size_t>::max(), maxBatchBytes, now, batch))
+				{
+					this->memoryBudget.Release(reservedBytes);
+					break;
+				}
+
+				auto readTime = static_cast<double>(this->serverClock.GetLocalNanoseconds() - readStart);
+				this->readNanosecondsPerByte += ReadTimeWeight * (readTime / batch.body.size() - this->readNanosecondsPerByte);
+
+				auto compress = batch.body.size() >= this->compressionThreshold;
+
+				this->upload.reset(new RequestBuilder("http://api.gameanalytics.com/v2/" + this->gameKey + "/events", std::move(batch.body), this->signer,
+					compress, this->metricsEnabled ? &this->serverClock : nullptr));
+				this->uploadBatchId = batch.id;
+				this->uploadReservedBytes = reservedBytes;
+			}
+
+			// Sign and compress the request piece by piece, continuing with the next call if out of time.
+			while (!this->upload->Continue())
+			{
+				if (this->serverClock.GetLocalNanoseconds() >= deadline)
+				{
+					this->sendAgain = true;
+					this->sending = false;
+					return false;
+				}
+			}
+
+			this->CountRequest(*this->upload);
+
+			std::weak_ptr<GameAnalyticsCore> weakThis = this->shared_from_this();
+			auto & request = this->upload->GetRequest();
+			auto batchId = this->uploadBatchId;
+			auto batchBytes = this->upload->GetBodySize();
+			auto requestNanoseconds = this->serverClock.GetLocalNanoseconds();
+
+			// Keep only the request until it has been answered. Batches sent again may hold a single event exceeding the maximum batch size.
+			auto requestBytes = request.body.size();
+			auto reservedBytes = this->uploadReservedBytes;
+
+			if (requestBytes > reservedBytes)
+			{
+				this->memoryBudget.Reserve(requestBytes - reservedBytes);
+			}
+			else
+			{
+				this->memoryBudget.Release(reservedBytes - requestBytes);
+			}
+
+			this->environment.transport->Post(request, [weakThis, requestNanoseconds, batchId, batchBytes, requestBytes](const TransportResponse & response)
+			{
+				auto core = weakThis.lock();
+
+				if (core)
+				{
+					core->memoryBudget.Release(requestBytes);
+					core->OnEventsResponse(response, requestNanoseconds, batchId, batchBytes);
+				}
+			});
+
+			this->upload.reset();
+		}
+
+		this->sending = false;
+
+		if (!this->sendAgain)
+		{
+			return true;
+		}
+	}
+
+	return true;
+}
+
+void GameAnalyticsCore::SendStoredEventsSoon()
+{
+	if (this->pumped)
+	{
+		// Leave sending to the next slice of work.
+		this->sendAgain = true;
+		this->WakeWorker();
+	}
+	else
+	{
+		this->SendStoredEvents(NoDeadline);
+	}
+}
+
+uint16_t GameAnalyticsCore::RegisterProgression(const std::string_view & eventId)
+{
+	auto handle = this->progressions.Find(eventId);
+
+	if (handle != EventIdRegistry::None)
+	{
+		return handle;
+	}
+
+	try
+	{
+		return this->progressions.Register(eventId).handle;
+	}
+	catch (const std::length_error &)
+	{
+		// Registry is full. Don't track progression, but still send the event.
+		return EventIdRegistry::None;
+	}
+}
+
+void GameAnalyticsCore::RequestFlush()
+{
+	if (!this->flushRequested.exchange(true))
+	{
+		this->WakeWorker();
+	}
+}
+
+void GameAnalyticsCore::SetProgression(const uint16_t progression)
+{
+	auto player = this->GetCurrentPlayer();
+
+	if (player != PlayerRegistry::None)
+	{
+		this->players.Get(player).progression = progression;
+	}
+	else
+	{
+		this->progression = progression;
+	}
+}
+
+bool GameAnalyticsCore::CheckEvent(const bool valid)
+{
+	if (!valid)
+	{
+		this->invalidEvents.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return valid;
+}
+
+bool GameAnalyticsCore::IsValidEventId(const EventCategory::EventCategory category, const EventId & eventId) const
+{
+	return (this->eventIds.GetValidCategories(eventId.handle) & (1u << category)) != 0;
+}
+
+void GameAnalyticsCore::SetEventId(EventRecord & record, const std::string_view & eventId) const
+{
+	this->SetEventId(record, eventId, HashString(eventId));
+}
+
+void GameAnalyticsCore::SetEventId(EventRecord & record, const std::string_view & eventId, const uint32_t hash) const
+{
+	auto handle = this->eventIds.Find(eventId, hash);
+
+	if (handle != EventIdRegistry::None)
+	{
+		record.registeredEventId = handle;
+		record.fields |= EventField::RegisteredEventId;
+	}
+	else
+	{
+		record.eventId = eventId;
+	}
+}
+
+void GameAnalyticsCore::SetEventId(EventRecord & record, const EventId & eventId) const
+{
+	// Verify handle.
+	this->eventIds.Get(eventId.handle);
+
+	record.registeredEventId = eventId.handle;
+	record.fields |= EventField::RegisteredEventId;
+}
+
+void GameAnalyticsCore::UpdateAnnotations()
+{
+	// Write members only, so the annotations can be spliced into each event.
+	JsonWriter jsonObject;
+
+	// Add device model.
+	jsonObject.WriteMember("device", this->deviceModel);
+
+	// Add GameAnalytics API version.
+	jsonObject.WriteMember("v", static_cast<int64_t>(2));
+
+	// Add SDK version.
+	jsonObject.WriteMember("sdk_version", this->GetSDKVersion());
+
+	// Add OS version.
+	jsonObject.WriteMember("os_version", this->osVersion);
+
+	// Add manufacturer.
+	jsonObject.WriteMember("manufacturer", this->manufacturer);
+
+	// Add platform.
+	jsonObject.WriteMember("platform", this->platform);
+
+	// Add build.
+	jsonObject.WriteMember("build", this->build);
+
+	Annotations annotations;
+	annotations.shared = jsonObject.GetString();
+
+	// Add members of the local user.
+	jsonObject.Clear();
+
+	// Add user id.
+	jsonObject.WriteMember("user_id", this->userId);
+
+	// Add session ID.
+	jsonObject.WriteMember("session_id", this->sessionId);
+
+	// Add session number.
+	jsonObject.WriteMember("session_num", static_cast<int64_t>(this->sessionNumber));
+
+	// Add Google+ id.
+	if (!this->googlePlusId.empty())
+	{
+		jsonObject.WriteMember("googleplus_id", this->googlePlusId);
+	}
+
+	// Add Facebook id.
+	if (!this->facebookId.empty())
+	{
+		jsonObject.WriteMember("facebook_id", this->facebookId);
+	}
+
+	// Add gender.
+	if (this->gender != Gender::Unknown)
+	{
+		jsonObject.WriteMember("gender", Gender::ToString(this->gender));
+	}
+
+	// Add birthyear.
+	if (this->birthYear >= 0)
+	{
+		jsonObject.WriteMember("birth_year", static_cast<int64_t>(this->birthYear));
+	}
+
+	annotations.user = jsonObject.GetString();
+
+	// Keep previous annotations until all events referring to them have been serialized.
+	this->annotationsSize = annotations.shared.size() + 1 + annotations.user.size();
+	this->annotations.push_back(std::move(annotations));
+	++this->annotationsGeneration;
+}
+
+void GameAnalyticsCore::UpdatePlayerAnnotations(Player & player) const
+{
+	// Write the same members as for the local user.
+	JsonWriter jsonObject;
+
+	jsonObject.WriteMember("user_id", player.userId);
+	jsonObject.WriteMember("session_id", player.sessionId);
+	jsonObject.WriteMember("session_num", static_cast<int64_t>(player.sessionNumber));
+
+	if (!player.googlePlusId.empty())
+	{
+		jsonObject.WriteMember("googleplus_id", player.googlePlusId);
+	}
+
+	if (!player.facebookId.empty())
+	{
+		jsonObject.WriteMember("facebook_id", player.facebookId);
+	}
+
+	if (player.gender != Gender::Unknown)
+	{
+		jsonObject.WriteMember("gender", Gender::ToString(player.gender));
+	}
+
+	if (player.birthYear >= 0)
+	{
+		jsonObject.WriteMember("birth_year", static_cast<int64_t>(player.birthYear));
+	}
+
+	player.annotations = jsonObject.GetString();
+}
+
+void GameAnalyticsCore::WakeWorker()
+{
+	std::lock_guard<std::mutex> lock(this->workerMutex);
+
+	if (this->worker)
+	{
+		this->worker->WakeUp();
+	}
+}
+
+void GameAnalyticsCore::WriteEvent(JsonWriter & writer, const EventRecord & record) const
+{
+	writer.BeginObject();
+
+	// Add category.
+	auto category = EventCategory::ToString(record.category);
+	writer.WriteMember("category", category);
+
+	// Add timestamp.
+	writer.WriteMember("client_ts", this->serverClock.ToServerMilliseconds(record.timestamp) / 1000);
+
+	// Add progression.
+	if (record.fields & EventField::Progression)
+	{
+		writer.WriteMember("progression", record.progression);
+	}
+
+	// Add event fields.
+	switch (record.category)
+	{
+	case EventCategory::Business:
+		this->WriteEventId(writer, nullptr, record);
+		writer.WriteMember("currency", record.currency);
+		writer.WriteMember("amount", static_cast<int64_t>(record.value));
+		writer.WriteMember("transaction_num", static_cast<int64_t>(record.transactionNumber));
+
+		if (record.fields & EventField::CartType)
+		{
+			writer.WriteMember("cart_type", record.cartType);
+		}
+		break;
+
+	case EventCategory::Design:
+		this->WriteEventId(writer, nullptr, record);
+
+		if (record.fields & EventField::Value)
+		{
+			writer.WriteMember("value", record.value);
+		}
+		break;
+
+	case EventCategory::Error:
+	{
+		auto severity = Severity::ToString(static_cast<Severity::Severity>(record.subtype));
+
+		writer.WriteMember("message", record.message);
+		writer.WriteMember("severity", severity);
+		break;
+	}
+
+	case EventCategory::Progression:
+	{
+		auto status = ProgressionStatus::ToString(static_cast<ProgressionStatus::ProgressionStatus>(record.subtype));
+		this->WriteEventId(writer, status, record);
+
+		if (record.fields & EventField::Value)
+		{
+			writer.WriteMember("score", static_cast<int64_t>(record.value));
+		}
+		break;
+	}
+
+	case EventCategory::Resource:
+	{
+		auto flowType = FlowType::ToString(static_cast<FlowType::FlowType>(record.subtype));
+		this->WriteEventId(writer, flowType, record);
+
+		writer.WriteMember("amount", record.value);
+		break;
+	}
+
+	case EventCategory::SessionEnd:
+		writer.WriteMember("length", static_cast<int64_t>(record.value));
+		break;
+
+	case EventCategory::User:
+		break;
+	}
+
+	// Add session annotations. Caller holds the annotations mutex.
+	// Generations wrap around, and events queued during a concurrent update fall back to the oldest annotations kept.
+	auto age = static_cast<uint16_t>(this->annotationsGeneration - record.annotations);
+	auto index = age < this->annotations.size() ? this->annotations.size() - 1 - age : 0;
+	auto & annotations = this->annotations[index];
+
+	writer.WriteMembers(annotations.shared);
+
+	// Add user and session of the player, if sent on behalf of one.
+	writer.WriteMembers(record.player != PlayerRegistry::None ? this->players.Get(record.player).annotations : annotations.user);
+	writer.EndObject();
+}
+
+void GameAnalyticsCore::WriteEventId(JsonWriter & writer, const char * prefix, const EventRecord & record) const
+{
+	writer.WriteName("event_id");
+	writer.BeginString();
+
+	if (prefix != nullptr)
+	{
+		writer.WriteStringPart(prefix);
+		writer.WriteStringPart(":");
+	}
+
+	if (record.fields & EventField::RegisteredEventId)
+	{
+		writer.WriteEscapedStringPart(this->eventIds.GetEscaped(record.registeredEventId));
+	}
+	else
+	{
+		// Event ids have been checked before being queued, and valid ids don't need to be escaped.
+		writer.WriteEscapedStringPart(record.eventId);
+	}
+
+	writer.EndString();
+}
+
+PlayerScope::PlayerScope(const GameAnalyticsCore & core, const PlayerContext & player)
+	: previousCore(CurrentPlayer.core),
+	previousPlayer(CurrentPlayer.player)
+{
+	CurrentPlayer.core = &core;
+	CurrentPlayer.player = player.handle;
+}
+
+PlayerScope::~PlayerScope()
+{
+	CurrentPlayer.core = this->previousCore;
+	CurrentPlayer.player = this->previousPlayer;
+}
@@ -0,0 +1,516 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "GameAnalyticsBatchSizer.h"
+#include "GameAnalyticsClock.h"
+#include "GameAnalyticsDeviceInfo.h"
+#include "GameAnalyticsErrorSeverity.h"
+#include "GameAnalyticsEventAggregator.h"
+#include "GameAnalyticsEventBatch.h"
+#include "GameAnalyticsEventCategory.h"
+#include "GameAnalyticsEventIdRegistry.h"
+#include "GameAnalyticsEventLimiter.h"
+#include "GameAnalyticsEventQueue.h"
+#include "GameAnalyticsEventRecord.h"
+#include "GameAnalyticsEventRing.h"
+#include "GameAnalyticsEventSchema.h"
+#include "GameAnalyticsEventStore.h"
+#include "GameAnalyticsJsonWriter.h"
+#include "GameAnalyticsKeyValueStore.h"
+#include "GameAnalyticsLatencyHistogram.h"
+#include "GameAnalyticsMemoryBudget.h"
+#include "GameAnalyticsMetrics.h"
+#include "GameAnalyticsPersistentCounter.h"
+#include "GameAnalyticsPlayerRegistry.h"
+#include "GameAnalyticsProgressionStatus.h"
+#include "GameAnalyticsRequestBuilder.h"
+#include "GameAnalyticsResourceFlowType.h"
+#include "GameAnalyticsServerClock.h"
+#include "GameAnalyticsSha256.h"
+#include "GameAnalyticsTransport.h"
+#include "GameAnalyticsUploadScheduler.h"
+#include "GameAnalyticsUserGender.h"
+#include "GameAnalyticsWorker.h"
+
+namespace GameAnalytics
+{
+	// Platform-specific services used by the GameAnalytics core.
+	struct Environment
+	{
+		std::shared_ptr<Transport> transport;
+		std::shared_ptr<Clock> clock;
+		std::shared_ptr<KeyValueStore> keyValueStore;
+		std::shared_ptr<DeviceInfo> deviceInfo;
+
+		// Directory to store events in that have not been sent yet.
+		std::filesystem::path storeDirectory;
+	};
+
+	// Result of initializing the GameAnalytics core.
+	struct InitResult
+	{
+		// Whether the backend could be reached and has enabled sending events.
+		bool success;
+
+		// Whether the backend could not be reached in time, and sending events has been enabled by the response of a previous session instead.
+		bool cached;
+
+		// UTF-8 encoded response body of the backend.
+		std::string response;
+
+		// Description of the error, if initialization has failed.
+		std::string error;
+	};
+
+	// Platform-independent implementation of the GameAnalytics REST API v2.
+	// Builds, serializes, signs, queues and stores events, and sends them using the transport of the environment.
+	// All strings are expected to be UTF-8 encoded.
+	// Has to be owned by a std::shared_ptr, because pending transport callbacks keep track of it.
+	class GameAnalyticsCore : public std::enable_shared_from_this<GameAnalyticsCore>
+	{
+	public:
+		typedef std::function<void(const InitResult & result)> InitCallback;
+
+		// Initializes a new instance of the GameAnalytics core
+		// for the game with the specified game key and secret key.
+		// Uses the app version as build id, uses the hardware id as user id,
+		// and generates a new GUID for the session.
+		GameAnalyticsCore(const std::string & gameKey, const std::string & secretKey, const Environment & environment);
+		~GameAnalyticsCore();
+
+		// Should be called when a new session starts. Returns without waiting for the backend.
+		// Determines if the SDK should be disabled and gets the server timestamp otherwise.
+		// If the backend can't be reached within the init timeout, and has enabled sending events in the previous session, continues as enabled.
+		// Passes the result to the specified callback once, which may be invoked on any thread.
+		// Events sent before initialization has completed are buffered, and sent with the first flush afterwards.
+		void Init(const InitCallback & callback);
+
+		bool IsInitialized() const;
+
+		// Sends queued events if the flush interval has passed or the queue is full. Should be called regularly, e.g. once per second,
+		// starting before Init, so the init timeout can be checked.
+		void Update();
+
+		// Does the work of Update in slices, e.g. within the share of the frame budget granted to analytics, returning as soon as the specified
+		// number of microseconds has been used up. Serializing and storing events, and signing and compressing requests, continue with the next call.
+		// Once called, sending events and receiving responses of the backend never do any work beyond queueing, but leave it to the next call.
+		// Only the position of the events accepted by the backend is written to disk on the thread receiving the response.
+		// Never waits for the disk, so stored events survive the app being terminated, but not the device losing power until the next Flush.
+		// Returns true if all work due has been done, and false if some has been left for the next call.
+		bool Pump(const int64_t maxMicroseconds);
+
+		// Does the work of Update on a dedicated thread with low priority, in slices like Pump, instead of requiring calls to Update or Pump.
+		void StartWorker();
+
+		// Stops the worker thread, waiting for its current slice of work. Work has to be done by calling Update or Pump again afterwards.
+		void StopWorker();
+
+		// Stores all queued events on disk and sends them to the GameAnalytics backend in batches. Does nothing before initialization.
+		void Flush();
+
+		// Flushes with the next call of Update or Pump, or the next slice of the worker thread, waking it.
+		// Never does any work on the calling thread, e.g. for handlers of system events called on arbitrary threads.
+		void RequestFlush();
+
+		// Aggregates all design and resource events whose id starts with the specified prefix, e.g. "Kill:" for ids sent thousands of times per session.
+		// Instead of each event, sends summary design events per aggregation interval and event id, with ":Count", ":Sum", ":Min", ":Max",
+		// ":P50", ":P90" and ":P99" appended to the id. Resource events are summed up per flow type and sent as single resource events.
+		// Aggregated design event ids should have at most four parts. Throws std::length_error if more than 64 prefixes have been added.
+		void AggregateEvents(const std::string_view & eventIdPrefix);
+
+		// Registers the specified event id for sending events by handle, returning the same handle for equal ids.
+		// Events with registered ids are queued and serialized without copying or escaping the id again,
+		// which is worth it for ids sent over and over. Events sent by string use registered ids automatically.
+		// For resource events, register the id without flow type, e.g. "Gold:Weapon:Sword".
+		// Can be called before initialization. Throws std::length_error if more than 4096 ids have been registered.
+		EventId RegisterEventId(const std::string_view & eventId);
+
+		// Gets counters and latencies of the GameAnalytics pipeline itself, e.g. for showing them in a debug overlay.
+		// Latencies are measured only if enabled by SetMetricsEnabled.
+		Metrics GetMetrics() const;
+
+		// Starts a session on behalf of another player, e.g. by a dedicated game server for each connected player, and returns its context.
+		// Events sent and user data set by a thread within a PlayerScope of the context are attributed to that player,
+		// and sent in the same batches as all other events. User data changes apply to events of the player that haven't been flushed yet.
+		// The session number has to be counted by the caller, starting at 1. Throws std::length_error if more than a million sessions are active.
+		PlayerContext StartPlayerSession(const std::string_view & userId, const int sessionNumber);
+
+		// Sends the session end event of the specified player, and releases its context once all of its events have been flushed.
+		// The context must not be used afterwards.
+		void EndPlayerSession(const PlayerContext & player);
+
+		// Events breaking the rules of the backend, e.g. with malformed ids, are dropped instead of being queued, and counted by the metrics.
+		// Events sent by typed ids don't check or hash the ids again.
+		void SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount);
+		void SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType);
+		void SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount);
+		void SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType);
+		void SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount);
+		void SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType);
+		void SendDesignEvent(const std::string_view & eventId);
+		void SendDesignEvent(const std::string_view & eventId, const float value);
+		void SendDesignEvent(const EventId & eventId);
+		void SendDesignEvent(const EventId & eventId, const float value);
+		void SendDesignEvent(const DesignEventId & eventId);
+		void SendDesignEvent(const DesignEventId & eventId, const float value);
+		void SendErrorEvent(const std::string_view & message, const Severity::Severity severity);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId, const int score);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId, const int score);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId, const int score);
+		void SendResourceEvent(const FlowType::FlowType flowType, const std::string_view & ingameCurrency, const std::string_view & itemType, const std::string_view & itemId, const float amount);
+		void SendResourceEvent(const FlowType::FlowType flowType, const EventId & eventId, const float amount);
+		void SendResourceEvent(const FlowType::FlowType flowType, const ResourceEventId & eventId, const float amount);
+		void SendSessionEndEvent();
+
+		// Sends the user event with the current user data to the GameAnalytics backend.
+		void SendUserEvent();
+
+		void SetAggregationInterval(const int aggregationInterval);
+		void SetBirthYear(const int birthYear);
+		void SetBuild(const std::string_view & build);
+		void SetCompressionThreshold(const size_t compressionThreshold);
+		void SetFacebookId(const std::string_view & facebookId);
+		void SetFlushInterval(const int flushInterval);
+		void SetGender(const Gender::Gender gender);
+		void SetGooglePlusId(const std::string_view & googlePlusId);
+
+		// Sets how long to wait for the init response before falling back to the decision of the previous session, in seconds. Defaults to 5.
+		void SetInitTimeout(const int initTimeout);
+		void SetMaxBatchBytes(const size_t maxBatchBytes);
+		void SetMaxBatchEvents(const size_t maxBatchEvents);
+		void SetMaxBatchRetries(const int maxBatchRetries);
+		void SetMaxInFlightBatches(const size_t maxInFlightBatches);
+
+		// Limits the size of each request to the specified number of bytes before compression. Defaults to 1 MB.
+		// Smaller limits are learned from the backend refusing requests as too large.
+		void SetMaxPayloadBytes(const size_t maxPayloadBytes);
+
+		void SetMaxPendingEvents(const size_t maxPendingEvents);
+		void SetMaxStoreBytes(const uint64_t maxStoreBytes);
+
+		// Sets how long it may take to get the response to a batch of stored events, in milliseconds. Defaults to 2000.
+		// Batches are sized to the network within that time: they grow while answered faster, and shrink when answered slower, timing out or failing.
+		// The time is measured per request, from sending the batch. Events wait for the flush interval, and for earlier batches if the window
+		// of in-flight batches is full, before that. Waiting for earlier batches doesn't shrink batches, which would only slow down sending a backlog.
+		void SetMaxUploadLatency(const int maxUploadLatency);
+
+		// Limits the memory used for queued events and request bodies to the specified number of bytes. 0 removes the limit, which is the default.
+		// As the budget fills up, design events are dropped first, then resource and error events, while business, progression and session events
+		// are kept until it is used up. Repeated error messages are counted instead of sent then, even without repeated error interval.
+		// Allocator overhead isn't accounted for, so some headroom should be left. Should be at least a few times the maximum batch size.
+		void SetMemoryBudget(const size_t memoryBudget);
+
+		// Enables measuring latencies of queueing, serializing, signing, compressing and uploading events. Counters are always kept.
+		// Queueing is measured for every 64th event of each thread only, which costs less than a nanosecond per event on average.
+		void SetMetricsEnabled(const bool metricsEnabled);
+
+		// Writes the metrics to the specified file as JSON object with the first update after each interval in seconds.
+		// An empty path stops writing them.
+		void SetMetricsFile(const std::filesystem::path & metricsPath, const int metricsInterval);
+
+		// Sends at most the specified number of events of the specified category per second on average, and at most burst events at once.
+		// Events beyond the limit are dropped. Error events are limited to 10 per second and bursts of 100 by default. A rate of 0 removes the limit.
+		// Throws std::invalid_argument for session end and user events.
+		void SetRateLimit(const EventCategory::EventCategory category, const double eventsPerSecond, const int burst);
+
+		// Sends at most the specified number of events with the same event id per second on average, and at most burst events at once.
+		// Applies to business, design, progression and resource events, after aggregation, and separately per progression status and resource flow type.
+		// A rate of 0 removes the limit, which is the default.
+		void SetEventIdRateLimit(const double eventsPerSecond, const int burst);
+
+		// Counts repetitions of the same error message and severity within the specified interval in seconds, instead of sending each of them.
+		// Repetitions are sent as a single error event per interval, with " (repeated <count> times)" appended to the message. Defaults to 60; 0 sends all of them.
+		void SetRepeatedErrorInterval(const int repeatedErrorInterval);
+
+		// Sends events of the specified category for the specified share of users only, between 0 and 1.
+		// Users are sampled by user id, so the same user is either always sampled or never, across sessions.
+		// Throws std::invalid_argument for session end and user events.
+		void SetSamplingRate(const EventCategory::EventCategory category, const double samplingRate);
+		void SetUserId(const std::string_view & userId);
+
+	private:
+		std::string gameKey;
+		std::string secretKey;
+
+		// Signs request bodies. Prepared once, and copied for each request.
+		HmacSha256 signer;
+
+		Environment environment;
+
+		std::atomic<bool> initialized;
+		ServerClock serverClock;
+
+		// Local time of initialization, in milliseconds.
+		std::atomic<int64_t> initializationTime;
+
+		// Callback of the pending initialization. Invoked by whoever clears initPending first, the response or the timeout.
+		InitCallback initCallback;
+		std::atomic<bool> initPending;
+		std::atomic<int> initTimeout;
+
+		// Whether the backend has enabled sending events in the previous session.
+		std::atomic<bool> enabledBefore;
+
+		// Memory used by queued events and request bodies.
+		MemoryBudget memoryBudget;
+
+		EventQueue eventQueue;
+		std::atomic<int64_t> lastFlushTime;
+		std::atomic<bool> flushRequested;
+
+		// Set by the game, and read by whichever thread does the work.
+		std::atomic<int> flushInterval;
+		std::atomic<size_t> compressionThreshold;
+
+		// Event ids registered for sending events by handle.
+		EventIdRegistry eventIds;
+
+		// Progressions players have started, apart from the event ids registered by the game, so they never use up its handles.
+		EventIdRegistry progressions;
+
+		// Statistics of events aggregated instead of being sent one by one.
+		EventAggregator aggregator;
+
+		// Sampling and rate limits deciding which events to drop.
+		EventLimiter limiter;
+
+		// Events taken from the queue to be serialized and stored. Reused for every flush.
+		JsonWriter flushWriter;
+		EventBatch flushBatch;
+		std::mutex flushMutex;
+
+		// Whether a flush has been started but not completed yet, e.g. by Pump running out of time, and the events it is serializing, if any.
+		// Annotations older than the flush generation are no longer referred to by events queued after the flush has started.
+		std::atomic<bool> flushing;
+		EventRing * flushEvents;
+		uint16_t flushGeneration;
+		int64_t flushTime;
+
+		std::unique_ptr<EventStore> eventStore;
+
+		// Stored events being sent to the backend, in batches sized to the network.
+		UploadScheduler uploads;
+		BatchSizer batchSizer;
+		std::atomic<bool> sending;
+		std::atomic<bool> sendAgain;
+
+		// Request of the batch being built by the thread sending, if Pump has run out of time, and the memory reserved for it.
+		std::unique_ptr<RequestBuilder> upload;
+		uint64_t uploadBatchId;
+		size_t uploadReservedBytes;
+
+		// Average time for reading stored events, in nanoseconds per byte, for reading no more than fits into the time left for a slice of work.
+		double readNanosecondsPerByte;
+
+		// Whether work is done by Pump or the worker thread only, rather than whenever required.
+		std::atomic<bool> pumped;
+
+		// Thread doing the work instead of Update or Pump, if started.
+		std::unique_ptr<Worker> worker;
+		std::mutex workerMutex;
+
+		// Counters and latencies of the pipeline itself. Latencies are measured only if enabled.
+		std::atomic<bool> metricsEnabled;
+		std::atomic<uint64_t> storedEvents;
+		std::atomic<uint64_t> unstoredEvents;
+		std::atomic<uint64_t> requests;
+		std::atomic<uint64_t> failedRequests;
+		std::atomic<uint64_t> sentBytes;
+		std::atomic<uint64_t> uncompressedBytes;
+		std::atomic<uint64_t> invalidEvents;
+		LatencyHistogram enqueueLatency;
+		LatencyHistogram serializeLatency;
+		LatencyHistogram signLatency;
+		LatencyHistogram compressLatency;
+		LatencyHistogram uploadLatency;
+
+		// File to write the metrics to periodically, if any.
+		std::filesystem::path metricsPath;
+		int64_t metricsInterval;
+		int64_t lastMetricsTime;
+		std::mutex metricsMutex;
+
+		std::string build;
+		std::string sessionId;
+		int sessionNumber;
+		PersistentCounter transactionCounter;
+		std::string userId;
+
+		// Handle of the current progression in the progression registry, or EventIdRegistry::None.
+		std::atomic<uint16_t> progression;
+
+		int birthYear;
+		std::string facebookId;
+		Gender::Gender gender;
+		std::string googlePlusId;
+
+		std::string deviceModel;
+		std::string manufacturer;
+		std::string osVersion;
+		std::string platform;
+
+		// Single generation of session annotations, as JSON object members.
+		struct Annotations
+		{
+			// Members shared by all players, e.g. device and build.
+			std::string shared;
+
+			// Members of the local user, e.g. user and session id.
+			std::string user;
+		};
+
+		// Session annotations added to every event.
+		// Queued events refer to the annotations current when they were sent by generation, the last one being the current one.
+		std::deque<Annotations> annotations;
+		std::atomic<uint16_t> annotationsGeneration;
+		std::atomic<size_t> annotationsSize;
+		std::mutex annotationsMutex;
+
+		// Sessions on behalf of other players. Guarded by the annotations mutex, except for looking up players.
+		PlayerRegistry players;
+
+		// Builds the event record for business analytics events. The event id has to be set by the caller.
+		EventRecord BuildBusinessEventRecord(const std::string_view & currency, const int amount);
+
+		// Builds an event record with the specified category, timestamp, current progression and session annotations.
+		EventRecord BuildEventRecord(const EventCategory::EventCategory category) const;
+
+		// Builds the event record for progression analytics events. The event id has to be set by the caller.
+		EventRecord BuildProgressionEventRecord(const ProgressionStatus::ProgressionStatus status) const;
+
+		// Builds a signed and, if worth it, compressed request for the specified route of the backend.
+		TransportRequest BuildRequest(const std::string & route, const std::string & body);
+
+		// Passes the specified result to the callback of the pending initialization, unless it has been passed a result already.
+		// Starts flushing events, including those buffered before, if sending events has been enabled.
+		void CompleteInit(const InitResult & result);
+
+		// Continues the flush started before, or starts a new one: serializes the queued events of all threads and stores them on disk,
+		// until the specified local time in nanoseconds has passed. Returns true if the flush has completed. Caller has to hold the flush mutex.
+		// Waits for the disk only if syncing, which may take milliseconds.
+		bool ContinueFlush(const int64_t deadline, const bool sync);
+
+		// Counts the specified completed request in the metrics.
+		void CountRequest(RequestBuilder & builder);
+
+		// Does the work of Update until the specified local time in nanoseconds has passed, syncing stored events to disk if specified.
+		// Returns true if all work due has been done.
+		bool DoWork(const int64_t deadline, const bool sync);
+
+		// Drops the specified event if sampled out or rate limited. Otherwise, adds it to its aggregate, if configured, or to the event queue.
+		void EnqueueEvent(const EventRecord & record);
+
+		// Queues summary events of all aggregates, if the aggregation interval has passed or if forced.
+		void EmitAggregates(const bool force);
+
+		// Queues error events counting repeated error messages, if their interval has passed or if forced.
+		void EmitRepeatedErrors(const bool force);
+
+		// Adds the specified event to the event queue without blocking. Requests a flush with the next update if the queue is full.
+		void QueueEvent(const EventRecord & record);
+
+		// Generates a new GUID for the current session.
+		std::string GenerateSessionId() const;
+
+		// Gets the handle of the player the calling thread sends events for, or PlayerRegistry::None for the local user.
+		uint32_t GetCurrentPlayer() const;
+
+		// Gets the number of the next transaction.
+		int GetNextTransactionNumber();
+
+		// Gets the handle of the current progression of the current player in the progression registry, or EventIdRegistry::None.
+		uint16_t GetProgression() const;
+
+		// Gets the version of this GameAnalytics SDK.
+		std::string GetSDKVersion() const;
+
+		// Get the elapsed time since initialization, in seconds.
+		int64_t GetTimeSinceInit() const;
+
+		// Gets the local time for new event records, in milliseconds. Converted to server time when serializing events.
+		int64_t GetTimestamp() const;
+
+		// Verifies the init response of the backend to the request sent at the specified local time, and remembers whether sending events is enabled.
+		void OnInitResponse(const TransportResponse & response, const int64_t requestTime);
+
+		// Completes the specified batch of stored events of the specified size, sent at the specified local time in nanoseconds, and continues with the next one.
+		void OnEventsResponse(const TransportResponse & response, const int64_t requestNanoseconds, const uint64_t batchId, const size_t batchBytes);
+
+		// Sends stored events to the GameAnalytics backend in batches, until the window of in-flight batches is full
+		// or all have been sent. Failed batches are sent again first, unless still backing off.
+		// Stops building requests when the specified local time in nanoseconds has passed, returning false.
+		bool SendStoredEvents(const int64_t deadline);
+
+		// Sends stored events right away, or with the next slice of work, waking the worker thread, if any.
+		void SendStoredEventsSoon();
+
+		// Gets the handle of the specified progression in the progression registry, registering it if required.
+		// Returns EventIdRegistry::None if the progression registry is full.
+		uint16_t RegisterProgression(const std::string_view & eventId);
+
+		// Sets the handle of the current progression of the current player in the progression registry.
+		void SetProgression(const uint16_t progression);
+
+		// Counts the event as invalid if it's not valid, returning whether it is.
+		bool CheckEvent(const bool valid);
+
+		// Checks whether the registered event id is valid for the specified category.
+		// Throws std::invalid_argument if the id has not been registered.
+		bool IsValidEventId(const EventCategory::EventCategory category, const EventId & eventId) const;
+
+		// Sets the event id of the specified record, using the registered id if available.
+		void SetEventId(EventRecord & record, const std::string_view & eventId) const;
+
+		// Sets the event id with the specified hash, as computed by HashString, of the specified record, using the registered id if available.
+		void SetEventId(EventRecord & record, const std::string_view & eventId, const uint32_t hash) const;
+
+		// Sets the registered event id of the specified record.
+		// Throws std::invalid_argument if the id has not been registered.
+		void SetEventId(EventRecord & record, const EventId & eventId) const;
+
+		// Rebuilds the session annotations added to every event, e.g. after the user or build has changed.
+		// Caller has to hold the annotations mutex.
+		void UpdateAnnotations();
+
+		// Rebuilds the annotations added to every event of the specified player. Caller has to hold the annotations mutex.
+		void UpdatePlayerAnnotations(Player & player) const;
+
+		// Wakes the worker thread, if any, because work is due.
+		void WakeWorker();
+
+		// Serializes the specified event, adding the session annotations it refers to.
+		// Caller has to hold the annotations mutex.
+		void WriteEvent(JsonWriter & writer, const EventRecord & record) const;
+
+		// Writes the event id of the specified record, with the specified prefix and a colon if not null.
+		void WriteEventId(JsonWriter & writer, const char * prefix, const EventRecord & record) const;
+	};
+
+	// Attributes events sent and user data set by the calling thread to the specified player of the specified core, while in scope.
+	// Scopes can be nested. An invalid context attributes them to the local user again.
+	class PlayerScope
+	{
+	public:
+		PlayerScope(const GameAnalyticsCore & core, const PlayerContext & player);
+		~PlayerScope();
+
+		PlayerScope(const PlayerScope &) = delete;
+		PlayerScope & operator=(const PlayerScope &) = delete;
+
+	private:
+		const GameAnalyticsCore * previousCore;
+		uint32_t previousPlayer;
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace GameAnalytics
+{
+	namespace Crc32
+	{
+		// Gets the lookup table for the CRC-32 polynomial used by zlib and gzip.
+		inline const uint32_t * GetTable()
+		{
+			struct Table
+			{
+				uint32_t entries[256];
+
+				Table()
+				{
+					for (uint32_t i = 0; i < 256; ++i)
+					{
+						auto c = i;
+
+						for (auto k = 0; k < 8; ++k)
+						{
+							c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+						}
+
+						this->entries[i] = c;
+					}
+				}
+			};
+
+			static const Table table;
+			return table.entries;
+		}
+
+		// Continues the specified CRC-32 checksum with the passed data.
+		// Pass 0 as checksum to start a new computation.
+		inline uint32_t Update(uint32_t crc, const void * data, const size_t length)
+		{
+			auto table = GetTable();
+			auto bytes = static_cast<const uint8_t *>(data);
+
+			crc = ~crc;
+
+			for (size_t i = 0; i < length; ++i)
+			{
+				crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+			}
+
+			return ~crc;
+		}
+	}
+}
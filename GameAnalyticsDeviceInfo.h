@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+
+namespace GameAnalytics
+{
+	// Provides information about the device and app, as added to every event. All strings are UTF-8 encoded.
+	class DeviceInfo
+	{
+	public:
+		virtual ~DeviceInfo() {}
+
+		// Gets the version of the app, used as default build id.
+		virtual std::string GetAppVersion() const = 0;
+
+		// Gets the model of the device this app runs on.
+		virtual std::string GetDeviceModel() const = 0;
+
+		// Gets a unique id of the device this app runs on, used as default user id.
+		virtual std::string GetHardwareId() const = 0;
+
+		// Gets the manufacturer of the device this app runs on.
+		virtual std::string GetManufacturer() const = 0;
+
+		// Gets the version of the operating system this app runs on, e.g. "windows 10".
+		virtual std::string GetOSVersion() const = 0;
+
+		// Gets the platform this app runs on, e.g. "windows".
+		virtual std::string GetPlatform() const = 0;
+	};
+}
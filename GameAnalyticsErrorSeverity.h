@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
 
 namespace GameAnalytics
@@ -15,6 +16,32 @@ namespace GameAnalytics
 			Debug
 		};
 
+		// Gets the name of the specified severity, as expected by the GameAnalytics backend.
+		inline const char * ToString(const Severity severity)
+		{
+			switch (severity)
+			{
+			case Critical:
+				return "critical";
+
+			case Error:
+				return "error";
+
+			case Warning:
+				return "warning";
+
+			case Info:
+				return "info";
+
+			case Debug:
+				return "debug";
+			}
+
+			// Unknown severity value.
+			throw std::invalid_argument("Unknown severity: " + std::to_string(severity));
+		}
+
+#ifdef __cplusplus_winrt
 		inline std::wstring ToWString(const Severity severity)
 		{
 			switch (severity)
@@ -40,5 +67,6 @@ namespace GameAnalytics
 			auto messageString = ref new Platform::String(message.c_str());
 			throw ref new Platform::FailureException(messageString);
 		}
+#endif
 	}
 }
\ No newline at end of file
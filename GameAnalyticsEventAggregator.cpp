@@ -0,0 +1,156 @@
+#include "pch.h"
+
+#include "GameAnalyticsEventAggregator.h"
+#include "GameAnalyticsHash.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Gets the buffer for building aggregate keys on the calling thread, so looking up aggregates doesn't allocate memory.
+	std::string & GetKeyBuffer()
+	{
+		thread_local std::string buffer;
+		buffer.clear();
+		return buffer;
+	}
+}
+
+
+EventAggregate::EventAggregate()
+	: count(0),
+	hasValue(false),
+	sum(0),
+	min(0),
+	max(0)
+{
+}
+
+EventAggregator::EventAggregator()
+	: prefixCount(0),
+	windowStart(0),
+	window(60 * 1000)
+{
+}
+
+void EventAggregator::AddPrefix(const std::string_view & prefix)
+{
+	std::lock_guard<std::mutex> lock(this->prefixMutex);
+
+	auto count = this->prefixCount.load();
+
+	if (std::find(this->prefixes, this->prefixes + count, prefix) != this->prefixes + count)
+	{
+		return;
+	}
+
+	if (count >= MaxPrefixes)
+	{
+		throw std::length_error("Too many aggregated event id prefixes.");
+	}
+
+	// Publish prefix after it has been written.
+	this->prefixes[count] = prefix;
+	this->prefixCount.store(count + 1, std::memory_order_release);
+}
+
+bool EventAggregator::TryAdd(const EventCategory::EventCategory category, const uint8_t subtype, const std::string_view & eventId, const double value, const bool hasValue)
+{
+	if (category != EventCategory::Design && category != EventCategory::Resource)
+	{
+		return false;
+	}
+
+	// Check prefixes.
+	auto count = this->prefixCount.load(std::memory_order_acquire);
+
+	if (count == 0)
+	{
+		return false;
+	}
+
+	auto matches = false;
+
+	for (size_t i = 0; i < count && !matches; ++i)
+	{
+		auto & prefix = this->prefixes[i];
+		matches = eventId.size() >= prefix.size() && eventId.compare(0, prefix.size(), prefix) == 0;
+	}
+
+	if (!matches)
+	{
+		return false;
+	}
+
+	// Find aggregate.
+	auto & key = GetKeyBuffer();
+	key.push_back(static_cast<char>(category));
+	key.push_back(static_cast<char>(subtype));
+	key.append(eventId);
+
+	auto & stripe = this->stripes[HashString(key) % StripeCount];
+	std::lock_guard<std::mutex> lock(stripe.mutex);
+
+	auto & aggregate = stripe.aggregates[key];
+
+	// Update statistics.
+	if (hasValue)
+	{
+		if (!aggregate.hasValue)
+		{
+			aggregate.min = value;
+			aggregate.max = value;
+			aggregate.hasValue = true;
+		}
+
+		aggregate.sum += value;
+		aggregate.min = std::min(aggregate.min, value);
+		aggregate.max = std::max(aggregate.max, value);
+		aggregate.quantiles.Add(value);
+	}
+
+	++aggregate.count;
+	return true;
+}
+
+bool EventAggregator::IsWindowElapsed(const int64_t now) const
+{
+	return now - this->windowStart >= this->window;
+}
+
+void EventAggregator::TakeAggregates(const int64_t now, const std::function<void(EventCategory::EventCategory category, uint8_t subtype, const std::string & eventId, const EventAggregate & aggregate)> & consume)
+{
+	this->windowStart = now;
+
+	std::unordered_map<std::string, EventAggregate> aggregates;
+
+	for (auto & stripe : this->stripes)
+	{
+		{
+			std::lock_guard<std::mutex> lock(stripe.mutex);
+
+			if (stripe.aggregates.empty())
+			{
+				continue;
+			}
+
+			aggregates.swap(stripe.aggregates);
+		}
+
+		for (auto & entry : aggregates)
+		{
+			auto & key = entry.first;
+			consume(static_cast<EventCategory::EventCategory>(key[0]), static_cast<uint8_t>(key[1]), key.substr(2), entry.second);
+		}
+
+		aggregates.clear();
+	}
+}
+
+void EventAggregator::SetWindow(const int64_t window)
+{
+	this->window = window;
+}
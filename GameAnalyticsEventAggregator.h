@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "GameAnalyticsEventCategory.h"
+#include "GameAnalyticsQuantileSketch.h"
+
+namespace GameAnalytics
+{
+	// Statistics of all values of an aggregated event id within a single window.
+	struct EventAggregate
+	{
+		EventAggregate();
+
+		uint64_t count;
+
+		// Whether any of the events had a value. Events without value are only counted.
+		bool hasValue;
+
+		double sum;
+		double min;
+		double max;
+
+		QuantileSketch quantiles;
+	};
+
+	// Collects design and resource events with configured event id prefixes, instead of sending each of them.
+	// Keeps count, sum, min, max and quantiles of the values of each event id and flow type, to be sent as few summary events per window.
+	// Events can be added by any number of threads at the same time. Event ids are spread over independently locked stripes.
+	class EventAggregator
+	{
+	public:
+		// Maximum number of prefixes to aggregate events for.
+		static const size_t MaxPrefixes = 64;
+
+		EventAggregator();
+
+		// Aggregates all design and resource events whose id starts with the specified prefix. Can't be undone.
+		// For resource events, the id doesn't include the flow type, e.g. "Gold:Coin".
+		// Throws std::length_error if more than MaxPrefixes prefixes have been added.
+		void AddPrefix(const std::string_view & prefix);
+
+		// Adds the specified event to its aggregate, if its id has one of the configured prefixes.
+		// Returns false if the event should be sent as it is.
+		bool TryAdd(const EventCategory::EventCategory category, const uint8_t subtype, const std::string_view & eventId, const double value, const bool hasValue);
+
+		// Checks whether the aggregation window has passed at the specified time in milliseconds.
+		bool IsWindowElapsed(const int64_t now) const;
+
+		// Removes all aggregates, passing each to the specified function, and starts a new window at the specified time in milliseconds.
+		void TakeAggregates(const int64_t now, const std::function<void(EventCategory::EventCategory category, uint8_t subtype, const std::string & eventId, const EventAggregate & aggregate)> & consume);
+
+		// Sets the length of each aggregation window, in milliseconds.
+		void SetWindow(const int64_t window);
+
+	private:
+		// Aggregates by category, subtype and event id.
+		struct Stripe
+		{
+			std::mutex mutex;
+			std::unordered_map<std::string, EventAggregate> aggregates;
+		};
+
+		static const size_t StripeCount = 16;
+
+		// Prefixes are never removed, so they can be checked without locking.
+		std::string prefixes[MaxPrefixes];
+		std::atomic<size_t> prefixCount;
+		std::mutex prefixMutex;
+
+		Stripe stripes[StripeCount];
+
+		std::atomic<int64_t> windowStart;
+		std::atomic<int64_t> window;
+	};
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace GameAnalytics
+{
+	// UTF-8 encoded JSON events, stored back to back in a single buffer.
+	class EventBatch
+	{
+	public:
+		// Adds the specified serialized event to this batch.
+		void Add(const char * event, const size_t length)
+		{
+			this->data.append(event, length);
+			this->ends.push_back(this->data.size());
+		}
+
+		// Removes all events from this batch. Keeps the allocated buffers.
+		void Clear()
+		{
+			this->data.clear();
+			this->ends.clear();
+		}
+
+		// Gets the number of events in this batch.
+		size_t GetCount() const
+		{
+			return this->ends.size();
+		}
+
+		// Gets the total size of all events in this batch, in bytes.
+		size_t GetSize() const
+		{
+			return this->data.size();
+		}
+
+		// Gets the serialized event with the specified index.
+		const char * GetEvent(const size_t index, size_t & length) const
+		{
+			auto begin = index > 0 ? this->ends[index - 1] : 0;
+			length = this->ends[index] - begin;
+			return this->data.data() + begin;
+		}
+
+		bool IsEmpty() const
+		{
+			return this->ends.empty();
+		}
+
+		void Swap(EventBatch & other)
+		{
+			this->data.swap(other.data);
+			this->ends.swap(other.ends);
+		}
+
+	private:
+		std::string data;
+		std::vector<size_t> ends;
+	};
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace GameAnalytics
+{
+	namespace EventCategory
+	{
+		enum EventCategory : uint8_t
+		{
+			Business,
+			Design,
+			Error,
+			Progression,
+			Resource,
+			SessionEnd,
+			User
+		};
+
+		// Gets the name of the specified category, as expected by the GameAnalytics backend.
+		inline const char * ToString(const EventCategory category)
+		{
+			switch (category)
+			{
+			case Business:
+				return "business";
+
+			case Design:
+				return "design";
+
+			case Error:
+				return "error";
+
+			case Progression:
+				return "progression";
+
+			case Resource:
+				return "resource";
+
+			case SessionEnd:
+				return "session_end";
+
+			case User:
+				return "user";
+			}
+
+			// Unknown category value.
+			throw std::invalid_argument("Unknown event category: " + std::to_string(category));
+		}
+	}
+}
@@ -0,0 +1,140 @@
+#include "pch.h"
+
+#include "GameAnalyticsEventIdRegistry.h"
+#include "GameAnalyticsEventSchema.h"
+#include "GameAnalyticsHash.h"
+#include "GameAnalyticsJsonWriter.h"
+
+#include <stdexcept>
+
+using namespace GameAnalytics;
+
+
+EventIdRegistry::EventIdRegistry(const size_t capacity)
+	: entries(new Entry[capacity]),
+	capacity(capacity),
+	count(0),
+	mask(0)
+{
+	if (capacity >= None)
+	{
+		throw std::invalid_argument("Event id registry capacity must be less than 65535.");
+	}
+
+	// Keep load factor at or below one half.
+	size_t slotCount = 1;
+
+	while (slotCount < capacity * 2)
+	{
+		slotCount <<= 1;
+	}
+
+	this->slots.reset(new std::atomic<uint16_t>[slotCount]);
+	this->mask = slotCount - 1;
+
+	for (size_t i = 0; i < slotCount; ++i)
+	{
+		this->slots[i].store(None, std::memory_order_relaxed);
+	}
+}
+
+EventId EventIdRegistry::Register(const std::string_view & eventId)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	// Check if already registered.
+	auto slot = HashString(eventId) & this->mask;
+
+	while (true)
+	{
+		auto handle = this->slots[slot].load(std::memory_order_acquire);
+
+		if (handle == None)
+		{
+			break;
+		}
+
+		if (this->entries[handle].value == eventId)
+		{
+			return EventId(handle);
+		}
+
+		slot = (slot + 1) & this->mask;
+	}
+
+	auto handle = this->count.load(std::memory_order_relaxed);
+
+	if (handle >= this->capacity)
+	{
+		throw std::length_error("Too many event ids registered.");
+	}
+
+	// Escape id once.
+	JsonWriter writer;
+	writer.WriteString(eventId);
+
+	auto & escaped = writer.GetString();
+
+	auto & entry = this->entries[handle];
+	entry.value.assign(eventId.data(), eventId.size());
+	entry.escaped.assign(escaped, 1, escaped.size() - 2);
+	entry.validCategories = EventSchema::GetValidCategories(eventId);
+
+	// Publish entry.
+	this->slots[slot].store(static_cast<uint16_t>(handle), std::memory_order_release);
+	this->count.store(handle + 1, std::memory_order_release);
+
+	return EventId(static_cast<uint16_t>(handle));
+}
+
+uint16_t EventIdRegistry::Find(const std::string_view & eventId) const
+{
+	return this->Find(eventId, HashString(eventId));
+}
+
+uint16_t EventIdRegistry::Find(const std::string_view & eventId, const uint32_t hash) const
+{
+	auto slot = hash & this->mask;
+
+	while (true)
+	{
+		auto handle = this->slots[slot].load(std::memory_order_acquire);
+
+		if (handle == None || this->entries[handle].value == eventId)
+		{
+			return handle;
+		}
+
+		slot = (slot + 1) & this->mask;
+	}
+}
+
+const std::string & EventIdRegistry::Get(const uint16_t handle) const
+{
+	return this->GetEntry(handle).value;
+}
+
+const std::string & EventIdRegistry::GetEscaped(const uint16_t handle) const
+{
+	return this->GetEntry(handle).escaped;
+}
+
+uint32_t EventIdRegistry::GetValidCategories(const uint16_t handle) const
+{
+	return this->GetEntry(handle).validCategories;
+}
+
+size_t EventIdRegistry::GetCount() const
+{
+	return this->count.load(std::memory_order_acquire);
+}
+
+const EventIdRegistry::Entry & EventIdRegistry::GetEntry(const uint16_t handle) const
+{
+	if (handle >= this->count.load(std::memory_order_acquire))
+	{
+		throw std::invalid_argument("Unknown event id handle: " + std::to_string(handle));
+	}
+
+	return this->entries[handle];
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace GameAnalytics
+{
+	// Handle of a registered event id, for sending events without copying, hashing or escaping the id again.
+	struct EventId
+	{
+		EventId()
+			: handle(0xFFFF)
+		{
+		}
+
+		explicit EventId(const uint16_t handle)
+			: handle(handle)
+		{
+		}
+
+		bool IsValid() const
+		{
+			return this->handle != 0xFFFF;
+		}
+
+		uint16_t handle;
+	};
+
+	// Maps event ids that are sent over and over, like "PickedUpAmmo:Shotgun", to stable small integer handles.
+	// Keeps both the UTF-8 encoded and the JSON-escaped id, so events can be serialized by just copying the escaped bytes.
+	// Registered ids are never removed. Looking up ids doesn't lock, and can be done from any thread.
+	class EventIdRegistry
+	{
+	public:
+		// Handle returned if an id is not registered.
+		static constexpr uint16_t None = 0xFFFF;
+
+		// Creates a registry with room for the specified number of event ids, which must be less than 65535.
+		explicit EventIdRegistry(const size_t capacity);
+
+		// Registers the specified event id, returning the same handle for equal ids.
+		// Throws std::length_error if the registry is full.
+		EventId Register(const std::string_view & eventId);
+
+		// Gets the handle of the specified event id, or None if not registered.
+		uint16_t Find(const std::string_view & eventId) const;
+
+		// Gets the handle of the specified event id with the specified hash, as computed by HashString, or None if not registered.
+		uint16_t Find(const std::string_view & eventId, const uint32_t hash) const;
+
+		// Gets the event id with the specified handle.
+		// Throws std::invalid_argument if the handle is invalid.
+		const std::string & Get(const uint16_t handle) const;
+
+		// Gets the JSON-escaped event id with the specified handle, without quotes.
+		const std::string & GetEscaped(const uint16_t handle) const;
+
+		// Gets the categories the event id with the specified handle is valid for, as bitmask of EventSchema::GetValidCategories.
+		// Throws std::invalid_argument if the handle is invalid.
+		uint32_t GetValidCategories(const uint16_t handle) const;
+
+		// Gets the number of event ids registered.
+		size_t GetCount() const;
+
+	private:
+		struct Entry
+		{
+			std::string value;
+			std::string escaped;
+			uint32_t validCategories;
+		};
+
+		// Entries are never moved, so they can be read without locking once their handle has been published.
+		std::unique_ptr<Entry[]> entries;
+		size_t capacity;
+		std::atomic<size_t> count;
+
+		// Open addressing hash table of handles, with None marking empty slots.
+		std::unique_ptr<std::atomic<uint16_t>[]> slots;
+		size_t mask;
+
+		// Serializes registrations.
+		std::mutex mutex;
+
+		// Checks the specified handle, throwing std::invalid_argument if it's invalid.
+		const Entry & GetEntry(const uint16_t handle) const;
+	};
+}
@@ -0,0 +1,333 @@
+#include "pch.h"
+
+#include "GameAnalyticsEventLimiter.h"
+#include "GameAnalyticsHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Share of users that are always sampled, scaled to 2^32.
+	const uint64_t AllUsers = 1ull << 32;
+
+	// Interval for counting repetitions of error messages, in milliseconds.
+	const int64_t DefaultRepeatedErrorInterval = 60 * 1000;
+
+	// Spreads the bits of the specified hash, so that similar user ids fall into different shares of users.
+	uint32_t MixHash(uint32_t hash)
+	{
+		hash ^= hash >> 16;
+		hash *= 0x85ebca6bu;
+		hash ^= hash >> 13;
+		hash *= 0xc2b2ae35u;
+		hash ^= hash >> 16;
+		return hash;
+	}
+
+	// Gets the buffer for building repeated error keys on the calling thread, so looking up repetitions doesn't allocate memory.
+	std::string & GetKeyBuffer()
+	{
+		thread_local std::string buffer;
+		buffer.clear();
+		return buffer;
+	}
+}
+
+
+EventLimiter::RateLimit::RateLimit()
+	: theoreticalArrival(0),
+	interval(0),
+	tolerance(0)
+{
+}
+
+EventLimiter::EventLimiter()
+	: userHash(0),
+	eventIdLimited(false),
+	repeatedErrorInterval(DefaultRepeatedErrorInterval)
+{
+	for (size_t i = 0; i < CategoryCount; ++i)
+	{
+		this->samplingThresholds[i] = AllUsers;
+		this->sampledOut[i] = false;
+		this->droppedEvents[i] = 0;
+	}
+
+	// Errors are the most likely to be raised every frame.
+	SetRateLimit(this->categoryLimits[EventCategory::Error], 10, 100);
+}
+
+void EventLimiter::SetUser(const std::string_view & userId)
+{
+	std::lock_guard<std::mutex> lock(this->samplingMutex);
+
+	this->userHash = HashUser(userId);
+
+	for (size_t i = 0; i < CategoryCount; ++i)
+	{
+		this->UpdateSampling(static_cast<EventCategory::EventCategory>(i));
+	}
+}
+
+void EventLimiter::SetSamplingRate(const EventCategory::EventCategory category, const double rate)
+{
+	VerifyCategory(category);
+
+	if (!(rate >= 0 && rate <= 1))
+	{
+		throw std::invalid_argument("Sampling rate must be between 0 and 1.");
+	}
+
+	std::lock_guard<std::mutex> lock(this->samplingMutex);
+
+	this->samplingThresholds[category] = static_cast<uint64_t>(std::ldexp(rate, 32));
+	this->UpdateSampling(category);
+}
+
+void EventLimiter::SetRateLimit(const EventCategory::EventCategory category, const double eventsPerSecond, const int burst)
+{
+	VerifyCategory(category);
+	SetRateLimit(this->categoryLimits[category], eventsPerSecond, burst);
+}
+
+void EventLimiter::SetEventIdRateLimit(const double eventsPerSecond, const int burst)
+{
+	for (auto & limit : this->eventIdLimits)
+	{
+		SetRateLimit(limit, eventsPerSecond, burst);
+	}
+
+	this->eventIdLimited = eventsPerSecond > 0;
+}
+
+void EventLimiter::SetRepeatedErrorInterval(const int64_t interval)
+{
+	this->repeatedErrorInterval = interval;
+}
+
+bool EventLimiter::IsSampled(const EventCategory::EventCategory category)
+{
+	if (this->sampledOut[category].load(std::memory_order_relaxed))
+	{
+		this->droppedEvents[category].fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+bool EventLimiter::IsSampled(const EventCategory::EventCategory category, const uint32_t userHash)
+{
+	if (userHash >= this->samplingThresholds[category].load(std::memory_order_relaxed))
+	{
+		this->droppedEvents[category].fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+uint32_t EventLimiter::HashUser(const std::string_view & userId)
+{
+	return MixHash(HashString(userId));
+}
+
+bool EventLimiter::TryAcquire(const EventCategory::EventCategory category, const uint8_t subtype, const std::string_view & eventId, const int64_t now)
+{
+	auto microseconds = now * 1000;
+	RateLimit * eventIdLimit = nullptr;
+
+	// Check event id first, so that a single flooding id doesn't use up the limit of its whole category.
+	if (this->eventIdLimited.load(std::memory_order_relaxed) && !eventId.empty())
+	{
+		eventIdLimit = &this->eventIdLimits[MixHash(HashString(eventId) + subtype) % EventIdLimitCount];
+
+		if (!TryAcquire(*eventIdLimit, microseconds))
+		{
+			this->droppedEvents[category].fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+	}
+
+	if (!TryAcquire(this->categoryLimits[category], microseconds))
+	{
+		// Dropped events don't count against their id.
+		if (eventIdLimit != nullptr)
+		{
+			Release(*eventIdLimit);
+		}
+
+		this->droppedEvents[category].fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+bool EventLimiter::TryAcquireError(const Severity::Severity severity, const std::string_view & message, const int64_t now, const bool deduplicate)
+{
+	// Count repetitions of messages sent within the interval.
+	auto interval = this->repeatedErrorInterval.load(std::memory_order_relaxed);
+
+	if (interval == 0 && deduplicate)
+	{
+		interval = DefaultRepeatedErrorInterval;
+	}
+
+	if (interval > 0)
+	{
+		auto & key = GetKeyBuffer();
+		key.push_back(static_cast<char>(severity));
+		key.append(message);
+
+		std::lock_guard<std::mutex> lock(this->repeatedErrorsMutex);
+
+		auto it = this->repeatedErrors.find(key);
+
+		if (it != this->repeatedErrors.end())
+		{
+			auto & repeated = it->second;
+
+			// Keep counting until the repetitions have been taken, even if the interval has passed in the meantime.
+			if (repeated.repetitions > 0 || now - repeated.intervalStart < interval)
+			{
+				++repeated.repetitions;
+				return false;
+			}
+
+			repeated.intervalStart = now;
+		}
+		else if (this->repeatedErrors.size() < MaxRepeatedErrors)
+		{
+			this->repeatedErrors.emplace(key, RepeatedError { now, 0 });
+		}
+	}
+
+	// Rate limit distinct messages.
+	if (!TryAcquire(this->categoryLimits[EventCategory::Error], now * 1000))
+	{
+		this->droppedEvents[EventCategory::Error].fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+void EventLimiter::TakeRepeatedErrors(const int64_t now, const bool force, const std::function<void(Severity::Severity severity, const std::string & message, uint64_t repetitions)> & consume)
+{
+	std::unordered_map<std::string, RepeatedError> passed;
+
+	{
+		std::lock_guard<std::mutex> lock(this->repeatedErrorsMutex);
+
+		// Repetitions are counted without interval only if forced to deduplicate.
+		auto interval = this->repeatedErrorInterval.load();
+
+		if (interval == 0)
+		{
+			interval = DefaultRepeatedErrorInterval;
+		}
+
+		for (auto it = this->repeatedErrors.begin(); it != this->repeatedErrors.end();)
+		{
+			if (force || now - it->second.intervalStart >= interval)
+			{
+				if (it->second.repetitions > 0)
+				{
+					passed.emplace(it->first, it->second);
+				}
+
+				it = this->repeatedErrors.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	// Pass repetitions without holding the lock, so they can be sent as new error events.
+	for (auto & entry : passed)
+	{
+		auto & key = entry.first;
+		consume(static_cast<Severity::Severity>(key[0]), key.substr(1), entry.second.repetitions);
+	}
+}
+
+uint64_t EventLimiter::GetDroppedEvents(const EventCategory::EventCategory category) const
+{
+	return this->droppedEvents[category].load(std::memory_order_relaxed);
+}
+
+bool EventLimiter::TryAcquire(RateLimit & limit, const int64_t now)
+{
+	auto interval = limit.interval.load(std::memory_order_relaxed);
+
+	if (interval == 0)
+	{
+		return true;
+	}
+
+	auto tolerance = limit.tolerance.load(std::memory_order_relaxed);
+	auto arrival = limit.theoreticalArrival.load(std::memory_order_relaxed);
+
+	int64_t nextArrival;
+
+	do
+	{
+		// Bucket is empty if the theoretical arrival is too far ahead.
+		auto start = std::max(arrival, now);
+
+		if (start - now > tolerance)
+		{
+			return false;
+		}
+
+		nextArrival = start + interval;
+	}
+	while (!limit.theoreticalArrival.compare_exchange_weak(arrival, nextArrival, std::memory_order_relaxed));
+
+	return true;
+}
+
+void EventLimiter::Release(RateLimit & limit)
+{
+	// Times before now all mean a full bucket, so giving back a token can't exceed the burst.
+	limit.theoreticalArrival.fetch_sub(limit.interval.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void EventLimiter::SetRateLimit(RateLimit & limit, const double eventsPerSecond, const int burst)
+{
+	if (!(eventsPerSecond >= 0))
+	{
+		throw std::invalid_argument("Rate limit must not be negative.");
+	}
+
+	if (burst < 1)
+	{
+		throw std::invalid_argument("Rate limit burst must be at least 1.");
+	}
+
+	auto interval = eventsPerSecond > 0 ? std::max<int64_t>(static_cast<int64_t>(1000000 / eventsPerSecond), 1) : 0;
+
+	limit.tolerance = interval * (burst - 1);
+	limit.interval = interval;
+}
+
+void EventLimiter::VerifyCategory(const EventCategory::EventCategory category)
+{
+	// Session events are needed for every session to be counted.
+	if (category == EventCategory::SessionEnd || category == EventCategory::User || category >= CategoryCount)
+	{
+		throw std::invalid_argument(std::string("Events can't be limited for category: ") + EventCategory::ToString(category));
+	}
+}
+
+void EventLimiter::UpdateSampling(const EventCategory::EventCategory category)
+{
+	this->sampledOut[category] = this->userHash.load() >= this->samplingThresholds[category];
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "GameAnalyticsErrorSeverity.h"
+#include "GameAnalyticsEventCategory.h"
+
+namespace GameAnalytics
+{
+	// Decides which events to send at all, protecting the backend and the event store against floods, e.g. an error raised every frame.
+	// Samples a deterministic share of users per category, caps the rate of each category and of each event id,
+	// and counts repetitions of identical error messages instead of sending each of them.
+	// Checking unlimited categories costs a single atomic load. Rate limits take one compare-and-swap per event.
+	// Can be used by any number of threads at the same time.
+	class EventLimiter
+	{
+	public:
+		// Maximum number of distinct error messages whose repetitions are counted at the same time.
+		static const size_t MaxRepeatedErrors = 1024;
+
+		EventLimiter();
+
+		// Sets the user whose events are sampled. The same user is always either sampled or not, across sessions.
+		void SetUser(const std::string_view & userId);
+
+		// Sends the events of the specified share of users only, between 0 and 1.
+		// Throws std::invalid_argument for session events, and for rates outside that range.
+		void SetSamplingRate(const EventCategory::EventCategory category, const double rate);
+
+		// Sends at most the specified number of events of the specified category per second on average, and at most burst events at once.
+		// Error events are limited to 10 per second and bursts of 100 by default. A rate of 0 removes the limit. Throws std::invalid_argument for session events, and for negative rates or bursts below 1.
+		void SetRateLimit(const EventCategory::EventCategory category, const double eventsPerSecond, const int burst);
+
+		// Sends at most the specified number of events with the same event id and subtype per second on average, and at most burst events at once.
+		// Thus, starting and completing a progression, or sourcing and sinking a resource, are limited separately.
+		// Event ids are hashed to a fixed number of limits, so rarely, different ids share one. A rate of 0 removes the limit.
+		void SetEventIdRateLimit(const double eventsPerSecond, const int burst);
+
+		// Counts repetitions of the same error message within the specified interval in milliseconds, instead of sending them. 0 sends all of them. Defaults to one minute.
+		void SetRepeatedErrorInterval(const int64_t interval);
+
+		// Checks whether the events of the specified category are sent for the current user at all.
+		bool IsSampled(const EventCategory::EventCategory category);
+
+		// Checks whether the events of the specified category are sent for the user with the specified hash, as computed by HashUser.
+		bool IsSampled(const EventCategory::EventCategory category, const uint32_t userHash);
+
+		// Gets the hash users are sampled by.
+		static uint32_t HashUser(const std::string_view & userId);
+
+		// Checks whether the rate limits allow sending an event of the specified category, subtype and event id at the specified time in milliseconds.
+		// Subtypes are progression statuses and resource flow types. Error events are checked with TryAcquireError instead.
+		bool TryAcquire(const EventCategory::EventCategory category, const uint8_t subtype, const std::string_view & eventId, const int64_t now);
+
+		// Checks whether to send an error event with the specified severity and message at the specified time in milliseconds.
+		// Repetitions of a message that has been sent within the repeated error interval are counted instead.
+		// If forced to deduplicate, e.g. when running out of memory, repetitions are counted even if the interval is 0, within one minute then.
+		bool TryAcquireError(const Severity::Severity severity, const std::string_view & message, const int64_t now, const bool deduplicate);
+
+		// Removes all counted repetitions whose interval has passed at the specified time in milliseconds, or all of them if forced,
+		// passing severity, message and number of repetitions to the specified function.
+		void TakeRepeatedErrors(const int64_t now, const bool force, const std::function<void(Severity::Severity severity, const std::string & message, uint64_t repetitions)> & consume);
+
+		// Gets the number of events of the specified category that have been sampled out or rate limited so far.
+		// Repetitions of error messages are not included.
+		uint64_t GetDroppedEvents(const EventCategory::EventCategory category) const;
+
+	private:
+		// Rate limit implemented as generic cell rate algorithm, which is a token bucket needing a single atomic value.
+		struct RateLimit
+		{
+			RateLimit();
+
+			// Time at which the bucket would be full again, in microseconds.
+			std::atomic<int64_t> theoreticalArrival;
+
+			// Time needed to refill a single token, in microseconds. 0 means unlimited.
+			std::atomic<int64_t> interval;
+
+			// How far the theoretical arrival may be ahead of the current time, in microseconds.
+			std::atomic<int64_t> tolerance;
+		};
+
+		// Repetitions of a single error message.
+		struct RepeatedError
+		{
+			int64_t intervalStart;
+			uint64_t repetitions;
+		};
+
+		static const size_t CategoryCount = EventCategory::User + 1;
+		static const size_t EventIdLimitCount = 256;
+
+		static bool TryAcquire(RateLimit & limit, const int64_t now);
+
+		// Gives back the token taken by the last successful TryAcquire.
+		static void Release(RateLimit & limit);
+		static void SetRateLimit(RateLimit & limit, const double eventsPerSecond, const int burst);
+		static void VerifyCategory(const EventCategory::EventCategory category);
+
+		void UpdateSampling(const EventCategory::EventCategory category);
+
+		// Hash of the user id, compared against the sampling threshold of each category.
+		std::atomic<uint32_t> userHash;
+
+		// Share of users to send events of each category for, scaled to 2^32.
+		std::atomic<uint64_t> samplingThresholds[CategoryCount];
+		std::atomic<bool> sampledOut[CategoryCount];
+		std::mutex samplingMutex;
+
+		RateLimit categoryLimits[CategoryCount];
+		RateLimit eventIdLimits[EventIdLimitCount];
+		std::atomic<bool> eventIdLimited;
+
+		std::atomic<uint64_t> droppedEvents[CategoryCount];
+
+		// Repetitions by severity and message.
+		std::atomic<int64_t> repeatedErrorInterval;
+		std::unordered_map<std::string, RepeatedError> repeatedErrors;
+		std::mutex repeatedErrorsMutex;
+	};
+}
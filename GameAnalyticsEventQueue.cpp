@@ -0,0 +1,344 @@
+#include "pch.h"
+
+#include "GameAnalyticsEventQueue.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	std::atomic<uint64_t> NextQueueId(1);
+
+	// Producer of the queue the calling thread has added events to most recently.
+	struct ProducerCache
+	{
+		uint64_t queueId;
+		void * producer;
+	};
+
+	thread_local ProducerCache CachedProducer = { 0, nullptr };
+
+	// Producers of all queues the calling thread has added events to, given up when the thread exits.
+	class ProducerOwner
+	{
+	public:
+		~ProducerOwner()
+		{
+			for (auto & producer : this->producers)
+			{
+				producer.owned->store(false, std::memory_order_release);
+			}
+		}
+
+		// Gets the producer the calling thread owns for the queue with the specified id, or null if there is none.
+		void * Find(const uint64_t queueId) const
+		{
+			for (auto & producer : this->producers)
+			{
+				if (producer.queueId == queueId)
+				{
+					return producer.producer;
+				}
+			}
+
+			return nullptr;
+		}
+
+		void Add(const uint64_t queueId, void * producer, const std::shared_ptr<std::atomic<bool>> & owned)
+		{
+			// Forget producers of queues that have been destroyed.
+			this->producers.erase(
+				std::remove_if(this->producers.begin(), this->producers.end(), [](const OwnedProducer & producer) { return producer.owned.use_count() == 1; }),
+				this->producers.end());
+
+			this->producers.push_back(OwnedProducer{ queueId, producer, owned });
+		}
+
+	private:
+		struct OwnedProducer
+		{
+			uint64_t queueId;
+			void * producer;
+			std::shared_ptr<std::atomic<bool>> owned;
+		};
+
+		std::vector<OwnedProducer> producers;
+	};
+
+	thread_local ProducerOwner OwnedProducers;
+
+	// Gets the highest number of bytes the strings of the specified event can add to a ring, if none of them is stored already.
+	size_t GetMaxStringBytes(const EventRecord & record)
+	{
+		auto bytes = record.currency.size() + record.cartType.size() + record.progression.size() + 4 * sizeof(uint32_t);
+
+		if (!(record.fields & EventField::RegisteredEventId))
+		{
+			bytes += record.category == EventCategory::Error ? record.message.size() : record.eventId.size();
+		}
+
+		return bytes;
+	}
+}
+
+
+EventQueue::EventQueue(const size_t maxBatchEvents, const size_t maxBatchBytes, MemoryBudget & memoryBudget)
+	: id(NextQueueId++),
+	producers(nullptr),
+	spare(new EventRing(maxBatchEvents)),
+	nextProducer(nullptr),
+	taking(false),
+	memoryBudget(memoryBudget),
+	maxBatchEvents(maxBatchEvents),
+	maxBatchBytes(maxBatchBytes),
+	maxPendingEvents(65536)
+{
+	this->memoryBudget.Reserve(this->spare->GetMemoryBytes());
+}
+
+EventQueue::~EventQueue()
+{
+	auto producer = this->producers.load();
+
+	while (producer != nullptr)
+	{
+		auto next = producer->next;
+
+		delete producer->ring.load();
+		delete producer;
+
+		producer = next;
+	}
+}
+
+bool EventQueue::TryEnqueue(const EventRecord & record, const size_t size, bool & full)
+{
+	auto & producer = this->GetProducer();
+
+	// Take the ring, so it isn't swapped out while adding the event.
+	auto ring = producer.ring.exchange(nullptr, std::memory_order_acq_rel);
+
+	// Reserve memory for the strings of the event, and for growing the ring.
+	auto priority = MemoryPriority::ForCategory(record.category);
+	auto memoryBytes = ring->GetMemoryBytes();
+	auto reservedBytes = GetMaxStringBytes(record);
+	auto added = false;
+
+	if (this->memoryBudget.TryReserve(reservedBytes, priority))
+	{
+		added = ring->TryPush(record, size);
+
+		if (!added)
+		{
+			// Grow ring, if allowed.
+			auto maxPendingEvents = this->maxPendingEvents.load(std::memory_order_relaxed);
+			auto capacity = std::min(ring->GetCapacity() * 2, maxPendingEvents);
+
+			if (capacity > ring->GetCapacity() && this->memoryBudget.TryReserve((capacity - ring->GetCapacity()) * EventRing::RecordBytes, priority))
+			{
+				reservedBytes += (capacity - ring->GetCapacity()) * EventRing::RecordBytes;
+
+				ring->Reserve(capacity);
+				added = ring->TryPush(record, size);
+			}
+		}
+
+		// Return what hasn't been used, e.g. for interned strings.
+		this->memoryBudget.Release(reservedBytes - (ring->GetMemoryBytes() - memoryBytes));
+	}
+
+	// Count event.
+	auto & counter = added ? producer.enqueuedEvents : producer.droppedEvents;
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	full = !added
+		|| ring->GetCount() >= this->maxBatchEvents.load(std::memory_order_relaxed)
+		|| ring->GetBytes() >= this->maxBatchBytes.load(std::memory_order_relaxed);
+
+	// Give the ring back.
+	producer.ring.store(ring, std::memory_order_release);
+
+	return added;
+}
+
+void EventQueue::TakeEvents(const std::function<void(EventRing & events)> & consume)
+{
+	for (auto events = this->TakeNextEvents(); events != nullptr; events = this->TakeNextEvents())
+	{
+		if (events->GetCount() > 0)
+		{
+			consume(*events);
+		}
+
+		this->ReleaseEvents();
+	}
+}
+
+EventRing * EventQueue::TakeNextEvents()
+{
+	auto producer = this->taking ? this->nextProducer : this->producers.load(std::memory_order_acquire);
+
+	if (producer == nullptr)
+	{
+		this->taking = false;
+		return nullptr;
+	}
+
+	this->nextProducer = producer->next;
+	this->taking = true;
+
+	// Swap in the spare ring. Waits while the producer is adding an event, which takes only a few stores.
+	auto ring = producer->ring.load(std::memory_order_acquire);
+
+	while (ring == nullptr || !producer->ring.compare_exchange_weak(ring, this->spare.get(), std::memory_order_acq_rel))
+	{
+		if (ring == nullptr)
+		{
+			std::this_thread::yield();
+			ring = producer->ring.load(std::memory_order_acquire);
+		}
+	}
+
+	this->spare.release();
+	this->spare.reset(ring);
+
+	return ring;
+}
+
+void EventQueue::ReleaseEvents()
+{
+	auto ring = this->spare.get();
+
+	// Give back the memory of the events. If there's a budget, rings grow as granted by it, and shrink back to the batch size.
+	auto memoryBytes = ring->GetMemoryBytes();
+	auto maxBatchEvents = this->maxBatchEvents.load(std::memory_order_relaxed);
+
+	ring->Clear();
+
+	if (this->memoryBudget.GetLimitBytes() > 0)
+	{
+		ring->Shrink(maxBatchEvents);
+	}
+	else
+	{
+		ring->Reserve(maxBatchEvents);
+	}
+
+	this->memoryBudget.Release(memoryBytes);
+	this->memoryBudget.Reserve(ring->GetMemoryBytes());
+}
+
+uint64_t EventQueue::GetEnqueuedEvents() const
+{
+	uint64_t events = 0;
+
+	for (auto producer = this->producers.load(std::memory_order_acquire); producer != nullptr; producer = producer->next)
+	{
+		events += producer->enqueuedEvents.load(std::memory_order_relaxed);
+	}
+
+	return events;
+}
+
+uint64_t EventQueue::GetDroppedEvents() const
+{
+	uint64_t events = 0;
+
+	for (auto producer = this->producers.load(std::memory_order_acquire); producer != nullptr; producer = producer->next)
+	{
+		events += producer->droppedEvents.load(std::memory_order_relaxed);
+	}
+
+	return events;
+}
+
+size_t EventQueue::GetMaxBatchEvents() const
+{
+	return this->maxBatchEvents;
+}
+
+size_t EventQueue::GetMaxBatchBytes() const
+{
+	return this->maxBatchBytes;
+}
+
+size_t EventQueue::GetMaxPendingEvents() const
+{
+	return this->maxPendingEvents;
+}
+
+void EventQueue::SetMaxBatchEvents(const size_t maxBatchEvents)
+{
+	this->maxBatchEvents = maxBatchEvents;
+}
+
+void EventQueue::SetMaxBatchBytes(const size_t maxBatchBytes)
+{
+	this->maxBatchBytes = maxBatchBytes;
+}
+
+void EventQueue::SetMaxPendingEvents(const size_t maxPendingEvents)
+{
+	this->maxPendingEvents = maxPendingEvents;
+}
+
+EventQueue::Producer & EventQueue::GetProducer()
+{
+	if (CachedProducer.queueId == this->id)
+	{
+		return *static_cast<Producer *>(CachedProducer.producer);
+	}
+
+	// Find producer of the calling thread.
+	auto owned = static_cast<Producer *>(OwnedProducers.Find(this->id));
+
+	if (owned != nullptr)
+	{
+		CachedProducer.queueId = this->id;
+		CachedProducer.producer = owned;
+		return *owned;
+	}
+
+	// Reuse producer of an exited thread, keeping its events and counters.
+	auto head = this->producers.load(std::memory_order_acquire);
+	Producer * producer = nullptr;
+
+	for (auto candidate = head; candidate != nullptr; candidate = candidate->next)
+	{
+		auto expected = false;
+
+		if (!candidate->owned->load(std::memory_order_relaxed)
+			&& candidate->owned->compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+		{
+			producer = candidate;
+			break;
+		}
+	}
+
+	if (producer == nullptr)
+	{
+		// Add new producer.
+		producer = new Producer();
+		producer->owned = std::make_shared<std::atomic<bool>>(true);
+		producer->enqueuedEvents.store(0, std::memory_order_relaxed);
+		producer->droppedEvents.store(0, std::memory_order_relaxed);
+
+		// If there's a budget, the ring starts small and grows only as granted by it.
+		auto capacity = this->memoryBudget.GetLimitBytes() > 0 ? 1 : this->maxBatchEvents.load(std::memory_order_relaxed);
+		producer->ring.store(new EventRing(capacity), std::memory_order_relaxed);
+		this->memoryBudget.Reserve(producer->ring.load(std::memory_order_relaxed)->GetMemoryBytes());
+		producer->next = head;
+
+		while (!this->producers.compare_exchange_weak(producer->next, producer, std::memory_order_acq_rel))
+		{
+		}
+	}
+
+	OwnedProducers.Add(this->id, producer, producer->owned);
+
+	CachedProducer.queueId = this->id;
+	CachedProducer.producer = producer;
+	return *producer;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "GameAnalyticsEventRing.h"
+#include "GameAnalyticsMemoryBudget.h"
+
+namespace GameAnalytics
+{
+	// Collects typed events in memory, until they are sent to the GameAnalytics backend as a single batch.
+	// Any number of threads can add events without locking: each thread gets its own ring buffer,
+	// which is swapped out by the single thread taking the events.
+	// The records and strings of all ring buffers are accounted for by the specified memory budget.
+	class EventQueue
+	{
+	public:
+		EventQueue(const size_t maxBatchEvents, const size_t maxBatchBytes, MemoryBudget & memoryBudget);
+		~EventQueue();
+
+		// Adds the specified event with the specified estimated serialized size to the ring buffer of the calling thread.
+		// Grows the buffer if required, up to the maximum number of pending events per thread.
+		// Returns false if the event has been dropped because the buffer is at that limit, or the memory budget doesn't grant the priority of its category.
+		// Sets full to true if the buffer has reached its maximum batch size or byte budget and should be flushed soon.
+		bool TryEnqueue(const EventRecord & record, const size_t size, bool & full);
+
+		// Removes all events from this queue, passing the events of each thread to the specified function in the order they have been added.
+		// Events are cleared when the function returns. Must not be called by multiple threads at the same time.
+		void TakeEvents(const std::function<void(EventRing & events)> & consume);
+
+		// Removes the events of the next thread from this queue, for consuming them in slices, e.g. within a frame budget.
+		// Returns null after the events of all threads have been taken, starting over with the next call.
+		// The events must be released before taking the next ones. Must not be called by multiple threads at the same time.
+		EventRing * TakeNextEvents();
+
+		// Clears the events taken last, giving back their memory.
+		void ReleaseEvents();
+
+		// Gets the number of events added by all threads so far.
+		uint64_t GetEnqueuedEvents() const;
+
+		// Gets the number of events dropped by all threads so far, because their ring buffer was at its limit or the memory budget was used up.
+		uint64_t GetDroppedEvents() const;
+
+		// Gets the maximum number of events to send in a single batch.
+		size_t GetMaxBatchEvents() const;
+
+		// Gets the maximum size of a single batch, in bytes.
+		size_t GetMaxBatchBytes() const;
+
+		// Gets the maximum number of events waiting in the ring buffer of a single thread.
+		size_t GetMaxPendingEvents() const;
+
+		// Sets the maximum number of events to send in a single batch.
+		void SetMaxBatchEvents(const size_t maxBatchEvents);
+
+		// Sets the maximum size of a single batch, in bytes.
+		void SetMaxBatchBytes(const size_t maxBatchBytes);
+
+		// Sets the maximum number of events waiting in the ring buffer of a single thread.
+		void SetMaxPendingEvents(const size_t maxPendingEvents);
+
+	private:
+		// Ring buffer of a single thread adding events.
+		struct Producer
+		{
+			// Whether a thread adds events to this producer. Cleared when that thread exits, so the producer can be reused by the next new thread.
+			// Shared with the exiting thread, which might outlive the queue.
+			std::shared_ptr<std::atomic<bool>> owned;
+
+			// Null while the producing thread adds an event.
+			std::atomic<EventRing *> ring;
+
+			// Written by the producing thread only, so counting events doesn't need any atomic read-modify-write.
+			std::atomic<uint64_t> enqueuedEvents;
+			std::atomic<uint64_t> droppedEvents;
+
+			Producer * next;
+		};
+
+		// Identifies this queue in thread-local caches, which can outlive it.
+		uint64_t id;
+
+		// Singly linked list of all producers. Producers are added at the front, and never removed, but reused after their thread has exited.
+		// Events left by exited threads are taken as usual. Thus, there are never more producers than threads adding events at the same time.
+		std::atomic<Producer *> producers;
+
+		// Empty ring swapped in when taking the events of a producer. Holds the events taken last until they are released.
+		std::unique_ptr<EventRing> spare;
+
+		// Producer to take the events of next, and whether some have been taken since the last one.
+		Producer * nextProducer;
+		bool taking;
+
+		MemoryBudget & memoryBudget;
+
+		std::atomic<size_t> maxBatchEvents;
+		std::atomic<size_t> maxBatchBytes;
+		std::atomic<size_t> maxPendingEvents;
+
+		// Gets the producer of the calling thread, reusing the one of an exited thread, or adding a new one if required.
+		Producer & GetProducer();
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include "GameAnalyticsEventCategory.h"
+
+namespace GameAnalytics
+{
+	// Optional fields of event records.
+	namespace EventField
+	{
+		enum EventField : uint8_t
+		{
+			// Design event value or progression event score.
+			Value = 1,
+
+			// Business event cart type.
+			CartType = 2,
+
+			// Progression the player was in when the event occurred.
+			Progression = 4,
+
+			// Event id is a handle of the event id registry instead of a string.
+			RegisteredEventId = 8
+		};
+	}
+
+	// Typed event, as passed to and taken from the event queue.
+	// Events are serialized to JSON only when they are stored, right before being sent.
+	struct EventRecord
+	{
+		EventCategory::EventCategory category;
+
+		// Severity of error events, status of progression events, or flow type of resource events.
+		uint8_t subtype;
+
+		// Bitmask of the optional EventField values set.
+		uint8_t fields;
+
+		// Generation of the session annotations to add to the event.
+		uint16_t annotations;
+
+		// Handle of the player the event has been sent on behalf of, or PlayerRegistry::None (0) for the local user.
+		uint32_t player;
+
+		// Local time of the server clock of the core, in milliseconds.
+		int64_t timestamp;
+
+		// Transaction number of business events.
+		int32_t transactionNumber;
+
+		// Amount of business and resource events, value of design events, score of progression events, or length of session end events.
+		double value;
+
+		// Handle of the registered event id, if the RegisteredEventId field is set.
+		uint16_t registeredEventId;
+
+		// Strings are copied by the queue. For resource events, the event id doesn't include the flow type.
+		std::string_view eventId;
+		std::string_view currency;
+		std::string_view cartType;
+		std::string_view progression;
+		std::string_view message;
+	};
+}
@@ -0,0 +1,254 @@
+#include "pch.h"
+
+#include "GameAnalyticsEventRing.h"
+
+#include <utility>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	size_t RoundUpToPowerOfTwo(const size_t value)
+	{
+		size_t result = 1;
+
+		while (result < value)
+		{
+			result <<= 1;
+		}
+
+		return result;
+	}
+
+	static_assert(EventRing::RecordBytes == sizeof(EventCategory::EventCategory) + 2 * sizeof(uint8_t) + 5 * sizeof(uint16_t) + sizeof(uint32_t) + sizeof(int64_t) + sizeof(int32_t) + sizeof(double),
+		"Record size doesn't match the fields of the ring.");
+}
+
+
+EventRing::EventRing(const size_t capacity)
+	: head(0),
+	tail(0),
+	mask(0),
+	bytes(0)
+{
+	this->Allocate(RoundUpToPowerOfTwo(capacity));
+}
+
+bool EventRing::TryPush(const EventRecord & record, const size_t size)
+{
+	if (this->GetCount() >= this->GetCapacity())
+	{
+		return false;
+	}
+
+	// Copy strings.
+	uint16_t eventId;
+
+	if (record.fields & EventField::RegisteredEventId)
+	{
+		// Registered ids don't need to be copied.
+		eventId = record.registeredEventId;
+	}
+	else if (record.category == EventCategory::Error)
+	{
+		eventId = this->strings.Add(record.message);
+	}
+	else
+	{
+		eventId = this->strings.Intern(record.eventId);
+	}
+
+	auto currency = record.category == EventCategory::Business ? this->strings.Intern(record.currency) : StringTable::None;
+	auto cartType = (record.fields & EventField::CartType) ? this->strings.Intern(record.cartType) : StringTable::None;
+	auto progression = (record.fields & EventField::Progression) ? this->strings.Intern(record.progression) : StringTable::None;
+
+	if (eventId == StringTable::None
+		|| (record.category == EventCategory::Business && currency == StringTable::None)
+		|| ((record.fields & EventField::CartType) && cartType == StringTable::None)
+		|| ((record.fields & EventField::Progression) && progression == StringTable::None))
+	{
+		// String table is full. Strings already added are dropped with the next clear.
+		return false;
+	}
+
+	// Store fields.
+	auto index = this->tail & this->mask;
+
+	this->categories[index] = record.category;
+	this->subtypes[index] = record.subtype;
+	this->fields[index] = record.fields;
+	this->annotations[index] = record.annotations;
+	this->players[index] = record.player;
+	this->timestamps[index] = record.timestamp;
+	this->transactionNumbers[index] = record.transactionNumber;
+	this->values[index] = record.value;
+	this->eventIds[index] = eventId;
+	this->currencies[index] = currency;
+	this->cartTypes[index] = cartType;
+	this->progressions[index] = progression;
+
+	++this->tail;
+	this->bytes += size;
+	return true;
+}
+
+bool EventRing::TryPop(EventRecord & record)
+{
+	if (this->head == this->tail)
+	{
+		return false;
+	}
+
+	auto index = this->head & this->mask;
+
+	record.category = this->categories[index];
+	record.subtype = this->subtypes[index];
+	record.fields = this->fields[index];
+	record.annotations = this->annotations[index];
+	record.player = this->players[index];
+	record.timestamp = this->timestamps[index];
+	record.transactionNumber = this->transactionNumbers[index];
+	record.value = this->values[index];
+
+	record.registeredEventId = StringTable::None;
+	record.eventId = std::string_view();
+	record.message = std::string_view();
+
+	if (record.fields & EventField::RegisteredEventId)
+	{
+		record.registeredEventId = this->eventIds[index];
+	}
+	else if (record.category == EventCategory::Error)
+	{
+		record.message = this->strings.Get(this->eventIds[index]);
+	}
+	else
+	{
+		record.eventId = this->strings.Get(this->eventIds[index]);
+	}
+
+	record.currency = this->currencies[index] != StringTable::None ? this->strings.Get(this->currencies[index]) : std::string_view();
+	record.cartType = this->cartTypes[index] != StringTable::None ? this->strings.Get(this->cartTypes[index]) : std::string_view();
+	record.progression = this->progressions[index] != StringTable::None ? this->strings.Get(this->progressions[index]) : std::string_view();
+
+	++this->head;
+	return true;
+}
+
+void EventRing::Clear()
+{
+	this->head = 0;
+	this->tail = 0;
+	this->bytes = 0;
+	this->strings.Clear();
+}
+
+size_t EventRing::GetCount() const
+{
+	return this->tail - this->head;
+}
+
+size_t EventRing::GetBytes() const
+{
+	return this->bytes;
+}
+
+size_t EventRing::GetCapacity() const
+{
+	return this->mask + 1;
+}
+
+void EventRing::Reserve(const size_t capacity)
+{
+	if (capacity <= this->GetCapacity())
+	{
+		return;
+	}
+
+	// Move records to a new ring, sharing the string table.
+	EventRing ring(capacity);
+	ring.strings = std::move(this->strings);
+
+	auto count = this->GetCount();
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto from = (this->head + i) & this->mask;
+
+		ring.categories[i] = this->categories[from];
+		ring.subtypes[i] = this->subtypes[from];
+		ring.fields[i] = this->fields[from];
+		ring.annotations[i] = this->annotations[from];
+		ring.players[i] = this->players[from];
+		ring.timestamps[i] = this->timestamps[from];
+		ring.transactionNumbers[i] = this->transactionNumbers[from];
+		ring.values[i] = this->values[from];
+		ring.eventIds[i] = this->eventIds[from];
+		ring.currencies[i] = this->currencies[from];
+		ring.cartTypes[i] = this->cartTypes[from];
+		ring.progressions[i] = this->progressions[from];
+	}
+
+	ring.tail = static_cast<uint32_t>(count);
+	ring.bytes = this->bytes;
+	this->Swap(ring);
+}
+
+void EventRing::Shrink(const size_t capacity)
+{
+	if (this->GetCount() > 0 || RoundUpToPowerOfTwo(capacity) >= this->GetCapacity())
+	{
+		return;
+	}
+
+	// Allocate new arrays, because vectors never give back memory when resized.
+	EventRing ring(capacity);
+	ring.strings = std::move(this->strings);
+	this->Swap(ring);
+}
+
+size_t EventRing::GetMemoryBytes() const
+{
+	return this->GetCapacity() * RecordBytes + this->strings.GetBytes();
+}
+
+void EventRing::Swap(EventRing & other)
+{
+	this->categories.swap(other.categories);
+	this->subtypes.swap(other.subtypes);
+	this->fields.swap(other.fields);
+	this->annotations.swap(other.annotations);
+	this->players.swap(other.players);
+	this->timestamps.swap(other.timestamps);
+	this->transactionNumbers.swap(other.transactionNumbers);
+	this->values.swap(other.values);
+	this->eventIds.swap(other.eventIds);
+	this->currencies.swap(other.currencies);
+	this->cartTypes.swap(other.cartTypes);
+	this->progressions.swap(other.progressions);
+
+	std::swap(this->strings, other.strings);
+	std::swap(this->head, other.head);
+	std::swap(this->tail, other.tail);
+	std::swap(this->mask, other.mask);
+	std::swap(this->bytes, other.bytes);
+}
+
+void EventRing::Allocate(const size_t capacity)
+{
+
+	this->categories.resize(capacity);
+	this->subtypes.resize(capacity);
+	this->fields.resize(capacity);
+	this->annotations.resize(capacity);
+	this->players.resize(capacity);
+	this->timestamps.resize(capacity);
+	this->transactionNumbers.resize(capacity);
+	this->values.resize(capacity);
+	this->eventIds.resize(capacity);
+	this->currencies.resize(capacity);
+	this->cartTypes.resize(capacity);
+	this->progressions.resize(capacity);
+
+	this->mask = capacity - 1;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "GameAnalyticsEventRecord.h"
+#include "GameAnalyticsStringTable.h"
+
+namespace GameAnalytics
+{
+	// Ring buffer of typed event records, with one preallocated array per field (struct of arrays).
+	// Strings are stored in a string table shared by all records, and referred to by 16 bit handles,
+	// so a pending event takes 37 bytes plus its strings, and event ids sent over and over are stored only once.
+	class EventRing
+	{
+	public:
+		// Number of bytes taken by the fields of a single record, not counting its strings.
+		static const size_t RecordBytes = 37;
+
+		// Creates a ring with room for the specified number of records, rounded up to the next power of two.
+		explicit EventRing(const size_t capacity);
+
+		// Adds the specified event with the specified estimated serialized size to the end of this ring, copying its strings.
+		// Returns false if there's no room left.
+		bool TryPush(const EventRecord & record, const size_t size);
+
+		// Removes the first event from this ring.
+		// Strings of the record stay valid until the ring is cleared.
+		bool TryPop(EventRecord & record);
+
+		// Removes all events from this ring. Keeps the allocated buffers.
+		void Clear();
+
+		// Gets the number of events in this ring.
+		size_t GetCount() const;
+
+		// Gets the estimated serialized size of all events in this ring, in bytes.
+		size_t GetBytes() const;
+
+		// Gets the maximum number of events in this ring.
+		size_t GetCapacity() const;
+
+		// Makes room for at least the specified number of events, keeping all events in this ring.
+		void Reserve(const size_t capacity);
+
+		// Frees the memory of all records beyond the specified capacity, rounded up to the next power of two. Does nothing unless this ring is empty.
+		void Shrink(const size_t capacity);
+
+		// Gets the number of bytes taken by all records this ring has room for, and by the strings of its events.
+		size_t GetMemoryBytes() const;
+
+		void Swap(EventRing & other);
+
+	private:
+		std::vector<EventCategory::EventCategory> categories;
+		std::vector<uint8_t> subtypes;
+		std::vector<uint8_t> fields;
+		std::vector<uint16_t> annotations;
+		std::vector<uint32_t> players;
+		std::vector<int64_t> timestamps;
+		std::vector<int32_t> transactionNumbers;
+		std::vector<double> values;
+
+		// Event ids, registered event id handles, or messages for error events.
+		std::vector<uint16_t> eventIds;
+
+		// Currencies of business events.
+		std::vector<uint16_t> currencies;
+
+		std::vector<uint16_t> cartTypes;
+		std::vector<uint16_t> progressions;
+
+		StringTable strings;
+
+		// Positions of the first and after the last record. Increase monotonically, and wrap around the arrays.
+		uint32_t head;
+		uint32_t tail;
+
+		size_t mask;
+		size_t bytes;
+
+		// Resizes all arrays to the specified capacity, which has to be a power of two.
+		void Allocate(const size_t capacity);
+	};
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "GameAnalyticsEventCategory.h"
+#include "GameAnalyticsHash.h"
+
+namespace GameAnalytics
+{
+	// Rules the GameAnalytics backend checks events against, for checking events before they are queued.
+	// Events breaking them would get the whole batch they're sent in rejected.
+	// All checks are constexpr, so ids known at compile time can be checked by the compiler.
+	namespace EventSchema
+	{
+		// Maximum length of each part of an event id, between ":" separators.
+		constexpr size_t MaxPartLength = 64;
+
+		// Maximum length of business event cart types.
+		constexpr size_t MaxCartTypeLength = 32;
+
+		// Checks whether the specified character may be used in parts of event ids.
+		// None of them has to be escaped in JSON.
+		constexpr bool IsValidCharacter(const char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')
+				|| c == ' ' || c == '-' || c == '_' || c == '.' || c == '(' || c == ')' || c == '!' || c == '?';
+		}
+
+		// Kinds of characters, for checking event ids with a single table lookup per character.
+		namespace CharacterKind
+		{
+			enum CharacterKind : uint8_t
+			{
+				Invalid,
+				Valid,
+				Letter,
+				Separator
+			};
+		}
+
+		// Kinds of all 256 characters, computed at compile time.
+		struct CharacterKindTable
+		{
+			constexpr CharacterKindTable()
+				: kinds()
+			{
+				for (size_t i = 0; i < 256; ++i)
+				{
+					auto c = static_cast<char>(i);
+
+					this->kinds[i] = c == ':' ? CharacterKind::Separator
+						: (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ? CharacterKind::Letter
+						: IsValidCharacter(c) ? CharacterKind::Valid
+						: CharacterKind::Invalid;
+				}
+			}
+
+			CharacterKind::CharacterKind kinds[256];
+		};
+
+		inline constexpr CharacterKindTable CharacterKinds;
+
+		// Gets the categories the specified event id is valid for, as bitmask with bit (1 << category) set for each of them.
+		// Design event ids have up to five parts, business event ids two, and progression event ids up to three, without the status.
+		// Resource event ids consist of currency, item type and item id, without the flow type, and currencies are letters only.
+		constexpr uint32_t GetValidCategories(const std::string_view & eventId)
+		{
+			size_t parts = 1;
+			size_t partStart = 0;
+			auto alphabeticFirstPart = true;
+
+			for (size_t i = 0; i < eventId.size(); ++i)
+			{
+				auto kind = CharacterKinds.kinds[static_cast<uint8_t>(eventId[i])];
+
+				if (kind == CharacterKind::Letter)
+				{
+					continue;
+				}
+
+				if (kind == CharacterKind::Invalid)
+				{
+					return 0;
+				}
+
+				if (kind == CharacterKind::Valid)
+				{
+					alphabeticFirstPart = alphabeticFirstPart && parts > 1;
+					continue;
+				}
+
+				// Check length of the part ending here.
+				if (i == partStart || i - partStart > MaxPartLength)
+				{
+					return 0;
+				}
+
+				++parts;
+				partStart = i + 1;
+			}
+
+			// Empty ids and parts are not allowed.
+			if (eventId.size() == partStart || eventId.size() - partStart > MaxPartLength)
+			{
+				return 0;
+			}
+
+			uint32_t categories = 0;
+
+			if (parts <= 5)
+			{
+				categories |= 1u << EventCategory::Design;
+			}
+
+			if (parts == 2)
+			{
+				categories |= 1u << EventCategory::Business;
+			}
+
+			if (parts <= 3)
+			{
+				categories |= 1u << EventCategory::Progression;
+			}
+
+			if (parts == 3 && alphabeticFirstPart)
+			{
+				categories |= 1u << EventCategory::Resource;
+			}
+
+			return categories;
+		}
+
+		// Checks whether the specified event id is valid for the specified category.
+		constexpr bool IsValidEventId(const EventCategory::EventCategory category, const std::string_view & eventId)
+		{
+			return (GetValidCategories(eventId) & (1u << category)) != 0;
+		}
+
+		// Checks whether the specified business event currency consists of three uppercase letters, like "USD".
+		constexpr bool IsValidCurrency(const std::string_view & currency)
+		{
+			if (currency.size() != 3)
+			{
+				return false;
+			}
+
+			for (auto c : currency)
+			{
+				if (c < 'A' || c > 'Z')
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		// Checks whether the specified business event cart type is short enough.
+		constexpr bool IsValidCartType(const std::string_view & cartType)
+		{
+			return cartType.size() <= MaxCartTypeLength;
+		}
+	}
+
+	// Event id of the specified category, checked when constructed.
+	// Declaring typed event ids constexpr checks them at compile time, so invalid ids don't compile:
+	//   constexpr DesignEventId PickedUpShotgunAmmo("PickedUpAmmo:Shotgun");
+	// Events are sent by typed ids without checking or hashing the ids again. The string has to outlive the typed id.
+	template <EventCategory::EventCategory Category>
+	class TypedEventId
+	{
+	public:
+		// Throws std::invalid_argument if the specified id is invalid for the category, which fails compilation in constant expressions.
+		constexpr explicit TypedEventId(const std::string_view & eventId)
+			: eventId(EventSchema::IsValidEventId(Category, eventId) ? eventId : throw std::invalid_argument("Invalid " + std::string(EventCategory::ToString(Category)) + " event id: " + std::string(eventId))),
+			hash(HashString(eventId))
+		{
+		}
+
+		// Gets the UTF-8 encoded event id.
+		constexpr const std::string_view & GetValue() const
+		{
+			return this->eventId;
+		}
+
+		// Gets the hash of the event id, as computed by HashString.
+		constexpr uint32_t GetHash() const
+		{
+			return this->hash;
+		}
+
+	private:
+		std::string_view eventId;
+		uint32_t hash;
+	};
+
+	using BusinessEventId = TypedEventId<EventCategory::Business>;
+	using DesignEventId = TypedEventId<EventCategory::Design>;
+	using ProgressionEventId = TypedEventId<EventCategory::Progression>;
+	using ResourceEventId = TypedEventId<EventCategory::Resource>;
+}
@@ -0,0 +1,619 @@
+#include "pch.h"
+
+#include "GameAnalyticsEventStore.h"
+#include "GameAnalyticsCrc32.h"
+#include "GameAnalyticsFile.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Each record consists of the payload length and the CRC-32 of the payload, followed by the payload itself.
+	const size_t RecordHeaderSize = 8;
+
+	// Records larger than this are considered corrupt.
+	const uint32_t MaxRecordSize = 16 * 1024 * 1024;
+
+	// Sets the position of the specified file, which may be beyond 2 GB even where long has 32 bits.
+	bool SeekFile(FILE * file, const uint64_t offset)
+	{
+#ifdef _WIN32
+		return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+		return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+	}
+
+	void WriteUInt32(uint8_t * buffer, const uint32_t value)
+	{
+		buffer[0] = static_cast<uint8_t>(value);
+		buffer[1] = static_cast<uint8_t>(value >> 8);
+		buffer[2] = static_cast<uint8_t>(value >> 16);
+		buffer[3] = static_cast<uint8_t>(value >> 24);
+	}
+
+	uint32_t ReadUInt32(const uint8_t * buffer)
+	{
+		return static_cast<uint32_t>(buffer[0])
+			| (static_cast<uint32_t>(buffer[1]) << 8)
+			| (static_cast<uint32_t>(buffer[2]) << 16)
+			| (static_cast<uint32_t>(buffer[3]) << 24);
+	}
+
+	// Reads the next record from the specified file, returning false if it is incomplete or corrupt.
+	bool ReadRecord(FILE * file, std::string & payload)
+	{
+		uint8_t header[RecordHeaderSize];
+
+		if (fread(header, 1, RecordHeaderSize, file) != RecordHeaderSize)
+		{
+			return false;
+		}
+
+		auto length = ReadUInt32(header);
+		auto crc = ReadUInt32(header + 4);
+
+		// Events are never empty. Disk blocks that have been allocated, but not written, read as zeros, which would pass the CRC.
+		if (length == 0 || length > MaxRecordSize)
+		{
+			return false;
+		}
+
+		payload.resize(length);
+
+		if (fread(&payload[0], 1, length, file) != length)
+		{
+			return false;
+		}
+
+		return Crc32::Update(0, payload.data(), payload.size()) == crc;
+	}
+
+	// Gets the length of the intact part of the specified segment file.
+	uint64_t GetValidLength(const std::filesystem::path & path)
+	{
+		auto file = OpenFile(path, L"rb");
+
+		if (file == nullptr)
+		{
+			return 0;
+		}
+
+		uint64_t length = 0;
+		std::string payload;
+
+		while (ReadRecord(file, payload))
+		{
+			length += RecordHeaderSize + payload.size();
+		}
+
+		fclose(file);
+		return length;
+	}
+}
+
+
+EventStore::EventStore(const std::filesystem::path & directory, const uint64_t maxSegmentBytes, const uint64_t maxTotalBytes)
+	: directory(directory),
+	maxSegmentBytes(maxSegmentBytes),
+	maxTotalBytes(maxTotalBytes),
+	totalBytes(0),
+	writeFile(nullptr),
+	cursorChanged(false)
+{
+	std::filesystem::create_directories(this->directory);
+
+	// Find existing segments.
+	std::vector<uint32_t> ids;
+
+	for (auto & entry : std::filesystem::directory_iterator(this->directory))
+	{
+		auto name = entry.path().filename().string();
+		unsigned int id;
+		char extension[4];
+
+		if (sscanf(name.c_str(), "events-%8u.%3s", &id, extension) == 2 && std::string(extension) == "log")
+		{
+			ids.push_back(id);
+		}
+	}
+
+	std::sort(ids.begin(), ids.end());
+
+	for (auto id : ids)
+	{
+		Segment segment = { id, std::filesystem::file_size(this->GetSegmentPath(id)) };
+		this->segments.push_back(segment);
+		this->totalBytes += segment.size;
+	}
+
+	// Discard incomplete records written before a crash. Full segments are only flushed to disk with the next sync,
+	// so any segment may end in a torn record, not just the last one.
+	for (auto & segment : this->segments)
+	{
+		auto path = this->GetSegmentPath(segment.id);
+		auto validLength = GetValidLength(path);
+
+		if (validLength < segment.size)
+		{
+			std::filesystem::resize_file(path, validLength);
+			this->totalBytes -= segment.size - validLength;
+			segment.size = validLength;
+		}
+	}
+
+	// Restore acknowledged position.
+	this->LoadCursor();
+	this->DeleteAcknowledgedSegments();
+
+	// Continue writing to the last segment, if possible.
+	if (!this->segments.empty() && this->segments.back().size < this->maxSegmentBytes)
+	{
+		this->writeFile = OpenFile(this->GetSegmentPath(this->segments.back().id), L"ab");
+
+		if (this->writeFile == nullptr)
+		{
+			throw std::runtime_error("Unable to open GameAnalytics event store.");
+		}
+	}
+	else
+	{
+		this->OpenNewSegment();
+	}
+
+	// Previous sessions might have left more events than fit into the maximum size, e.g. if it has been reduced since.
+	this->EvictSegments();
+}
+
+EventStore::~EventStore()
+{
+	if (this->writeFile != nullptr)
+	{
+		fclose(this->writeFile);
+	}
+
+	this->SaveCursor();
+}
+
+size_t EventStore::Append(const EventBatch & events)
+{
+	if (events.IsEmpty())
+	{
+		return 0;
+	}
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	// Records are buffered until the segment is closed or flushed. If that fails, all of them are discarded,
+	// so the segment never ends in a torn record followed by further records.
+	auto bufferedSize = this->segments.back().size;
+	size_t bufferedEvents = 0;
+
+	for (size_t i = 0; i < events.GetCount(); ++i)
+	{
+		size_t length;
+		auto event = events.GetEvent(i, length);
+
+		// Write record.
+		uint8_t header[RecordHeaderSize];
+		WriteUInt32(header, static_cast<uint32_t>(length));
+		WriteUInt32(header + 4, Crc32::Update(0, event, length));
+
+		if (fwrite(header, 1, RecordHeaderSize, this->writeFile) != RecordHeaderSize
+			|| fwrite(event, 1, length, this->writeFile) != length)
+		{
+			this->DiscardBufferedRecords(bufferedSize);
+			return bufferedEvents;
+		}
+
+		auto recordSize = RecordHeaderSize + length;
+		this->segments.back().size += recordSize;
+		this->totalBytes += recordSize;
+
+		// Start new segment if full. The full one is flushed to disk with the next sync.
+		if (this->segments.back().size >= this->maxSegmentBytes)
+		{
+			auto closed = fclose(this->writeFile) == 0;
+			this->writeFile = nullptr;
+
+			if (!closed)
+			{
+				this->DiscardBufferedRecords(bufferedSize);
+				return bufferedEvents;
+			}
+
+			this->unsyncedSegments.push_back(this->segments.back().id);
+
+			this->OpenNewSegment();
+
+			bufferedSize = 0;
+			bufferedEvents = i + 1;
+		}
+	}
+
+	// Hand the events to the operating system, without waiting for the disk.
+	if (fflush(this->writeFile) != 0)
+	{
+		this->DiscardBufferedRecords(bufferedSize);
+		return bufferedEvents;
+	}
+
+	this->EvictSegments();
+	return events.GetCount();
+}
+
+void EventStore::Sync()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		// Segments completed since the last sync may have been deleted already.
+		for (auto id : this->unsyncedSegments)
+		{
+			auto file = OpenFile(this->GetSegmentPath(id), L"r+b");
+
+			if (file != nullptr)
+			{
+				SyncFile(file);
+				fclose(file);
+			}
+		}
+
+		this->unsyncedSegments.clear();
+
+		SyncFile(this->writeFile);
+	}
+
+	this->SaveCursor();
+}
+
+size_t EventStore::ReadBatch(const Position & start, const size_t maxEvents, const size_t maxBytes, std::string & batch, Position & end) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	batch.clear();
+	end = start < this->acknowledged ? this->acknowledged : start;
+
+	size_t count = 0;
+	std::string payload;
+
+	for (auto & segment : this->segments)
+	{
+		if (segment.id < end.segment)
+		{
+			continue;
+		}
+
+		if (segment.id > end.segment)
+		{
+			end.segment = segment.id;
+			end.offset = 0;
+		}
+
+		if (end.offset >= segment.size)
+		{
+			continue;
+		}
+
+		auto file = OpenFile(this->GetSegmentPath(segment.id), L"rb");
+
+		if (file == nullptr)
+		{
+			continue;
+		}
+
+		if (!SeekFile(file, end.offset))
+		{
+			fclose(file);
+			continue;
+		}
+
+		while (count < maxEvents && end.offset < segment.size)
+		{
+			if (!ReadRecord(file, payload))
+			{
+				// Skip the corrupt remainder of this segment.
+				end.offset = segment.size;
+				break;
+			}
+
+			// Always send at least one event, even if it exceeds the byte limit on its own.
+			if (count > 0 && batch.size() + payload.size() + 2 > maxBytes)
+			{
+				break;
+			}
+
+			batch.push_back(count == 0 ? '[' : ',');
+			batch.append(payload);
+			end.offset += RecordHeaderSize + payload.size();
+			++count;
+		}
+
+		fclose(file);
+
+		if (end.offset < segment.size)
+		{
+			break;
+		}
+	}
+
+	if (count > 0)
+	{
+		batch.push_back(']');
+	}
+
+	return count;
+}
+
+void EventStore::Acknowledge(const Position & position)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	// Events of evicted segments might have been acknowledged already.
+	if (!(this->acknowledged < position))
+	{
+		return;
+	}
+
+	this->acknowledged = position;
+	this->cursorChanged = true;
+	this->DeleteAcknowledgedSegments();
+}
+
+void EventStore::SaveCursor()
+{
+	std::lock_guard<std::mutex> cursorLock(this->cursorMutex);
+
+	Position position;
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (!this->cursorChanged)
+		{
+			return;
+		}
+
+		position = this->acknowledged;
+		this->cursorChanged = false;
+	}
+
+	// Write outside the lock of the log, because syncing may take milliseconds, e.g. while the game thread is appending events.
+	if (!this->WriteCursor(position))
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->cursorChanged = true;
+	}
+}
+
+EventStore::Position EventStore::GetAcknowledged() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->acknowledged;
+}
+
+bool EventStore::IsEmpty() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	for (auto & segment : this->segments)
+	{
+		if (segment.id > this->acknowledged.segment
+			|| (segment.id == this->acknowledged.segment && segment.size > this->acknowledged.offset))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+uint64_t EventStore::GetSize() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->totalBytes;
+}
+
+void EventStore::SetMaxTotalBytes(const uint64_t maxTotalBytes)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->maxTotalBytes = maxTotalBytes;
+	this->EvictSegments();
+}
+
+std::filesystem::path EventStore::GetSegmentPath(const uint32_t id) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "events-%08u.log", id);
+	return this->directory / name;
+}
+
+void EventStore::OpenNewSegment()
+{
+	// Segment ids always increase, even if all previous segments have been deleted.
+	auto lastId = this->segments.empty() ? 0 : this->segments.back().id;
+	Segment segment = { std::max(lastId, this->acknowledged.segment) + 1, 0 };
+
+	this->writeFile = OpenFile(this->GetSegmentPath(segment.id), L"wb");
+
+	if (this->writeFile == nullptr)
+	{
+		throw std::runtime_error("Unable to create GameAnalytics event store segment.");
+	}
+
+	this->segments.push_back(segment);
+}
+
+void EventStore::DiscardBufferedRecords(const uint64_t validSize)
+{
+	auto & segment = this->segments.back();
+	auto path = this->GetSegmentPath(segment.id);
+
+	if (this->writeFile != nullptr)
+	{
+		fclose(this->writeFile);
+	}
+
+	// Cut off whatever has made it to disk. Shrinking a file doesn't need any free space.
+	std::error_code error;
+	std::filesystem::resize_file(path, validSize, error);
+
+	this->totalBytes -= segment.size - validSize;
+	segment.size = validSize;
+
+	this->writeFile = OpenFile(path, L"ab");
+
+	if (this->writeFile == nullptr)
+	{
+		throw std::runtime_error("Unable to open GameAnalytics event store segment.");
+	}
+}
+
+void EventStore::EvictSegments()
+{
+	auto evicted = false;
+
+	// Never evict the segment being written to.
+	while (this->totalBytes > this->maxTotalBytes && this->segments.size() > 1)
+	{
+		auto oldest = this->segments.front();
+
+		std::error_code error;
+		std::filesystem::remove(this->GetSegmentPath(oldest.id), error);
+
+		this->segments.pop_front();
+		this->totalBytes -= oldest.size;
+
+		if (this->acknowledged.segment <= oldest.id)
+		{
+			this->acknowledged.segment = this->segments.front().id;
+			this->acknowledged.offset = 0;
+			evicted = true;
+		}
+	}
+
+	if (evicted)
+	{
+		this->cursorChanged = true;
+	}
+}
+
+void EventStore::DeleteAcknowledgedSegments()
+{
+	// Never delete the segment being written to.
+	while (this->segments.size() > 1)
+	{
+		auto oldest = this->segments.front();
+
+		auto acknowledgedCompletely = oldest.id < this->acknowledged.segment
+			|| (oldest.id == this->acknowledged.segment && oldest.size <= this->acknowledged.offset);
+
+		if (!acknowledgedCompletely)
+		{
+			break;
+		}
+
+		std::error_code error;
+		std::filesystem::remove(this->GetSegmentPath(oldest.id), error);
+
+		this->segments.pop_front();
+		this->totalBytes -= oldest.size;
+	}
+}
+
+void EventStore::LoadCursor()
+{
+	this->acknowledged.segment = this->segments.empty() ? 0 : this->segments.front().id;
+	this->acknowledged.offset = 0;
+
+	auto file = OpenFile(this->directory / "cursor", L"rb");
+
+	if (file == nullptr)
+	{
+		return;
+	}
+
+	std::string payload;
+	auto clamped = false;
+
+	if (ReadRecord(file, payload) && payload.size() == 12)
+	{
+		auto bytes = reinterpret_cast<const uint8_t *>(payload.data());
+		auto segment = ReadUInt32(bytes);
+		auto offset = static_cast<uint64_t>(ReadUInt32(bytes + 4)) | (static_cast<uint64_t>(ReadUInt32(bytes + 8)) << 32);
+
+		// Cursor might point to a segment that has been evicted in the meantime.
+		auto valid = this->segments.empty()
+			|| (segment >= this->segments.front().id && segment <= this->segments.back().id);
+
+		if (valid)
+		{
+			this->acknowledged.segment = segment;
+			this->acknowledged.offset = offset;
+
+			// Cursor may be written to disk before the segment it points to is synced, so after a power loss,
+			// it might point beyond the recovered end of its segment. Events appended from there on have not been acknowledged.
+			for (auto & recovered : this->segments)
+			{
+				if (recovered.id == segment && recovered.size < offset)
+				{
+					this->acknowledged.offset = recovered.size;
+					clamped = true;
+					break;
+				}
+			}
+		}
+	}
+
+	fclose(file);
+
+	// Replace the cursor before appending, so it doesn't skip the new events after the next restart.
+	if (clamped)
+	{
+		this->WriteCursor(this->acknowledged);
+	}
+}
+
+bool EventStore::WriteCursor(const Position & position) const
+{
+	uint8_t payload[12];
+	WriteUInt32(payload, position.segment);
+	WriteUInt32(payload + 4, static_cast<uint32_t>(position.offset));
+	WriteUInt32(payload + 8, static_cast<uint32_t>(position.offset >> 32));
+
+	uint8_t header[RecordHeaderSize];
+	WriteUInt32(header, sizeof(payload));
+	WriteUInt32(header + 4, Crc32::Update(0, payload, sizeof(payload)));
+
+	// Replace cursor atomically, so it never gets lost.
+	auto temporaryPath = this->directory / "cursor.tmp";
+	auto file = OpenFile(temporaryPath, L"wb");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	// Flush the new cursor to disk before renaming it, so a power loss can't leave an empty one in place of the previous one.
+	auto written = fwrite(header, 1, RecordHeaderSize, file) == RecordHeaderSize
+		&& fwrite(payload, 1, sizeof(payload), file) == sizeof(payload)
+		&& SyncFile(file);
+
+	written = fclose(file) == 0 && written;
+
+	std::error_code error;
+
+	// Keep the previous cursor if writing the new one has failed, e.g. because the disk is full.
+	// Events acknowledged since are sent again after a restart, which is better than losing all of them.
+	if (!written)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	return RenameFile(temporaryPath, this->directory / "cursor");
+}
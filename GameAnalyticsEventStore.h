@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "GameAnalyticsEventBatch.h"
+
+namespace GameAnalytics
+{
+	// Disk-backed, append-only log of serialized events that have not been acknowledged by the GameAnalytics backend yet.
+	// Events are appended to a sequence of segment files. Segments are deleted as soon as all of their events
+	// have been acknowledged, and the oldest segments are evicted if the log exceeds its maximum size.
+	class EventStore
+	{
+	public:
+		// Location of an event in the log.
+		struct Position
+		{
+			uint32_t segment;
+			uint64_t offset;
+
+			bool operator<(const Position & other) const
+			{
+				return this->segment < other.segment || (this->segment == other.segment && this->offset < other.offset);
+			}
+		};
+
+		// Opens the log in the specified directory, recovering all unacknowledged events of previous sessions.
+		// Incomplete records at the end of any segment, e.g. caused by a crash before syncing, are discarded,
+		// and the oldest events are evicted if the log exceeds the specified maximum size.
+		EventStore(const std::filesystem::path & directory, const uint64_t maxSegmentBytes, const uint64_t maxTotalBytes);
+
+		~EventStore();
+
+		EventStore(const EventStore &) = delete;
+		EventStore & operator=(const EventStore &) = delete;
+
+		// Appends the specified UTF-8 encoded JSON events to the log. The events survive the app being terminated,
+		// but are flushed to disk only when a segment is full, or by calling Sync.
+		// Returns the number of events appended, which is less than the number of events specified if writing has failed,
+		// e.g. because the disk is full. The remaining events are not appended, and the log is left intact.
+		size_t Append(const EventBatch & events);
+
+		// Flushes the events appended to the log so far, and the acknowledged position, to disk, so they survive the device losing power.
+		void Sync();
+
+		// Reads the unacknowledged events starting at the specified position from the log as a single UTF-8 encoded JSON array,
+		// limited to the specified number of events and bytes, and gets the position after the last event read.
+		// Starts at the oldest unacknowledged event if the specified position has been acknowledged or evicted already.
+		// Returns the number of events read, which is zero if there are no unacknowledged events at or after the specified position.
+		size_t ReadBatch(const Position & start, const size_t maxEvents, const size_t maxBytes, std::string & batch, Position & end) const;
+
+		// Gets the position of the oldest unacknowledged event.
+		Position GetAcknowledged() const;
+
+		// Marks all events before the specified position as acknowledged, deleting segments that are no longer required.
+		// The position is kept in memory only, until written to disk by SaveCursor or Sync.
+		void Acknowledge(const Position & position);
+
+		// Writes the acknowledged position to disk if it has changed since, waiting for the disk.
+		// Doesn't block appending or reading events meanwhile.
+		void SaveCursor();
+
+		// Checks whether all events of this log have been acknowledged.
+		bool IsEmpty() const;
+
+		// Gets the total size of all segments of this log, in bytes.
+		uint64_t GetSize() const;
+
+		// Sets the maximum total size of all segments of this log, in bytes.
+		// The oldest events are evicted if this size is exceeded.
+		void SetMaxTotalBytes(const uint64_t maxTotalBytes);
+
+	private:
+		struct Segment
+		{
+			uint32_t id;
+			uint64_t size;
+		};
+
+		mutable std::mutex mutex;
+
+		std::filesystem::path directory;
+		uint64_t maxSegmentBytes;
+		uint64_t maxTotalBytes;
+
+		// All segments on disk, oldest first. The last segment is the one being written to.
+		std::deque<Segment> segments;
+		uint64_t totalBytes;
+
+		FILE * writeFile;
+
+		// Segments completed since the last sync.
+		std::vector<uint32_t> unsyncedSegments;
+
+		// Position of the oldest unacknowledged event, and whether it has changed since it has been written to disk.
+		Position acknowledged;
+		bool cursorChanged;
+
+		// Held while writing the cursor, so positions are written in order, without holding the mutex of the log.
+		std::mutex cursorMutex;
+
+		// Gets the path of the segment file with the specified id.
+		std::filesystem::path GetSegmentPath(const uint32_t id) const;
+
+		// Creates a new, empty segment and starts writing to it.
+		void OpenNewSegment();
+
+		// Truncates the segment being written to to the specified size after writing has failed, and continues writing to it.
+		void DiscardBufferedRecords(const uint64_t validSize);
+
+		// Deletes the oldest segments until this log fits into its maximum total size again.
+		void EvictSegments();
+
+		// Deletes all segments whose events have been acknowledged completely.
+		void DeleteAcknowledgedSegments();
+
+		// Reads the position of the oldest unacknowledged event from disk.
+		void LoadCursor();
+
+		// Writes the specified position of the oldest unacknowledged event to disk.
+		// Returns false if writing has failed, keeping the previous cursor.
+		bool WriteCursor(const Position & position) const;
+	};
+}
@@ -0,0 +1,64 @@
+#include "pch.h"
+
+#include "GameAnalyticsFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace GameAnalytics;
+
+
+FILE * GameAnalytics::OpenFile(const std::filesystem::path & path, const wchar_t * mode)
+{
+#ifdef _WIN32
+	return _wfopen(path.c_str(), mode);
+#else
+	return fopen(path.c_str(), std::filesystem::path(mode).string().c_str());
+#endif
+}
+
+bool GameAnalytics::SyncFile(FILE * file)
+{
+	if (fflush(file) != 0)
+	{
+		return false;
+	}
+
+#ifdef _WIN32
+	return _commit(_fileno(file)) == 0;
+#else
+	return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool GameAnalytics::RenameFile(const std::filesystem::path & source, const std::filesystem::path & target)
+{
+#ifdef _WIN32
+	return MoveFileExW(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+	if (rename(source.c_str(), target.c_str()) != 0)
+	{
+		return false;
+	}
+
+	// The new name is part of the directory, which has to be synced separately.
+	auto directory = open(target.parent_path().c_str(), O_RDONLY | O_DIRECTORY);
+
+	if (directory < 0)
+	{
+		return false;
+	}
+
+	auto synced = fsync(directory) == 0;
+	close(directory);
+	return synced;
+#endif
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+
+namespace GameAnalytics
+{
+	// Opens the specified file with the specified fopen mode, which works with paths that aren't ANSI on Windows, too.
+	FILE * OpenFile(const std::filesystem::path & path, const wchar_t * mode);
+
+	// Flushes the specified file to disk, returning whether it has succeeded.
+	bool SyncFile(FILE * file);
+
+	// Replaces the specified target file by the specified source file, returning once the rename has been flushed to disk.
+	bool RenameFile(const std::filesystem::path & source, const std::filesystem::path & target);
+}
@@ -0,0 +1,120 @@
+#include "pch.h"
+
+#include "GameAnalyticsFileKeyValueStore.h"
+#include "GameAnalyticsFile.h"
+
+#include <cstdlib>
+
+using namespace GameAnalytics;
+
+
+FileKeyValueStore::FileKeyValueStore(const std::filesystem::path & path)
+	: path(path),
+	dirty(false)
+{
+	auto file = OpenFile(path, L"rb");
+
+	if (file == nullptr)
+	{
+		return;
+	}
+
+	// Each line consists of a key and a value, separated by a tab.
+	std::string line;
+	int c;
+
+	while ((c = fgetc(file)) != EOF)
+	{
+		if (c != '\n')
+		{
+			line.push_back(static_cast<char>(c));
+			continue;
+		}
+
+		auto separator = line.rfind('\t');
+
+		if (separator != std::string::npos)
+		{
+			this->values[line.substr(0, separator)] = static_cast<int>(strtol(line.c_str() + separator + 1, nullptr, 10));
+		}
+
+		line.clear();
+	}
+
+	fclose(file);
+}
+
+FileKeyValueStore::~FileKeyValueStore()
+{
+	this->Commit();
+}
+
+int FileKeyValueStore::GetInt32OrDefault(const std::string & key) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	auto it = this->values.find(key);
+	return it != this->values.end() ? it->second : 0;
+}
+
+void FileKeyValueStore::SetInt32(const std::string & key, const int value)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	auto & storedValue = this->values[key];
+
+	if (storedValue != value)
+	{
+		storedValue = value;
+		this->dirty = true;
+	}
+}
+
+bool FileKeyValueStore::Commit()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (!this->dirty)
+	{
+		return true;
+	}
+
+	// Replace file atomically.
+	auto temporaryPath = this->path;
+	temporaryPath += ".tmp";
+
+	auto file = OpenFile(temporaryPath, L"wb");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	auto written = true;
+
+	for (auto & entry : this->values)
+	{
+		written = written && fprintf(file, "%s\t%d\n", entry.first.c_str(), entry.second) > 0;
+	}
+
+	// Flush the new file to disk before renaming it, so a power loss can't leave a truncated one in place of the previous one.
+	written = written && SyncFile(file);
+	written = fclose(file) == 0 && written;
+
+	// Keep the previous file if writing the new one has failed, e.g. because the disk is full.
+	// Replacing it by a truncated one would reset counters, and hand out transaction numbers again.
+	if (!written)
+	{
+		std::error_code error;
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	if (!RenameFile(temporaryPath, this->path))
+	{
+		return false;
+	}
+
+	this->dirty = false;
+	return true;
+}
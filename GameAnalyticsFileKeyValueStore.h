@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "GameAnalyticsKeyValueStore.h"
+
+namespace GameAnalytics
+{
+	// Keeps values in memory, and writes them to a single file when committed, e.g. for platforms without app settings.
+	// Reading and setting values never touches the disk. The file is replaced atomically, so it never gets lost.
+	class FileKeyValueStore : public KeyValueStore
+	{
+	public:
+		// Loads all values from the specified file, if it exists.
+		explicit FileKeyValueStore(const std::filesystem::path & path);
+
+		// Commits all values.
+		~FileKeyValueStore();
+
+		FileKeyValueStore(const FileKeyValueStore &) = delete;
+		FileKeyValueStore & operator=(const FileKeyValueStore &) = delete;
+
+		int GetInt32OrDefault(const std::string & key) const override;
+		void SetInt32(const std::string & key, const int value) override;
+
+		// Writes all values to the file, if any have changed since the last commit.
+		// Keeps the previous file if any write fails, e.g. because the disk is full.
+		bool Commit() override;
+
+	private:
+		mutable std::mutex mutex;
+
+		std::filesystem::path path;
+		std::map<std::string, int> values;
+		bool dirty;
+	};
+}
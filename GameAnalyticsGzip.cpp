@@ -0,0 +1,563 @@
+#include "pch.h"
+
+#include "GameAnalyticsGzip.h"
+#include "GameAnalyticsCrc32.h"
+
+#include <algorithm>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const size_t WindowSize = 32768;
+	const size_t WindowMask = WindowSize - 1;
+
+	const size_t HashSize = 1 << 15;
+	const size_t HashMask = HashSize - 1;
+
+	const int MinMatch = 3;
+	const int MaxMatch = 258;
+
+	// Maximum number of earlier positions to check for each match. Trades compression ratio for speed.
+	const int MaxChainLength = 32;
+
+	const int LengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const int LengthExtraBits[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+	const int DistanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const int DistanceExtraBits[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+	// Huffman codes are packed starting with the most significant bit, while all other data starts with the least significant one.
+	uint32_t ReverseBits(uint32_t code, int length)
+	{
+		uint32_t result = 0;
+
+		for (auto i = 0; i < length; ++i)
+		{
+			result = (result << 1) | (code & 1);
+			code >>= 1;
+		}
+
+		return result;
+	}
+
+	size_t Hash(const uint8_t * bytes)
+	{
+		return ((bytes[0] << 10) ^ (bytes[1] << 5) ^ bytes[2]) & HashMask;
+	}
+
+	// Reads bits of a deflate stream, least significant bit first.
+	class BitReader
+	{
+	public:
+		BitReader(const uint8_t * data, const size_t length)
+			: data(data),
+			length(length),
+			position(0)
+		{
+		}
+
+		// Reads the specified number of bits. Returns false at the end of the data.
+		bool TryRead(const int count, uint32_t & value)
+		{
+			if (this->position + count > this->length * 8)
+			{
+				return false;
+			}
+
+			value = 0;
+
+			for (auto i = 0; i < count; ++i, ++this->position)
+			{
+				value |= ((this->data[this->position / 8] >> (this->position % 8)) & 1u) << i;
+			}
+
+			return true;
+		}
+
+		// Reads a Huffman code of the specified length, most significant bit first, appending it to the passed code.
+		bool TryReadCode(const int count, uint32_t & code)
+		{
+			for (auto i = 0; i < count; ++i)
+			{
+				uint32_t bit;
+
+				if (!this->TryRead(1, bit))
+				{
+					return false;
+				}
+
+				code = (code << 1) | bit;
+			}
+
+			return true;
+		}
+
+		// Skips to the next byte boundary.
+		void Align()
+		{
+			this->position = (this->position + 7) & ~static_cast<size_t>(7);
+		}
+
+		size_t GetBytePosition() const
+		{
+			return this->position / 8;
+		}
+
+		void SetBytePosition(const size_t bytePosition)
+		{
+			this->position = bytePosition * 8;
+		}
+
+	private:
+		const uint8_t * data;
+		size_t length;
+		size_t position;
+	};
+
+	// Reads a literal/length symbol with its fixed Huffman code.
+	bool TryReadLiteralLengthSymbol(BitReader & reader, int & symbol)
+	{
+		uint32_t code = 0;
+
+		// Codes of 7 bits: 256 to 279.
+		if (!reader.TryReadCode(7, code))
+		{
+			return false;
+		}
+
+		if (code <= 0x17)
+		{
+			symbol = 256 + static_cast<int>(code);
+			return true;
+		}
+
+		// Codes of 8 bits: 0 to 143, and 280 to 287.
+		if (!reader.TryReadCode(1, code))
+		{
+			return false;
+		}
+
+		if (code >= 0x30 && code <= 0xbf)
+		{
+			symbol = static_cast<int>(code) - 0x30;
+			return true;
+		}
+
+		if (code >= 0xc0 && code <= 0xc7)
+		{
+			symbol = 280 + static_cast<int>(code) - 0xc0;
+			return true;
+		}
+
+		// Codes of 9 bits: 144 to 255.
+		if (!reader.TryReadCode(1, code))
+		{
+			return false;
+		}
+
+		symbol = 144 + static_cast<int>(code) - 0x190;
+		return true;
+	}
+
+	uint32_t ReadUInt32(const uint8_t * bytes)
+	{
+		return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+	}
+
+	void AppendUInt32(std::vector<uint8_t> & output, const uint32_t value)
+	{
+		output.push_back(static_cast<uint8_t>(value));
+		output.push_back(static_cast<uint8_t>(value >> 8));
+		output.push_back(static_cast<uint8_t>(value >> 16));
+		output.push_back(static_cast<uint8_t>(value >> 24));
+	}
+}
+
+
+GzipCompressor::GzipCompressor()
+	: head(HashSize),
+	previous(WindowSize)
+{
+	this->Reset();
+}
+
+void GzipCompressor::Write(const void * data, const size_t length)
+{
+	auto bytes = static_cast<const uint8_t *>(data);
+
+	this->input.insert(this->input.end(), bytes, bytes + length);
+	this->crc = Crc32::Update(this->crc, data, length);
+
+	// Keep enough lookahead for finding the longest possible match.
+	if (this->input.size() > MaxMatch)
+	{
+		this->Compress(this->input.size() - MaxMatch);
+	}
+}
+
+const std::vector<uint8_t> & GzipCompressor::Finish()
+{
+	if (this->finished)
+	{
+		return this->output;
+	}
+
+	this->Compress(this->input.size());
+
+	// End of block.
+	this->PutLiteralLengthSymbol(256);
+
+	// Flush remaining bits.
+	if (this->bitCount > 0)
+	{
+		this->PutBits(0, 8 - this->bitCount);
+	}
+
+	// Write gzip trailer.
+	AppendUInt32(this->output, this->crc);
+	AppendUInt32(this->output, static_cast<uint32_t>(this->input.size()));
+
+	this->finished = true;
+	return this->output;
+}
+
+const std::vector<uint8_t> & GzipCompressor::GetOutput() const
+{
+	return this->output;
+}
+
+void GzipCompressor::Reset()
+{
+	this->input.clear();
+	this->position = 0;
+
+	std::fill(this->head.begin(), this->head.end(), 0);
+	std::fill(this->previous.begin(), this->previous.end(), 0);
+
+	this->output.clear();
+	this->bitBuffer = 0;
+	this->bitCount = 0;
+
+	this->crc = 0;
+	this->finished = false;
+
+	// Write gzip header: magic number, deflate, no flags, no modification time, no extra flags, unknown OS.
+	const uint8_t header[] = { 0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF };
+	this->output.insert(this->output.end(), header, header + sizeof(header));
+
+	// Start single final block with fixed Huffman codes.
+	this->PutBits(1, 1);
+	this->PutBits(1, 2);
+}
+
+size_t GzipCompressor::GetInputSize() const
+{
+	return this->input.size();
+}
+
+void GzipCompressor::Compress(const size_t end)
+{
+	auto data = this->input.data();
+	auto size = this->input.size();
+
+	while (this->position < end)
+	{
+		auto bestLength = MinMatch - 1;
+		auto bestDistance = 0;
+
+		if (this->position + MinMatch <= size)
+		{
+			// Find longest match in the window.
+			auto maxLength = static_cast<int>(std::min<size_t>(MaxMatch, size - this->position));
+			auto candidate = this->head[Hash(data + this->position)];
+			auto chainLength = MaxChainLength;
+
+			while (candidate != 0 && chainLength-- > 0)
+			{
+				auto match = static_cast<size_t>(candidate - 1);
+
+				if (match >= this->position || this->position - match > WindowSize)
+				{
+					break;
+				}
+
+				if (data[match + bestLength] == data[this->position + bestLength])
+				{
+					auto length = 0;
+
+					while (length < maxLength && data[match + length] == data[this->position + length])
+					{
+						++length;
+					}
+
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestDistance = static_cast<int>(this->position - match);
+
+						if (length == maxLength)
+						{
+							break;
+						}
+					}
+				}
+
+				auto next = this->previous[match & WindowMask];
+
+				if (next == 0 || next - 1 >= match)
+				{
+					break;
+				}
+
+				candidate = next;
+			}
+		}
+
+		if (bestLength >= MinMatch)
+		{
+			this->PutMatch(bestLength, bestDistance);
+
+			for (auto i = 0; i < bestLength; ++i)
+			{
+				this->InsertHash(this->position + i);
+			}
+
+			this->position += bestLength;
+		}
+		else
+		{
+			this->PutLiteral(data[this->position]);
+			this->InsertHash(this->position);
+			++this->position;
+		}
+	}
+}
+
+void GzipCompressor::InsertHash(const size_t at)
+{
+	if (at + MinMatch > this->input.size())
+	{
+		return;
+	}
+
+	auto hash = Hash(this->input.data() + at);
+	this->previous[at & WindowMask] = this->head[hash];
+	this->head[hash] = static_cast<uint32_t>(at + 1);
+}
+
+void GzipCompressor::PutBits(const uint32_t value, const int count)
+{
+	this->bitBuffer |= static_cast<uint64_t>(value) << this->bitCount;
+	this->bitCount += count;
+
+	while (this->bitCount >= 8)
+	{
+		this->output.push_back(static_cast<uint8_t>(this->bitBuffer));
+		this->bitBuffer >>= 8;
+		this->bitCount -= 8;
+	}
+}
+
+void GzipCompressor::PutLiteralLengthSymbol(const int symbol)
+{
+	if (symbol < 144)
+	{
+		this->PutBits(ReverseBits(0x30 + symbol, 8), 8);
+	}
+	else if (symbol < 256)
+	{
+		this->PutBits(ReverseBits(0x190 + symbol - 144, 9), 9);
+	}
+	else if (symbol < 280)
+	{
+		this->PutBits(ReverseBits(symbol - 256, 7), 7);
+	}
+	else
+	{
+		this->PutBits(ReverseBits(0xC0 + symbol - 280, 8), 8);
+	}
+}
+
+void GzipCompressor::PutLiteral(const uint8_t literal)
+{
+	this->PutLiteralLengthSymbol(literal);
+}
+
+void GzipCompressor::PutMatch(const int length, const int distance)
+{
+	// Write length.
+	auto lengthCode = 28;
+
+	while (LengthBase[lengthCode] > length)
+	{
+		--lengthCode;
+	}
+
+	this->PutLiteralLengthSymbol(257 + lengthCode);
+	this->PutBits(length - LengthBase[lengthCode], LengthExtraBits[lengthCode]);
+
+	// Write distance.
+	auto distanceCode = 29;
+
+	while (DistanceBase[distanceCode] > distance)
+	{
+		--distanceCode;
+	}
+
+	this->PutBits(ReverseBits(distanceCode, 5), 5);
+	this->PutBits(distance - DistanceBase[distanceCode], DistanceExtraBits[distanceCode]);
+}
+
+bool GameAnalytics::GzipDecompress(const uint8_t * data, const size_t length, std::string & output)
+{
+	output.clear();
+
+	// Check header.
+	const size_t HeaderSize = 10;
+	const size_t TrailerSize = 8;
+
+	if (length < HeaderSize + TrailerSize || data[0] != 0x1f || data[1] != 0x8b || data[2] != 8)
+	{
+		return false;
+	}
+
+	auto flags = data[3];
+	size_t offset = HeaderSize;
+
+	// Skip extra field, file name, comment and header checksum.
+	if (flags & 4)
+	{
+		if (offset + 2 > length)
+		{
+			return false;
+		}
+
+		offset += 2 + (data[offset] | (data[offset + 1] << 8));
+	}
+
+	for (auto flag : { 8, 16 })
+	{
+		if (flags & flag)
+		{
+			while (offset < length && data[offset] != 0)
+			{
+				++offset;
+			}
+
+			++offset;
+		}
+	}
+
+	if (flags & 2)
+	{
+		offset += 2;
+	}
+
+	if (offset + TrailerSize > length)
+	{
+		return false;
+	}
+
+	// Inflate blocks.
+	BitReader reader(data + offset, length - offset - TrailerSize);
+	uint32_t last = 0;
+
+	while (!last)
+	{
+		uint32_t type;
+
+		if (!reader.TryRead(1, last) || !reader.TryRead(2, type))
+		{
+			return false;
+		}
+
+		if (type == 0)
+		{
+			// Stored block.
+			reader.Align();
+
+			auto position = reader.GetBytePosition();
+			auto block = data + offset + position;
+
+			if (offset + position + 4 > length - TrailerSize)
+			{
+				return false;
+			}
+
+			auto size = static_cast<size_t>(block[0] | (block[1] << 8));
+			auto complement = static_cast<size_t>(block[2] | (block[3] << 8));
+
+			if ((size ^ 0xffff) != complement || offset + position + 4 + size > length - TrailerSize)
+			{
+				return false;
+			}
+
+			output.append(reinterpret_cast<const char *>(block + 4), size);
+			reader.SetBytePosition(position + 4 + size);
+			continue;
+		}
+
+		if (type != 1)
+		{
+			// Dynamic Huffman codes are not supported.
+			return false;
+		}
+
+		// Block with fixed Huffman codes.
+		while (true)
+		{
+			int symbol;
+
+			if (!TryReadLiteralLengthSymbol(reader, symbol))
+			{
+				return false;
+			}
+
+			if (symbol < 256)
+			{
+				output.push_back(static_cast<char>(symbol));
+				continue;
+			}
+
+			if (symbol == 256)
+			{
+				break;
+			}
+
+			// Copy match.
+			auto lengthCode = symbol - 257;
+			uint32_t lengthExtra;
+			uint32_t distanceCode = 0;
+
+			if (lengthCode >= 29 || !reader.TryRead(LengthExtraBits[lengthCode], lengthExtra) || !reader.TryReadCode(5, distanceCode) || distanceCode >= 30)
+			{
+				return false;
+			}
+
+			uint32_t distanceExtra;
+
+			if (!reader.TryRead(DistanceExtraBits[distanceCode], distanceExtra))
+			{
+				return false;
+			}
+
+			auto matchLength = static_cast<size_t>(LengthBase[lengthCode] + lengthExtra);
+			auto distance = static_cast<size_t>(DistanceBase[distanceCode] + distanceExtra);
+
+			if (distance > output.size())
+			{
+				return false;
+			}
+
+			for (size_t i = 0; i < matchLength; ++i)
+			{
+				output.push_back(output[output.size() - distance]);
+			}
+		}
+	}
+
+	// Check trailer.
+	auto trailer = data + length - TrailerSize;
+	return ReadUInt32(trailer) == Crc32::Update(0, output.data(), output.size()) && ReadUInt32(trailer + 4) == static_cast<uint32_t>(output.size());
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace GameAnalytics
+{
+	// Compresses data to the gzip format (RFC 1952), as accepted by the GameAnalytics backend.
+	// Uses LZ77 with hash chains and the fixed Huffman codes of deflate (RFC 1951),
+	// which work well for event batches repeating the same keys and annotations over and over.
+	// Data can be passed in as many pieces as required, e.g. while it is being serialized.
+	class GzipCompressor
+	{
+	public:
+		GzipCompressor();
+
+		// Compresses the specified data.
+		void Write(const void * data, const size_t length);
+
+		// Completes the gzip stream, and gets the compressed data.
+		const std::vector<uint8_t> & Finish();
+
+		// Gets the compressed data written so far, e.g. for passing it on while compressing. Complete only after Finish.
+		const std::vector<uint8_t> & GetOutput() const;
+
+		// Discards all data, starting a new gzip stream. Keeps allocated buffers.
+		void Reset();
+
+		// Gets the number of bytes passed to this compressor since the start of the current stream.
+		size_t GetInputSize() const;
+
+	private:
+		std::vector<uint8_t> input;
+		size_t position;
+
+		// Most recent position of each hash, and previous position with the same hash for each position in the window.
+		// Positions are stored incremented by one, so zero means "none".
+		std::vector<uint32_t> head;
+		std::vector<uint32_t> previous;
+
+		std::vector<uint8_t> output;
+		uint64_t bitBuffer;
+		int bitCount;
+
+		uint32_t crc;
+		bool finished;
+
+		// Compresses input up to the specified position.
+		void Compress(const size_t end);
+
+		// Inserts the three bytes at the specified position into the hash chains.
+		void InsertHash(const size_t at);
+
+		// Writes the specified number of bits, least significant bit first.
+		void PutBits(const uint32_t value, const int count);
+
+		// Writes the fixed Huffman code of the specified literal/length symbol.
+		void PutLiteralLengthSymbol(const int symbol);
+
+		// Writes the codes for the specified literal byte.
+		void PutLiteral(const uint8_t literal);
+
+		// Writes the codes for the specified match.
+		void PutMatch(const int length, const int distance);
+	};
+
+	// Decompresses the specified gzip stream, e.g. for checking request bodies like the GameAnalytics backend does.
+	// Supports stored blocks and blocks with fixed Huffman codes, as written by GzipCompressor, but no dynamic Huffman codes.
+	// Returns false if the stream is invalid, uses unsupported features or doesn't match its checksum.
+	bool GzipDecompress(const uint8_t * data, const size_t length, std::string & output);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace GameAnalytics
+{
+	// Computes the 32 bit FNV-1a hash of the specified string, e.g. for looking up event ids.
+	constexpr uint32_t HashString(const std::string_view & value)
+	{
+		uint32_t hash = 2166136261u;
+
+		for (auto c : value)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+}
@@ -1,8 +1,8 @@
 #include "pch.h"
 
 #include "GameAnalyticsInterface.h"
-
-#include <Windows.h>
+#include "GameAnalyticsUtf8.h"
+#include "GameAnalyticsWinRT.h"
 
 using namespace GameAnalytics;
 
@@ -10,577 +10,542 @@ using namespace concurrency;
 using namespace Platform;
 using namespace Windows::Data::Json;
 using namespace Windows::Foundation;
-using namespace Windows::Security::Cryptography;
-using namespace Windows::Security::Cryptography::Core;
+using namespace Windows::Networking::Connectivity;
 using namespace Windows::Storage;
-using namespace Windows::Web::Http;
-using namespace Windows::Web::Http::Headers;
+using namespace Windows::System::Threading;
+
+namespace
+{
+	// Converts the specified wide string to UTF-8 into the specified buffer of the calling thread, reusing its memory.
+	// Each argument of the same call needs its own buffer. The core copies all strings it keeps.
+	std::string_view ToUtf8Buffer(const std::wstring_view & s, const size_t buffer)
+	{
+		thread_local std::string buffers[3];
+		ToUtf8(s, buffers[buffer]);
+		return buffers[buffer];
+	}
+}
 
 
 GameAnalyticsInterface::GameAnalyticsInterface(const std::wstring & gameKey, const std::wstring & secretKey)
-	: initialized(false), 
-	httpClient(ref new Windows::Web::Http::HttpClient()),
-	gameKey(gameKey),
-	secretKey(secretKey),
-	build(this->GetAppVersion()),
-	sessionId(this->GenerateSessionId()),
-	userId(this->GetHardwareId()),
-	user(std::make_shared<User>())
+	: core(std::make_shared<GameAnalyticsCore>(ToUtf8(gameKey), ToUtf8(secretKey), CreateEnvironment())),
+	pumped(false),
+	networkStatusChangedRegistered(false)
 {
 }
 
-task<JsonObject^> GameAnalyticsInterface::Init()
+GameAnalyticsInterface::~GameAnalyticsInterface()
 {
-	// Increase session counter.
-	this->sessionNumber = this->GetStorageInt32OrDefault("GameAnalytics::Session");
-	++this->sessionNumber;
-	this->SetStorageInt32("GameAnalytics::Session", this->sessionNumber);
+	this->StopUpdateTimer();
 
-	// Build event object.
-	auto jsonObject = ref new JsonObject();
+	if (this->networkStatusChangedRegistered)
+	{
+		NetworkInformation::NetworkStatusChanged -= this->networkStatusChangedToken;
+	}
+}
 
-	jsonObject->Insert(L"platform", this->ToJsonValue(this->GetPlatform()));
-	jsonObject->Insert(L"os_version", this->ToJsonValue(this->GetOSVersion()));
-	jsonObject->Insert(L"sdk_version", this->ToJsonValue(this->GetSDKVersion()));
+task<JsonObject^> GameAnalyticsInterface::Init()
+{
+	// Update regularly from now on, unless the game does. The core checks the init timeout and the flush interval itself.
+	if (!this->pumped)
+	{
+		this->StartUpdateTimer();
+	}
 
-	// Send event.
-	return this->SendGameAnalyticsEvent(L"init", jsonObject).then([this](JsonObject^ response)
+	// Send stored events as soon as the device goes online again. Left to the timer, Pump or the worker thread,
+	// because the handler is called on an arbitrary thread. Flushing does nothing until initialization has completed.
+	// Registered here instead of when the returned task completes, so nothing refers to this interface after it has been destroyed.
+	// The handler doesn't keep the core alive, in case it is called while being unregistered.
+	if (!this->networkStatusChangedRegistered)
 	{
-		// Verify response.
-		auto enabled = response->GetNamedBoolean(L"enabled");
+		std::weak_ptr<GameAnalyticsCore> weakCore = this->core;
 
-		if (!enabled)
+		this->networkStatusChangedToken = NetworkInformation::NetworkStatusChanged += ref new NetworkStatusChangedEventHandler([weakCore](Object^ sender)
 		{
-			auto message = L"Error initializing GameAnalytics.";
-			auto messageString = ref new Platform::String(message);
-			throw ref new Platform::FailureException(messageString);
-		}
+			auto core = weakCore.lock();
+
+			if (core)
+			{
+				core->RequestFlush();
+			}
+		});
 
-		// Set server timestamp.
-		this->initialized = true;
-		this->serverTimestamp = response->GetNamedNumber(L"server_ts");
+		this->networkStatusChangedRegistered = true;
+	}
+
+	task_completion_event<JsonObject^> initialized;
+
+	this->core->Init([initialized](const InitResult & result)
+	{
+		if (!result.success)
+		{
+			auto message = FromUtf8(result.error);
+			initialized.set_exception(ref new Platform::FailureException(ref new String(message.c_str())));
+			return;
+		}
 
-		if (!QueryPerformanceCounter(&this->initializationTime))
+		// No response to pass if sending events has been enabled by a previous session.
+		if (result.cached)
 		{
-			throw ref new Platform::FailureException("Unable to get system time.");
+			initialized.set(ref new JsonObject());
+			return;
 		}
 
-		return response;
+		auto response = FromUtf8(result.response);
+		initialized.set(JsonObject::Parse(ref new String(response.c_str())));
 	});
+
+	return create_task(initialized);
 }
 
 bool GameAnalyticsInterface::IsInitialized() const
 {
-	return this->initialized;
+	return this->core->IsInitialized();
 }
 
-void GameAnalyticsInterface::SendBusinessEvent(const std::wstring & eventId, const std::wstring & currency, const int amount) const
+void GameAnalyticsInterface::Flush() const
 {
-	// Build event object.
-	auto jsonObject = this->BuildBusinessEventObject(eventId, currency, amount);
-
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+	this->core->Flush();
 }
 
-void GameAnalyticsInterface::SendBusinessEvent(const std::wstring & eventId, const std::wstring & currency, const int amount, const std::wstring & cartType) const
+bool GameAnalyticsInterface::Pump(const int64_t maxMicroseconds)
 {
-	// Build event object.
-	auto jsonObject = this->BuildBusinessEventObject(eventId, currency, amount);
-	jsonObject->Insert(L"cart_type", this->ToJsonValue(cartType));
-
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
-}
-
-// TODO: Enable as soon as supported by GameAnalytics.
-//void GameAnalyticsInterface::SendBusinessEvent(const std::wstring & eventId, const std::wstring & currency, const int amount, const ReceiptInfo & receiptInfo) const
-//{
-//	// Build event object.
-//	auto jsonObject = this->BuildBusinessEventObject(eventId, currency, amount);
-//	auto receiptObject = this->BuildReceiptObject(receiptInfo);
-//
-//	jsonObject->Insert(L"receipt_info", receiptObject);
-//
-//	// Send event.
-//	this->SendGameAnalyticsEvent(L"events", jsonObject);
-//}
-//
-//void GameAnalyticsInterface::SendBusinessEvent(const std::wstring & eventId, const std::wstring & currency, const int amount, const std::wstring & cartType, const ReceiptInfo & receiptInfo) const
-//{
-//	// Build event object.
-//	auto jsonObject = this->BuildBusinessEventObject(eventId, currency, amount);
-//	auto receiptObject = this->BuildReceiptObject(receiptInfo);
-//
-//	jsonObject->Insert(L"cart_type", this->ToJsonValue(cartType));
-//	jsonObject->Insert(L"receipt_info", receiptObject);
-//
-//	// Send event.
-//	this->SendGameAnalyticsEvent(L"events", jsonObject);
-//}
-
-void GameAnalyticsInterface::SendDesignEvent(const std::wstring & eventId) const
-{
-	// Build event object.
-	auto jsonObject = this->BuildDesignEventObject(eventId);
+	// Don't compete with the timer for the work.
+	if (!this->pumped)
+	{
+		this->pumped = true;
+		this->StopUpdateTimer();
+	}
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+	return this->core->Pump(maxMicroseconds);
 }
 
-void GameAnalyticsInterface::SendDesignEvent(const std::wstring & eventId, const float value) const
+void GameAnalyticsInterface::StartWorker()
 {
-	// Build event object.
-	auto jsonObject = this->BuildDesignEventObject(eventId);
-	jsonObject->Insert(L"value", this->ToJsonValue(value));
+	this->pumped = true;
+	this->StopUpdateTimer();
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+	this->core->StartWorker();
 }
 
-void GameAnalyticsInterface::SendErrorEvent(const std::wstring & message, const Severity::Severity severity) const
+void GameAnalyticsInterface::StopWorker()
 {
-	// Build event object.
-	auto jsonObject = this->BuildEventObject(L"error");
+	this->core->StopWorker();
 
-	jsonObject->Insert(L"message", this->ToJsonValue(message));
-	jsonObject->Insert(L"severity", this->ToJsonValue(Severity::ToWString(severity)));
-
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+	this->pumped = false;
+	this->StartUpdateTimer();
 }
 
-void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring & eventId)
+void GameAnalyticsInterface::AggregateEvents(const std::wstring_view & eventIdPrefix) const
 {
-	// Update progression status.
-	if (status == ProgressionStatus::ProgressionStatus::Start)
-	{
-		this->progression = eventId;
-	}
-	else
-	{
-		this->progression = std::wstring();
-	}
+	this->core->AggregateEvents(ToUtf8Buffer(eventIdPrefix, 0));
+}
 
-	// Build event object.
-	auto jsonObject = this->BuildProgressionEventObject(status, eventId);
+void GameAnalyticsInterface::AggregateEvents(const std::string_view & eventIdPrefix) const
+{
+	this->core->AggregateEvents(eventIdPrefix);
+}
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+Metrics GameAnalyticsInterface::GetMetrics() const
+{
+	return this->core->GetMetrics();
 }
 
-void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring & eventId, const int score)
+EventId GameAnalyticsInterface::RegisterEventId(const std::wstring_view & eventId) const
 {
-	if (status == ProgressionStatus::ProgressionStatus::Start)
-	{
-		// Update progression status.
-		this->progression = eventId;
-	}
-	
-	// Build event object.
-	auto jsonObject = this->BuildProgressionEventObject(status, eventId);
-	jsonObject->Insert(L"score", this->ToJsonValue(score));
+	return this->core->RegisterEventId(ToUtf8Buffer(eventId, 0));
+}
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+EventId GameAnalyticsInterface::RegisterEventId(const std::string_view & eventId) const
+{
+	return this->core->RegisterEventId(eventId);
+}
 
-	if (status != ProgressionStatus::ProgressionStatus::Start)
-	{
-		// Reset progression status.
-		this->progression = std::wstring();
-	}
+void GameAnalyticsInterface::SendBusinessEvent(const std::wstring_view & eventId, const std::wstring_view & currency, const int amount) const
+{
+	this->core->SendBusinessEvent(ToUtf8Buffer(eventId, 0), ToUtf8Buffer(currency, 1), amount);
 }
 
-void GameAnalyticsInterface::SendResourceEvent(const FlowType::FlowType flowType, const std::wstring & ingameCurrency, const std::wstring & itemType, const std::wstring & itemId, float amount) const
+void GameAnalyticsInterface::SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount) const
 {
-	// Build event object.
-	auto jsonObject = this->BuildEventObject(L"resource");
+	this->core->SendBusinessEvent(eventId, currency, amount);
+}
 
-	auto eventId = ToWString(flowType) + L":" + ingameCurrency + L":" + itemType + L":" + itemId;
-	jsonObject->Insert(L"event_id", this->ToJsonValue(eventId));
-	jsonObject->Insert(L"amount", this->ToJsonValue(amount));
+void GameAnalyticsInterface::SendBusinessEvent(const std::wstring_view & eventId, const std::wstring_view & currency, const int amount, const std::wstring_view & cartType) const
+{
+	this->core->SendBusinessEvent(ToUtf8Buffer(eventId, 0), ToUtf8Buffer(currency, 1), amount, ToUtf8Buffer(cartType, 2));
+}
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+void GameAnalyticsInterface::SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType) const
+{
+	this->core->SendBusinessEvent(eventId, currency, amount, cartType);
 }
 
-void GameAnalyticsInterface::SendSessionEndEvent() const
+void GameAnalyticsInterface::SendBusinessEvent(const EventId & eventId, const std::wstring_view & currency, const int amount) const
 {
-	// Build event object.
-	auto jsonObject = this->BuildEventObject(L"session_end");
-	jsonObject->Insert(L"length", this->ToJsonValue(this->GetTimeSinceInit()));
+	this->core->SendBusinessEvent(eventId, ToUtf8Buffer(currency, 0), amount);
+}
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+void GameAnalyticsInterface::SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount) const
+{
+	this->core->SendBusinessEvent(eventId, currency, amount);
 }
 
-void GameAnalyticsInterface::SendUserEvent(const User & user) const
+void GameAnalyticsInterface::SendBusinessEvent(const EventId & eventId, const std::wstring_view & currency, const int amount, const std::wstring_view & cartType) const
 {
-	// Store user data.
-	if (user.birthYear >= 0)
-	{
-		this->user->birthYear = user.birthYear;
-	}
+	this->core->SendBusinessEvent(eventId, ToUtf8Buffer(currency, 0), amount, ToUtf8Buffer(cartType, 1));
+}
 
-	if (!user.facebookId.empty())
-	{
-		this->user->facebookId = user.facebookId;
-	}
+void GameAnalyticsInterface::SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType) const
+{
+	this->core->SendBusinessEvent(eventId, currency, amount, cartType);
+}
 
-	if (user.gender != Gender::Unknown)
-	{
-		this->user->gender = user.gender;
-	}
+void GameAnalyticsInterface::SendBusinessEvent(const BusinessEventId & eventId, const std::wstring_view & currency, const int amount) const
+{
+	this->core->SendBusinessEvent(eventId, ToUtf8Buffer(currency, 0), amount);
+}
 
-	if (!user.googlePlusId.empty())
-	{
-		this->user->googlePlusId = user.googlePlusId;
-	}
+void GameAnalyticsInterface::SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount) const
+{
+	this->core->SendBusinessEvent(eventId, currency, amount);
+}
 
-	// Build event object.
-	auto jsonObject = this->BuildEventObject(L"user");
+void GameAnalyticsInterface::SendBusinessEvent(const BusinessEventId & eventId, const std::wstring_view & currency, const int amount, const std::wstring_view & cartType) const
+{
+	this->core->SendBusinessEvent(eventId, ToUtf8Buffer(currency, 0), amount, ToUtf8Buffer(cartType, 1));
+}
 
-	// Send event.
-	this->SendGameAnalyticsEvent(L"events", jsonObject);
+void GameAnalyticsInterface::SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType) const
+{
+	this->core->SendBusinessEvent(eventId, currency, amount, cartType);
 }
 
-void GameAnalyticsInterface::SetBirthYear(const int birthYear)
+void GameAnalyticsInterface::SendDesignEvent(const std::wstring_view & eventId) const
 {
-	this->user->birthYear = birthYear;
+	this->core->SendDesignEvent(ToUtf8Buffer(eventId, 0));
 }
 
-void GameAnalyticsInterface::SetBuild(const std::wstring & build)
+void GameAnalyticsInterface::SendDesignEvent(const std::string_view & eventId) const
 {
-	this->build = build;
+	this->core->SendDesignEvent(eventId);
 }
 
-void GameAnalyticsInterface::SetFacebookId(const std::wstring & facebookId)
+void GameAnalyticsInterface::SendDesignEvent(const std::wstring_view & eventId, const float value) const
 {
-	this->user->facebookId = facebookId;
+	this->core->SendDesignEvent(ToUtf8Buffer(eventId, 0), value);
 }
 
-void GameAnalyticsInterface::SetGender(const Gender::Gender gender)
+void GameAnalyticsInterface::SendDesignEvent(const std::string_view & eventId, const float value) const
 {
-	this->user->gender = gender;
+	this->core->SendDesignEvent(eventId, value);
 }
 
-void GameAnalyticsInterface::SetGooglePlusId(const std::wstring & googlePlusId)
+void GameAnalyticsInterface::SendDesignEvent(const EventId & eventId) const
 {
-	this->user->googlePlusId = googlePlusId;
+	this->core->SendDesignEvent(eventId);
 }
 
-void GameAnalyticsInterface::SetUserId(const std::wstring & userId)
+void GameAnalyticsInterface::SendDesignEvent(const EventId & eventId, const float value) const
 {
-	this->userId = userId;
+	this->core->SendDesignEvent(eventId, value);
 }
 
-JsonObject^ GameAnalyticsInterface::BuildBusinessEventObject(const std::wstring & eventId, const std::wstring & currency, const int amount) const
+void GameAnalyticsInterface::SendDesignEvent(const DesignEventId & eventId) const
 {
-	auto jsonObject = this->BuildEventObject(L"business");
+	this->core->SendDesignEvent(eventId);
+}
 
-	jsonObject->Insert(L"event_id", this->ToJsonValue(eventId));
-	jsonObject->Insert(L"currency", this->ToJsonValue(currency));
-	jsonObject->Insert(L"amount", this->ToJsonValue(amount));
-	jsonObject->Insert(L"transaction_num", this->ToJsonValue(this->GetNextTransactionNumber()));
+void GameAnalyticsInterface::SendDesignEvent(const DesignEventId & eventId, const float value) const
+{
+	this->core->SendDesignEvent(eventId, value);
+}
 
-	return jsonObject;
+void GameAnalyticsInterface::SendErrorEvent(const std::wstring_view & message, const Severity::Severity severity) const
+{
+	this->core->SendErrorEvent(ToUtf8Buffer(message, 0), severity);
 }
 
-JsonObject^ GameAnalyticsInterface::BuildEventObject(const std::wstring & category) const
+void GameAnalyticsInterface::SendErrorEvent(const std::string_view & message, const Severity::Severity severity) const
 {
-	// Check if initialized.
-	if (!this->initialized)
-	{
-		throw ref new Platform::FailureException("GameAnalytics has not been initialized yet. Call Init() first.");
-	}
+	this->core->SendErrorEvent(message, severity);
+}
 
-	// Build event object.
-	auto jsonObject = ref new JsonObject();
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring_view & eventId)
+{
+	this->core->SendProgressionEvent(status, ToUtf8Buffer(eventId, 0));
+}
 
-	// Add category.
-	jsonObject->Insert(L"category", this->ToJsonValue(category));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId)
+{
+	this->core->SendProgressionEvent(status, eventId);
+}
 
-	// Add device model.
-	jsonObject->Insert(L"device", this->ToJsonValue(this->GetDeviceModel()));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring_view & eventId, const int score)
+{
+	this->core->SendProgressionEvent(status, ToUtf8Buffer(eventId, 0), score);
+}
 
-	// Add GameAnalytics API version.
-	jsonObject->Insert(L"v", this->ToJsonValue(2));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId, const int score)
+{
+	this->core->SendProgressionEvent(status, eventId, score);
+}
 
-	// Add user id.
-	jsonObject->Insert(L"user_id", this->ToJsonValue(this->userId));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId)
+{
+	this->core->SendProgressionEvent(status, eventId);
+}
 
-	// Add timestamp.
-	auto clientTimestamp = this->serverTimestamp + this->GetTimeSinceInit();
-	jsonObject->Insert(L"client_ts", this->ToJsonValue(clientTimestamp));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId, const int score)
+{
+	this->core->SendProgressionEvent(status, eventId, score);
+}
 
-	// Add SDK version.
-	jsonObject->Insert(L"sdk_version", this->ToJsonValue(this->GetSDKVersion()));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId)
+{
+	this->core->SendProgressionEvent(status, eventId);
+}
 
-	// Add OS version.
-	jsonObject->Insert(L"os_version", this->ToJsonValue(this->GetOSVersion()));
+void GameAnalyticsInterface::SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId, const int score)
+{
+	this->core->SendProgressionEvent(status, eventId, score);
+}
 
-	// Add manufacturer.
-	jsonObject->Insert(L"manufacturer", this->ToJsonValue(this->GetManufacturer()));
+void GameAnalyticsInterface::SendResourceEvent(const FlowType::FlowType flowType, const std::wstring_view & ingameCurrency, const std::wstring_view & itemType, const std::wstring_view & itemId, float amount) const
+{
+	this->core->SendResourceEvent(flowType, ToUtf8Buffer(ingameCurrency, 0), ToUtf8Buffer(itemType, 1), ToUtf8Buffer(itemId, 2), amount);
+}
 
-	// Add platform.
-	jsonObject->Insert(L"platform", this->ToJsonValue(this->GetPlatform()));
+void GameAnalyticsInterface::SendResourceEvent(const FlowType::FlowType flowType, const std::string_view & ingameCurrency, const std::string_view & itemType, const std::string_view & itemId, float amount) const
+{
+	this->core->SendResourceEvent(flowType, ingameCurrency, itemType, itemId, amount);
+}
 
-	// Add session ID.
-	jsonObject->Insert(L"session_id", this->ToJsonValue(this->sessionId));
+void GameAnalyticsInterface::SendResourceEvent(const FlowType::FlowType flowType, const EventId & eventId, float amount) const
+{
+	this->core->SendResourceEvent(flowType, eventId, amount);
+}
 
-	// Add session number.
-	jsonObject->Insert(L"session_num", this->ToJsonValue(this->GetSessionNumber()));
+void GameAnalyticsInterface::SendResourceEvent(const FlowType::FlowType flowType, const ResourceEventId & eventId, float amount) const
+{
+	this->core->SendResourceEvent(flowType, eventId, amount);
+}
 
-	// Add Google+ id.
-	if (!this->user->googlePlusId.empty())
-	{
-		jsonObject->Insert(L"googleplus_id", this->ToJsonValue(this->user->googlePlusId));
-	}
+void GameAnalyticsInterface::SendSessionEndEvent() const
+{
+	this->core->SendSessionEndEvent();
+}
 
-	// Add Facebook id.
-	if (!this->user->facebookId.empty())
+void GameAnalyticsInterface::SendUserEvent(const User & user) const
+{
+	// Store user data.
+	if (user.birthYear >= 0)
 	{
-		jsonObject->Insert(L"facebook_id", this->ToJsonValue(this->user->facebookId));
+		this->core->SetBirthYear(user.birthYear);
 	}
 
-	// Add gender.
-	if (this->user->gender != Gender::Unknown)
+	if (!user.facebookId.empty())
 	{
-		jsonObject->Insert(L"gender", this->ToJsonValue(Gender::ToWString(this->user->gender)));
+		this->core->SetFacebookId(ToUtf8Buffer(user.facebookId, 0));
 	}
 
-	// Add birthyear.
-	if (this->user->birthYear >= 0)
+	if (user.gender != Gender::Unknown)
 	{
-		jsonObject->Insert(L"birth_year", this->ToJsonValue(this->user->birthYear));
+		this->core->SetGender(user.gender);
 	}
 
-	// Add build.
-	jsonObject->Insert(L"build", this->ToJsonValue(this->build));
-
-	// Add progression.
-	if (!this->progression.empty())
+	if (!user.googlePlusId.empty())
 	{
-		jsonObject->Insert(L"progression", this->ToJsonValue(this->progression));
+		this->core->SetGooglePlusId(ToUtf8Buffer(user.googlePlusId, 0));
 	}
 
-	return jsonObject;
+	// Send event.
+	this->core->SendUserEvent();
 }
 
-JsonObject^ GameAnalyticsInterface::BuildDesignEventObject(const std::wstring & eventId) const
+void GameAnalyticsInterface::SetAggregationInterval(const int aggregationInterval)
 {
-	auto jsonObject = this->BuildEventObject(L"design");
-	jsonObject->Insert(L"event_id", this->ToJsonValue(eventId));
-
-	return jsonObject;
+	this->core->SetAggregationInterval(aggregationInterval);
 }
 
-JsonObject^ GameAnalyticsInterface::BuildProgressionEventObject(const ProgressionStatus::ProgressionStatus status, const std::wstring & eventId) const
+void GameAnalyticsInterface::SetBirthYear(const int birthYear)
 {
-	auto jsonObject = this->BuildEventObject(L"progression");
+	this->core->SetBirthYear(birthYear);
+}
 
-	auto eventIdString = ToWString(status) + L":" + eventId;
-	jsonObject->Insert(L"event_id", this->ToJsonValue(eventIdString));
+void GameAnalyticsInterface::SetBuild(const std::wstring_view & build)
+{
+	this->core->SetBuild(ToUtf8Buffer(build, 0));
+}
 
-	// TODO: Add current attempt number.
+void GameAnalyticsInterface::SetBuild(const std::string_view & build)
+{
+	this->core->SetBuild(build);
+}
 
-	return jsonObject;
+void GameAnalyticsInterface::SetCompressionThreshold(const size_t compressionThreshold)
+{
+	this->core->SetCompressionThreshold(compressionThreshold);
 }
 
-JsonObject^ GameAnalyticsInterface::BuildReceiptObject(const ReceiptInfo & receiptInfo) const
+void GameAnalyticsInterface::SetEventIdRateLimit(const double eventsPerSecond, const int burst)
 {
-	auto receiptObject = ref new JsonObject();
+	this->core->SetEventIdRateLimit(eventsPerSecond, burst);
+}
 
-	receiptObject->Insert(L"receipt", this->ToJsonValue(receiptInfo.receipt));
-	
-	// TODO: Set correct store as soon as available in GameAnalytics.
-	receiptObject->Insert(L"store", this->ToJsonValue(L"unknown"));
+void GameAnalyticsInterface::SetFacebookId(const std::wstring_view & facebookId)
+{
+	this->core->SetFacebookId(ToUtf8Buffer(facebookId, 0));
+}
 
-	if (!receiptInfo.signature.empty())
-	{
-		receiptObject->Insert(L"signature", this->ToJsonValue(receiptInfo.signature));
-	}
+void GameAnalyticsInterface::SetFacebookId(const std::string_view & facebookId)
+{
+	this->core->SetFacebookId(facebookId);
+}
 
-	return receiptObject;
+void GameAnalyticsInterface::SetFlushInterval(const int flushInterval)
+{
+	this->core->SetFlushInterval(flushInterval);
 }
 
-std::wstring GameAnalyticsInterface::GenerateSessionId() const
+void GameAnalyticsInterface::SetGender(const Gender::Gender gender)
 {
-	GUID result;
-	HRESULT hr = CoCreateGuid(&result);
+	this->core->SetGender(gender);
+}
 
-	if (SUCCEEDED(hr))
-	{
-		// Generate new GUID.
-		Guid guid(result);
-		auto guidString = std::wstring(guid.ToString()->Data());
+void GameAnalyticsInterface::SetGooglePlusId(const std::wstring_view & googlePlusId)
+{
+	this->core->SetGooglePlusId(ToUtf8Buffer(googlePlusId, 0));
+}
 
-		// Remove curly brackets.
-		auto sessionId = guidString.substr(1, guidString.length() - 2);
-		return sessionId;
-	}
+void GameAnalyticsInterface::SetGooglePlusId(const std::string_view & googlePlusId)
+{
+	this->core->SetGooglePlusId(googlePlusId);
+}
 
-	throw Exception::CreateException(hr);
+void GameAnalyticsInterface::SetInitTimeout(const int initTimeout)
+{
+	this->core->SetInitTimeout(initTimeout);
 }
 
-std::wstring GameAnalyticsInterface::GetAppVersion() const
+void GameAnalyticsInterface::SetMaxBatchBytes(const size_t maxBatchBytes)
 {
-	auto thisPackage = Windows::ApplicationModel::Package::Current;
-	auto version = thisPackage->Id->Version;
-	return std::wstring(std::to_wstring(version.Major)
-		+ L"." + std::to_wstring(version.Minor)
-		+ L"." + std::to_wstring(version.Build)
-		+ L"." + std::to_wstring(version.Revision));
+	this->core->SetMaxBatchBytes(maxBatchBytes);
 }
 
-std::wstring GameAnalyticsInterface::GetDeviceModel() const
+void GameAnalyticsInterface::SetMaxBatchEvents(const size_t maxBatchEvents)
 {
-	auto info = ref new Windows::Security::ExchangeActiveSyncProvisioning::EasClientDeviceInformation();
-	return std::wstring(info->SystemProductName->Data());
+	this->core->SetMaxBatchEvents(maxBatchEvents);
 }
 
-std::wstring GameAnalyticsInterface::GetHardwareId() const
+void GameAnalyticsInterface::SetMaxBatchRetries(const int maxBatchRetries)
 {
-	auto packageSpecificToken = Windows::System::Profile::HardwareIdentification::GetPackageSpecificToken(nullptr);
-	auto hardwareId = packageSpecificToken->Id;
-	auto hardwareIdString = CryptographicBuffer::EncodeToHexString(hardwareId);
-	return std::wstring(hardwareIdString->Data());
+	this->core->SetMaxBatchRetries(maxBatchRetries);
 }
 
-std::wstring GameAnalyticsInterface::GetManufacturer() const
+void GameAnalyticsInterface::SetMaxInFlightBatches(const size_t maxInFlightBatches)
 {
-	auto info = ref new Windows::Security::ExchangeActiveSyncProvisioning::EasClientDeviceInformation();
-	return std::wstring(info->SystemManufacturer->Data());
+	this->core->SetMaxInFlightBatches(maxInFlightBatches);
 }
 
+void GameAnalyticsInterface::SetMaxPayloadBytes(const size_t maxPayloadBytes)
+{
+	this->core->SetMaxPayloadBytes(maxPayloadBytes);
+}
 
-std::wstring GameAnalyticsInterface::GetOSVersion() const
+void GameAnalyticsInterface::SetMaxPendingEvents(const size_t maxPendingEvents)
 {
-	auto deviceFamily = Windows::System::Profile::AnalyticsInfo::VersionInfo->DeviceFamily;
-	return (deviceFamily == "Windows.Desktop") ? L"windows 10" : L"windows_phone 10";
+	this->core->SetMaxPendingEvents(maxPendingEvents);
 }
 
-std::wstring GameAnalyticsInterface::GetPlatform() const
+void GameAnalyticsInterface::SetMaxStoreBytes(const uint64_t maxStoreBytes)
 {
-	// TODO: Get correct platform as soon as ported to UWP.
-	return L"windows";
+	this->core->SetMaxStoreBytes(maxStoreBytes);
 }
 
-int GameAnalyticsInterface::GetSessionNumber() const
+void GameAnalyticsInterface::SetMaxUploadLatency(const int maxUploadLatency)
 {
-	return this->sessionNumber;
+	this->core->SetMaxUploadLatency(maxUploadLatency);
 }
 
-std::wstring GameAnalyticsInterface::GetSDKVersion() const
+void GameAnalyticsInterface::SetMemoryBudget(const size_t memoryBudget)
 {
-	return L"rest api v2";
+	this->core->SetMemoryBudget(memoryBudget);
 }
 
-uint64 GameAnalyticsInterface::GetTimeSinceInit() const
+void GameAnalyticsInterface::SetMetricsEnabled(const bool metricsEnabled)
 {
-	LARGE_INTEGER currentTime;
+	this->core->SetMetricsEnabled(metricsEnabled);
+}
 
-	if (!QueryPerformanceCounter(&currentTime))
-	{
-		throw ref new Platform::FailureException(L"Unable to get system time.");
-	}
+void GameAnalyticsInterface::SetMetricsFile(const std::wstring & metricsPath, const int metricsInterval)
+{
+	this->core->SetMetricsFile(metricsPath, metricsInterval);
+}
 
-	return (currentTime.QuadPart - this->initializationTime.QuadPart) / 10000000;
+void GameAnalyticsInterface::SetRateLimit(const EventCategory::EventCategory category, const double eventsPerSecond, const int burst)
+{
+	this->core->SetRateLimit(category, eventsPerSecond, burst);
 }
 
-int GameAnalyticsInterface::GetNextTransactionNumber() const
+void GameAnalyticsInterface::SetRepeatedErrorInterval(const int repeatedErrorInterval)
 {
-	auto transactionNumber = this->GetStorageInt32OrDefault("GameAnalytics::Transaction");
-	++transactionNumber;
-	this->SetStorageInt32("GameAnalytics::Transaction", transactionNumber);
-	return transactionNumber;
+	this->core->SetRepeatedErrorInterval(repeatedErrorInterval);
 }
 
-JsonValue^ GameAnalyticsInterface::ToJsonValue(std::wstring s) const
+void GameAnalyticsInterface::SetSamplingRate(const EventCategory::EventCategory category, const double samplingRate)
 {
-	return JsonValue::CreateStringValue(ref new String(s.c_str()));
+	this->core->SetSamplingRate(category, samplingRate);
 }
 
-JsonValue^ GameAnalyticsInterface::ToJsonValue(double d) const
+void GameAnalyticsInterface::SetUserId(const std::wstring_view & userId)
 {
-	return JsonValue::CreateNumberValue(d);
+	this->core->SetUserId(ToUtf8Buffer(userId, 0));
 }
 
-task<JsonObject^> GameAnalyticsInterface::SendGameAnalyticsEvent(const std::wstring & route, JsonObject^ eventObject) const
+void GameAnalyticsInterface::SetUserId(const std::string_view & userId)
 {
-	// TODO: Add event queue, send reguarly, cache if offline.
-	// Build event JSON.
-	auto jsonArray = ref new JsonArray();
-	jsonArray->Append(eventObject);
+	this->core->SetUserId(userId);
+}
 
-	// Generate HMAC SHA256 of event data.
-	auto jsonString = jsonArray->Stringify();
-	auto secretKeyString = ref new String(this->secretKey.c_str());
+Environment GameAnalyticsInterface::CreateEnvironment()
+{
+	Environment environment;
 
-	// TODO: Add compression.
-	auto alg = MacAlgorithmProvider::OpenAlgorithm(MacAlgorithmNames::HmacSha256);
-	auto jsonBuffer = CryptographicBuffer::ConvertStringToBinary(jsonString, BinaryStringEncoding::Utf8);
-	auto secretKeyBuffer = CryptographicBuffer::ConvertStringToBinary(secretKeyString, BinaryStringEncoding::Utf8);
-	auto hmacKey = alg->CreateKey(secretKeyBuffer);
+	environment.transport = std::make_shared<WinRTTransport>();
+	environment.clock = std::make_shared<WinRTClock>();
+	environment.keyValueStore = std::make_shared<WinRTKeyValueStore>();
+	environment.deviceInfo = std::make_shared<WinRTDeviceInfo>();
 
-	auto hashedJsonBuffer = CryptographicEngine::Sign(hmacKey, jsonBuffer);
-	auto hashedJsonBase64 = CryptographicBuffer::EncodeToBase64String(hashedJsonBuffer);
+	auto localFolder = ApplicationData::Current->LocalFolder;
+	environment.storeDirectory = std::wstring(localFolder->Path->Data()) + L"\\GameAnalytics";
 
-	// Build category URL.
-	auto relativeUrl = this->gameKey + L"/" + route;
-	
-	// Sandbox URL: http://sandbox-api.gameanalytics.com/v2/
-	// Production URL: http://api.gameanalytics.com/v2/
-	auto absoluteUrl = L"http://api.gameanalytics.com/v2/" + relativeUrl;
-	auto absoluteUrlString = ref new String(absoluteUrl.c_str());
+	return environment;
+}
 
-	// Send event to GameAnalytics.
-	auto message = ref new HttpRequestMessage();
+void GameAnalyticsInterface::StartUpdateTimer()
+{
+	if (this->updateTimer != nullptr)
+	{
+		return;
+	}
 
-	message->RequestUri = ref new Uri(absoluteUrlString);
-	message->Method = HttpMethod::Post;
-	message->Content = ref new HttpStringContent
-		(jsonString,
-		Windows::Storage::Streams::UnicodeEncoding::Utf8,
-		ref new Platform::String(L"application/json"));
-	message->Headers->TryAppendWithoutValidation(L"Authorization", hashedJsonBase64);
+	auto core = this->core;
 
-	auto response = ref new HttpResponseMessage();
+	TimeSpan period;
+	period.Duration = 10000000;
 
-	return create_task(httpClient->SendRequestAsync(message)).then([=](HttpResponseMessage^ response)
+	this->updateTimer = ThreadPoolTimer::CreatePeriodicTimer(ref new TimerElapsedHandler([core](ThreadPoolTimer^ timer)
 	{
-		// Validate HTTP status code.
-		if (response->StatusCode == HttpStatusCode::BadRequest)
-		{
-			// Show error.
-			auto error = response->Content->ToString();
-			auto jsonArray = JsonArray::Parse(error);
-			auto jsonResponse = jsonArray->GetObjectAt(0);
-			auto jsonErrors = jsonResponse->GetNamedArray("errors");
-			auto jsonError = jsonErrors->GetObjectAt(0);
-			throw ref new Platform::FailureException(jsonError->Stringify());
-		}
-
-		// Default handling.
-		response->EnsureSuccessStatusCode();
-
-		return create_task(response->Content->ReadAsStringAsync());
-	}).then([=](String^ responseBodyAsText){
-		// Return response.
-		auto json = JsonObject::Parse(responseBodyAsText);
-		return json;
-	});
+		core->Update();
+	}), period);
 }
 
-int GameAnalyticsInterface::GetStorageInt32OrDefault(Platform::String^ key) const
+void GameAnalyticsInterface::StopUpdateTimer()
 {
-	auto localSettings = ApplicationData::Current->LocalSettings;
-	auto hasValue = localSettings->Values->HasKey(key);
-	return hasValue ? safe_cast<IPropertyValue^>(localSettings->Values->Lookup(key))->GetInt32() : 0;
+	if (this->updateTimer != nullptr)
+	{
+		this->updateTimer->Cancel();
+		this->updateTimer = nullptr;
+	}
 }
-
-void GameAnalyticsInterface::SetStorageInt32(Platform::String^ key, int value) const
-{
-	auto localSettings = ApplicationData::Current->LocalSettings;
-	localSettings->Values->Insert(key, dynamic_cast<PropertyValue^>(PropertyValue::CreateInt32(value)));
-}
\ No newline at end of file
@@ -1,11 +1,14 @@
 #pragma once
 
-#include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <ppltasks.h>
 
+#include "GameAnalyticsCore.h"
 #include "GameAnalyticsErrorSeverity.h"
+#include "GameAnalyticsEventCategory.h"
+#include "GameAnalyticsMetrics.h"
 #include "GameAnalyticsProgressionStatus.h"
 #include "GameAnalyticsReceiptInfo.h"
 #include "GameAnalyticsResourceFlowType.h"
@@ -17,6 +20,8 @@ using namespace Windows::Data::Json;
 
 namespace GameAnalytics
 {
+	// Windows Runtime interface to GameAnalytics.
+	// Forwards all events to the platform-independent GameAnalytics core, providing Windows Runtime implementations of its services.
 	class GameAnalyticsInterface
 	{
 	public:
@@ -27,20 +32,64 @@ namespace GameAnalytics
 		// and generates a new GUID for the session.
 		GameAnalyticsInterface(const std::wstring & gameKey, const std::wstring & secretKey);
 
+		// Stops sending queued and stored events.
+		~GameAnalyticsInterface();
+
 		// Should be called when a new session starts.
 		// Determines if the SDK should be disabled and gets the server timestamp otherwise.
 		// That timestamp is used to calculate an offset, if client clock is not configured correctly. 
+		// Doesn't block. Events sent before the returned task has completed are buffered and sent afterwards.
+		// If the backend can't be reached within the init timeout, continues with the decision of the previous session, passing an empty response.
 		task<JsonObject^> GameAnalyticsInterface::Init();
 
 		bool IsInitialized() const;
 
+		// Gets counters and latencies of the GameAnalytics pipeline itself, e.g. for showing them in a debug overlay.
+		// Latencies are measured only if enabled by SetMetricsEnabled.
+		Metrics GetMetrics() const;
+
+		// Stores all queued events on disk and sends them to the GameAnalytics backend in batches.
+		// Events are sent automatically whenever the flush interval has passed, or the maximum batch size has been reached.
+		// Events that could not be sent, e.g. because the device is offline, are sent again with the next flush.
+		void Flush() const;
+
+		// Does the work of the GameAnalytics pipeline in slices, instead of on a thread pool timer, e.g. once per frame within the share
+		// of the frame budget granted to analytics. Returns as soon as the specified number of microseconds has been used up,
+		// continuing with the next call. Returns true if all work due has been done.
+		bool Pump(const int64_t maxMicroseconds);
+
+		// Does the work of the GameAnalytics pipeline in slices on a dedicated thread with low priority, instead of on a thread pool timer.
+		void StartWorker();
+
+		// Stops the worker thread, doing the work on a thread pool timer again.
+		void StopWorker();
+
+		// Aggregates all design and resource events whose id starts with the specified prefix, sending summary events
+		// per aggregation interval instead of each event. Up to 64 prefixes can be added.
+		void AggregateEvents(const std::wstring_view & eventIdPrefix) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void AggregateEvents(const std::string_view & eventIdPrefix) const;
+
+		// Registers the specified event id for sending events by handle, returning the same handle for equal ids.
+		// Sending events by handle doesn't convert, copy or escape the id again, which is worth it for ids sent over and over.
+		// For resource events, register the id without flow type, e.g. "Gold:Weapon:Sword".
+		// Up to 4096 event ids can be registered.
+		EventId RegisterEventId(const std::wstring_view & eventId) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		EventId RegisterEventId(const std::string_view & eventId) const;
+
 		// Sends the business event with the specified id to the GameAnalytics backend.
 		// Event ids can be sub-categorized by using ":" notation, for example "Purchase:RocketLauncher".
 		// Check http://support.gameanalytics.com/hc/en-us/articles/200841576-Supported-currencies for a list of currencies that will populate the monetization dashboard.
 		// For all other virtual currency strings, you will need to create your custom dashboards and widgets.
 		// The amount is a numeric value which corresponds to the cost of the purchase in the monetary unit multiplied by 100.
 		// For example, if the currency is "USD", the amount should be specified in cents.
-		void SendBusinessEvent(const std::wstring & eventId, const std::wstring & currency, const int amount) const;
+		void SendBusinessEvent(const std::wstring_view & eventId, const std::wstring_view & currency, const int amount) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount) const;
 
 		// Sends the business event with the specified id to the GameAnalytics backend.
 		// Event ids can be sub-categorized by using ":" notation, for example "Purchase:RocketLauncher".
@@ -49,7 +98,37 @@ namespace GameAnalytics
 		// The amount is a numeric value which corresponds to the cost of the purchase in the monetary unit multiplied by 100.
 		// For example, if the currency is "USD", the amount should be specified in cents.
 		// Includes a string representing the cart (the location) from which the purchase was made, i.e. menu_shop or end_of_level_shop.
-		void SendBusinessEvent(const std::wstring & eventId, const std::wstring & currency, const int amount, const std::wstring & cartType) const;
+		void SendBusinessEvent(const std::wstring_view & eventId, const std::wstring_view & currency, const int amount, const std::wstring_view & cartType) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendBusinessEvent(const std::string_view & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType) const;
+
+		// Sends the business event with the specified registered id to the GameAnalytics backend.
+		void SendBusinessEvent(const EventId & eventId, const std::wstring_view & currency, const int amount) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount) const;
+
+		// Sends the business event with the specified registered id to the GameAnalytics backend.
+		// Includes a string representing the cart (the location) from which the purchase was made, i.e. menu_shop or end_of_level_shop.
+		void SendBusinessEvent(const EventId & eventId, const std::wstring_view & currency, const int amount, const std::wstring_view & cartType) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendBusinessEvent(const EventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType) const;
+
+		// Sends the business event with the specified typed id to the GameAnalytics backend.
+		// Declaring typed ids constexpr checks them at compile time, and events sent by them don't check the ids again.
+		void SendBusinessEvent(const BusinessEventId & eventId, const std::wstring_view & currency, const int amount) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount) const;
+
+		// Sends the business event with the specified typed id to the GameAnalytics backend.
+		// Includes a string representing the cart (the location) from which the purchase was made, i.e. menu_shop or end_of_level_shop.
+		void SendBusinessEvent(const BusinessEventId & eventId, const std::wstring_view & currency, const int amount, const std::wstring_view & cartType) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendBusinessEvent(const BusinessEventId & eventId, const std::string_view & currency, const int amount, const std::string_view & cartType) const;
 
 		// TODO: Enable as soon as supported by GameAnalytics.
 
@@ -74,29 +153,79 @@ namespace GameAnalytics
 
 		// Sends the design event with the specified id to the GameAnalytics backend.
 		// Event ids can be sub-categorized by using ":" notation, for example "PickedUpAmmo:Shotgun".
-		void SendDesignEvent(const std::wstring & eventId) const;
+		void SendDesignEvent(const std::wstring_view & eventId) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendDesignEvent(const std::string_view & eventId) const;
 
 		// Sends the design event with the specified id and value to the GameAnalytics backend.
 		// Event ids can be sub-categorized by using ":" notation, for example "PickedUpAmmo:Shotgun".
-		void SendDesignEvent(const std::wstring & eventId, const float value) const;
+		void SendDesignEvent(const std::wstring_view & eventId, const float value) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendDesignEvent(const std::string_view & eventId, const float value) const;
+
+		// Sends the design event with the specified registered id to the GameAnalytics backend.
+		void SendDesignEvent(const EventId & eventId) const;
+
+		// Sends the design event with the specified registered id and value to the GameAnalytics backend.
+		void SendDesignEvent(const EventId & eventId, const float value) const;
+
+		// Sends the design event with the specified typed id to the GameAnalytics backend.
+		void SendDesignEvent(const DesignEventId & eventId) const;
+
+		// Sends the design event with the specified typed id and value to the GameAnalytics backend.
+		void SendDesignEvent(const DesignEventId & eventId, const float value) const;
 
 		// Sends the error event with the specified message and severity to the GameAnalytics backend.
 		// Event ids can be sub-categorized by using ":" notation, for example "Exception:NullReference".
-		void SendErrorEvent(const std::wstring & message, const Severity::Severity severity) const;
+		void SendErrorEvent(const std::wstring_view & message, const Severity::Severity severity) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendErrorEvent(const std::string_view & message, const Severity::Severity severity) const;
 
 		// Sends the progression event with the specified status to the GameAnalytics backend.
 		// Progress event id can consist of 1-3 parts: Progression1:Progression2:Progression3.
 		// Stores the event id, associating further events with the current attempt.
-		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring & eventId);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring_view & eventId);
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId);
 
 		// Sends the progression event with the specified status to the GameAnalytics backend.
 		// Progress event id can consist of 1-3 parts: Progression1:Progression2:Progression3.
 		// Stores the event id, associating further events with the current attempt.
 		// Includes player score for the attempt. Use with status "Fail" or "Complete" only.
-		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring & eventId, const int score);
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::wstring_view & eventId, const int score);
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const std::string_view & eventId, const int score);
+
+		// Sends the progression event with the specified status and registered id to the GameAnalytics backend.
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId);
+
+		// Sends the progression event with the specified status, registered id and score to the GameAnalytics backend.
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const EventId & eventId, const int score);
+
+		// Sends the progression event with the specified status and typed id to the GameAnalytics backend.
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId);
+
+		// Sends the progression event with the specified status, typed id and score to the GameAnalytics backend.
+		void SendProgressionEvent(const ProgressionStatus::ProgressionStatus status, const ProgressionEventId & eventId, const int score);
 
 		// Sends the resource event with the specified flow type and currency and item data to the GameAnalytics backend.
-		void SendResourceEvent(const FlowType::FlowType flowType, const std::wstring & ingameCurrency, const std::wstring & itemType, const std::wstring & itemId, float amount) const;
+		void SendResourceEvent(const FlowType::FlowType flowType, const std::wstring_view & ingameCurrency, const std::wstring_view & itemType, const std::wstring_view & itemId, float amount) const;
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SendResourceEvent(const FlowType::FlowType flowType, const std::string_view & ingameCurrency, const std::string_view & itemType, const std::string_view & itemId, float amount) const;
+
+		// Sends the resource event with the specified flow type and registered id to the GameAnalytics backend.
+		// The id has to consist of currency and item data, e.g. "Gold:Weapon:Sword".
+		void SendResourceEvent(const FlowType::FlowType flowType, const EventId & eventId, float amount) const;
+
+		// Sends the resource event with the specified flow type and typed id to the GameAnalytics backend.
+		// The id has to consist of currency and item data, e.g. "Gold:Weapon:Sword".
+		void SendResourceEvent(const FlowType::FlowType flowType, const ResourceEventId & eventId, float amount) const;
 
 		// Sends the session end event to the GameAnalytics backend.
 		// Should always be sent whenever a session is determined to be over, for example whenever the app is suspended.
@@ -106,99 +235,117 @@ namespace GameAnalytics
 		// Sends the user event with the specified data to the GameAnalytics backend.
 		void SendUserEvent(const User & user) const;
 
+		// Sets the interval for sending summaries of aggregated events, in seconds. Defaults to 60.
+		void SetAggregationInterval(const int aggregationInterval);
+
 		void SetBirthYear(const int birthYear);
 
 		// Sets the current version of the game being played. Defaults to the app package version.
-		void SetBuild(const std::wstring & build);
+		void SetBuild(const std::wstring_view & build);
 
-		void SetFacebookId(const std::wstring & facebookId);
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SetBuild(const std::string_view & build);
 
-		void SetGender(const Gender::Gender gender);
+		// Sets the minimum size of a batch of events to be compressed before being sent, in bytes. Defaults to 1 KB.
+		// Smaller batches are sent uncompressed, because compressing them is not worth the CPU time.
+		void SetCompressionThreshold(const size_t compressionThreshold);
 
-		void SetGooglePlusId(const std::wstring & googlePlusId);
+		// Sends at most the specified number of events with the same event id per second on average, and at most burst events at once.
+		// Applies to business, design, progression and resource events, separately per progression status and resource flow type.
+		// A rate of 0 removes the limit, which is the default.
+		void SetEventIdRateLimit(const double eventsPerSecond, const int burst);
 
-		// Sets the unique ID representing the user playing the game.
-		// This ID should remain the same across different play sessions.
-		// Defaults to the ASHWID.
-		void SetUserId(const std::wstring & userId);
-		
-	private:
-		bool initialized;
-		long serverTimestamp;
-		LARGE_INTEGER initializationTime;
+		void SetFacebookId(const std::wstring_view & facebookId);
 
-		Windows::Web::Http::HttpClient^ httpClient;
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SetFacebookId(const std::string_view & facebookId);
 
-		std::wstring gameKey;
-		std::wstring secretKey;
+		// Sets the interval for sending queued events, in seconds. Defaults to 8 seconds.
+		void SetFlushInterval(const int flushInterval);
 
-		std::wstring build;
-		std::wstring sessionId;
-		int sessionNumber;
-		std::wstring userId;
-		std::wstring progression;
+		void SetGender(const Gender::Gender gender);
 
-		std::shared_ptr<User> user;
+		void SetGooglePlusId(const std::wstring_view & googlePlusId);
 
-		// Builds the event object for business analytics events.
-		JsonObject^ BuildBusinessEventObject(const std::wstring & eventId, const std::wstring & currency, const int amount) const;
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SetGooglePlusId(const std::string_view & googlePlusId);
 
-		// Builds an event object, adding GameAnalytics default annotations.
-		JsonObject^ BuildEventObject(const std::wstring & category) const;
+		// Sets how long to wait for the init response before falling back to the decision of the previous session, in seconds. Defaults to 5.
+		void SetInitTimeout(const int initTimeout);
 
-		// Builds the event object for design analytics events.
-		JsonObject^ BuildDesignEventObject(const std::wstring & eventId) const;
+		// Sets the maximum size of a single batch of events, in bytes. Defaults to 64 KB.
+		// Queued events are sent with the next update as soon as this size has been reached.
+		void SetMaxBatchBytes(const size_t maxBatchBytes);
 
-		// Builds the event object for progression analytics events.
-		JsonObject^ BuildProgressionEventObject(const ProgressionStatus::ProgressionStatus status, const std::wstring & eventId) const;
+		// Sets the maximum number of events to send in a single batch. Defaults to 100.
+		// Queued events are sent with the next update as soon as this number has been reached.
+		void SetMaxBatchEvents(const size_t maxBatchEvents);
 
-		// Builds an receipt info object, as used by some business events.
-		JsonObject^ BuildReceiptObject(const ReceiptInfo & receiptInfo) const;
+		// Sets how often a batch of stored events is sent again after server errors, before its events are discarded. Defaults to 10.
+		// Batches failing because the device is offline are always sent again.
+		void SetMaxBatchRetries(const int maxBatchRetries);
 
-		// Generates a new GUID for the current session.
-		std::wstring GenerateSessionId() const;
+		// Sets the maximum number of batches of stored events being sent at the same time. Defaults to 4.
+		// Further batches wait until one of them has been answered.
+		void SetMaxInFlightBatches(const size_t maxInFlightBatches);
 
-		// Gets the app package version.
-		std::wstring GetAppVersion() const;
+		// Limits the size of each request to the specified number of bytes before compression. Defaults to 1 MB.
+		void SetMaxPayloadBytes(const size_t maxPayloadBytes);
 
-		// Gets the model of the device this app runs on.
-		std::wstring GetDeviceModel() const;
+		// Sets the maximum number of events a single thread may queue between two flushes. Defaults to 65536.
+		// Further events of that thread are dropped until the next flush.
+		void SetMaxPendingEvents(const size_t maxPendingEvents);
 
-		// Gets the Application Specific Hardware Identifier (ASHWID).
-		// See https://msdn.microsoft.com/en-us/library/windows/apps/jj553431
-		std::wstring GetHardwareId() const;
+		// Sets the maximum disk space for storing events that have not been sent yet, in bytes. Defaults to 10 MB.
+		// The oldest events are discarded if this size is exceeded.
+		void SetMaxStoreBytes(const uint64_t maxStoreBytes);
 
-		// Gets the manufacturer of the device this app runs on.
-		std::wstring GetManufacturer() const;
+		// Sets how long it may take to get the response to a batch of events, in milliseconds, measured per request. Defaults to 2000.
+		// Batches grow while answered faster, and shrink when answered slower, timing out or failing.
+		void SetMaxUploadLatency(const int maxUploadLatency);
 
-		// Gets the version of the operation systems this app runs on.
-		std::wstring GetOSVersion() const;
+		// Limits the memory used for queued events and request bodies, in bytes. Unlimited by default.
+		// As the budget fills up, design events are dropped first, and business and progression events last.
+		void SetMemoryBudget(const size_t memoryBudget);
 
-		// Gets the platform this app runs on.
-		std::wstring GetPlatform() const;
+		// Enables measuring latencies of queueing, serializing, signing, compressing and uploading events. Disabled by default.
+		void SetMetricsEnabled(const bool metricsEnabled);
 
-		// Gets the number of the current session.
-		int GetSessionNumber() const;
+		// Writes the metrics to the specified file as JSON object every interval in seconds. An empty path stops writing them.
+		void SetMetricsFile(const std::wstring & metricsPath, const int metricsInterval);
 
-		// Gets the version of this GameAnalytics SDK.
-		std::wstring GetSDKVersion() const;
+		// Sends at most the specified number of events of the specified category per second on average, and at most burst events at once.
+		// Error events are limited to 10 per second and bursts of 100 by default. A rate of 0 removes the limit.
+		void SetRateLimit(const EventCategory::EventCategory category, const double eventsPerSecond, const int burst);
 
-		// Get the elapsed time since initialization, in seconds.
-		uint64 GetTimeSinceInit() const;
+		// Sets the interval for counting repetitions of the same error message instead of sending them, in seconds. Defaults to 60; 0 sends all of them.
+		void SetRepeatedErrorInterval(const int repeatedErrorInterval);
 
-		// Gets the number of the next transaction.
-		int GetNextTransactionNumber() const;
+		// Sends events of the specified category for the specified share of users only, between 0 and 1. Defaults to 1.
+		// The same user is either always sampled or never, across sessions.
+		void SetSamplingRate(const EventCategory::EventCategory category, const double samplingRate);
 
-		JsonValue^ ToJsonValue(std::wstring s) const;
-		JsonValue^ ToJsonValue(double d) const;
+		// Sets the unique ID representing the user playing the game.
+		// This ID should remain the same across different play sessions.
+		// Defaults to the ASHWID.
+		void SetUserId(const std::wstring_view & userId);
+
+		// Same as above, passing the UTF-8 encoded strings to the core without converting them.
+		void SetUserId(const std::string_view & userId);
+		
+	private:
+		std::shared_ptr<GameAnalyticsCore> core;
 
-		// Sends the specified event to the GameAnalytics backend.
-		task<JsonObject^> SendGameAnalyticsEvent(const std::wstring & route, JsonObject^ eventObject) const;
+		Windows::System::Threading::ThreadPoolTimer^ updateTimer;
+		bool pumped;
+		Windows::Foundation::EventRegistrationToken networkStatusChangedToken;
+		bool networkStatusChangedRegistered;
 
-		// Gets a locally stored integer value, or 0 if not found.
-		int GetStorageInt32OrDefault(Platform::String^ key) const;
+		// Creates the Windows Runtime implementations of the services used by the GameAnalytics core.
+		static Environment CreateEnvironment();
 
-		// Sets a locally stored integer value.
-		void SetStorageInt32(Platform::String^ key, int value) const;
+		// Starts or stops updating the core on a thread pool timer.
+		void StartUpdateTimer();
+		void StopUpdateTimer();
 	};
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "pch.h"
+
+#include "GameAnalyticsJson.h"
+
+#include <cstdlib>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	void SkipWhitespace(const std::string & json, size_t & position)
+	{
+		while (position < json.size()
+			&& (json[position] == ' ' || json[position] == '\t' || json[position] == '\n' || json[position] == '\r'))
+		{
+			++position;
+		}
+	}
+
+	// Skips the JSON string starting at the specified position, returning false if it is not terminated.
+	bool SkipString(const std::string & json, size_t & position)
+	{
+		for (++position; position < json.size(); ++position)
+		{
+			if (json[position] == '\\')
+			{
+				++position;
+			}
+			else if (json[position] == '"')
+			{
+				++position;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Skips the JSON value starting at the specified position, returning false if it is malformed.
+	bool SkipValue(const std::string & json, size_t & position)
+	{
+		if (position >= json.size())
+		{
+			return false;
+		}
+
+		if (json[position] == '"')
+		{
+			return SkipString(json, position);
+		}
+
+		if (json[position] == '{' || json[position] == '[')
+		{
+			// Skip nested objects and arrays, including strings containing brackets.
+			auto depth = 0;
+
+			while (position < json.size())
+			{
+				auto c = json[position];
+
+				if (c == '"')
+				{
+					if (!SkipString(json, position))
+					{
+						return false;
+					}
+
+					continue;
+				}
+
+				if (c == '{' || c == '[')
+				{
+					++depth;
+				}
+				else if (c == '}' || c == ']')
+				{
+					--depth;
+				}
+
+				++position;
+
+				if (depth == 0)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Skip literals and numbers.
+		while (position < json.size() && json[position] != ',' && json[position] != '}' && json[position] != ']'
+			&& json[position] != ' ' && json[position] != '\t' && json[position] != '\n' && json[position] != '\r')
+		{
+			++position;
+		}
+
+		return true;
+	}
+}
+
+
+bool Json::TryGetMember(const std::string & json, const std::string & name, std::string & value)
+{
+	size_t position = 0;
+	SkipWhitespace(json, position);
+
+	if (position >= json.size() || json[position] != '{')
+	{
+		return false;
+	}
+
+	++position;
+
+	while (true)
+	{
+		SkipWhitespace(json, position);
+
+		if (position >= json.size() || json[position] != '"')
+		{
+			return false;
+		}
+
+		// Read member name. Names are compared without unescaping, which is sufficient for the names used by the backend.
+		auto nameStart = position + 1;
+
+		if (!SkipString(json, position))
+		{
+			return false;
+		}
+
+		auto memberName = json.substr(nameStart, position - nameStart - 1);
+
+		SkipWhitespace(json, position);
+
+		if (position >= json.size() || json[position] != ':')
+		{
+			return false;
+		}
+
+		++position;
+		SkipWhitespace(json, position);
+
+		// Read member value.
+		auto valueStart = position;
+
+		if (!SkipValue(json, position))
+		{
+			return false;
+		}
+
+		if (memberName == name)
+		{
+			value = json.substr(valueStart, position - valueStart);
+			return true;
+		}
+
+		SkipWhitespace(json, position);
+
+		if (position >= json.size() || json[position] != ',')
+		{
+			return false;
+		}
+
+		++position;
+	}
+}
+
+bool Json::TryGetBoolean(const std::string & json, const std::string & name, bool & value)
+{
+	std::string rawValue;
+
+	if (!TryGetMember(json, name, rawValue))
+	{
+		return false;
+	}
+
+	if (rawValue == "true" || rawValue == "false")
+	{
+		value = rawValue == "true";
+		return true;
+	}
+
+	return false;
+}
+
+bool Json::TryGetNumber(const std::string & json, const std::string & name, double & value)
+{
+	std::string rawValue;
+
+	if (!TryGetMember(json, name, rawValue) || rawValue.empty())
+	{
+		return false;
+	}
+
+	char * end;
+	value = strtod(rawValue.c_str(), &end);
+	return *end == '\0';
+}
+
+bool Json::TryGetElements(const std::string & json, std::vector<std::string> & elements)
+{
+	elements.clear();
+
+	size_t position = 0;
+	SkipWhitespace(json, position);
+
+	if (position >= json.size() || json[position] != '[')
+	{
+		return false;
+	}
+
+	++position;
+	SkipWhitespace(json, position);
+
+	if (position < json.size() && json[position] == ']')
+	{
+		return true;
+	}
+
+	while (true)
+	{
+		SkipWhitespace(json, position);
+
+		// Read element.
+		auto valueStart = position;
+
+		if (!SkipValue(json, position) || position == valueStart)
+		{
+			return false;
+		}
+
+		elements.push_back(json.substr(valueStart, position - valueStart));
+
+		SkipWhitespace(json, position);
+
+		if (position >= json.size())
+		{
+			return false;
+		}
+
+		if (json[position] == ']')
+		{
+			return true;
+		}
+
+		if (json[position] != ',')
+		{
+			return false;
+		}
+
+		++position;
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace GameAnalytics
+{
+	// Helpers for reading UTF-8 encoded JSON without building an object tree.
+	// See JsonWriter for writing JSON.
+	namespace Json
+	{
+		// Gets the raw JSON value of the top-level member with the specified name of the passed JSON object.
+		// Returns false if the JSON is no object or has no such member.
+		bool TryGetMember(const std::string & json, const std::string & name, std::string & value);
+
+		// Gets the value of the top-level boolean member with the specified name of the passed JSON object.
+		bool TryGetBoolean(const std::string & json, const std::string & name, bool & value);
+
+		// Gets the value of the top-level numeric member with the specified name of the passed JSON object.
+		bool TryGetNumber(const std::string & json, const std::string & name, double & value);
+
+		// Gets the raw JSON values of all elements of the passed JSON array.
+		// Returns false if the JSON is no array or malformed.
+		bool TryGetElements(const std::string & json, std::vector<std::string> & elements);
+	}
+}
@@ -0,0 +1,273 @@
+#include "pch.h"
+
+#include "GameAnalyticsJsonWriter.h"
+
+#include <charconv>
+#include <cmath>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const char HexDigits[] = "0123456789abcdef";
+
+	// Smallest magnitude from which on not every integer can be represented by a double, 2^53.
+	const double MinImpreciseInteger = 9007199254740992.0;
+
+	// Checks whether the specified byte has to be escaped within JSON strings.
+	inline bool RequiresEscaping(const unsigned char c)
+	{
+		return c < 0x20 || c == '"' || c == '\\';
+	}
+}
+
+
+JsonWriter::JsonWriter()
+	: separatorRequired(false)
+{
+}
+
+void JsonWriter::BeginObject()
+{
+	this->BeginValue();
+	this->buffer.push_back('{');
+	this->separatorRequired = false;
+}
+
+void JsonWriter::EndObject()
+{
+	this->buffer.push_back('}');
+	this->separatorRequired = true;
+}
+
+void JsonWriter::BeginArray()
+{
+	this->BeginValue();
+	this->buffer.push_back('[');
+	this->separatorRequired = false;
+}
+
+void JsonWriter::EndArray()
+{
+	this->buffer.push_back(']');
+	this->separatorRequired = true;
+}
+
+void JsonWriter::WriteName(const char * name)
+{
+	this->BeginValue();
+
+	this->buffer.push_back('"');
+	this->buffer.append(name);
+	this->buffer.append("\":", 2);
+
+	this->separatorRequired = false;
+}
+
+void JsonWriter::WriteString(const std::string_view & value)
+{
+	this->BeginString();
+	this->WriteStringPart(value);
+	this->EndString();
+}
+
+void JsonWriter::BeginString()
+{
+	this->BeginValue();
+	this->buffer.push_back('"');
+}
+
+void JsonWriter::WriteStringPart(const std::string_view & value)
+{
+	size_t runStart = 0;
+
+	for (size_t i = 0; i < value.size(); ++i)
+	{
+		auto c = static_cast<unsigned char>(value[i]);
+
+		if (!RequiresEscaping(c))
+		{
+			continue;
+		}
+
+		// Copy all characters not requiring escaping at once.
+		this->buffer.append(value.data() + runStart, i - runStart);
+		runStart = i + 1;
+
+		switch (c)
+		{
+		case '"':
+			this->buffer.append("\\\"", 2);
+			break;
+
+		case '\\':
+			this->buffer.append("\\\\", 2);
+			break;
+
+		case '\b':
+			this->buffer.append("\\b", 2);
+			break;
+
+		case '\f':
+			this->buffer.append("\\f", 2);
+			break;
+
+		case '\n':
+			this->buffer.append("\\n", 2);
+			break;
+
+		case '\r':
+			this->buffer.append("\\r", 2);
+			break;
+
+		case '\t':
+			this->buffer.append("\\t", 2);
+			break;
+
+		default:
+			// Escape remaining control characters.
+			char escaped[] = { '\\', 'u', '0', '0', HexDigits[c >> 4], HexDigits[c & 0xF] };
+			this->buffer.append(escaped, sizeof(escaped));
+		}
+	}
+
+	this->buffer.append(value.data() + runStart, value.size() - runStart);
+}
+
+void JsonWriter::WriteEscapedStringPart(const std::string_view & value)
+{
+	this->buffer.append(value.data(), value.size());
+}
+
+void JsonWriter::EndString()
+{
+	this->buffer.push_back('"');
+	this->separatorRequired = true;
+}
+
+void JsonWriter::WriteInteger(const int64_t value)
+{
+	this->BeginValue();
+
+	// Write digits backwards into a local buffer.
+	char digits[20];
+	auto end = digits + sizeof(digits);
+	auto begin = end;
+
+	auto magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+
+	do
+	{
+		*--begin = static_cast<char>('0' + magnitude % 10);
+		magnitude /= 10;
+	}
+	while (magnitude != 0);
+
+	if (value < 0)
+	{
+		this->buffer.push_back('-');
+	}
+
+	this->buffer.append(begin, end - begin);
+	this->separatorRequired = true;
+}
+
+void JsonWriter::WriteNumber(const double value)
+{
+	// JSON can't represent infinity or NaN.
+	if (!std::isfinite(value))
+	{
+		this->BeginValue();
+		this->buffer.append("null", 4);
+		this->separatorRequired = true;
+		return;
+	}
+
+	// Most values sent are integral, e.g. amounts and scores.
+	if (value == std::floor(value) && std::fabs(value) < MinImpreciseInteger)
+	{
+		this->WriteInteger(static_cast<int64_t>(value));
+		return;
+	}
+
+	this->BeginValue();
+
+	// Larger values are all integral, but 15 digits would round them to another integer.
+	char digits[32];
+	auto result = std::fabs(value) < MinImpreciseInteger
+		? std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 15)
+		: std::to_chars(digits, digits + sizeof(digits), value);
+	this->buffer.append(digits, result.ptr - digits);
+
+	this->separatorRequired = true;
+}
+
+void JsonWriter::WriteBoolean(const bool value)
+{
+	this->BeginValue();
+
+	if (value)
+	{
+		this->buffer.append("true", 4);
+	}
+	else
+	{
+		this->buffer.append("false", 5);
+	}
+
+	this->separatorRequired = true;
+}
+
+void JsonWriter::WriteMembers(const std::string & members)
+{
+	if (members.empty())
+	{
+		return;
+	}
+
+	this->BeginValue();
+	this->buffer.append(members);
+	this->separatorRequired = true;
+}
+
+void JsonWriter::WriteMember(const char * name, const std::string_view & value)
+{
+	this->WriteName(name);
+	this->WriteString(value);
+}
+
+void JsonWriter::WriteMember(const char * name, const int64_t value)
+{
+	this->WriteName(name);
+	this->WriteInteger(value);
+}
+
+void JsonWriter::WriteMember(const char * name, const double value)
+{
+	if (!std::isfinite(value))
+	{
+		return;
+	}
+
+	this->WriteName(name);
+	this->WriteNumber(value);
+}
+
+void JsonWriter::Clear()
+{
+	this->buffer.clear();
+	this->separatorRequired = false;
+}
+
+const std::string & JsonWriter::GetString() const
+{
+	return this->buffer;
+}
+
+void JsonWriter::BeginValue()
+{
+	if (this->separatorRequired)
+	{
+		this->buffer.push_back(',');
+	}
+}
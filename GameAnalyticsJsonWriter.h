@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace GameAnalytics
+{
+	// Writes UTF-8 encoded JSON straight into a reusable buffer, without building an object tree.
+	// Separators are added automatically. Names are expected not to require escaping.
+	class JsonWriter
+	{
+	public:
+		JsonWriter();
+
+		void BeginObject();
+		void EndObject();
+
+		void BeginArray();
+		void EndArray();
+
+		// Writes the name of the next member of the current object.
+		void WriteName(const char * name);
+
+		// Writes the specified string, enclosed in quotes and escaped as required.
+		void WriteString(const std::string_view & value);
+
+		// Writes a string in several parts, e.g. for joining event id parts without concatenating them first.
+		void BeginString();
+		void WriteStringPart(const std::string_view & value);
+
+		// Writes the specified part of a string, which has already been escaped.
+		void WriteEscapedStringPart(const std::string_view & value);
+		void EndString();
+
+		void WriteInteger(const int64_t value);
+
+		// Writes the specified number with up to 15 significant digits. Integral values are written without fraction,
+		// and exactly from 2^53 on, where 15 digits would round them. Infinity and NaN are written as null.
+		void WriteNumber(const double value);
+
+		void WriteBoolean(const bool value);
+
+		// Writes the specified already serialized, comma-separated members into the current object.
+		void WriteMembers(const std::string & members);
+
+		void WriteMember(const char * name, const std::string_view & value);
+		void WriteMember(const char * name, const int64_t value);
+
+		// Skips the member if the specified value is infinity or NaN, which JSON can't represent.
+		void WriteMember(const char * name, const double value);
+
+		// Discards all written JSON. Keeps the allocated buffer.
+		void Clear();
+
+		// Gets the JSON written so far.
+		const std::string & GetString() const;
+
+	private:
+		std::string buffer;
+
+		// Whether a comma has to be written before the next member or element.
+		bool separatorRequired;
+
+		// Writes a comma if required.
+		void BeginValue();
+	};
+}
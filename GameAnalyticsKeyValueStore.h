@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+namespace GameAnalytics
+{
+	// Persistently stores small values across sessions, such as session and transaction counters.
+	class KeyValueStore
+	{
+	public:
+		virtual ~KeyValueStore() {}
+
+		// Gets a stored integer value, or 0 if not found.
+		virtual int GetInt32OrDefault(const std::string & key) const = 0;
+
+		// Stores the specified integer value.
+		virtual void SetInt32(const std::string & key, const int value) = 0;
+
+		// Writes all values stored so far to persistent storage, if the store defers writing them.
+		// Returns false if they couldn't be written, in which case the values stored before are kept.
+		virtual bool Commit() { return true; }
+	};
+}
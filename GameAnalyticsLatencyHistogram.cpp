@@ -0,0 +1,122 @@
+#include "pch.h"
+
+#include "GameAnalyticsLatencyHistogram.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Gets the index of the highest bit set in the specified non-zero value.
+	int GetHighestBit(const uint64_t value)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanReverse64(&index, value);
+		return static_cast<int>(index);
+#else
+		return 63 - __builtin_clzll(value);
+#endif
+	}
+}
+
+
+LatencyHistogram::LatencyHistogram()
+	: count(0),
+	sum(0),
+	max(0)
+{
+	for (auto & bucket : this->buckets)
+	{
+		bucket = 0;
+	}
+}
+
+void LatencyHistogram::Record(const uint64_t nanoseconds)
+{
+	this->buckets[GetIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+	this->count.fetch_add(1, std::memory_order_relaxed);
+	this->sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+	// New maximums become rare quickly.
+	auto max = this->max.load(std::memory_order_relaxed);
+
+	while (nanoseconds > max && !this->max.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed))
+	{
+	}
+}
+
+LatencySummary LatencyHistogram::GetSummary() const
+{
+	LatencySummary summary = {};
+
+	// Counts are read one by one while other threads may record, so the buckets may add up to a slightly different count.
+	uint64_t counts[BucketCount];
+	uint64_t total = 0;
+
+	for (size_t i = 0; i < BucketCount; ++i)
+	{
+		counts[i] = this->buckets[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+
+	if (total == 0)
+	{
+		return summary;
+	}
+
+	summary.count = total;
+	summary.mean = static_cast<double>(this->sum.load(std::memory_order_relaxed)) / this->count.load(std::memory_order_relaxed) / 1000;
+	summary.max = static_cast<double>(this->max.load(std::memory_order_relaxed)) / 1000;
+
+	// Find the bucket of each quantile.
+	const double quantiles[] = { 0.5, 0.9, 0.99 };
+	double * values[] = { &summary.p50, &summary.p90, &summary.p99 };
+
+	uint64_t seen = 0;
+	size_t quantile = 0;
+
+	for (size_t i = 0; i < BucketCount && quantile < 3; ++i)
+	{
+		seen += counts[i];
+
+		while (quantile < 3 && seen > quantiles[quantile] * (total - 1))
+		{
+			*values[quantile] = std::min(GetValue(i), static_cast<double>(this->max.load(std::memory_order_relaxed))) / 1000;
+			++quantile;
+		}
+	}
+
+	return summary;
+}
+
+size_t LatencyHistogram::GetIndex(const uint64_t value)
+{
+	// Small values get a bucket each.
+	if (value < 2 * SubBucketCount)
+	{
+		return static_cast<size_t>(value);
+	}
+
+	// Larger values are bucketed by their highest bits.
+	auto shift = GetHighestBit(value) - SubBucketBits;
+	return SubBucketCount * (shift + 1) + static_cast<size_t>((value >> shift) - SubBucketCount);
+}
+
+double LatencyHistogram::GetValue(const size_t index)
+{
+	if (index < 2 * SubBucketCount)
+	{
+		return static_cast<double>(index);
+	}
+
+	auto shift = static_cast<int>(index / SubBucketCount) - 1;
+	auto lowest = static_cast<double>((index % SubBucketCount) + SubBucketCount) * static_cast<double>(1ull << shift);
+
+	return lowest + static_cast<double>(1ull << shift) / 2;
+}
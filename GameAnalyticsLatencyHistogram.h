@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace GameAnalytics
+{
+	// Statistics of the durations recorded by a latency histogram, in microseconds.
+	struct LatencySummary
+	{
+		uint64_t count;
+		double mean;
+		double p50;
+		double p90;
+		double p99;
+		double max;
+	};
+
+	// Counts durations in buckets whose width grows with their magnitude, so quantiles are estimated within about 3% of their true value.
+	// Recording a duration takes a few relaxed atomic additions, without locking or allocating memory.
+	// Can be used by any number of threads at the same time.
+	class LatencyHistogram
+	{
+	public:
+		LatencyHistogram();
+
+		// Adds the specified duration, in nanoseconds.
+		void Record(const uint64_t nanoseconds);
+
+		// Gets count, mean, quantiles and maximum of all durations recorded so far.
+		LatencySummary GetSummary() const;
+
+	private:
+		// Each power of two is split into 2^SubBucketBits buckets.
+		static const int SubBucketBits = 4;
+		static const size_t SubBucketCount = 1 << SubBucketBits;
+		static const size_t BucketCount = SubBucketCount * (64 - SubBucketBits + 1);
+
+		std::atomic<uint64_t> buckets[BucketCount];
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;
+		std::atomic<uint64_t> max;
+
+		// Gets the index of the bucket for the specified duration.
+		static size_t GetIndex(const uint64_t value);
+
+		// Gets the duration in the middle of the bucket with the specified index.
+		static double GetValue(const size_t index);
+	};
+}
@@ -0,0 +1,458 @@
+#include "pch.h"
+
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsBase64.h"
+#include "GameAnalyticsEventSchema.h"
+#include "GameAnalyticsGzip.h"
+#include "GameAnalyticsJson.h"
+#include "GameAnalyticsSha256.h"
+
+#include <algorithm>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	bool EndsWith(const std::string & s, const std::string & suffix)
+	{
+		return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	// Gets the specified string member of the specified event without quotes, or an empty string if it's missing.
+	// Escaped characters are kept escaped, which makes ids containing them invalid, as they should be.
+	std::string GetStringMember(const std::string & event, const char * name)
+	{
+		std::string value;
+
+		if (!Json::TryGetMember(event, name, value) || value.size() < 2 || value.front() != '"')
+		{
+			return std::string();
+		}
+
+		return value.substr(1, value.size() - 2);
+	}
+
+	// Removes the specified prefix, followed by ":", from the specified event id, returning false if the id doesn't start with it.
+	bool RemovePrefix(std::string & eventId, const std::string & prefix)
+	{
+		if (eventId.compare(0, prefix.size() + 1, prefix + ":") != 0)
+		{
+			return false;
+		}
+
+		eventId.erase(0, prefix.size() + 1);
+		return true;
+	}
+
+	// Checks the event id and currency of the specified event like the backend does, appending an error for each invalid one.
+	void ValidateEventId(const std::string & event, const EventCategory::EventCategory category, std::string & errors)
+	{
+		auto eventId = GetStringMember(event, "event_id");
+
+		// Progression event ids start with the status, and resource event ids with the flow type.
+		auto valid = true;
+
+		if (category == EventCategory::Progression)
+		{
+			valid = RemovePrefix(eventId, "Start") || RemovePrefix(eventId, "Fail") || RemovePrefix(eventId, "Complete");
+		}
+		else if (category == EventCategory::Resource)
+		{
+			valid = RemovePrefix(eventId, "Sink") || RemovePrefix(eventId, "Source");
+		}
+
+		if (!valid || !EventSchema::IsValidEventId(category, eventId))
+		{
+			errors += std::string(errors.empty() ? "" : ",") + "{\"error_type\":\"regex\",\"path\":\"/event_id\"}";
+		}
+
+		if (category == EventCategory::Business && !EventSchema::IsValidCurrency(GetStringMember(event, "currency")))
+		{
+			errors += std::string(errors.empty() ? "" : ",") + "{\"error_type\":\"regex\",\"path\":\"/currency\"}";
+		}
+	}
+
+	// Checks whether the specified event has all members the backend requires, appending an error for each missing or invalid one.
+	void ValidateEvent(const std::string & event, std::string & errors)
+	{
+		std::vector<const char *> required = { "category", "v", "user_id", "session_id", "session_num", "client_ts" };
+		std::string category;
+
+		if (Json::TryGetMember(event, "category", category))
+		{
+			if (category == "\"business\"")
+			{
+				required.insert(required.end(), { "event_id", "amount", "currency", "transaction_num" });
+			}
+			else if (category == "\"design\"" || category == "\"progression\"")
+			{
+				required.push_back("event_id");
+			}
+			else if (category == "\"error\"")
+			{
+				required.insert(required.end(), { "severity", "message" });
+			}
+			else if (category == "\"resource\"")
+			{
+				required.insert(required.end(), { "event_id", "amount" });
+			}
+			else if (category == "\"session_end\"")
+			{
+				required.push_back("length");
+			}
+			else if (category != "\"user\"")
+			{
+				errors += std::string(errors.empty() ? "" : ",") + "{\"error_type\":\"enum\",\"path\":\"/category\"}";
+			}
+		}
+
+		std::string value;
+
+		for (auto name : required)
+		{
+			if (!Json::TryGetMember(event, name, value))
+			{
+				errors += std::string(errors.empty() ? "" : ",") + "{\"error_type\":\"required\",\"path\":\"/" + name + "\"}";
+			}
+		}
+
+		// Check event ids of the categories having them.
+		if (category == "\"business\"")
+		{
+			ValidateEventId(event, EventCategory::Business, errors);
+		}
+		else if (category == "\"design\"")
+		{
+			ValidateEventId(event, EventCategory::Design, errors);
+		}
+		else if (category == "\"progression\"")
+		{
+			ValidateEventId(event, EventCategory::Progression, errors);
+		}
+		else if (category == "\"resource\"")
+		{
+			ValidateEventId(event, EventCategory::Resource, errors);
+		}
+	}
+
+	// Checks all events of the specified batch, returning the errors as sent by the backend, or an empty string if all are valid.
+	// Events containing the specified text, if any, are rejected as well.
+	std::string ValidateEvents(const std::string & body, const std::string & rejectedText, uint64_t & eventCount)
+	{
+		std::vector<std::string> events;
+
+		if (!Json::TryGetElements(body, events))
+		{
+			return "[{\"errors\":[{\"error_type\":\"malformed\"}]}]";
+		}
+
+		eventCount = events.size();
+
+		std::string response;
+
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			std::string errors;
+			ValidateEvent(events[i], errors);
+
+			if (errors.empty() && !rejectedText.empty() && events[i].find(rejectedText) != std::string::npos)
+			{
+				errors = "{\"error_type\":\"rejected\"}";
+			}
+
+			if (!errors.empty())
+			{
+				response += std::string(response.empty() ? "[" : ",") + "{\"index\":" + std::to_string(i) + ",\"errors\":[" + errors + "]}";
+			}
+		}
+
+		return response.empty() ? response : response + "]";
+	}
+}
+
+
+LoopbackTransport::LoopbackTransport()
+	: latency(0),
+	bandwidth(0),
+	timeout(0),
+	maxRequestBytes(0),
+	stopping(false),
+	workerStopped(std::make_shared<std::atomic<bool>>(false))
+{
+	this->statistics.initRequests = 0;
+	this->statistics.eventsRequests = 0;
+	this->statistics.bytesReceived = 0;
+	this->statistics.eventsReceived = 0;
+	this->statistics.rejectedRequests = 0;
+	this->statistics.unauthorizedRequests = 0;
+	this->statistics.timedOutRequests = 0;
+	this->statistics.largestRequestBytes = 0;
+	this->statistics.maxPendingRequests = 0;
+}
+
+LoopbackTransport::~LoopbackTransport()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+	}
+
+	this->pendingChanged.notify_all();
+
+	if (!this->worker.joinable())
+	{
+		return;
+	}
+
+	this->workerStopped->store(true);
+
+	// Callbacks may release the last reference to this transport. The worker returns right after the callback then.
+	if (this->worker.get_id() == std::this_thread::get_id())
+	{
+		this->worker.detach();
+	}
+	else
+	{
+		this->worker.join();
+	}
+}
+
+void LoopbackTransport::Post(const TransportRequest & request, const Callback & callback)
+{
+	TransportResponse response;
+
+	auto now = std::chrono::system_clock::now().time_since_epoch();
+	response.serverTime = std::chrono::duration_cast<std::chrono::seconds>(now).count();
+
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		// Simulate the time for transferring the request and getting the response.
+		auto postTime = std::chrono::steady_clock::now();
+		std::chrono::steady_clock::duration delay = this->latency;
+
+		if (this->bandwidth > 0)
+		{
+			// Requests share the link, waiting for the ones posted before.
+			auto start = std::max(postTime, this->linkFreeTime);
+			auto transfer = std::chrono::duration<double>(static_cast<double>(request.body.size()) / this->bandwidth);
+
+			this->linkFreeTime = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(transfer);
+			delay += this->linkFreeTime - postTime;
+		}
+
+		if (this->timeout.count() > 0 && delay > this->timeout)
+		{
+			// Client gives up, aborting the transfer.
+			++this->statistics.timedOutRequests;
+
+			delay = this->timeout;
+			this->linkFreeTime = std::min(this->linkFreeTime, postTime + delay);
+
+			response.statusCode = 0;
+		}
+		else
+		{
+			this->statistics.bytesReceived += request.body.size();
+			this->statistics.largestRequestBytes = std::max<uint64_t>(this->statistics.largestRequestBytes, request.body.size());
+
+			// Verify signature of all requests, including init.
+			if (!this->secretKey.empty() && !this->IsAuthorized(request))
+			{
+				++this->statistics.unauthorizedRequests;
+
+				response.statusCode = 401;
+				response.body = "{\"error\":\"unauthorized\"}";
+			}
+			else if (EndsWith(request.url, "/init"))
+			{
+				++this->statistics.initRequests;
+
+				response.statusCode = 200;
+				response.body = "{\"enabled\":true,\"server_ts\":" + std::to_string(response.serverTime) + ",\"flags\":[]}";
+			}
+			else if (EndsWith(request.url, "/events"))
+			{
+				++this->statistics.eventsRequests;
+
+				response.statusCode = 200;
+				response.body = "{}";
+
+				// Refuse large requests like the backend, and inject failures.
+				if (this->maxRequestBytes > 0 && request.body.size() > this->maxRequestBytes)
+				{
+					response.statusCode = 413;
+					response.body.clear();
+				}
+				else if (!this->scriptedStatusCodes.empty())
+				{
+					response.statusCode = this->scriptedStatusCodes.front();
+					response.body.clear();
+					this->scriptedStatusCodes.pop_front();
+				}
+				else
+				{
+					this->ReceiveEvents(request, response);
+				}
+			}
+			else
+			{
+				response.statusCode = 404;
+			}
+		}
+
+		if (delay.count() > 0)
+		{
+			// Answer later.
+			PendingResponse pendingResponse;
+			pendingResponse.due = postTime + delay;
+			pendingResponse.response = response;
+			pendingResponse.callback = callback;
+
+			auto position = std::upper_bound(this->pending.begin(), this->pending.end(), pendingResponse.due, [](const std::chrono::steady_clock::time_point & due, const PendingResponse & other)
+			{
+				return due < other.due;
+			});
+
+			this->pending.insert(position, pendingResponse);
+			this->statistics.maxPendingRequests = std::max<uint64_t>(this->statistics.maxPendingRequests, this->pending.size());
+
+			if (!this->worker.joinable())
+			{
+				this->worker = std::thread(&LoopbackTransport::Run, this, this->workerStopped);
+			}
+
+			this->pendingChanged.notify_all();
+			return;
+		}
+
+		this->statistics.maxPendingRequests = std::max<uint64_t>(this->statistics.maxPendingRequests, 1);
+	}
+
+	callback(response);
+}
+
+LoopbackTransport::Statistics LoopbackTransport::GetStatistics() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->statistics;
+}
+
+void LoopbackTransport::SetLatency(const std::chrono::milliseconds latency)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->latency = latency;
+}
+
+void LoopbackTransport::SetBandwidth(const uint64_t bytesPerSecond)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->bandwidth = bytesPerSecond;
+}
+
+void LoopbackTransport::SetTimeout(const std::chrono::milliseconds timeout)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->timeout = timeout;
+}
+
+void LoopbackTransport::SetMaxRequestBytes(const size_t maxRequestBytes)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->maxRequestBytes = maxRequestBytes;
+}
+
+void LoopbackTransport::ScriptEventsResponses(const std::vector<int> & statusCodes)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->scriptedStatusCodes.insert(this->scriptedStatusCodes.end(), statusCodes.begin(), statusCodes.end());
+}
+
+void LoopbackTransport::SetRejectedText(const std::string & rejectedText)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->rejectedText = rejectedText;
+}
+
+void LoopbackTransport::SetSecretKey(const std::string & secretKey)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->secretKey = secretKey;
+}
+
+bool LoopbackTransport::IsAuthorized(const TransportRequest & request) const
+{
+	// Authorization is computed for the body as sent, i.e. compressed.
+	HmacSha256 signer(this->secretKey);
+	signer.Update(request.body.data(), request.body.size());
+
+	uint8_t mac[Sha256::DigestSize];
+	signer.Finish(mac);
+
+	return request.authorization == Base64Encode(mac, sizeof(mac));
+}
+
+void LoopbackTransport::ReceiveEvents(const TransportRequest & request, TransportResponse & response)
+{
+	std::string decompressedBody;
+
+	if (request.compressed && !GzipDecompress(reinterpret_cast<const uint8_t *>(request.body.data()), request.body.size(), decompressedBody))
+	{
+		++this->statistics.rejectedRequests;
+
+		response.statusCode = 400;
+		response.body = "[{\"errors\":[{\"error_type\":\"compression\"}]}]";
+		return;
+	}
+
+	auto & body = request.compressed ? decompressedBody : request.body;
+
+	// Check events.
+	uint64_t eventCount = 0;
+	auto errors = ValidateEvents(body, this->rejectedText, eventCount);
+
+	if (!errors.empty())
+	{
+		++this->statistics.rejectedRequests;
+
+		response.statusCode = 400;
+		response.body = errors;
+		return;
+	}
+
+	this->statistics.eventsReceived += eventCount;
+}
+
+void LoopbackTransport::Run(const std::shared_ptr<std::atomic<bool>> stopped)
+{
+	std::unique_lock<std::mutex> lock(this->mutex);
+
+	while (!this->stopping)
+	{
+		if (this->pending.empty())
+		{
+			this->pendingChanged.wait(lock);
+			continue;
+		}
+
+		if (std::chrono::steady_clock::now() < this->pending.front().due)
+		{
+			this->pendingChanged.wait_until(lock, this->pending.front().due);
+			continue;
+		}
+
+		auto pendingResponse = this->pending.front();
+		this->pending.pop_front();
+
+		// Callbacks may post new requests.
+		lock.unlock();
+		pendingResponse.callback(pendingResponse.response);
+
+		if (stopped->load())
+		{
+			return;
+		}
+
+		lock.lock();
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameAnalyticsTransport.h"
+
+namespace GameAnalytics
+{
+	// Stand-in for the GameAnalytics backend, answering all requests in-process.
+	// Enables running and profiling the whole event pipeline without network access.
+	// Answers immediately on the calling thread by default, or after a simulated network latency and bandwidth on a separate thread.
+	// Checks requests like the backend does: verifies their signature if a secret key is set, decompresses them,
+	// and rejects events batches with missing members, malformed event ids or currencies with status code 400.
+	// Failures can be injected for testing how the pipeline recovers from them, and slow connections simulated for testing how batches adapt to them.
+	class LoopbackTransport : public Transport
+	{
+	public:
+		// Numbers of requests and bytes received.
+		struct Statistics
+		{
+			uint64_t initRequests;
+			uint64_t eventsRequests;
+			uint64_t bytesReceived;
+			uint64_t eventsReceived;
+
+			// Numbers of events requests answered with status code 400 because of invalid events, and 401 because of an invalid signature.
+			uint64_t rejectedRequests;
+			uint64_t unauthorizedRequests;
+
+			// Number of requests that have timed out, and size of the largest request received, in bytes.
+			uint64_t timedOutRequests;
+			uint64_t largestRequestBytes;
+
+			// Highest number of requests that have been waiting for their response at the same time.
+			uint64_t maxPendingRequests;
+		};
+
+		LoopbackTransport();
+		~LoopbackTransport();
+
+		void Post(const TransportRequest & request, const Callback & callback) override;
+
+		// Gets the numbers of requests and bytes received so far.
+		Statistics GetStatistics() const;
+
+		// Sets the time to wait before answering each request. Requests are answered immediately if zero.
+		// Can be changed at any time, e.g. for simulating a mobile connection getting worse.
+		void SetLatency(const std::chrono::milliseconds latency);
+
+		// Transfers request bodies one after another at the specified number of bytes per second, adding to the latency. Unlimited if zero.
+		void SetBandwidth(const uint64_t bytesPerSecond);
+
+		// Answers requests with status code 0, like a client timing out, if answering them would take longer than the specified time. Disabled if zero.
+		void SetTimeout(const std::chrono::milliseconds timeout);
+
+		// Answers events requests with bodies larger than the specified number of bytes with status code 413, like the backend. Unlimited if zero.
+		void SetMaxRequestBytes(const size_t maxRequestBytes);
+
+		// Answers the next events requests with the specified HTTP status codes, one after another, e.g. 503 or 0 for being offline.
+		// Later requests are accepted again.
+		void ScriptEventsResponses(const std::vector<int> & statusCodes);
+
+		// Rejects all events requests with events containing the specified text with status code 400, reporting the index of each of these events
+		// like the backend does for invalid events. Bodies are checked after decompressing them. Nothing is rejected if empty.
+		void SetRejectedText(const std::string & rejectedText);
+
+		// Verifies the authorization of all requests with the specified secret key, answering status code 401 if it doesn't match.
+		// Nothing is verified if empty.
+		void SetSecretKey(const std::string & secretKey);
+
+	private:
+		// Response waiting for its simulated latency to pass.
+		struct PendingResponse
+		{
+			std::chrono::steady_clock::time_point due;
+			TransportResponse response;
+			Callback callback;
+		};
+
+		mutable std::mutex mutex;
+		Statistics statistics;
+
+		std::chrono::milliseconds latency;
+		uint64_t bandwidth;
+		std::chrono::milliseconds timeout;
+		size_t maxRequestBytes;
+
+		// Time the simulated link has transferred all requests posted so far.
+		std::chrono::steady_clock::time_point linkFreeTime;
+
+		std::deque<int> scriptedStatusCodes;
+		std::string rejectedText;
+		std::string secretKey;
+
+		// Responses ordered by the time they are due.
+		std::deque<PendingResponse> pending;
+		std::condition_variable pendingChanged;
+		std::thread worker;
+		bool stopping;
+
+		// Shared with the worker thread, so it can tell when it must not touch this transport anymore,
+		// e.g. because a callback has destroyed it.
+		std::shared_ptr<std::atomic<bool>> workerStopped;
+
+		// Checks whether the authorization of the specified request matches its body.
+		bool IsAuthorized(const TransportRequest & request) const;
+
+		// Checks the events of the specified request, setting the response to status code 400 if any is invalid.
+		void ReceiveEvents(const TransportRequest & request, TransportResponse & response);
+
+		// Delivers pending responses as soon as they are due.
+		void Run(const std::shared_ptr<std::atomic<bool>> stopped);
+	};
+}
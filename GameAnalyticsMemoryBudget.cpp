@@ -0,0 +1,100 @@
+#include "pch.h"
+
+#include "GameAnalyticsMemoryBudget.h"
+
+using namespace GameAnalytics;
+
+
+MemoryBudget::MemoryBudget()
+	: usedBytes(0),
+	highWaterBytes(0),
+	limitBytes(0)
+{
+}
+
+bool MemoryBudget::TryReserve(const size_t bytes, const MemoryPriority::MemoryPriority priority)
+{
+	auto limit = this->limitBytes.load(std::memory_order_relaxed);
+
+	if (limit == 0)
+	{
+		this->Reserve(bytes);
+		return true;
+	}
+
+	// Leave room for higher priorities.
+	switch (priority)
+	{
+	case MemoryPriority::Low:
+		limit /= 2;
+		break;
+
+	case MemoryPriority::Normal:
+		limit -= limit / 4;
+		break;
+
+	default:
+		break;
+	}
+
+	auto used = this->usedBytes.load(std::memory_order_relaxed);
+
+	do
+	{
+		if (used + bytes > limit)
+		{
+			return false;
+		}
+	}
+	while (!this->usedBytes.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+
+	this->UpdateHighWater(used + bytes);
+	return true;
+}
+
+void MemoryBudget::Reserve(const size_t bytes)
+{
+	auto used = this->usedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	this->UpdateHighWater(used);
+}
+
+void MemoryBudget::Release(const size_t bytes)
+{
+	this->usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+bool MemoryBudget::IsUnderPressure() const
+{
+	auto limit = this->limitBytes.load(std::memory_order_relaxed);
+	return limit > 0 && this->usedBytes.load(std::memory_order_relaxed) >= limit / 2;
+}
+
+size_t MemoryBudget::GetUsedBytes() const
+{
+	return this->usedBytes.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::GetHighWaterBytes() const
+{
+	return this->highWaterBytes.load(std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::GetLimitBytes() const
+{
+	return this->limitBytes.load(std::memory_order_relaxed);
+}
+
+void MemoryBudget::SetLimitBytes(const size_t limitBytes)
+{
+	this->limitBytes = limitBytes;
+}
+
+void MemoryBudget::UpdateHighWater(const size_t bytes)
+{
+	// New high-water marks become rare quickly.
+	auto highWater = this->highWaterBytes.load(std::memory_order_relaxed);
+
+	while (bytes > highWater && !this->highWaterBytes.compare_exchange_weak(highWater, bytes, std::memory_order_relaxed))
+	{
+	}
+}
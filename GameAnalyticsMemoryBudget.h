@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+#include "GameAnalyticsEventCategory.h"
+
+namespace GameAnalytics
+{
+	namespace MemoryPriority
+	{
+		// How long memory is granted as the budget fills up.
+		enum MemoryPriority
+		{
+			// Granted while less than half of the budget is used, e.g. for design events.
+			Low,
+
+			// Granted while less than three quarters of the budget are used, e.g. for error events and requests.
+			Normal,
+
+			// Granted until the budget is used up, e.g. for business and progression events.
+			High
+		};
+
+		// Gets the priority of memory for events of the specified category.
+		inline MemoryPriority ForCategory(const EventCategory::EventCategory category)
+		{
+			switch (category)
+			{
+			case EventCategory::Design:
+				return Low;
+
+			case EventCategory::Error:
+			case EventCategory::Resource:
+				return Normal;
+
+			default:
+				return High;
+			}
+		}
+	}
+
+	// Accounts for the memory used by queued events and requests being sent, against a fixed total budget.
+	// Memory of lower priority is refused before memory of higher priority, so the most valuable events are kept longest.
+	// Reserving memory takes a single compare-and-swap, without locking.
+	// Can be used by any number of threads at the same time.
+	class MemoryBudget
+	{
+	public:
+		MemoryBudget();
+
+		// Reserves the specified number of bytes, if granted by the budget for the specified priority.
+		bool TryReserve(const size_t bytes, const MemoryPriority::MemoryPriority priority);
+
+		// Reserves the specified number of bytes, even if that exceeds the budget, e.g. for memory that can't be done without.
+		void Reserve(const size_t bytes);
+
+		// Returns the specified number of reserved bytes to the budget.
+		void Release(const size_t bytes);
+
+		// Checks whether memory of low priority is refused already.
+		bool IsUnderPressure() const;
+
+		// Gets the number of bytes reserved right now.
+		size_t GetUsedBytes() const;
+
+		// Gets the highest number of bytes that have been reserved at the same time.
+		size_t GetHighWaterBytes() const;
+
+		// Gets the total budget in bytes, or 0 if unlimited.
+		size_t GetLimitBytes() const;
+
+		// Sets the total budget in bytes. 0 removes the limit.
+		void SetLimitBytes(const size_t limitBytes);
+
+	private:
+		std::atomic<size_t> usedBytes;
+		std::atomic<size_t> highWaterBytes;
+		std::atomic<size_t> limitBytes;
+
+		// Raises the high-water mark to the specified number of bytes, if higher.
+		void UpdateHighWater(const size_t bytes);
+	};
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+
+#include "GameAnalyticsKeyValueStore.h"
+
+namespace GameAnalytics
+{
+	// Keeps values in memory only, e.g. for profiling or load testing. Values are lost when the process ends.
+	class MemoryKeyValueStore : public KeyValueStore
+	{
+	public:
+		int GetInt32OrDefault(const std::string & key) const override
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+
+			auto it = this->values.find(key);
+			return it != this->values.end() ? it->second : 0;
+		}
+
+		void SetInt32(const std::string & key, const int value) override
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->values[key] = value;
+		}
+
+	private:
+		mutable std::mutex mutex;
+		std::map<std::string, int> values;
+	};
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+
+#include "GameAnalyticsMetrics.h"
+#include "GameAnalyticsFile.h"
+#include "GameAnalyticsJsonWriter.h"
+
+#include <cstdio>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	void WriteLatency(JsonWriter & writer, const char * name, const LatencySummary & latency)
+	{
+		writer.WriteName(name);
+		writer.BeginObject();
+		writer.WriteMember("count", static_cast<int64_t>(latency.count));
+		writer.WriteMember("mean", latency.mean);
+		writer.WriteMember("p50", latency.p50);
+		writer.WriteMember("p90", latency.p90);
+		writer.WriteMember("p99", latency.p99);
+		writer.WriteMember("max", latency.max);
+		writer.EndObject();
+	}
+}
+
+
+std::string GameAnalytics::MetricsToJson(const Metrics & metrics)
+{
+	JsonWriter writer;
+
+	writer.BeginObject();
+	writer.WriteMember("queued_events", static_cast<int64_t>(metrics.queuedEvents));
+	writer.WriteMember("dropped_events", static_cast<int64_t>(metrics.droppedEvents));
+	writer.WriteMember("limited_events", static_cast<int64_t>(metrics.limitedEvents));
+	writer.WriteMember("invalid_events", static_cast<int64_t>(metrics.invalidEvents));
+	writer.WriteMember("pending_events", static_cast<int64_t>(metrics.pendingEvents));
+	writer.WriteMember("stored_events", static_cast<int64_t>(metrics.storedEvents));
+	writer.WriteMember("store_bytes", static_cast<int64_t>(metrics.storeBytes));
+	writer.WriteMember("requests", static_cast<int64_t>(metrics.requests));
+	writer.WriteMember("failed_requests", static_cast<int64_t>(metrics.failedRequests));
+	writer.WriteMember("sent_bytes", static_cast<int64_t>(metrics.sentBytes));
+	writer.WriteMember("uncompressed_bytes", static_cast<int64_t>(metrics.uncompressedBytes));
+	writer.WriteMember("in_flight_batches", static_cast<int64_t>(metrics.inFlightBatches));
+	writer.WriteMember("batch_bytes", static_cast<int64_t>(metrics.batchBytes));
+	writer.WriteMember("throughput", static_cast<int64_t>(metrics.throughput));
+	writer.WriteMember("memory_bytes", static_cast<int64_t>(metrics.memoryBytes));
+	writer.WriteMember("memory_high_water_bytes", static_cast<int64_t>(metrics.memoryHighWaterBytes));
+	writer.WriteMember("memory_budget_bytes", static_cast<int64_t>(metrics.memoryBudgetBytes));
+
+	WriteLatency(writer, "enqueue", metrics.enqueue);
+	WriteLatency(writer, "serialize", metrics.serialize);
+	WriteLatency(writer, "sign", metrics.sign);
+	WriteLatency(writer, "compress", metrics.compress);
+	WriteLatency(writer, "upload", metrics.upload);
+	writer.EndObject();
+
+	return writer.GetString();
+}
+
+bool GameAnalytics::WriteMetricsFile(const std::filesystem::path & path, const Metrics & metrics)
+{
+	auto json = MetricsToJson(metrics);
+
+	// Replace file atomically, so it can be read at any time.
+	auto temporaryPath = path;
+	temporaryPath += ".tmp";
+
+	auto file = OpenFile(temporaryPath, L"wb");
+
+	if (file == nullptr)
+	{
+		return false;
+	}
+
+	auto written = fwrite(json.data(), 1, json.size(), file) == json.size();
+	written = fclose(file) == 0 && written;
+
+	// Keep the previous metrics rather than replacing them by truncated ones.
+	std::error_code error;
+
+	if (!written)
+	{
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+
+	std::filesystem::rename(temporaryPath, path, error);
+	return !error;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "GameAnalyticsLatencyHistogram.h"
+
+namespace GameAnalytics
+{
+	// Snapshot of what the GameAnalytics pipeline itself has done and cost so far.
+	struct Metrics
+	{
+		// Events added to the queue, and events dropped because the queue of the sending thread was full, the memory budget was used up,
+		// or they couldn't be stored on disk.
+		uint64_t queuedEvents;
+		uint64_t droppedEvents;
+
+		// Events dropped by sampling or rate limits.
+		uint64_t limitedEvents;
+
+		// Events dropped because the backend would have rejected them, e.g. because of malformed event ids, or values like NaN, which JSON can't represent.
+		uint64_t invalidEvents;
+
+		// Events in the queue, and events taken from the queue and stored on disk.
+		uint64_t pendingEvents;
+		uint64_t storedEvents;
+
+		// Size of all events on disk that have not been sent yet, in bytes.
+		uint64_t storeBytes;
+
+		// Requests sent to the backend, and requests that haven't been answered with success.
+		uint64_t requests;
+		uint64_t failedRequests;
+
+		// Size of all request bodies on the wire, and before compression, in bytes.
+		uint64_t sentBytes;
+		uint64_t uncompressedBytes;
+
+		// Batches currently waiting for their response.
+		size_t inFlightBatches;
+
+		// Current maximum size of new batches in bytes, and throughput measured for sending them in bytes per second, both before compression.
+		uint64_t batchBytes;
+		uint64_t throughput;
+
+		// Memory used by queued events and request bodies right now, at most so far, and allowed, in bytes. The budget is 0 if unlimited.
+		uint64_t memoryBytes;
+		uint64_t memoryHighWaterBytes;
+		uint64_t memoryBudgetBytes;
+
+		// Time for queueing a single event, sampled for every 64th event of each thread.
+		LatencySummary enqueue;
+
+		// Time for serializing all queued events with a single flush.
+		LatencySummary serialize;
+
+		// Time for signing and compressing a single request body.
+		LatencySummary sign;
+		LatencySummary compress;
+
+		// Time between sending a batch and receiving its response.
+		LatencySummary upload;
+	};
+
+	// Serializes the specified metrics as JSON object. Latencies are in microseconds.
+	std::string MetricsToJson(const Metrics & metrics);
+
+	// Replaces the specified file with the specified metrics as JSON object. Returns false if the file couldn't be written.
+	bool WriteMetricsFile(const std::filesystem::path & path, const Metrics & metrics);
+}
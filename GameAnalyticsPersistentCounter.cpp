@@ -0,0 +1,107 @@
+#include "pch.h"
+
+#include "GameAnalyticsPersistentCounter.h"
+
+#include <algorithm>
+
+using namespace GameAnalytics;
+
+
+PersistentCounter::PersistentCounter(const std::shared_ptr<KeyValueStore> & keyValueStore, const std::string & key, const int rangeSize)
+	: keyValueStore(keyValueStore),
+	key(key),
+	rangeSize(rangeSize),
+	last(0),
+	reserved(0),
+	stored(0),
+	reserving(false)
+{
+}
+
+void PersistentCounter::Load()
+{
+	std::lock_guard<std::mutex> lock(this->reserveMutex);
+
+	auto stored = this->keyValueStore->GetInt32OrDefault(this->key);
+
+	this->last = stored;
+	this->reserved = stored;
+	this->stored = stored;
+}
+
+int PersistentCounter::Next()
+{
+	auto number = ++this->last;
+
+	if (number <= this->reserved.load(std::memory_order_acquire))
+	{
+		return number;
+	}
+
+	std::unique_lock<std::mutex> lock(this->reserveMutex);
+
+	while (number > this->reserved)
+	{
+		if (this->reserving)
+		{
+			// Wait for another thread to store the next range, e.g. the worker flushing events.
+			this->reservedChanged.wait(lock);
+		}
+		else
+		{
+			// Numbers are handed out faster than ranges are reserved ahead, so the caller has to write to the store itself.
+			this->Reserve(lock, number + this->rangeSize - 1);
+		}
+	}
+
+	return number;
+}
+
+bool PersistentCounter::IsLow() const
+{
+	return this->reserved.load(std::memory_order_relaxed) - this->last.load(std::memory_order_relaxed) < this->rangeSize / 2;
+}
+
+bool PersistentCounter::ReserveAhead()
+{
+	std::unique_lock<std::mutex> lock(this->reserveMutex);
+
+	if (this->reserving)
+	{
+		return true;
+	}
+
+	// Store ranges again that have been handed out before without being stored.
+	if (this->IsLow() || this->stored < this->reserved)
+	{
+		return this->Reserve(lock, std::max(this->reserved.load(), this->last.load() + this->rangeSize));
+	}
+
+	return true;
+}
+
+bool PersistentCounter::Reserve(std::unique_lock<std::mutex> & lock, const int highest)
+{
+	// Don't block threads that only need numbers of the current range while writing.
+	this->reserving = true;
+	lock.unlock();
+
+	// Make sure the range is persisted before handing out any of its numbers.
+	this->keyValueStore->SetInt32(this->key, highest);
+	auto committed = this->keyValueStore->Commit();
+
+	lock.lock();
+	this->reserving = false;
+
+	if (committed)
+	{
+		this->stored = highest;
+	}
+
+	// Hand out numbers even if the store couldn't be written, e.g. because the disk is full, rather than stop sending business events.
+	// They are unique unless the app crashes before the range has been stored by a later call.
+	this->reserved.store(std::max(this->reserved.load(), highest), std::memory_order_release);
+	this->reservedChanged.notify_all();
+
+	return committed;
+}
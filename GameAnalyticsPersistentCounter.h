@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "GameAnalyticsKeyValueStore.h"
+
+namespace GameAnalytics
+{
+	// Hands out increasing numbers that are unique across sessions, such as transaction numbers.
+	// Reserves ranges of numbers in the key-value store ahead of time, so numbers stay unique even if the app crashes,
+	// while the store is written only once per range. Reserved numbers that have not been handed out are skipped by the next session.
+	class PersistentCounter
+	{
+	public:
+		PersistentCounter(const std::shared_ptr<KeyValueStore> & keyValueStore, const std::string & key, const int rangeSize);
+
+		// Loads the highest number reserved by previous sessions. Numbers handed out continue after that.
+		void Load();
+
+		// Gets the next number without locking or touching the store, as long as ReserveAhead is called often enough.
+		// Otherwise, waits for the reservation of the next range by another thread, or reserves it as a last resort.
+		int Next();
+
+		// Whether less than half of the reserved range is left, so ReserveAhead should be called soon.
+		bool IsLow() const;
+
+		// Reserves the next range if less than half of the current one is left, so Next doesn't have to.
+		// Should be called at points where writing to the store doesn't hurt, e.g. when flushing.
+		// Returns false if the store couldn't be written, in which case the range is stored again with the next call.
+		bool ReserveAhead();
+
+	private:
+		std::shared_ptr<KeyValueStore> keyValueStore;
+		std::string key;
+		int rangeSize;
+
+		// Last number handed out, and highest number that may be handed out.
+		std::atomic<int> last;
+		std::atomic<int> reserved;
+
+		// Highest number written to the store, and whether a thread is writing to the store right now.
+		int stored;
+		bool reserving;
+
+		std::mutex reserveMutex;
+		std::condition_variable reservedChanged;
+
+		// Stores the specified highest reserved number, releasing the specified lock of the reserve mutex while writing to the store.
+		bool Reserve(std::unique_lock<std::mutex> & lock, const int highest);
+	};
+}
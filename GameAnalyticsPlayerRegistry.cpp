@@ -0,0 +1,96 @@
+#include "pch.h"
+
+#include "GameAnalyticsPlayerRegistry.h"
+#include "GameAnalyticsEventIdRegistry.h"
+
+#include <stdexcept>
+
+using namespace GameAnalytics;
+
+
+PlayerRegistry::PlayerRegistry()
+	: nextHandle(1)
+{
+	for (auto & chunk : this->chunks)
+	{
+		chunk = nullptr;
+	}
+}
+
+PlayerRegistry::~PlayerRegistry()
+{
+	for (auto & chunk : this->chunks)
+	{
+		delete[] chunk.load();
+	}
+}
+
+uint32_t PlayerRegistry::Add(const std::string_view & userId)
+{
+	uint32_t handle;
+
+	if (!this->freeHandles.empty())
+	{
+		// Reuse released player.
+		handle = this->freeHandles.back();
+		this->freeHandles.pop_back();
+	}
+	else
+	{
+		handle = this->nextHandle;
+		auto chunk = (handle - 1) / ChunkSize;
+
+		if (chunk >= MaxChunks)
+		{
+			throw std::length_error("Too many players.");
+		}
+
+		// Allocate chunk before handing out its first handle, so looking up players never sees a missing chunk.
+		if (this->chunks[chunk].load(std::memory_order_relaxed) == nullptr)
+		{
+			this->chunks[chunk].store(new Player[ChunkSize], std::memory_order_release);
+		}
+
+		++this->nextHandle;
+	}
+
+	// Reset player.
+	auto & player = this->Get(handle);
+
+	player.userHash = 0;
+	player.progression = EventIdRegistry::None;
+	player.sessionStart = 0;
+	player.userId = userId;
+	player.sessionId.clear();
+	player.sessionNumber = 0;
+	player.birthYear = -1;
+	player.facebookId.clear();
+	player.gender = Gender::Unknown;
+	player.googlePlusId.clear();
+	player.annotations.clear();
+
+	return handle;
+}
+
+Player & PlayerRegistry::Get(const uint32_t handle) const
+{
+	auto index = handle - 1;
+	return this->chunks[index / ChunkSize].load(std::memory_order_acquire)[index % ChunkSize];
+}
+
+void PlayerRegistry::Remove(const uint32_t handle)
+{
+	this->removedHandles.push_back(handle);
+}
+
+void PlayerRegistry::BeginFlush()
+{
+	this->releasingHandles.insert(this->releasingHandles.end(), this->removedHandles.begin(), this->removedHandles.end());
+	this->removedHandles.clear();
+}
+
+void PlayerRegistry::EndFlush()
+{
+	this->freeHandles.insert(this->freeHandles.end(), this->releasingHandles.begin(), this->releasingHandles.end());
+	this->releasingHandles.clear();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "GameAnalyticsUserGender.h"
+
+namespace GameAnalytics
+{
+	// Handle of a player session reported on behalf of a player, e.g. by a dedicated game server.
+	struct PlayerContext
+	{
+		PlayerContext()
+			: handle(0)
+		{
+		}
+
+		explicit PlayerContext(const uint32_t handle)
+			: handle(handle)
+		{
+		}
+
+		bool IsValid() const
+		{
+			return this->handle != 0;
+		}
+
+		uint32_t handle;
+	};
+
+	// Session and user state of a single player.
+	struct Player
+	{
+		// Hash of the user id, for sampling.
+		uint32_t userHash;
+
+		// Handle of the current progression in the progression registry of the core, or EventIdRegistry::None.
+		std::atomic<uint16_t> progression;
+
+		// Local time the session has started at, in milliseconds.
+		int64_t sessionStart;
+
+		std::string userId;
+		std::string sessionId;
+		int sessionNumber;
+
+		int birthYear;
+		std::string facebookId;
+		Gender::Gender gender;
+		std::string googlePlusId;
+
+		// Annotations added to every event of this player, as JSON object members.
+		std::string annotations;
+	};
+
+	// Stores the state of many player sessions in chunks, referring to them by small integer handles.
+	// Looking up players doesn't lock, and can be done from any thread.
+	// Adding and removing players must not be done by multiple threads at the same time.
+	// Handles of removed players stay valid until the next flush has completed, so their queued events can still be serialized.
+	class PlayerRegistry
+	{
+	public:
+		// Handle never returned for a player.
+		static const uint32_t None = 0;
+
+		// Number of players allocated at once.
+		static const size_t ChunkSize = 1024;
+
+		PlayerRegistry();
+		~PlayerRegistry();
+
+		PlayerRegistry(const PlayerRegistry &) = delete;
+		PlayerRegistry & operator=(const PlayerRegistry &) = delete;
+
+		// Adds a player with the specified user id, returning its handle. Reuses the handles and memory of released players.
+		// Throws std::length_error if there are too many players.
+		uint32_t Add(const std::string_view & userId);
+
+		// Gets the player with the specified handle.
+		Player & Get(const uint32_t handle) const;
+
+		// Removes the player with the specified handle, releasing it as soon as a flush beginning afterwards has completed.
+		void Remove(const uint32_t handle);
+
+		// Marks all players removed so far to be released when the current flush has completed.
+		void BeginFlush();
+
+		// Releases all players removed before the current flush has begun.
+		void EndFlush();
+
+	private:
+		static const size_t MaxChunks = 1024;
+
+		std::atomic<Player *> chunks[MaxChunks];
+		uint32_t nextHandle;
+
+		std::vector<uint32_t> freeHandles;
+		std::vector<uint32_t> removedHandles;
+		std::vector<uint32_t> releasingHandles;
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
 
 namespace GameAnalytics
@@ -13,6 +14,26 @@ namespace GameAnalytics
 			Complete
 		};
 
+		// Gets the name of the specified progression status, as expected by the GameAnalytics backend.
+		inline const char * ToString(const ProgressionStatus status)
+		{
+			switch (status)
+			{
+			case Start:
+				return "Start";
+
+			case Fail:
+				return "Fail";
+
+			case Complete:
+				return "Complete";
+			}
+
+			// Unknown progression status.
+			throw std::invalid_argument("Unknown status: " + std::to_string(status));
+		}
+
+#ifdef __cplusplus_winrt
 		inline std::wstring ToWString(const ProgressionStatus status)
 		{
 			switch (status)
@@ -32,5 +53,6 @@ namespace GameAnalytics
 			auto messageString = ref new Platform::String(message.c_str());
 			throw ref new Platform::FailureException(messageString);
 		}
+#endif
 	}
 }
\ No newline at end of file
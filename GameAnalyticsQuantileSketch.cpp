@@ -0,0 +1,128 @@
+#include "pch.h"
+
+#include "GameAnalyticsQuantileSketch.h"
+
+#include <cmath>
+#include <iterator>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Relative accuracy of estimated values.
+	const double RelativeAccuracy = 0.01;
+
+	// Bucket i covers values between Gamma^(i - 1) and Gamma^i.
+	const double Gamma = (1 + RelativeAccuracy) / (1 - RelativeAccuracy);
+	const double LogGamma = std::log(Gamma);
+
+	// Values of smaller magnitude are counted as zero.
+	const double MinValue = 1e-9;
+
+	// Maximum number of buckets for positive and negative values each. Covers values from 1 to 1e11 without collapsing.
+	const size_t MaxBuckets = 1280;
+}
+
+
+QuantileSketch::QuantileSketch()
+	: zeroCount(0),
+	count(0)
+{
+}
+
+void QuantileSketch::Add(const double value)
+{
+	++this->count;
+
+	if (value > MinValue)
+	{
+		++this->positive[this->GetIndex(value)];
+		this->Collapse(this->positive);
+	}
+	else if (value < -MinValue)
+	{
+		++this->negative[this->GetIndex(-value)];
+		this->Collapse(this->negative);
+	}
+	else
+	{
+		++this->zeroCount;
+	}
+}
+
+double QuantileSketch::GetQuantile(const double quantile) const
+{
+	if (this->count == 0)
+	{
+		return 0;
+	}
+
+	auto rank = static_cast<uint64_t>(quantile * (this->count - 1));
+	uint64_t seen = 0;
+
+	// Walk buckets in ascending order of their values: negative values of decreasing magnitude, zero, positive values.
+	for (auto it = this->negative.rbegin(); it != this->negative.rend(); ++it)
+	{
+		seen += it->second;
+
+		if (seen > rank)
+		{
+			return -this->GetValue(it->first);
+		}
+	}
+
+	seen += this->zeroCount;
+
+	if (seen > rank)
+	{
+		return 0;
+	}
+
+	for (auto & bucket : this->positive)
+	{
+		seen += bucket.second;
+
+		if (seen > rank)
+		{
+			return this->GetValue(bucket.first);
+		}
+	}
+
+	return this->positive.empty() ? 0 : this->GetValue(this->positive.rbegin()->first);
+}
+
+uint64_t QuantileSketch::GetCount() const
+{
+	return this->count;
+}
+
+void QuantileSketch::Clear()
+{
+	this->positive.clear();
+	this->negative.clear();
+	this->zeroCount = 0;
+	this->count = 0;
+}
+
+int QuantileSketch::GetIndex(const double value) const
+{
+	return static_cast<int>(std::ceil(std::log(value) / LogGamma));
+}
+
+double QuantileSketch::GetValue(const int index) const
+{
+	// Halfway between the bucket bounds, relative to their size.
+	return 2 * std::pow(Gamma, index) / (Gamma + 1);
+}
+
+void QuantileSketch::Collapse(std::map<int, uint32_t> & buckets)
+{
+	while (buckets.size() > MaxBuckets)
+	{
+		auto smallest = buckets.begin();
+		auto next = std::next(smallest);
+
+		next->second += smallest->second;
+		buckets.erase(smallest);
+	}
+}
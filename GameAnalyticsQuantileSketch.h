@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace GameAnalytics
+{
+	// Estimates quantiles of a stream of values with bounded relative error, using logarithmically sized buckets.
+	// Any value is estimated within 1% of its true value, as long as the number of buckets stays below the maximum.
+	// Otherwise, the buckets of the smallest magnitudes are merged, which affects only the accuracy of the lowest quantiles.
+	class QuantileSketch
+	{
+	public:
+		QuantileSketch();
+
+		// Adds the specified value.
+		void Add(const double value);
+
+		// Gets the estimated value at the specified quantile between 0 and 1, or 0 if no values have been added.
+		double GetQuantile(const double quantile) const;
+
+		// Gets the number of values added.
+		uint64_t GetCount() const;
+
+		// Removes all values.
+		void Clear();
+
+	private:
+		// Counts of positive and negative values by bucket index, and of values too close to zero for any bucket.
+		std::map<int, uint32_t> positive;
+		std::map<int, uint32_t> negative;
+		uint64_t zeroCount;
+		uint64_t count;
+
+		// Gets the index of the bucket for the specified positive value.
+		int GetIndex(const double value) const;
+
+		// Gets the value representing the bucket with the specified index.
+		double GetValue(const int index) const;
+
+		// Merges the buckets of the smallest magnitudes until at most the maximum number of buckets is used.
+		void Collapse(std::map<int, uint32_t> & buckets);
+	};
+}
@@ -0,0 +1,136 @@
+#include "pch.h"
+
+#include "GameAnalyticsRequestBuilder.h"
+#include "GameAnalyticsBase64.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Size of the pieces of request bodies to process at a time, small enough for signing the output while still in cache,
+	// and for compressing a piece within a few hundred microseconds.
+	const size_t ChunkBytes = 4 * 1024;
+}
+
+
+RequestBuilder::RequestBuilder(const std::string & url, std::string body, const HmacSha256 & signer, const bool compress, const ServerClock * clock)
+	: body(std::move(body)),
+	signer(signer),
+	compressor(compress ? new GzipCompressor() : nullptr),
+	compressing(compress),
+	bodySize(this->body.size()),
+	offset(0),
+	signedBytes(0),
+	clock(clock),
+	signTime(0),
+	compressTime(0)
+{
+	this->request.url = url;
+	this->request.compressed = false;
+}
+
+bool RequestBuilder::Continue()
+{
+	// Measure signing and compressing separately, although they are interleaved.
+	auto lapStart = this->clock != nullptr ? this->clock->GetLocalNanoseconds() : 0;
+	auto length = std::min(ChunkBytes, this->body.size() - this->offset);
+
+	if (!this->compressing)
+	{
+		// Sign uncompressed body.
+		this->signer.Update(this->body.data() + this->offset, length);
+		this->offset += length;
+
+		if (this->offset < this->body.size())
+		{
+			this->Lap(lapStart, this->signTime);
+			return false;
+		}
+
+		this->request.body = std::move(this->body);
+		this->Finish();
+
+		this->Lap(lapStart, this->signTime);
+		return true;
+	}
+
+	auto & compressedBody = this->compressor->GetOutput();
+
+	if (this->offset < this->body.size())
+	{
+		this->compressor->Write(this->body.data() + this->offset, length);
+		this->offset += length;
+		this->Lap(lapStart, this->compressTime);
+
+		this->signer.Update(compressedBody.data() + this->signedBytes, compressedBody.size() - this->signedBytes);
+		this->signedBytes = compressedBody.size();
+		this->Lap(lapStart, this->signTime);
+		return false;
+	}
+
+	this->compressor->Finish();
+	this->Lap(lapStart, this->compressTime);
+
+	// Compress body, if worth it.
+	if (compressedBody.size() < this->body.size())
+	{
+		this->signer.Update(compressedBody.data() + this->signedBytes, compressedBody.size() - this->signedBytes);
+
+		this->request.body.assign(compressedBody.begin(), compressedBody.end());
+		this->request.compressed = true;
+		this->compressor.reset();
+		this->Finish();
+
+		this->Lap(lapStart, this->signTime);
+		return true;
+	}
+
+	// Sign the uncompressed body from the start.
+	this->signer.Reset();
+	this->compressor.reset();
+	this->compressing = false;
+	this->offset = 0;
+
+	this->Lap(lapStart, this->signTime);
+	return false;
+}
+
+TransportRequest & RequestBuilder::GetRequest()
+{
+	return this->request;
+}
+
+size_t RequestBuilder::GetBodySize() const
+{
+	return this->bodySize;
+}
+
+int64_t RequestBuilder::GetSignTime() const
+{
+	return this->signTime;
+}
+
+int64_t RequestBuilder::GetCompressTime() const
+{
+	return this->compressTime;
+}
+
+void RequestBuilder::Lap(int64_t & lapStart, int64_t & time) const
+{
+	if (this->clock != nullptr)
+	{
+		auto now = this->clock->GetLocalNanoseconds();
+		time += now - lapStart;
+		lapStart = now;
+	}
+}
+
+void RequestBuilder::Finish()
+{
+	uint8_t mac[Sha256::DigestSize];
+	this->signer.Finish(mac);
+	this->request.authorization = Base64Encode(mac, sizeof(mac));
+}
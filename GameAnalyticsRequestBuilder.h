@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "GameAnalyticsGzip.h"
+#include "GameAnalyticsServerClock.h"
+#include "GameAnalyticsSha256.h"
+#include "GameAnalyticsTransport.h"
+
+namespace GameAnalytics
+{
+	// Builds a signed and, if worth it, compressed request for the GameAnalytics backend, a small piece of the body at a time,
+	// so building large requests can be spread across frames. Signs the data actually sent, while it is being compressed.
+	class RequestBuilder
+	{
+	public:
+		// Starts building a request with the specified URL and body, signed with a copy of the specified signer.
+		// Measures the time for signing and compressing with the specified clock, if not null.
+		RequestBuilder(const std::string & url, std::string body, const HmacSha256 & signer, const bool compress, const ServerClock * clock);
+
+		// Signs and compresses the next piece of the body. Returns true if the request is complete.
+		bool Continue();
+
+		// Gets the request, which is complete after Continue has returned true.
+		TransportRequest & GetRequest();
+
+		// Gets the size of the body before compression, in bytes.
+		size_t GetBodySize() const;
+
+		// Gets the time spent signing and compressing so far, in nanoseconds, if measured. No time is spent compressing bodies too small to be worth it.
+		int64_t GetSignTime() const;
+		int64_t GetCompressTime() const;
+
+	private:
+		TransportRequest request;
+		std::string body;
+
+		HmacSha256 signer;
+
+		// Created only if the body is compressed, because of its tables.
+		std::unique_ptr<GzipCompressor> compressor;
+
+		// Whether the body is still being compressed.
+		bool compressing;
+
+		// Bytes of the body before compression, bytes of the body processed, and bytes of the compressed body signed so far.
+		size_t bodySize;
+		size_t offset;
+		size_t signedBytes;
+
+		const ServerClock * clock;
+		int64_t signTime;
+		int64_t compressTime;
+
+		// Adds the time since the specified start to the specified total, and restarts measuring.
+		void Lap(int64_t & lapStart, int64_t & time) const;
+
+		// Completes the signature of the request.
+		void Finish();
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
 
 namespace GameAnalytics
@@ -12,6 +13,23 @@ namespace GameAnalytics
 			Source
 		};
 
+		// Gets the name of the specified flow type, as expected by the GameAnalytics backend.
+		inline const char * ToString(const FlowType flowType)
+		{
+			switch (flowType)
+			{
+			case Sink:
+				return "Sink";
+
+			case Source:
+				return "Source";
+			}
+
+			// Unknown flow type.
+			throw std::invalid_argument("Unknown flow type: " + std::to_string(flowType));
+		}
+
+#ifdef __cplusplus_winrt
 		inline std::wstring ToWString(const FlowType flowType)
 		{
 			switch (flowType)
@@ -28,5 +46,6 @@ namespace GameAnalytics
 			auto messageString = ref new Platform::String(message.c_str());
 			throw ref new Platform::FailureException(messageString);
 		}
+#endif
 	}
 }
\ No newline at end of file
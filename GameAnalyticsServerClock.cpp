@@ -0,0 +1,79 @@
+#include "pch.h"
+
+#include "GameAnalyticsServerClock.h"
+
+#include <chrono>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Corrections larger than this are applied at once, in milliseconds.
+	const int64_t MaxSmoothedCorrection = 10 * 1000;
+
+	// Share of each smaller correction applied, as a power of two. Averages out the imprecision of single measurements.
+	const int CorrectionShift = 3;
+}
+
+
+ServerClock::ServerClock(const std::shared_ptr<Clock> & clock)
+	: clock(clock),
+	startTicks(clock->GetTicks()),
+	millisecondsPerTick(1000.0 / clock->GetTicksPerSecond()),
+	nanosecondsPerTick(1000000000.0 / clock->GetTicksPerSecond()),
+	offset(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()),
+	synchronized(false)
+{
+}
+
+int64_t ServerClock::GetLocalMilliseconds() const
+{
+	return static_cast<int64_t>((this->clock->GetTicks() - this->startTicks) * this->millisecondsPerTick);
+}
+
+int64_t ServerClock::GetLocalNanoseconds() const
+{
+	return static_cast<int64_t>((this->clock->GetTicks() - this->startTicks) * this->nanosecondsPerTick);
+}
+
+int64_t ServerClock::ToServerMilliseconds(const int64_t localMilliseconds) const
+{
+	return localMilliseconds + this->offset.load(std::memory_order_relaxed);
+}
+
+bool ServerClock::IsSynchronized() const
+{
+	return this->synchronized;
+}
+
+void ServerClock::Synchronize(const int64_t serverMilliseconds, const int64_t precision, const int64_t requestMilliseconds, const int64_t responseMilliseconds)
+{
+	// Assume the server time has been taken halfway through the round trip, and lies in the middle of its precision.
+	auto localMilliseconds = requestMilliseconds + (responseMilliseconds - requestMilliseconds) / 2;
+	auto measuredOffset = serverMilliseconds + precision / 2 - localMilliseconds;
+
+	if (!this->synchronized.exchange(true))
+	{
+		this->offset = measuredOffset;
+		return;
+	}
+
+	// Responses may arrive on any thread.
+	auto currentOffset = this->offset.load();
+	int64_t newOffset;
+
+	do
+	{
+		auto correction = measuredOffset - currentOffset;
+
+		if (correction > MaxSmoothedCorrection || correction < -MaxSmoothedCorrection)
+		{
+			newOffset = measuredOffset;
+		}
+		else
+		{
+			newOffset = currentOffset + correction / (1 << CorrectionShift);
+		}
+	}
+	while (!this->offset.compare_exchange_weak(currentOffset, newOffset));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "GameAnalyticsClock.h"
+
+namespace GameAnalytics
+{
+	// Estimates the time of the GameAnalytics backend from a local monotonic clock.
+	// Reads the clock frequency only once, so getting the local time costs one counter read and one multiplication.
+	// The offset to the server time is synchronized with every server response, smoothing out small corrections
+	// and applying large ones at once, e.g. after the device has been suspended or its counter has been reset.
+	// Until synchronized for the first time, the system clock of the device is assumed to be right.
+	// Can be used by any number of threads at the same time.
+	class ServerClock
+	{
+	public:
+		explicit ServerClock(const std::shared_ptr<Clock> & clock);
+
+		// Gets the time since this clock has been created, in milliseconds.
+		int64_t GetLocalMilliseconds() const;
+
+		// Gets the time since this clock has been created, in nanoseconds. Used for measuring short durations.
+		int64_t GetLocalNanoseconds() const;
+
+		// Converts the specified time since this clock has been created to server time, in milliseconds since the epoch.
+		int64_t ToServerMilliseconds(const int64_t localMilliseconds) const;
+
+		// Checks whether the server time has been received at least once.
+		bool IsSynchronized() const;
+
+		// Adjusts the offset to the specified server time in milliseconds since the epoch, with the specified precision in milliseconds,
+		// received in response to a request sent and answered at the specified local times.
+		void Synchronize(const int64_t serverMilliseconds, const int64_t precision, const int64_t requestMilliseconds, const int64_t responseMilliseconds);
+
+	private:
+		std::shared_ptr<Clock> clock;
+		int64_t startTicks;
+		double millisecondsPerTick;
+		double nanosecondsPerTick;
+
+		// Server time minus local time, in milliseconds.
+		std::atomic<int64_t> offset;
+		std::atomic<bool> synchronized;
+	};
+}
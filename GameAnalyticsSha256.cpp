@@ -0,0 +1,393 @@
+#include "pch.h"
+
+#include "GameAnalyticsSha256.h"
+
+#include <cstring>
+
+#if (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#define GAMEANALYTICS_SHA_NI
+#define GAMEANALYTICS_TARGET_SHA_NI
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <cpuid.h>
+#include <immintrin.h>
+#define GAMEANALYTICS_SHA_NI
+#define GAMEANALYTICS_TARGET_SHA_NI __attribute__((target("sha,sse4.1")))
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const uint32_t RoundConstants[64] =
+	{
+		0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+		0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+		0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+		0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+		0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+		0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+		0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+		0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+	};
+
+	inline uint32_t RotateRight(const uint32_t value, const int bits)
+	{
+		return (value >> bits) | (value << (32 - bits));
+	}
+
+	typedef void(*TransformFunction)(uint32_t * state, const uint8_t * blocks, const size_t count);
+
+	void TransformPortable(uint32_t * state, const uint8_t * blocks, const size_t count)
+	{
+		uint32_t w[64];
+
+		for (size_t n = 0; n < count; ++n)
+		{
+			auto block = blocks + n * Sha256::BlockSize;
+
+			for (auto i = 0; i < 16; ++i)
+			{
+				w[i] = (static_cast<uint32_t>(block[4 * i]) << 24)
+					| (static_cast<uint32_t>(block[4 * i + 1]) << 16)
+					| (static_cast<uint32_t>(block[4 * i + 2]) << 8)
+					| static_cast<uint32_t>(block[4 * i + 3]);
+			}
+
+			for (auto i = 16; i < 64; ++i)
+			{
+				auto s0 = RotateRight(w[i - 15], 7) ^ RotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+				auto s1 = RotateRight(w[i - 2], 17) ^ RotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+				w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+			}
+
+			auto a = state[0];
+			auto b = state[1];
+			auto c = state[2];
+			auto d = state[3];
+			auto e = state[4];
+			auto f = state[5];
+			auto g = state[6];
+			auto h = state[7];
+
+			for (auto i = 0; i < 64; ++i)
+			{
+				auto s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+				auto ch = (e & f) ^ (~e & g);
+				auto t1 = h + s1 + ch + RoundConstants[i] + w[i];
+				auto s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+				auto maj = (a & b) ^ (a & c) ^ (b & c);
+				auto t2 = s0 + maj;
+
+				h = g;
+				g = f;
+				f = e;
+				e = d + t1;
+				d = c;
+				c = b;
+				b = a;
+				a = t1 + t2;
+			}
+
+			state[0] += a;
+			state[1] += b;
+			state[2] += c;
+			state[3] += d;
+			state[4] += e;
+			state[5] += f;
+			state[6] += g;
+			state[7] += h;
+		}
+	}
+
+#ifdef GAMEANALYTICS_SHA_NI
+	// Checks whether the processor supports the SHA extensions, and SSE4.1 required for preparing their operands.
+	bool IsShaNiSupported()
+	{
+#ifdef _MSC_VER
+		int registers[4];
+
+		__cpuid(registers, 0);
+
+		if (registers[0] < 7)
+		{
+			return false;
+		}
+
+		__cpuid(registers, 1);
+		auto sse41 = (registers[2] & (1 << 19)) != 0;
+
+		__cpuidex(registers, 7, 0);
+		auto sha = (registers[1] & (1 << 29)) != 0;
+
+		return sse41 && sha;
+#else
+		unsigned int eax, ebx, ecx, edx;
+
+		if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || (ecx & (1 << 19)) == 0)
+		{
+			return false;
+		}
+
+		if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+		{
+			return false;
+		}
+
+		return (ebx & (1 << 29)) != 0;
+#endif
+	}
+
+	// Each SHA256RNDS2 instruction performs two rounds, on the state split into the ABEF and CDGH words.
+	// SHA256MSG1 and SHA256MSG2 compute the message schedule, four words at a time.
+	GAMEANALYTICS_TARGET_SHA_NI void TransformShaNi(uint32_t * state, const uint8_t * blocks, const size_t count)
+	{
+		// Converts big-endian message words.
+		const auto byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bull, 0x0405060700010203ull);
+
+		// Rearrange state from ABCD EFGH to ABEF CDGH.
+		auto dcba = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state));
+		auto hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i *>(state + 4));
+
+		auto cdab = _mm_shuffle_epi32(dcba, 0xB1);
+		auto efgh = _mm_shuffle_epi32(hgfe, 0x1B);
+		auto abef = _mm_alignr_epi8(cdab, efgh, 8);
+		auto cdgh = _mm_blend_epi16(efgh, cdab, 0xF0);
+
+		for (size_t n = 0; n < count; ++n)
+		{
+			auto block = blocks + n * Sha256::BlockSize;
+
+			auto abefStart = abef;
+			auto cdghStart = cdgh;
+
+			__m128i message[4];
+
+			for (auto i = 0; i < 16; ++i)
+			{
+				auto & current = message[i & 3];
+
+				if (i < 4)
+				{
+					current = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i)), byteSwap);
+				}
+
+				// Rounds 4i to 4i + 3.
+				auto words = _mm_add_epi32(current, _mm_loadu_si128(reinterpret_cast<const __m128i *>(RoundConstants + 4 * i)));
+				cdgh = _mm_sha256rnds2_epu32(cdgh, abef, words);
+
+				// Complete message words four rounds ahead.
+				if (i >= 3 && i < 15)
+				{
+					auto & next = message[(i + 1) & 3];
+					next = _mm_add_epi32(next, _mm_alignr_epi8(current, message[(i - 1) & 3], 4));
+					next = _mm_sha256msg2_epu32(next, current);
+				}
+
+				words = _mm_shuffle_epi32(words, 0x0E);
+				abef = _mm_sha256rnds2_epu32(abef, cdgh, words);
+
+				// Start message words eight rounds ahead.
+				if (i >= 1 && i < 13)
+				{
+					auto & previous = message[(i - 1) & 3];
+					previous = _mm_sha256msg1_epu32(previous, current);
+				}
+			}
+
+			abef = _mm_add_epi32(abef, abefStart);
+			cdgh = _mm_add_epi32(cdgh, cdghStart);
+		}
+
+		// Rearrange state back to ABCD EFGH.
+		auto feba = _mm_shuffle_epi32(abef, 0x1B);
+		auto dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(state), _mm_blend_epi16(feba, dchg, 0xF0));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(state + 4), _mm_alignr_epi8(dchg, feba, 8));
+	}
+#endif
+
+	// Checks the processor only once.
+#ifdef GAMEANALYTICS_SHA_NI
+	const bool ShaNiSupported = IsShaNiSupported();
+#else
+	const bool ShaNiSupported = false;
+#endif
+
+	TransformFunction SelectTransform(const bool accelerated)
+	{
+#ifdef GAMEANALYTICS_SHA_NI
+		if (accelerated && ShaNiSupported)
+		{
+			return TransformShaNi;
+		}
+#endif
+
+		return TransformPortable;
+	}
+
+	TransformFunction TransformBlocks = SelectTransform(true);
+}
+
+
+Sha256::Sha256()
+{
+	this->Reset();
+}
+
+void Sha256::Update(const void * data, const size_t length)
+{
+	auto bytes = static_cast<const uint8_t *>(data);
+	auto remaining = length;
+
+	this->length += length;
+
+	// Fill partial block first.
+	if (this->bufferLength > 0)
+	{
+		auto count = BlockSize - this->bufferLength;
+
+		if (count > remaining)
+		{
+			count = remaining;
+		}
+
+		memcpy(this->buffer + this->bufferLength, bytes, count);
+		this->bufferLength += count;
+		bytes += count;
+		remaining -= count;
+
+		if (this->bufferLength < BlockSize)
+		{
+			return;
+		}
+
+		this->Transform(this->buffer, 1);
+		this->bufferLength = 0;
+	}
+
+	// Process full blocks without copying.
+	auto blocks = remaining / BlockSize;
+
+	if (blocks > 0)
+	{
+		this->Transform(bytes, blocks);
+		bytes += blocks * BlockSize;
+		remaining -= blocks * BlockSize;
+	}
+
+	memcpy(this->buffer, bytes, remaining);
+	this->bufferLength = remaining;
+}
+
+void Sha256::Finish(uint8_t * digest)
+{
+	auto bitLength = this->length * 8;
+
+	// Pad with a single one bit, zeros and the message length in bits.
+	const uint8_t padding[BlockSize] = { 0x80 };
+	auto paddingLength = (this->bufferLength < 56) ? 56 - this->bufferLength : 120 - this->bufferLength;
+	this->Update(padding, paddingLength);
+
+	uint8_t lengthBytes[8];
+
+	for (auto i = 0; i < 8; ++i)
+	{
+		lengthBytes[i] = static_cast<uint8_t>(bitLength >> (56 - 8 * i));
+	}
+
+	this->Update(lengthBytes, sizeof(lengthBytes));
+
+	for (auto i = 0; i < 8; ++i)
+	{
+		digest[4 * i] = static_cast<uint8_t>(this->state[i] >> 24);
+		digest[4 * i + 1] = static_cast<uint8_t>(this->state[i] >> 16);
+		digest[4 * i + 2] = static_cast<uint8_t>(this->state[i] >> 8);
+		digest[4 * i + 3] = static_cast<uint8_t>(this->state[i]);
+	}
+}
+
+void Sha256::Reset()
+{
+	this->state[0] = 0x6a09e667;
+	this->state[1] = 0xbb67ae85;
+	this->state[2] = 0x3c6ef372;
+	this->state[3] = 0xa54ff53a;
+	this->state[4] = 0x510e527f;
+	this->state[5] = 0x9b05688c;
+	this->state[6] = 0x1f83d9ab;
+	this->state[7] = 0x5be0cd19;
+
+	this->length = 0;
+	this->bufferLength = 0;
+}
+
+
+bool Sha256::IsAccelerationSupported()
+{
+	return ShaNiSupported;
+}
+
+void Sha256::SetAccelerationEnabled(const bool enabled)
+{
+	TransformBlocks = SelectTransform(enabled);
+}
+
+void Sha256::Transform(const uint8_t * blocks, const size_t count)
+{
+	TransformBlocks(this->state, blocks, count);
+}
+
+HmacSha256::HmacSha256(const std::string & key)
+{
+	uint8_t keyBlock[Sha256::BlockSize] = { 0 };
+
+	// Keys longer than the block size are hashed first.
+	if (key.size() > Sha256::BlockSize)
+	{
+		Sha256 keyHash;
+		keyHash.Update(key.data(), key.size());
+		keyHash.Finish(keyBlock);
+	}
+	else
+	{
+		memcpy(keyBlock, key.data(), key.size());
+	}
+
+	uint8_t innerPad[Sha256::BlockSize];
+	uint8_t outerPad[Sha256::BlockSize];
+
+	for (size_t i = 0; i < Sha256::BlockSize; ++i)
+	{
+		innerPad[i] = keyBlock[i] ^ 0x36;
+		outerPad[i] = keyBlock[i] ^ 0x5C;
+	}
+
+	this->innerStart.Update(innerPad, sizeof(innerPad));
+	this->outerStart.Update(outerPad, sizeof(outerPad));
+
+	this->inner = this->innerStart;
+}
+
+void HmacSha256::Update(const void * data, const size_t length)
+{
+	this->inner.Update(data, length);
+}
+
+void HmacSha256::Finish(uint8_t * mac)
+{
+	// Compute H((K ^ opad) || H((K ^ ipad) || data)).
+	uint8_t innerDigest[Sha256::DigestSize];
+	this->inner.Finish(innerDigest);
+
+	auto outer = this->outerStart;
+	outer.Update(innerDigest, sizeof(innerDigest));
+	outer.Finish(mac);
+}
+
+void HmacSha256::Reset()
+{
+	this->inner = this->innerStart;
+}
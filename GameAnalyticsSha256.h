@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace GameAnalytics
+{
+	// Computes SHA-256 hashes (FIPS 180-4) of data passed in as many pieces as required.
+	// Uses the SHA extensions of x86 processors if available.
+	class Sha256
+	{
+	public:
+		static const size_t BlockSize = 64;
+		static const size_t DigestSize = 32;
+
+		Sha256();
+
+		// Hashes the specified data.
+		void Update(const void * data, const size_t length);
+
+		// Completes the hash, and writes the resulting digest to the specified buffer.
+		void Finish(uint8_t * digest);
+
+		// Discards all data, starting a new hash.
+		void Reset();
+
+		// Checks whether this processor supports the SHA extensions.
+		static bool IsAccelerationSupported();
+
+		// Uses the SHA extensions, if supported, or the portable implementation for all blocks hashed afterwards, e.g. for comparing both.
+		// Uses the SHA extensions by default. Must not be called while hashes are being computed.
+		static void SetAccelerationEnabled(const bool enabled);
+
+	private:
+		uint32_t state[8];
+		uint64_t length;
+
+		uint8_t buffer[BlockSize];
+		size_t bufferLength;
+
+		// Processes the specified number of blocks of 64 bytes.
+		void Transform(const uint8_t * blocks, const size_t count);
+	};
+
+	// Computes HMAC SHA256 (RFC 2104) message authentication codes with a fixed key, of data passed in as many pieces as required.
+	// The padded key blocks are hashed only once, so each code costs just the data and two more blocks.
+	// Copying is cheap, so a prepared instance can be copied for each message.
+	class HmacSha256
+	{
+	public:
+		explicit HmacSha256(const std::string & key);
+
+		// Authenticates the specified data.
+		void Update(const void * data, const size_t length);
+
+		// Completes the code, and writes it to the specified buffer of Sha256::DigestSize bytes.
+		void Finish(uint8_t * mac);
+
+		// Discards all data, starting a new code with the same key.
+		void Reset();
+
+	private:
+		// States after hashing the inner and outer padded key block.
+		Sha256 innerStart;
+		Sha256 outerStart;
+
+		Sha256 inner;
+	};
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "GameAnalyticsDeviceInfo.h"
+
+namespace GameAnalytics
+{
+	// Provides fixed device info, e.g. for platforms without native device info or for load testing.
+	class StaticDeviceInfo : public DeviceInfo
+	{
+	public:
+		StaticDeviceInfo(const std::string & platform, const std::string & osVersion, const std::string & deviceModel, const std::string & manufacturer, const std::string & appVersion, const std::string & hardwareId)
+			: platform(platform),
+			osVersion(osVersion),
+			deviceModel(deviceModel),
+			manufacturer(manufacturer),
+			appVersion(appVersion),
+			hardwareId(hardwareId)
+		{
+		}
+
+		std::string GetAppVersion() const override { return this->appVersion; }
+		std::string GetDeviceModel() const override { return this->deviceModel; }
+		std::string GetHardwareId() const override { return this->hardwareId; }
+		std::string GetManufacturer() const override { return this->manufacturer; }
+		std::string GetOSVersion() const override { return this->osVersion; }
+		std::string GetPlatform() const override { return this->platform; }
+
+	private:
+		std::string platform;
+		std::string osVersion;
+		std::string deviceModel;
+		std::string manufacturer;
+		std::string appVersion;
+		std::string hardwareId;
+	};
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <chrono>
+
+#include "GameAnalyticsClock.h"
+
+namespace GameAnalytics
+{
+	// Clock based on std::chrono::steady_clock, for platforms without a native high-resolution counter.
+	class SteadyClock : public Clock
+	{
+	public:
+		int64_t GetTicks() const override
+		{
+			auto now = std::chrono::steady_clock::now().time_since_epoch();
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+		}
+
+		int64_t GetTicksPerSecond() const override
+		{
+			return 1000000000;
+		}
+	};
+}
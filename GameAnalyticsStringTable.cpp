@@ -0,0 +1,117 @@
+#include "pch.h"
+
+#include "GameAnalyticsStringTable.h"
+#include "GameAnalyticsHash.h"
+
+#include <algorithm>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const size_t InitialSlotCount = 256;
+}
+
+
+StringTable::StringTable()
+	: slots(InitialSlotCount, None)
+{
+}
+
+uint16_t StringTable::Intern(const std::string_view & value)
+{
+	// Look up existing string.
+	auto mask = this->slots.size() - 1;
+	auto slot = HashString(value) & mask;
+
+	while (this->slots[slot] != None)
+	{
+		if (this->Get(this->slots[slot]) == value)
+		{
+			return this->slots[slot];
+		}
+
+		slot = (slot + 1) & mask;
+	}
+
+	// Add new string.
+	auto handle = this->Add(value);
+
+	if (handle == None)
+	{
+		return None;
+	}
+
+	this->slots[slot] = handle;
+
+	// Keep load factor below one half.
+	if (this->ends.size() * 2 > this->slots.size())
+	{
+		this->Rehash(this->slots.size() * 2);
+	}
+
+	return handle;
+}
+
+uint16_t StringTable::Add(const std::string_view & value)
+{
+	if (this->ends.size() >= None)
+	{
+		return None;
+	}
+
+	this->data.append(value.data(), value.size());
+	this->ends.push_back(static_cast<uint32_t>(this->data.size()));
+
+	return static_cast<uint16_t>(this->ends.size() - 1);
+}
+
+std::string_view StringTable::Get(const uint16_t handle) const
+{
+	auto begin = handle > 0 ? this->ends[handle - 1] : 0;
+	return std::string_view(this->data.data() + begin, this->ends[handle] - begin);
+}
+
+size_t StringTable::GetCount() const
+{
+	return this->ends.size();
+}
+
+size_t StringTable::GetBytes() const
+{
+	return this->data.size() + this->ends.size() * sizeof(uint32_t);
+}
+
+void StringTable::Clear()
+{
+	this->data.clear();
+	this->ends.clear();
+
+	std::fill(this->slots.begin(), this->slots.end(), None);
+}
+
+void StringTable::Rehash(const size_t slotCount)
+{
+	// Re-insert all interned strings. Strings added without interning are not in the old table, and stay out.
+	std::vector<uint16_t> oldSlots(slotCount, None);
+	oldSlots.swap(this->slots);
+
+	auto mask = slotCount - 1;
+
+	for (auto handle : oldSlots)
+	{
+		if (handle == None)
+		{
+			continue;
+		}
+
+		auto slot = HashString(this->Get(handle)) & mask;
+
+		while (this->slots[slot] != None)
+		{
+			slot = (slot + 1) & mask;
+		}
+
+		this->slots[slot] = handle;
+	}
+}
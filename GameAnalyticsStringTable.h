@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace GameAnalytics
+{
+	// Stores strings back to back in a single buffer, referring to them by small integer handles.
+	// Interned strings are stored only once, which saves memory for event ids that are sent over and over.
+	class StringTable
+	{
+	public:
+		// Handle returned if the table is full.
+		static constexpr uint16_t None = 0xFFFF;
+
+		StringTable();
+
+		// Gets the handle of the specified string, adding it to this table if not found.
+		uint16_t Intern(const std::string_view & value);
+
+		// Adds the specified string without looking for an equal one, e.g. for error messages that rarely repeat.
+		uint16_t Add(const std::string_view & value);
+
+		// Gets the string with the specified handle.
+		std::string_view Get(const uint16_t handle) const;
+
+		// Gets the number of strings in this table.
+		size_t GetCount() const;
+
+		// Gets the number of bytes taken by the strings in this table and their handles, not counting preallocated memory.
+		size_t GetBytes() const;
+
+		// Removes all strings from this table, invalidating all handles. Keeps the allocated buffers.
+		void Clear();
+
+	private:
+		std::string data;
+		std::vector<uint32_t> ends;
+
+		// Open addressing hash table of interned string handles, with None marking empty slots.
+		std::vector<uint16_t> slots;
+
+		// Rebuilds the hash table with the specified number of slots, which has to be a power of two.
+		void Rehash(const size_t slotCount);
+	};
+}
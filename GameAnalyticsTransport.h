@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace GameAnalytics
+{
+	// Request to be sent to the GameAnalytics backend.
+	struct TransportRequest
+	{
+		// Absolute URL to post the request to.
+		std::string url;
+
+		// Body of the request, gzip-compressed if indicated.
+		std::string body;
+
+		// Base64-encoded HMAC SHA256 of the body, as required by the Authorization header.
+		std::string authorization;
+
+		// Whether the body is gzip-compressed and has to be sent with the Content-Encoding header.
+		bool compressed;
+	};
+
+	// Response received from the GameAnalytics backend.
+	struct TransportResponse
+	{
+		TransportResponse()
+			: statusCode(0),
+			serverTime(0)
+		{
+		}
+
+		// HTTP status code, or 0 if the request could not be sent at all, e.g. because the device is offline.
+		int statusCode;
+
+		// UTF-8 encoded body of the response.
+		std::string body;
+
+		// Server time from the Date header of the response, in seconds since the epoch, or 0 if unknown.
+		int64_t serverTime;
+	};
+
+	// Sends requests to the GameAnalytics backend, e.g. via HTTP.
+	class Transport
+	{
+	public:
+		typedef std::function<void(const TransportResponse & response)> Callback;
+
+		virtual ~Transport() {}
+
+		// Sends the specified request asynchronously, and passes the response to the specified callback.
+		// The callback may be invoked on any thread, including the calling one before this method returns.
+		virtual void Post(const TransportRequest & request, const Callback & callback) = 0;
+
+		// Hints how many requests will be sent at the same time at most, e.g. for keeping enough connections alive.
+		virtual void SetMaxConcurrentRequests(const size_t /* maxConcurrentRequests */) {}
+	};
+}
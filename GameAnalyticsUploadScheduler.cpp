@@ -0,0 +1,391 @@
+#include "pch.h"
+
+#include "GameAnalyticsUploadScheduler.h"
+#include "GameAnalyticsJson.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Removes the events at the specified indices, in ascending order, from the specified JSON array of events.
+	void RemoveEvents(std::string & body, const std::vector<size_t> & indices)
+	{
+		std::vector<std::string> events;
+
+		if (!Json::TryGetElements(body, events))
+		{
+			return;
+		}
+
+		body = "[";
+		size_t next = 0;
+
+		for (size_t i = 0; i < events.size(); ++i)
+		{
+			if (next < indices.size() && indices[next] == i)
+			{
+				++next;
+				continue;
+			}
+
+			if (body.size() > 1)
+			{
+				body += ",";
+			}
+
+			body += events[i];
+		}
+
+		body += "]";
+	}
+}
+
+
+UploadScheduler::UploadScheduler(EventStore & eventStore, const size_t maxInFlightBatches)
+	: eventStore(eventStore),
+	maxInFlightBatches(maxInFlightBatches),
+	inFlightBatches(0),
+	waitingBatches(0),
+	nextId(0),
+	maxRetries(10),
+	minRetryDelay(1000),
+	maxRetryDelay(5 * 60 * 1000),
+	consecutiveFailures(0),
+	retryTime(0),
+	unauthorized(false),
+	random(std::random_device()())
+{
+}
+
+bool UploadScheduler::TryNextBatch(const size_t maxEvents, const size_t maxBytes, const int64_t now, Batch & batch)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	if (this->inFlightBatches >= this->maxInFlightBatches || this->unauthorized || now < this->retryTime)
+	{
+		return false;
+	}
+
+	if (this->waitingBatches > 0)
+	{
+		// Send oldest waiting batch again.
+		size_t i = 0;
+
+		while (i < this->entries.size())
+		{
+			auto & entry = this->entries[i];
+
+			if (entry.state != State::Waiting)
+			{
+				++i;
+				continue;
+			}
+
+			--this->waitingBatches;
+
+			if (entry.dropped.size() >= entry.events)
+			{
+				// All events have been rejected.
+				entry.state = State::Sent;
+				++i;
+				continue;
+			}
+
+			EventStore::Position end;
+
+			if (this->eventStore.ReadBatch(entry.start, entry.events, std::numeric_limits<size_t>::max(), batch.body, end) == 0)
+			{
+				// Events have been evicted in the meantime.
+				entry.state = State::Sent;
+				++i;
+				continue;
+			}
+
+			if (batch.body.size() > maxBytes && entry.events > 1)
+			{
+				// Check the first half again.
+				this->Split(i);
+				continue;
+			}
+
+			if (!entry.dropped.empty())
+			{
+				RemoveEvents(batch.body, entry.dropped);
+			}
+
+			entry.state = State::InFlight;
+			++this->inFlightBatches;
+
+			batch.id = entry.id;
+			return true;
+		}
+
+		this->AcknowledgeSentBatches();
+	}
+
+	// Read next batch after all others.
+	Entry entry;
+	entry.start = this->entries.empty() ? this->eventStore.GetAcknowledged() : this->entries.back().end;
+	entry.events = this->eventStore.ReadBatch(entry.start, maxEvents, maxBytes, batch.body, entry.end);
+
+	if (entry.events == 0)
+	{
+		return false;
+	}
+
+	entry.id = this->nextId++;
+	entry.retries = 0;
+	entry.state = State::InFlight;
+
+	this->entries.push_back(entry);
+	++this->inFlightBatches;
+
+	batch.id = entry.id;
+	return true;
+}
+
+void UploadScheduler::Complete(const uint64_t id, const UploadResult result, const int64_t now)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	for (size_t i = 0; i < this->entries.size(); ++i)
+	{
+		auto & entry = this->entries[i];
+
+		if (entry.id != id || entry.state != State::InFlight)
+		{
+			continue;
+		}
+
+		--this->inFlightBatches;
+
+		switch (result)
+		{
+		case UploadResult::Accepted:
+			entry.state = State::Sent;
+			this->consecutiveFailures = 0;
+			break;
+
+		case UploadResult::Rejected:
+		case UploadResult::TooLarge:
+			this->Reject(i);
+			break;
+
+		case UploadResult::ServerError:
+			if (++entry.retries > this->maxRetries)
+			{
+				// Give up, rather than blocking all later events forever.
+				entry.state = State::Sent;
+			}
+			else
+			{
+				entry.state = State::Waiting;
+				++this->waitingBatches;
+			}
+
+			this->BackOff(now);
+			break;
+
+		case UploadResult::NetworkError:
+			entry.state = State::Waiting;
+			++this->waitingBatches;
+
+			this->BackOff(now);
+			break;
+
+		case UploadResult::Unauthorized:
+			entry.state = State::Waiting;
+			++this->waitingBatches;
+
+			// Sending again with the same keys won't help.
+			this->unauthorized = true;
+			break;
+		}
+
+		this->AcknowledgeSentBatches();
+		return;
+	}
+}
+
+void UploadScheduler::Complete(const uint64_t id, const std::vector<size_t> & rejectedEvents)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	for (size_t i = 0; i < this->entries.size(); ++i)
+	{
+		auto & entry = this->entries[i];
+
+		if (entry.id != id || entry.state != State::InFlight)
+		{
+			continue;
+		}
+
+		--this->inFlightBatches;
+
+		// Map the indices within the body to indices within the stored range, skipping the events dropped before.
+		std::vector<size_t> dropped;
+		dropped.reserve(entry.dropped.size() + rejectedEvents.size());
+
+		size_t next = 0;
+		size_t sent = 0;
+
+		for (size_t stored = 0; stored < entry.events; ++stored)
+		{
+			if (next < entry.dropped.size() && entry.dropped[next] == stored)
+			{
+				dropped.push_back(stored);
+				++next;
+				continue;
+			}
+
+			if (std::binary_search(rejectedEvents.begin(), rejectedEvents.end(), sent))
+			{
+				dropped.push_back(stored);
+			}
+
+			++sent;
+		}
+
+		if (rejectedEvents.empty() || rejectedEvents.back() >= sent)
+		{
+			// Don't know which events have been rejected.
+			this->Reject(i);
+		}
+		else
+		{
+			entry.dropped.swap(dropped);
+			entry.state = State::Waiting;
+			++this->waitingBatches;
+		}
+
+		this->AcknowledgeSentBatches();
+		return;
+	}
+}
+
+bool UploadScheduler::IsRetryDue(const int64_t now) const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->waitingBatches > 0 && !this->unauthorized && now >= this->retryTime;
+}
+
+void UploadScheduler::Resume()
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->unauthorized = false;
+	this->consecutiveFailures = 0;
+	this->retryTime = 0;
+}
+
+size_t UploadScheduler::GetInFlightBatches() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->inFlightBatches;
+}
+
+size_t UploadScheduler::GetMaxInFlightBatches() const
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->maxInFlightBatches;
+}
+
+void UploadScheduler::SetMaxInFlightBatches(const size_t maxInFlightBatches)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->maxInFlightBatches = maxInFlightBatches;
+}
+
+void UploadScheduler::SetMaxRetries(const int maxRetries)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->maxRetries = maxRetries;
+}
+
+void UploadScheduler::SetRetryDelay(const int64_t minRetryDelay, const int64_t maxRetryDelay)
+{
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	this->minRetryDelay = minRetryDelay;
+	this->maxRetryDelay = maxRetryDelay;
+}
+
+void UploadScheduler::AcknowledgeSentBatches()
+{
+	while (!this->entries.empty() && this->entries.front().state == State::Sent)
+	{
+		this->eventStore.Acknowledge(this->entries.front().end);
+		this->entries.pop_front();
+	}
+}
+
+void UploadScheduler::Reject(const size_t index)
+{
+	auto & entry = this->entries[index];
+
+	if (entry.events - entry.dropped.size() > 1)
+	{
+		this->Split(index);
+	}
+	else
+	{
+		entry.state = State::Sent;
+	}
+}
+
+void UploadScheduler::Split(const size_t index)
+{
+	auto & first = this->entries[index];
+
+	// Find the end of the first half.
+	std::string body;
+	EventStore::Position middle;
+	auto events = this->eventStore.ReadBatch(first.start, first.events / 2, std::numeric_limits<size_t>::max(), body, middle);
+
+	if (events == 0)
+	{
+		// Events have been evicted in the meantime.
+		first.state = State::Sent;
+		return;
+	}
+
+	Entry second;
+	second.id = this->nextId++;
+	second.start = middle;
+	second.end = first.end;
+	second.events = first.events - events;
+	second.retries = first.retries;
+	second.state = State::Waiting;
+
+	// Keep events rejected before out of both halves.
+	auto firstDropped = std::lower_bound(first.dropped.begin(), first.dropped.end(), events);
+
+	for (auto dropped = firstDropped; dropped != first.dropped.end(); ++dropped)
+	{
+		second.dropped.push_back(*dropped - events);
+	}
+
+	first.dropped.erase(firstDropped, first.dropped.end());
+
+	first.end = middle;
+	first.events = events;
+	first.state = State::Waiting;
+
+	this->entries.insert(this->entries.begin() + index + 1, second);
+	this->waitingBatches += 2;
+}
+
+void UploadScheduler::BackOff(const int64_t now)
+{
+	// Wait for a random time between the minimum and the exponentially growing, capped delay.
+	// Spreads retries of many devices that went offline at the same time.
+	auto exponent = std::min(this->consecutiveFailures, 30);
+	auto maxDelay = std::min(this->maxRetryDelay, this->minRetryDelay << exponent);
+	auto delay = std::uniform_int_distribution<int64_t>(this->minRetryDelay, std::max(this->minRetryDelay, maxDelay))(this->random);
+
+	++this->consecutiveFailures;
+	this->retryTime = std::max(this->retryTime, now + delay);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "GameAnalyticsEventStore.h"
+
+namespace GameAnalytics
+{
+	// Outcome of sending a batch of events to the GameAnalytics backend.
+	enum class UploadResult
+	{
+		// Backend has accepted the events.
+		Accepted,
+
+		// Backend has rejected some of the events, e.g. because of validation errors. Sending them again won't help.
+		Rejected,
+
+		// Backend has refused the request because of its size. Sending the events in smaller batches will help.
+		TooLarge,
+
+		// Backend could not handle the request right now, e.g. because of an internal error or too many requests.
+		ServerError,
+
+		// Request didn't reach the backend, e.g. because the device is offline or the connection has been reset.
+		NetworkError,
+
+		// Backend has refused the game and secret key.
+		Unauthorized
+	};
+
+	// Reads stored events in batches for sending them to the GameAnalytics backend,
+	// keeping up to a fixed number of batches in flight at the same time.
+	// Batches may complete in any order, but events are acknowledged in the order they have been stored.
+	// Failed batches are kept, and sent again before any new ones after a capped exponential backoff with jitter.
+	// Events rejected by the backend are dropped, and the other events of their batch sent again.
+	// Rejected batches are split in halves until the rejected events have been isolated, if the backend doesn't tell which events it has rejected.
+	// Batches to be sent again are split as well if they exceed the size of new batches, e.g. after it has been reduced because of timeouts.
+	class UploadScheduler
+	{
+	public:
+		// Batch of stored events to be sent.
+		struct Batch
+		{
+			// Identifies the batch when completing it.
+			uint64_t id;
+
+			// UTF-8 encoded JSON array of events.
+			std::string body;
+		};
+
+		UploadScheduler(EventStore & eventStore, const size_t maxInFlightBatches);
+
+		// Reads the next batch to send, limited to the specified number of events and bytes.
+		// Batches to be sent again come first, and are only limited in bytes.
+		// Returns false if the window of in-flight batches is full, sending is backing off at the specified time in milliseconds,
+		// or there are no more events to send.
+		bool TryNextBatch(const size_t maxEvents, const size_t maxBytes, const int64_t now, Batch & batch);
+
+		// Completes the batch with the specified id at the specified time in milliseconds.
+		// Acknowledges its events if they have been accepted, and schedules sending them again otherwise.
+		void Complete(const uint64_t id, const UploadResult result, const int64_t now);
+
+		// Completes the batch with the specified id, which the backend has rejected because of the events at the specified indices of its body, in ascending order.
+		// Drops these events, and sends the other ones again right away, without backing off. Splits the batch like other rejected ones if the indices don't fit the batch.
+		void Complete(const uint64_t id, const std::vector<size_t> & rejectedEvents);
+
+		// Checks whether failed batches are waiting to be sent again, and their backoff has passed at the specified time in milliseconds.
+		bool IsRetryDue(const int64_t now) const;
+
+		// Resets the backoff and resumes sending after the backend has refused the keys.
+		void Resume();
+
+		// Gets the number of batches currently being sent.
+		size_t GetInFlightBatches() const;
+
+		// Gets the maximum number of batches being sent at the same time.
+		size_t GetMaxInFlightBatches() const;
+
+		// Sets the maximum number of batches being sent at the same time.
+		void SetMaxInFlightBatches(const size_t maxInFlightBatches);
+
+		// Sets the number of server errors after which a batch is dropped. Network errors don't count.
+		void SetMaxRetries(const int maxRetries);
+
+		// Sets the delay before the first retry, and the maximum delay between retries, in milliseconds.
+		void SetRetryDelay(const int64_t minRetryDelay, const int64_t maxRetryDelay);
+
+	private:
+		enum class State
+		{
+			InFlight,
+			Waiting,
+			Sent
+		};
+
+		// Range of stored events read for sending.
+		struct Entry
+		{
+			uint64_t id;
+			EventStore::Position start;
+			EventStore::Position end;
+			size_t events;
+			int retries;
+			State state;
+
+			// Indices of the events within the range rejected by the backend, in ascending order. Left out when sending the range again.
+			std::vector<size_t> dropped;
+		};
+
+		mutable std::mutex mutex;
+
+		EventStore & eventStore;
+		size_t maxInFlightBatches;
+		size_t inFlightBatches;
+		size_t waitingBatches;
+		uint64_t nextId;
+
+		// Batches that have not been acknowledged yet, oldest first.
+		std::deque<Entry> entries;
+
+		int maxRetries;
+		int64_t minRetryDelay;
+		int64_t maxRetryDelay;
+
+		// Number of failures since the last accepted batch, and time to send again after the last failure.
+		int consecutiveFailures;
+		int64_t retryTime;
+		bool unauthorized;
+
+		std::minstd_rand random;
+
+		// Acknowledges the events of all sent batches that are not preceded by unsent ones.
+		void AcknowledgeSentBatches();
+
+		// Isolates rejected events, or sends smaller batches, by splitting the specified batch if it has more than one event, and drops it otherwise.
+		void Reject(const size_t index);
+
+		// Splits the specified batch in halves, to be sent separately.
+		void Split(const size_t index);
+
+		// Delays sending any batches after another failure.
+		void BackOff(const int64_t now);
+	};
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <stdexcept>
 #include <string>
 
 namespace GameAnalytics
@@ -13,6 +14,27 @@ namespace GameAnalytics
 			Female,
 		};
 
+		// Gets the name of the specified gender, as expected by the GameAnalytics backend.
+		inline const char * ToString(const Gender gender)
+		{
+			switch (gender)
+			{
+			case Male:
+				return "male";
+
+			case Female:
+				return "female";
+
+			case Unknown:
+				// Not sent to the backend at all.
+				break;
+			}
+
+			// Unknown gender value.
+			throw std::invalid_argument("Unknown gender: " + std::to_string(gender));
+		}
+
+#ifdef __cplusplus_winrt
 		inline std::wstring ToWString(const Gender gender)
 		{
 			switch (gender)
@@ -22,6 +44,10 @@ namespace GameAnalytics
 
 			case Female:
 				return L"female";
+
+			case Unknown:
+				// Not sent to the backend at all.
+				break;
 			}
 
 			// Unknown gender value.
@@ -29,5 +55,6 @@ namespace GameAnalytics
 			auto messageString = ref new Platform::String(message.c_str());
 			throw ref new Platform::FailureException(messageString);
 		}
+#endif
 	}
 }
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "pch.h"
+
+#include "GameAnalyticsUtf8.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define GAMEANALYTICS_SSE2
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define GAMEANALYTICS_NEON
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Number of UTF-16 or UTF-32 code units checked and converted at a time, if all of them are ASCII.
+	const size_t BlockLength = 8;
+
+	// Largest number of UTF-8 bytes a block converts to, with a surrogate pair starting at its last code unit, and size of the chunks converted at a time.
+	const size_t MaxBlockBytes = 4 * (BlockLength + 1);
+	const size_t ChunkLength = 256;
+
+	// Smallest code point encoded by UTF-8 sequences of each length, for rejecting overlong encodings.
+	const uint32_t MinCodePoints[] = { 0, 0, 0x80, 0x800, 0x10000 };
+
+	// Converts the block of UTF-16 or UTF-32 code units at the specified position to the specified output, if all of them are ASCII.
+	// Returns false, without writing anything, otherwise.
+	template <typename Char>
+	inline bool TryConvertAsciiBlock(const Char * s, char * out)
+	{
+#if defined(GAMEANALYTICS_SSE2)
+		auto zero = _mm_setzero_si128();
+
+		if (sizeof(Char) == 2)
+		{
+			auto characters = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+			auto ascii = _mm_cmpeq_epi16(_mm_and_si128(characters, _mm_set1_epi16(static_cast<short>(0xFF80))), zero);
+
+			if (_mm_movemask_epi8(ascii) != 0xFFFF)
+			{
+				return false;
+			}
+
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(characters, characters));
+		}
+		else
+		{
+			auto low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s));
+			auto high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s) + 1);
+			auto ascii = _mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi32(static_cast<int>(0xFFFFFF80))), zero);
+
+			if (_mm_movemask_epi8(ascii) != 0xFFFF)
+			{
+				return false;
+			}
+
+			auto characters = _mm_packs_epi32(low, high);
+			_mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(characters, characters));
+		}
+
+		return true;
+#elif defined(GAMEANALYTICS_NEON)
+		uint16x8_t characters;
+
+		if (sizeof(Char) == 2)
+		{
+			characters = vld1q_u16(reinterpret_cast<const uint16_t *>(s));
+		}
+		else
+		{
+			auto low = vld1q_u32(reinterpret_cast<const uint32_t *>(s));
+			auto high = vld1q_u32(reinterpret_cast<const uint32_t *>(s) + 4);
+
+			if (vmaxvq_u32(vorrq_u32(low, high)) >= 0x80)
+			{
+				return false;
+			}
+
+			characters = vcombine_u16(vmovn_u32(low), vmovn_u32(high));
+		}
+
+		if (vmaxvq_u16(characters) >= 0x80)
+		{
+			return false;
+		}
+
+		vst1_u8(reinterpret_cast<uint8_t *>(out), vmovn_u16(characters));
+		return true;
+#else
+		// Check and convert eight characters at a time, without SIMD instructions.
+		uint32_t bits = 0;
+
+		for (size_t i = 0; i < BlockLength; ++i)
+		{
+			bits |= static_cast<uint32_t>(s[i]);
+		}
+
+		if (bits >= 0x80)
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < BlockLength; ++i)
+		{
+			out[i] = static_cast<char>(s[i]);
+		}
+
+		return true;
+#endif
+	}
+
+	// Converts the specified UTF-16 or UTF-32 string to UTF-8, depending on the size of its code units.
+	template <typename Char>
+	void ConvertToUtf8(const std::basic_string_view<Char> & s, std::string & result)
+	{
+		// Reserve for the worst case only if the memory of the result doesn't suffice.
+		auto maxLength = s.length() * (sizeof(Char) == 2 ? 3 : 4);
+
+		result.clear();
+
+		if (result.capacity() < maxLength)
+		{
+			result.reserve(maxLength);
+		}
+
+		// Convert into a chunk on the stack, and append it whenever it might not hold another block,
+		// instead of resizing the result first, which fills it with zeros.
+		char chunk[ChunkLength];
+		auto out = chunk;
+
+		for (size_t i = 0; i < s.length();)
+		{
+			if (out > chunk + ChunkLength - MaxBlockBytes)
+			{
+				result.append(chunk, static_cast<size_t>(out - chunk));
+				out = chunk;
+			}
+
+			// Most event ids and strings are plain ASCII.
+			if (i + BlockLength <= s.length() && TryConvertAsciiBlock(s.data() + i, out))
+			{
+				i += BlockLength;
+				out += BlockLength;
+				continue;
+			}
+
+			// Convert the rest of the block one character at a time.
+			auto end = std::min(i + BlockLength, s.length());
+
+			while (i < end)
+			{
+				auto c = static_cast<uint32_t>(s[i++]);
+
+				if (c >= 0xD800 && c <= 0xDFFF)
+				{
+					// Combine surrogate pairs.
+					auto next = (i < s.length()) ? static_cast<uint32_t>(s[i]) : 0;
+
+					if (sizeof(Char) == 2 && c <= 0xDBFF && next >= 0xDC00 && next <= 0xDFFF)
+					{
+						c = 0x10000 + ((c - 0xD800) << 10) + (next - 0xDC00);
+						++i;
+					}
+					else
+					{
+						c = 0xFFFD;
+					}
+				}
+				else if (c > 0x10FFFF)
+				{
+					// UTF-32 code units beyond the range of Unicode.
+					c = 0xFFFD;
+				}
+
+				if (c < 0x80)
+				{
+					*out++ = static_cast<char>(c);
+				}
+				else if (c < 0x800)
+				{
+					*out++ = static_cast<char>(0xC0 | (c >> 6));
+					*out++ = static_cast<char>(0x80 | (c & 0x3F));
+				}
+				else if (c < 0x10000)
+				{
+					*out++ = static_cast<char>(0xE0 | (c >> 12));
+					*out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80 | (c & 0x3F));
+				}
+				else
+				{
+					*out++ = static_cast<char>(0xF0 | (c >> 18));
+					*out++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+					*out++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+					*out++ = static_cast<char>(0x80 | (c & 0x3F));
+				}
+			}
+		}
+
+		result.append(chunk, static_cast<size_t>(out - chunk));
+	}
+}
+
+
+void GameAnalytics::ToUtf8(const std::wstring_view & s, std::string & result)
+{
+	ConvertToUtf8(s, result);
+}
+
+void GameAnalytics::ToUtf8(const std::u16string_view & s, std::string & result)
+{
+	ConvertToUtf8(s, result);
+}
+
+std::string GameAnalytics::ToUtf8(const std::wstring_view & s)
+{
+	std::string result;
+	ToUtf8(s, result);
+	return result;
+}
+
+std::wstring GameAnalytics::FromUtf8(const std::string_view & s)
+{
+	std::wstring result;
+	result.reserve(s.length());
+
+	for (size_t i = 0; i < s.length();)
+	{
+		auto c = static_cast<uint8_t>(s[i]);
+		uint32_t codePoint;
+		size_t length;
+
+		if (c < 0x80)
+		{
+			codePoint = c;
+			length = 1;
+		}
+		else if ((c & 0xE0) == 0xC0)
+		{
+			codePoint = c & 0x1F;
+			length = 2;
+		}
+		else if ((c & 0xF0) == 0xE0)
+		{
+			codePoint = c & 0x0F;
+			length = 3;
+		}
+		else if ((c & 0xF8) == 0xF0)
+		{
+			codePoint = c & 0x07;
+			length = 4;
+		}
+		else
+		{
+			result.push_back(static_cast<wchar_t>(0xFFFD));
+			++i;
+			continue;
+		}
+
+		// Decode continuation bytes.
+		auto valid = i + length <= s.length();
+
+		for (size_t k = 1; valid && k < length; ++k)
+		{
+			auto continuation = static_cast<uint8_t>(s[i + k]);
+			valid = (continuation & 0xC0) == 0x80;
+			codePoint = (codePoint << 6) | (continuation & 0x3F);
+		}
+
+		// Reject overlong encodings, encoded surrogates, and code points beyond the range of Unicode.
+		if (!valid || codePoint < MinCodePoints[length] || (codePoint >= 0xD800 && codePoint <= 0xDFFF) || codePoint > 0x10FFFF)
+		{
+			result.push_back(static_cast<wchar_t>(0xFFFD));
+			++i;
+			continue;
+		}
+
+		i += length;
+
+		if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+		{
+			// Split into surrogate pair.
+			codePoint -= 0x10000;
+			result.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+			result.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+		}
+		else
+		{
+			result.push_back(static_cast<wchar_t>(codePoint));
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace GameAnalytics
+{
+	// Converts the specified wide string to UTF-8, replacing the contents of the specified string, so its memory can be reused.
+	// Wide strings are expected to be UTF-16 if wchar_t is 16 bits wide, and UTF-32 otherwise.
+	// Unpaired surrogates and values beyond U+10FFFF are replaced by U+FFFD. Runs of ASCII characters are converted with SIMD instructions, if available.
+	void ToUtf8(const std::wstring_view & s, std::string & result);
+
+	// Converts the specified UTF-16 string to UTF-8, like wide strings where wchar_t is 16 bits wide, replacing the contents of the specified string.
+	void ToUtf8(const std::u16string_view & s, std::string & result);
+
+	// Converts the specified wide string to UTF-8.
+	std::string ToUtf8(const std::wstring_view & s);
+
+	// Converts the specified UTF-8 string to a wide string.
+	// Wide strings are UTF-16 if wchar_t is 16 bits wide, and UTF-32 otherwise.
+	// Invalid sequences, overlong encodings, encoded surrogates and values beyond U+10FFFF are replaced by U+FFFD.
+	std::wstring FromUtf8(const std::string_view & s);
+}
@@ -0,0 +1,174 @@
+#include "pch.h"
+
+#include "GameAnalyticsWinRT.h"
+#include "GameAnalyticsUtf8.h"
+
+#include <memory>
+#include <ppltasks.h>
+#include <Windows.h>
+
+using namespace GameAnalytics;
+
+using namespace concurrency;
+using namespace Platform;
+using namespace Windows::Foundation;
+using namespace Windows::Security::Cryptography;
+using namespace Windows::Storage;
+using namespace Windows::Web::Http;
+using namespace Windows::Web::Http::Filters;
+using namespace Windows::Web::Http::Headers;
+
+
+WinRTTransport::WinRTTransport()
+	: httpFilter(ref new HttpBaseProtocolFilter())
+{
+	// Keep connections to the backend alive for all requests, one per batch in flight.
+	this->httpFilter->MaxConnectionsPerServer = 4;
+	this->httpClient = ref new HttpClient(this->httpFilter);
+}
+
+void WinRTTransport::SetMaxConcurrentRequests(const size_t maxConcurrentRequests)
+{
+	this->httpFilter->MaxConnectionsPerServer = static_cast<unsigned int>(maxConcurrentRequests);
+}
+
+void WinRTTransport::Post(const TransportRequest & request, const Callback & callback)
+{
+	auto url = FromUtf8(request.url);
+	auto authorization = FromUtf8(request.authorization);
+
+	auto bodyBytes = reinterpret_cast<unsigned char*>(const_cast<char*>(request.body.data()));
+	auto bodyArray = ArrayReference<unsigned char>(bodyBytes, static_cast<unsigned int>(request.body.size()));
+
+	// Send request to GameAnalytics.
+	auto message = ref new HttpRequestMessage();
+
+	message->RequestUri = ref new Uri(ref new String(url.c_str()));
+	message->Method = HttpMethod::Post;
+	message->Content = ref new HttpBufferContent(CryptographicBuffer::CreateFromByteArray(bodyArray));
+	message->Content->Headers->ContentType = ref new HttpMediaTypeHeaderValue(L"application/json");
+
+	if (request.compressed)
+	{
+		message->Content->Headers->ContentEncoding->Append(ref new HttpContentCodingHeaderValue(L"gzip"));
+	}
+
+	message->Headers->TryAppendWithoutValidation(L"Authorization", ref new String(authorization.c_str()));
+
+	auto result = std::make_shared<TransportResponse>();
+
+	create_task(this->httpClient->SendRequestAsync(message)).then([result](HttpResponseMessage^ response)
+	{
+		result->statusCode = static_cast<int>(response->StatusCode);
+
+		// Convert from 100-nanosecond intervals since 1601 to seconds since 1970.
+		auto date = response->Headers->Date;
+
+		if (date != nullptr)
+		{
+			result->serverTime = (date->Value.UniversalTime - 116444736000000000ll) / 10000000;
+		}
+
+		return create_task(response->Content->ReadAsStringAsync());
+	}).then([result, callback](task<String^> previousTask)
+	{
+		auto & response = *result;
+
+		try
+		{
+			response.body = ToUtf8(previousTask.get()->Data());
+		}
+		catch (Platform::Exception^)
+		{
+			// Request could not be sent (status code 0), or response could not be read.
+		}
+
+		callback(response);
+	});
+}
+
+WinRTClock::WinRTClock()
+{
+	LARGE_INTEGER frequency;
+
+	if (!QueryPerformanceFrequency(&frequency))
+	{
+		throw ref new Platform::FailureException(L"Unable to get system time.");
+	}
+
+	this->ticksPerSecond = frequency.QuadPart;
+}
+
+int64_t WinRTClock::GetTicks() const
+{
+	LARGE_INTEGER currentTime;
+
+	if (!QueryPerformanceCounter(&currentTime))
+	{
+		throw ref new Platform::FailureException(L"Unable to get system time.");
+	}
+
+	return currentTime.QuadPart;
+}
+
+int64_t WinRTClock::GetTicksPerSecond() const
+{
+	return this->ticksPerSecond;
+}
+
+int WinRTKeyValueStore::GetInt32OrDefault(const std::string & key) const
+{
+	auto keyString = ref new String(FromUtf8(key).c_str());
+	auto localSettings = ApplicationData::Current->LocalSettings;
+	auto hasValue = localSettings->Values->HasKey(keyString);
+	return hasValue ? safe_cast<IPropertyValue^>(localSettings->Values->Lookup(keyString))->GetInt32() : 0;
+}
+
+void WinRTKeyValueStore::SetInt32(const std::string & key, const int value)
+{
+	auto keyString = ref new String(FromUtf8(key).c_str());
+	auto localSettings = ApplicationData::Current->LocalSettings;
+	localSettings->Values->Insert(keyString, dynamic_cast<PropertyValue^>(PropertyValue::CreateInt32(value)));
+}
+
+std::string WinRTDeviceInfo::GetAppVersion() const
+{
+	auto thisPackage = Windows::ApplicationModel::Package::Current;
+	auto version = thisPackage->Id->Version;
+	return std::to_string(version.Major)
+		+ "." + std::to_string(version.Minor)
+		+ "." + std::to_string(version.Build)
+		+ "." + std::to_string(version.Revision);
+}
+
+std::string WinRTDeviceInfo::GetDeviceModel() const
+{
+	auto info = ref new Windows::Security::ExchangeActiveSyncProvisioning::EasClientDeviceInformation();
+	return ToUtf8(info->SystemProductName->Data());
+}
+
+std::string WinRTDeviceInfo::GetHardwareId() const
+{
+	auto packageSpecificToken = Windows::System::Profile::HardwareIdentification::GetPackageSpecificToken(nullptr);
+	auto hardwareId = packageSpecificToken->Id;
+	auto hardwareIdString = CryptographicBuffer::EncodeToHexString(hardwareId);
+	return ToUtf8(hardwareIdString->Data());
+}
+
+std::string WinRTDeviceInfo::GetManufacturer() const
+{
+	auto info = ref new Windows::Security::ExchangeActiveSyncProvisioning::EasClientDeviceInformation();
+	return ToUtf8(info->SystemManufacturer->Data());
+}
+
+std::string WinRTDeviceInfo::GetOSVersion() const
+{
+	auto deviceFamily = Windows::System::Profile::AnalyticsInfo::VersionInfo->DeviceFamily;
+	return (deviceFamily == "Windows.Desktop") ? "windows 10" : "windows_phone 10";
+}
+
+std::string WinRTDeviceInfo::GetPlatform() const
+{
+	// TODO: Get correct platform as soon as ported to UWP.
+	return "windows";
+}
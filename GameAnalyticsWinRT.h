@@ -0,0 +1,62 @@
+#pragma once
+
+#include "GameAnalyticsClock.h"
+#include "GameAnalyticsDeviceInfo.h"
+#include "GameAnalyticsKeyValueStore.h"
+#include "GameAnalyticsTransport.h"
+
+namespace GameAnalytics
+{
+	// Sends requests to the GameAnalytics backend using the Windows Runtime HTTP client.
+	class WinRTTransport : public Transport
+	{
+	public:
+		WinRTTransport();
+
+		void Post(const TransportRequest & request, const Callback & callback) override;
+		void SetMaxConcurrentRequests(const size_t maxConcurrentRequests) override;
+
+	private:
+		Windows::Web::Http::Filters::HttpBaseProtocolFilter^ httpFilter;
+		Windows::Web::Http::HttpClient^ httpClient;
+	};
+
+	// Provides the Windows performance counter as time source.
+	class WinRTClock : public Clock
+	{
+	public:
+		WinRTClock();
+
+		int64_t GetTicks() const override;
+		int64_t GetTicksPerSecond() const override;
+
+	private:
+		int64_t ticksPerSecond;
+	};
+
+	// Stores values in the local settings of the app.
+	class WinRTKeyValueStore : public KeyValueStore
+	{
+	public:
+		int GetInt32OrDefault(const std::string & key) const override;
+		void SetInt32(const std::string & key, const int value) override;
+	};
+
+	// Provides information about the Windows 10 device and app package.
+	class WinRTDeviceInfo : public DeviceInfo
+	{
+	public:
+		// Gets the app package version.
+		std::string GetAppVersion() const override;
+
+		std::string GetDeviceModel() const override;
+
+		// Gets the Application Specific Hardware Identifier (ASHWID).
+		// See https://msdn.microsoft.com/en-us/library/windows/apps/jj553431
+		std::string GetHardwareId() const override;
+
+		std::string GetManufacturer() const override;
+		std::string GetOSVersion() const override;
+		std::string GetPlatform() const override;
+	};
+}
@@ -0,0 +1,91 @@
+#include "pch.h"
+
+#include "GameAnalyticsWorker.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Lowers the priority of the calling thread, so it yields to the game.
+	void LowerThreadPriority()
+	{
+#ifdef _WIN32
+		SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+		// Linux applies nice values to single threads.
+		setpriority(PRIO_PROCESS, 0, 10);
+#endif
+	}
+}
+
+
+Worker::Worker(const std::function<bool()> & work, const std::chrono::milliseconds interval)
+	: state(std::make_shared<State>())
+{
+	this->state->work = work;
+	this->state->interval = interval;
+	this->state->woken = false;
+	this->state->stopping = false;
+
+	this->thread = std::thread(&Worker::Run, this->state);
+}
+
+Worker::~Worker()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->state->mutex);
+		this->state->stopping = true;
+	}
+
+	this->state->wakeUp.notify_one();
+
+	if (this->thread.get_id() == std::this_thread::get_id())
+	{
+		// Destroyed by its own function, which returns to a loop that stops right away.
+		this->thread.detach();
+	}
+	else
+	{
+		this->thread.join();
+	}
+}
+
+void Worker::WakeUp()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->state->mutex);
+		this->state->woken = true;
+	}
+
+	this->state->wakeUp.notify_one();
+}
+
+void Worker::Run(const std::shared_ptr<State> state)
+{
+	LowerThreadPriority();
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+
+	while (!state->stopping)
+	{
+		state->woken = false;
+
+		lock.unlock();
+		auto done = state->work();
+		lock.lock();
+
+		if (done)
+		{
+			state->wakeUp.wait_for(lock, state->interval, [&state] { return state->stopping || state->woken; });
+		}
+	}
+}
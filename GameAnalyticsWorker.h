@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace GameAnalytics
+{
+	// Calls a function over and over on a dedicated thread with low priority, e.g. for doing the work of the GameAnalytics core in the background.
+	// Calls it again right away while it returns false, and otherwise waits until woken up or the specified interval has passed.
+	// The function may destroy the worker, e.g. by releasing the last reference to its owner.
+	class Worker
+	{
+	public:
+		Worker(const std::function<bool()> & work, const std::chrono::milliseconds interval);
+
+		// Stops the worker, waiting for the current call of its function to return, unless called by the function itself.
+		~Worker();
+
+		Worker(const Worker &) = delete;
+		Worker & operator=(const Worker &) = delete;
+
+		// Calls the function as soon as possible.
+		void WakeUp();
+
+	private:
+		// Shared with the thread, so it can outlive the worker.
+		struct State
+		{
+			std::function<bool()> work;
+			std::chrono::milliseconds interval;
+
+			std::mutex mutex;
+			std::condition_variable wakeUp;
+			bool woken;
+			bool stopping;
+		};
+
+		std::shared_ptr<State> state;
+		std::thread thread;
+
+		static void Run(const std::shared_ptr<State> state);
+	};
+}
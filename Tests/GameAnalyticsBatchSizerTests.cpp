@@ -0,0 +1,181 @@
+#include "GameAnalyticsBatchSizer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const size_t KB = 1024;
+
+	// Sends a batch of the current size, answered after 1 ms, so its throughput doesn't limit the size.
+	void CompleteFast(BatchSizer & sizer, int64_t & now, const UploadResult result)
+	{
+		sizer.Complete(sizer.GetBatchBytes(), now, now + 1, result);
+		now += 1;
+	}
+}
+
+
+TEST(BatchSizerTests, StartsAt64KBAndDoubles)
+{
+	BatchSizer sizer;
+	int64_t now = 0;
+
+	EXPECT_EQ(64 * KB, sizer.GetBatchBytes());
+
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(128 * KB, sizer.GetBatchBytes());
+
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(256 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, GrowsBy16KBAfterReduction)
+{
+	BatchSizer sizer;
+	int64_t now = 0;
+
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	CompleteFast(sizer, now, UploadResult::ServerError);
+	EXPECT_EQ(128 * KB, sizer.GetBatchBytes());
+
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(144 * KB, sizer.GetBatchBytes());
+
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(160 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, DoesNotGrowForSmallBatches)
+{
+	// Batches not limited by their size don't tell whether larger ones would be fast enough.
+	BatchSizer sizer;
+	sizer.Complete(16 * KB, 0, 1, UploadResult::Accepted);
+
+	EXPECT_EQ(64 * KB, sizer.GetBatchBytes());
+	EXPECT_EQ(0u, sizer.GetThroughput());
+}
+
+TEST(BatchSizerTests, HalvesOnSlowResponse)
+{
+	BatchSizer sizer;
+	sizer.SetMaxLatency(500);
+
+	sizer.Complete(64 * KB, 0, 501, UploadResult::Accepted);
+	EXPECT_EQ(32 * KB, sizer.GetBatchBytes());
+
+	// Timeouts count as slow, but failing fast means being offline.
+	sizer.Complete(32 * KB, 1000, 1010, UploadResult::NetworkError);
+	EXPECT_EQ(32 * KB, sizer.GetBatchBytes());
+
+	sizer.Complete(32 * KB, 1000, 1500, UploadResult::NetworkError);
+	EXPECT_EQ(16 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, HalvesOnServerError)
+{
+	BatchSizer sizer;
+	int64_t now = 0;
+
+	CompleteFast(sizer, now, UploadResult::ServerError);
+	EXPECT_EQ(32 * KB, sizer.GetBatchBytes());
+
+	// Neither the batch nor the network is at fault.
+	CompleteFast(sizer, now, UploadResult::Rejected);
+	CompleteFast(sizer, now, UploadResult::Unauthorized);
+	EXPECT_EQ(32 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, HalvesOncePerRoundTrip)
+{
+	// Batches sent before the last change can't tell whether it has been right.
+	BatchSizer sizer;
+
+	sizer.Complete(64 * KB, 0, 10, UploadResult::ServerError);
+	sizer.Complete(64 * KB, 0, 11, UploadResult::ServerError);
+	sizer.Complete(64 * KB, 5, 12, UploadResult::ServerError);
+	EXPECT_EQ(32 * KB, sizer.GetBatchBytes());
+
+	sizer.Complete(32 * KB, 10, 20, UploadResult::ServerError);
+	EXPECT_EQ(16 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, HalvesOnPayloadTooLargeDownTo4KB)
+{
+	BatchSizer sizer;
+	int64_t now = 0;
+
+	CompleteFast(sizer, now, UploadResult::TooLarge);
+	EXPECT_EQ(32 * KB, sizer.GetBatchBytes());
+
+	CompleteFast(sizer, now, UploadResult::TooLarge);
+	EXPECT_EQ(16 * KB, sizer.GetBatchBytes());
+
+	for (int i = 0; i < 10; ++i)
+	{
+		CompleteFast(sizer, now, UploadResult::TooLarge);
+	}
+
+	EXPECT_EQ(BatchSizer::MinBatchBytes, sizer.GetBatchBytes());
+
+	// Accepted batches don't grow beyond the limit of the backend.
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(4 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, ReducesDownTo4KB)
+{
+	BatchSizer sizer;
+	int64_t now = 0;
+
+	for (int i = 0; i < 10; ++i)
+	{
+		CompleteFast(sizer, now, UploadResult::ServerError);
+	}
+
+	EXPECT_EQ(4 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, CapsByThroughputTimesMaxLatency)
+{
+	BatchSizer sizer;
+	sizer.SetMaxLatency(1000);
+
+	// 64 KB per second can only send 64 KB within the latency ceiling.
+	sizer.Complete(64 * KB, 0, 1000, UploadResult::Accepted);
+
+	EXPECT_EQ(64 * KB, sizer.GetThroughput());
+	EXPECT_EQ(64 * KB, sizer.GetBatchBytes());
+
+	// Twice as fast.
+	sizer.Complete(64 * KB, 1000, 1500, UploadResult::Accepted);
+
+	EXPECT_EQ(80 * KB, sizer.GetThroughput());
+	EXPECT_EQ(80 * KB, sizer.GetBatchBytes());
+}
+
+TEST(BatchSizerTests, CapsByMaxPayload)
+{
+	BatchSizer sizer;
+	int64_t now = 0;
+
+	sizer.SetMaxPayloadBytes(100 * KB);
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(100 * KB, sizer.GetBatchBytes());
+
+	sizer.SetMaxPayloadBytes(16 * KB);
+	EXPECT_EQ(16 * KB, sizer.GetBatchBytes());
+
+	CompleteFast(sizer, now, UploadResult::TooLarge);
+	EXPECT_EQ(8 * KB, sizer.GetBatchBytes());
+
+	// Changing the maximum payload forgets the limit learned from the backend, and batches grow again.
+	sizer.SetMaxPayloadBytes(1024 * KB);
+	CompleteFast(sizer, now, UploadResult::Accepted);
+	EXPECT_EQ(16 * KB, sizer.GetBatchBytes());
+}
@@ -0,0 +1,769 @@
+#include "GameAnalyticsJson.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Loopback transport keeping the bodies of all events requests it has been sent.
+	class RecordingTransport : public LoopbackTransport
+	{
+	public:
+		void Post(const TransportRequest & request, const Callback & callback) override
+		{
+			if (request.url.find("/events") != std::string::npos)
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->bodies += request.body;
+			}
+
+			LoopbackTransport::Post(request, callback);
+		}
+
+		// Gets the bodies of all events requests since the last call.
+		std::string TakeBodies()
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+
+			std::string bodies;
+			bodies.swap(this->bodies);
+			return bodies;
+		}
+
+	private:
+		std::mutex mutex;
+		std::string bodies;
+	};
+
+	// Gets the client timestamp of the first event of the specified events request bodies, in seconds, or -1 if there is none.
+	int64_t GetClientTimestamp(const std::string & bodies)
+	{
+		const std::string member = "\"client_ts\":";
+		auto index = bodies.find(member);
+		return index != std::string::npos ? std::stoll(bodies.substr(index + member.size())) : -1;
+	}
+
+	// Gets the events of the specified events request body with the specified id, or with ids starting with it if ending with a colon.
+	std::vector<std::string> GetEvents(const std::string & body, const std::string & eventId)
+	{
+		std::vector<std::string> events;
+		std::vector<std::string> matching;
+
+		if (!Json::TryGetElements(body, events))
+		{
+			return matching;
+		}
+
+		for (auto & event : events)
+		{
+			std::string id;
+
+			if (Json::TryGetMember(event, "event_id", id) && id.compare(0, eventId.size() + 1, "\"" + eventId) == 0
+				&& (eventId.back() == ':' || id == "\"" + eventId + "\""))
+			{
+				matching.push_back(event);
+			}
+		}
+
+		return matching;
+	}
+
+	// Gets the events of the specified events request body of the specified category.
+	std::vector<std::string> GetEventsOfCategory(const std::string & body, const std::string & category)
+	{
+		std::vector<std::string> events;
+		std::vector<std::string> matching;
+
+		if (!Json::TryGetElements(body, events))
+		{
+			return matching;
+		}
+
+		for (auto & event : events)
+		{
+			std::string value;
+
+			if (Json::TryGetMember(event, "category", value) && value == "\"" + category + "\"")
+			{
+				matching.push_back(event);
+			}
+		}
+
+		return matching;
+	}
+
+	// Gets the specified member of the specified event as JSON, e.g. with quotes for strings, or an empty string if missing.
+	std::string GetMember(const std::string & event, const std::string & name)
+	{
+		std::string value;
+		return Json::TryGetMember(event, name, value) ? value : std::string();
+	}
+
+	std::shared_ptr<GameAnalyticsCore> CreateCore(const std::shared_ptr<LoopbackTransport> & transport, const TestDirectory & directory)
+	{
+		transport->SetSecretKey(TestSecretKey);
+
+		auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+		core->Init([](const InitResult &) {});
+		return core;
+	}
+}
+
+
+TEST(CoreTests, ProgressionsDontUseUpEventIds)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	auto core = CreateCore(transport, directory);
+
+	for (auto i = 0; i < 4000; ++i)
+	{
+		core->RegisterEventId("Registered:Id" + std::to_string(i));
+	}
+
+	for (auto i = 0; i < 1000; ++i)
+	{
+		auto progression = "World" + std::to_string(i) + ":Level";
+		core->SendProgressionEvent(ProgressionStatus::Start, progression);
+		core->SendProgressionEvent(ProgressionStatus::Complete, progression, i);
+	}
+
+	for (auto i = 4000; i < 4096; ++i)
+	{
+		EXPECT_NO_THROW(core->RegisterEventId("Registered:Id" + std::to_string(i)));
+	}
+
+	core->Flush();
+
+	auto statistics = transport->GetStatistics();
+	EXPECT_EQ(2000u, statistics.eventsReceived);
+	EXPECT_EQ(0u, statistics.rejectedRequests);
+}
+
+TEST(CoreTests, LimitsProgressionEventsByStatusAndId)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	auto core = CreateCore(transport, directory);
+
+	core->SetEventIdRateLimit(1, 1);
+
+	// Each status of the progression has its own limit, regardless of the progression the player is in.
+	core->SendProgressionEvent(ProgressionStatus::Start, "World01:Level01");
+	core->SendProgressionEvent(ProgressionStatus::Complete, "World01:Level01", 100);
+	core->SendProgressionEvent(ProgressionStatus::Complete, "World01:Level01");
+	core->SendProgressionEvent(ProgressionStatus::Complete, "World01:Level01");
+
+	core->Flush();
+
+	EXPECT_EQ(2u, transport->GetStatistics().eventsReceived);
+	EXPECT_EQ(2u, core->GetMetrics().limitedEvents);
+}
+
+TEST(CoreTests, SendsSameProgressionEventsByHandle)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	// Keep timestamps and bodies comparable.
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(transport, directory.GetPath(), std::make_shared<ManualClock>()));
+	core->SetCompressionThreshold(1u << 30);
+	core->Init([](const InitResult &) {});
+
+	const std::string progression = "World01:Level01";
+	auto handle = core->RegisterEventId(progression);
+
+	// Events sent in between carry the progression the player is in.
+	core->SendProgressionEvent(ProgressionStatus::Start, progression);
+	core->SendDesignEvent("Kill:Orc");
+	core->SendProgressionEvent(ProgressionStatus::Complete, progression);
+	core->SendDesignEvent("Kill:Orc");
+	core->SendProgressionEvent(ProgressionStatus::Start, progression, 10);
+	core->SendProgressionEvent(ProgressionStatus::Fail, progression, 20);
+	core->SendDesignEvent("Kill:Orc");
+	core->Flush();
+
+	auto byString = transport->TakeBodies();
+
+	core->SendProgressionEvent(ProgressionStatus::Start, handle);
+	core->SendDesignEvent("Kill:Orc");
+	core->SendProgressionEvent(ProgressionStatus::Complete, handle);
+	core->SendDesignEvent("Kill:Orc");
+	core->SendProgressionEvent(ProgressionStatus::Start, handle, 10);
+	core->SendProgressionEvent(ProgressionStatus::Fail, handle, 20);
+	core->SendDesignEvent("Kill:Orc");
+	core->Flush();
+
+	auto byHandle = transport->TakeBodies();
+
+	EXPECT_NE(std::string::npos, byString.find("\"progression\":\"World01:Level01\""));
+	EXPECT_EQ(byString, byHandle);
+}
+
+TEST(CoreTests, LeavesRequestedFlushToUpdate)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	auto core = CreateCore(transport, directory);
+
+	core->SendDesignEvent("Kill:Orc");
+	core->RequestFlush();
+
+	EXPECT_EQ(0u, transport->GetStatistics().eventsReceived);
+
+	core->Update();
+
+	EXPECT_EQ(1u, transport->GetStatistics().eventsReceived);
+}
+
+TEST(CoreTests, KeepsTimestampsAdvancingAfterFiftyDays)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto clock = std::make_shared<ManualClock>();
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath(), clock));
+	core->SetCompressionThreshold(1u << 30);
+	core->Init([](const InitResult &) {});
+
+	core->SendDesignEvent("Kill:Orc");
+	core->Flush();
+
+	auto first = GetClientTimestamp(transport->TakeBodies());
+	ASSERT_GT(first, 0);
+
+	// Milliseconds since the start of the session no longer fit into 32 bits after 49.7 days.
+	const int64_t days = 60;
+	clock->Advance(days * 24 * 60 * 60 * 1000);
+
+	core->SendDesignEvent("Kill:Orc");
+	core->Flush();
+
+	auto second = GetClientTimestamp(transport->TakeBodies());
+
+	EXPECT_EQ(days * 24 * 60 * 60, second - first);
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+}
+
+TEST(CoreTests, DropsEventsWithNonFiniteValues)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	auto core = CreateCore(transport, directory);
+
+	core->SendDesignEvent("Kill:Orc", std::numeric_limits<float>::quiet_NaN());
+	core->SendDesignEvent("Kill:Orc", std::numeric_limits<float>::infinity());
+	core->SendResourceEvent(FlowType::Source, "Gems", "Reward", "Chest", -std::numeric_limits<float>::infinity());
+	core->SendDesignEvent("Kill:Orc", 1.0f);
+	core->Flush();
+
+	EXPECT_EQ(3u, core->GetMetrics().invalidEvents);
+	EXPECT_EQ(1u, transport->GetStatistics().eventsReceived);
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+}
+
+TEST(CoreTests, SendsAggregatesOfAllPlayersPerWindowAsLocalUser)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto clock = std::make_shared<ManualClock>();
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath(), clock));
+	core->SetCompressionThreshold(1u << 30);
+	core->AggregateEvents("Kill:");
+	core->SetAggregationInterval(60);
+	core->Init([](const InitResult &) {});
+
+	auto player = core->StartPlayerSession("player-1", 1);
+
+	{
+		PlayerScope scope(*core, player);
+
+		for (auto i = 1; i <= 100; ++i)
+		{
+			core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+		}
+
+		core->SendDesignEvent("Loot:Sword");
+	}
+
+	core->SendDesignEvent("Kill:Orc", 1000.0f);
+	core->Flush();
+
+	// Events without aggregated prefix are sent as they are, while aggregates wait for the end of their window.
+	auto body = transport->TakeBodies();
+	auto loot = GetEvents(body, "Loot:Sword");
+
+	ASSERT_EQ(1u, loot.size());
+	EXPECT_NE(std::string::npos, loot[0].find("\"user_id\":\"player-1\""));
+	EXPECT_TRUE(GetEvents(body, "Kill:").empty());
+
+	clock->Advance(60 * 1000);
+
+	// Summaries are sent by the local user, even if flushed within the scope of a player.
+	{
+		PlayerScope scope(*core, player);
+		core->Flush();
+	}
+
+	body = transport->TakeBodies();
+	auto summaries = GetEvents(body, "Kill:Orc:");
+
+	ASSERT_EQ(7u, summaries.size());
+
+	for (auto & summary : summaries)
+	{
+		EXPECT_NE(std::string::npos, summary.find("\"user_id\":\"test-hardware-id\"")) << summary;
+	}
+
+	auto getValue = [&body](const char * eventId)
+	{
+		auto events = GetEvents(body, eventId);
+		double value = -1;
+		return events.size() == 1 && Json::TryGetNumber(events[0], "value", value) ? value : -1;
+	};
+
+	EXPECT_EQ(101, getValue("Kill:Orc:Count"));
+	EXPECT_EQ(6050, getValue("Kill:Orc:Sum"));
+	EXPECT_EQ(1, getValue("Kill:Orc:Min"));
+	EXPECT_EQ(1000, getValue("Kill:Orc:Max"));
+	EXPECT_NEAR(51, getValue("Kill:Orc:P50"), 51 * 0.01);
+	EXPECT_NEAR(91, getValue("Kill:Orc:P90"), 91 * 0.01);
+	EXPECT_NEAR(100, getValue("Kill:Orc:P99"), 100 * 0.01);
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+
+	// Nothing is left for the next window.
+	clock->Advance(60 * 1000);
+	core->Flush();
+
+	EXPECT_TRUE(GetEvents(transport->TakeBodies(), "Kill:").empty());
+}
+
+TEST(CoreTests, KeepsInFlightBatchesWithinWindow)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetLatency(std::chrono::milliseconds(20));
+
+	auto core = CreateCore(transport, directory);
+	core->SetMaxInFlightBatches(3);
+	core->SetMaxPayloadBytes(8 * 1024);
+
+	while (!core->IsInitialized())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	for (auto i = 0; i < 500; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	// Flushing again and again must not send more batches while the window is full.
+	auto start = std::chrono::steady_clock::now();
+
+	while (transport->GetStatistics().eventsReceived < 500 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+	{
+		core->Flush();
+
+		EXPECT_LE(core->GetMetrics().inFlightBatches, 3u);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	auto statistics = transport->GetStatistics();
+
+	EXPECT_EQ(500u, statistics.eventsReceived);
+	EXPECT_GE(statistics.eventsRequests, 10u);
+	EXPECT_EQ(3u, statistics.maxPendingRequests);
+}
+
+TEST(CoreTests, AttributesEventsToPlayerSessions)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+	core->SetCompressionThreshold(1u << 30);
+	core->Init([](const InitResult &) {});
+
+	auto first = core->StartPlayerSession("player-1", 3);
+	auto second = core->StartPlayerSession("player-2", 1);
+
+	EXPECT_TRUE(first.IsValid());
+	EXPECT_NE(first.handle, second.handle);
+
+	{
+		PlayerScope scope(*core, first);
+		core->SendDesignEvent("Kill:First");
+	}
+
+	{
+		PlayerScope scope(*core, second);
+		core->SendDesignEvent("Kill:Second");
+
+		// Scopes nest, and restore the previous player when left.
+		{
+			PlayerScope inner(*core, first);
+			core->SendDesignEvent("Kill:First");
+		}
+
+		core->SendDesignEvent("Kill:Second");
+	}
+
+	core->SendDesignEvent("Kill:Local");
+	core->Flush();
+
+	auto body = transport->TakeBodies();
+	auto firstEvents = GetEvents(body, "Kill:First");
+	auto secondEvents = GetEvents(body, "Kill:Second");
+	auto localEvents = GetEvents(body, "Kill:Local");
+
+	ASSERT_EQ(2u, firstEvents.size());
+	ASSERT_EQ(2u, secondEvents.size());
+	ASSERT_EQ(1u, localEvents.size());
+
+	for (auto & event : firstEvents)
+	{
+		EXPECT_EQ("\"player-1\"", GetMember(event, "user_id"));
+		EXPECT_EQ("3", GetMember(event, "session_num"));
+		EXPECT_EQ(GetMember(firstEvents[0], "session_id"), GetMember(event, "session_id"));
+	}
+
+	for (auto & event : secondEvents)
+	{
+		EXPECT_EQ("\"player-2\"", GetMember(event, "user_id"));
+		EXPECT_EQ("1", GetMember(event, "session_num"));
+	}
+
+	EXPECT_EQ("\"test-hardware-id\"", GetMember(localEvents[0], "user_id"));
+
+	// Each session has an id of its own.
+	auto firstSession = GetMember(firstEvents[0], "session_id");
+	auto secondSession = GetMember(secondEvents[0], "session_id");
+	auto localSession = GetMember(localEvents[0], "session_id");
+
+	EXPECT_FALSE(firstSession.empty());
+	EXPECT_NE(firstSession, secondSession);
+	EXPECT_NE(firstSession, localSession);
+	EXPECT_NE(secondSession, localSession);
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+}
+
+TEST(CoreTests, SetsUserDataPerPlayer)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+	core->SetCompressionThreshold(1u << 30);
+	core->Init([](const InitResult &) {});
+
+	auto player = core->StartPlayerSession("player-1", 1);
+
+	{
+		PlayerScope scope(*core, player);
+		core->SendDesignEvent("Kill:Player");
+
+		// Applies to the events of the player that haven't been flushed yet.
+		core->SetFacebookId("facebook-1");
+		core->SetGooglePlusId("google-1");
+		core->SetGender(Gender::Female);
+		core->SetBirthYear(1990);
+	}
+
+	core->SendDesignEvent("Kill:Local");
+	core->Flush();
+
+	auto body = transport->TakeBodies();
+	auto playerEvents = GetEvents(body, "Kill:Player");
+	auto localEvents = GetEvents(body, "Kill:Local");
+
+	ASSERT_EQ(1u, playerEvents.size());
+	ASSERT_EQ(1u, localEvents.size());
+
+	EXPECT_EQ("\"facebook-1\"", GetMember(playerEvents[0], "facebook_id"));
+	EXPECT_EQ("\"google-1\"", GetMember(playerEvents[0], "googleplus_id"));
+	EXPECT_EQ("\"female\"", GetMember(playerEvents[0], "gender"));
+	EXPECT_EQ("1990", GetMember(playerEvents[0], "birth_year"));
+
+	// User data of the local user is left alone.
+	EXPECT_EQ("", GetMember(localEvents[0], "facebook_id"));
+	EXPECT_EQ("", GetMember(localEvents[0], "googleplus_id"));
+	EXPECT_EQ("", GetMember(localEvents[0], "gender"));
+	EXPECT_EQ("", GetMember(localEvents[0], "birth_year"));
+}
+
+TEST(CoreTests, EndsPlayerSessionWithEventsStillQueued)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto clock = std::make_shared<ManualClock>();
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath(), clock));
+	core->SetCompressionThreshold(1u << 30);
+	core->Init([](const InitResult &) {});
+	core->Flush();
+	transport->TakeBodies();
+
+	auto first = core->StartPlayerSession("player-1", 1);
+	auto second = core->StartPlayerSession("player-2", 1);
+
+	{
+		PlayerScope scope(*core, first);
+
+		for (auto i = 0; i < 3; ++i)
+		{
+			core->SendDesignEvent("Kill:First");
+		}
+	}
+
+	clock->Advance(30 * 1000);
+	core->EndPlayerSession(first);
+
+	// Ending the session within the scope of a player ends the session of that player.
+	{
+		PlayerScope scope(*core, second);
+		core->SendDesignEvent("Kill:Second");
+		core->SendSessionEndEvent();
+	}
+
+	// Handles of ended sessions aren't reused while their events are queued.
+	auto third = core->StartPlayerSession("player-3", 1);
+
+	EXPECT_NE(first.handle, third.handle);
+	EXPECT_NE(second.handle, third.handle);
+
+	core->Flush();
+
+	auto body = transport->TakeBodies();
+	auto firstEvents = GetEvents(body, "Kill:First");
+	auto sessionEnds = GetEventsOfCategory(body, "session_end");
+
+	ASSERT_EQ(3u, firstEvents.size());
+
+	for (auto & event : firstEvents)
+	{
+		EXPECT_EQ("\"player-1\"", GetMember(event, "user_id"));
+	}
+
+	ASSERT_EQ(2u, sessionEnds.size());
+	EXPECT_EQ("\"player-1\"", GetMember(sessionEnds[0], "user_id"));
+	EXPECT_EQ("30", GetMember(sessionEnds[0], "length"));
+	EXPECT_EQ("\"player-2\"", GetMember(sessionEnds[1], "user_id"));
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+}
+
+TEST(CoreTests, ReusesPlayerHandlesAfterFlush)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<RecordingTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+	core->SetCompressionThreshold(1u << 30);
+	core->Init([](const InitResult &) {});
+
+	auto first = core->StartPlayerSession("player-1", 4);
+
+	{
+		PlayerScope scope(*core, first);
+		core->SetFacebookId("facebook-1");
+		core->SendDesignEvent("Kill:First");
+	}
+
+	core->EndPlayerSession(first);
+	core->Flush();
+	transport->TakeBodies();
+
+	// The released player starts over, without any data of the previous one.
+	auto reused = core->StartPlayerSession("player-2", 1);
+
+	EXPECT_EQ(first.handle, reused.handle);
+
+	{
+		PlayerScope scope(*core, reused);
+		core->SendDesignEvent("Kill:Reused");
+	}
+
+	core->Flush();
+
+	auto events = GetEvents(transport->TakeBodies(), "Kill:Reused");
+
+	ASSERT_EQ(1u, events.size());
+	EXPECT_EQ("\"player-2\"", GetMember(events[0], "user_id"));
+	EXPECT_EQ("1", GetMember(events[0], "session_num"));
+	EXPECT_EQ("", GetMember(events[0], "facebook_id"));
+}
+
+TEST(CoreTests, SlicesFlushByPumpDeadline)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(transport, directory.GetPath(), std::make_shared<ManualClock>()));
+	core->Init([](const InitResult &) {});
+
+	for (auto i = 0; i < 100; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	core->RequestFlush();
+
+	// Time stands still, so each call without any time left stops at the first check of the deadline.
+	EXPECT_FALSE(core->Pump(0));
+
+	auto stored = core->GetMetrics().storedEvents;
+
+	EXPECT_GT(stored, 0u);
+	EXPECT_LT(stored, 100u);
+	EXPECT_EQ(100u - stored, core->GetMetrics().pendingEvents);
+
+	auto calls = 1;
+
+	while (stored < 100 && calls < 100)
+	{
+		EXPECT_FALSE(core->Pump(0));
+		++calls;
+
+		// Each slice makes progress.
+		auto metrics = core->GetMetrics();
+		EXPECT_GT(metrics.storedEvents, stored);
+		stored = metrics.storedEvents;
+	}
+
+	EXPECT_EQ(100u, stored);
+	EXPECT_GT(calls, 2);
+
+	// Sending is left to the next call with time left, too.
+	EXPECT_FALSE(core->Pump(0));
+	EXPECT_EQ(0u, transport->GetStatistics().eventsRequests);
+
+	EXPECT_TRUE(core->Pump(1000));
+
+	auto statistics = transport->GetStatistics();
+	EXPECT_EQ(100u, statistics.eventsReceived);
+	EXPECT_EQ(0u, statistics.rejectedRequests);
+}
+
+TEST(CoreTests, ResumesInterruptedFlush)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(transport, directory.GetPath(), std::make_shared<ManualClock>()));
+	core->Init([](const InitResult &) {});
+
+	for (auto i = 0; i < 100; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	core->RequestFlush();
+	EXPECT_FALSE(core->Pump(0));
+	ASSERT_LT(core->GetMetrics().storedEvents, 100u);
+
+	// Events queued meanwhile are flushed as well, after the interrupted flush has been completed.
+	for (auto i = 0; i < 50; ++i)
+	{
+		core->SendDesignEvent("Kill:Troll", static_cast<float>(i));
+	}
+
+	core->Flush();
+
+	auto metrics = core->GetMetrics();
+	EXPECT_EQ(150u, metrics.storedEvents);
+	EXPECT_EQ(0u, metrics.pendingEvents);
+	EXPECT_EQ(150u, transport->GetStatistics().eventsReceived);
+
+	// Nothing is left for the next call, nor sent twice.
+	EXPECT_TRUE(core->Pump(1000));
+	EXPECT_EQ(150u, transport->GetStatistics().eventsReceived);
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+}
+
+TEST(CoreTests, StopsWorkerCleanly)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(transport, directory.GetPath(), std::make_shared<ManualClock>()));
+	core->Init([](const InitResult &) {});
+
+	auto waitForEvents = [&transport](const uint64_t events)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		while (transport->GetStatistics().eventsReceived < events && std::chrono::steady_clock::now() - start < std::chrono::seconds(10))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		return transport->GetStatistics().eventsReceived;
+	};
+
+	core->StartWorker();
+
+	for (auto i = 0; i < 100; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	core->RequestFlush();
+	EXPECT_EQ(100u, waitForEvents(100));
+
+	core->StopWorker();
+	core->StopWorker();
+
+	// Nothing is done without the worker anymore, until Update is called.
+	for (auto i = 0; i < 10; ++i)
+	{
+		core->SendDesignEvent("Kill:Troll", static_cast<float>(i));
+	}
+
+	core->RequestFlush();
+	std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+	EXPECT_EQ(100u, transport->GetStatistics().eventsReceived);
+
+	core->Update();
+
+	EXPECT_EQ(110u, transport->GetStatistics().eventsReceived);
+
+	// The worker can be started again, and is stopped by releasing the core.
+	core->StartWorker();
+	core->SendDesignEvent("Kill:Goblin");
+	core->RequestFlush();
+
+	EXPECT_EQ(111u, waitForEvents(111));
+
+	core.reset();
+
+	EXPECT_EQ(0u, transport->GetStatistics().rejectedRequests);
+}
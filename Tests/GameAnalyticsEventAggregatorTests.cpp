@@ -0,0 +1,126 @@
+#include "GameAnalyticsEventAggregator.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <tuple>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	typedef std::tuple<EventCategory::EventCategory, uint8_t, std::string> AggregateKey;
+
+	// Takes all aggregates of the specified aggregator at the specified time.
+	std::map<AggregateKey, EventAggregate> TakeAggregates(EventAggregator & aggregator, const int64_t now)
+	{
+		std::map<AggregateKey, EventAggregate> aggregates;
+
+		aggregator.TakeAggregates(now, [&aggregates](EventCategory::EventCategory category, uint8_t subtype, const std::string & eventId, const EventAggregate & aggregate)
+		{
+			aggregates[AggregateKey(category, subtype, eventId)] = aggregate;
+		});
+
+		return aggregates;
+	}
+}
+
+
+TEST(EventAggregatorTests, KeepsStatisticsPerEventId)
+{
+	EventAggregator aggregator;
+	aggregator.AddPrefix("Kill:");
+
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", 3, true));
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", -1, true));
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", 7, true));
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Design, 0, "Kill:Troll", 0, false));
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Design, 0, "Kill:Troll", 0, false));
+
+	auto aggregates = TakeAggregates(aggregator, 0);
+	ASSERT_EQ(2u, aggregates.size());
+
+	auto & orc = aggregates[AggregateKey(EventCategory::Design, 0, "Kill:Orc")];
+	EXPECT_EQ(3u, orc.count);
+	EXPECT_TRUE(orc.hasValue);
+	EXPECT_EQ(9, orc.sum);
+	EXPECT_EQ(-1, orc.min);
+	EXPECT_EQ(7, orc.max);
+	EXPECT_EQ(3u, orc.quantiles.GetCount());
+
+	// Events without value are only counted.
+	auto & troll = aggregates[AggregateKey(EventCategory::Design, 0, "Kill:Troll")];
+	EXPECT_EQ(2u, troll.count);
+	EXPECT_FALSE(troll.hasValue);
+	EXPECT_EQ(0u, troll.quantiles.GetCount());
+}
+
+TEST(EventAggregatorTests, AggregatesOnlyDesignAndResourceEventsWithPrefix)
+{
+	EventAggregator aggregator;
+
+	// Nothing is aggregated without prefixes.
+	EXPECT_FALSE(aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", 1, true));
+
+	aggregator.AddPrefix("Kill:");
+	aggregator.AddPrefix("Gold:");
+
+	EXPECT_FALSE(aggregator.TryAdd(EventCategory::Design, 0, "Loot:Sword", 1, true));
+	EXPECT_FALSE(aggregator.TryAdd(EventCategory::Design, 0, "Kill", 1, true));
+	EXPECT_FALSE(aggregator.TryAdd(EventCategory::Business, 0, "Kill:Orc", 1, true));
+	EXPECT_FALSE(aggregator.TryAdd(EventCategory::Progression, 0, "Kill:Orc", 1, true));
+
+	// Resource events are aggregated per flow type.
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Resource, 1, "Gold:Coin", 10, true));
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Resource, 1, "Gold:Coin", 5, true));
+	EXPECT_TRUE(aggregator.TryAdd(EventCategory::Resource, 2, "Gold:Coin", 3, true));
+
+	auto aggregates = TakeAggregates(aggregator, 0);
+	ASSERT_EQ(2u, aggregates.size());
+
+	EXPECT_EQ(15, (aggregates[AggregateKey(EventCategory::Resource, 1, "Gold:Coin")].sum));
+	EXPECT_EQ(3, (aggregates[AggregateKey(EventCategory::Resource, 2, "Gold:Coin")].sum));
+}
+
+TEST(EventAggregatorTests, StartsNewWindowWhenTakingAggregates)
+{
+	EventAggregator aggregator;
+	aggregator.AddPrefix("Kill:");
+	aggregator.SetWindow(1000);
+
+	aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", 1, true);
+
+	EXPECT_TRUE(aggregator.IsWindowElapsed(1000));
+	EXPECT_EQ(1u, TakeAggregates(aggregator, 1000).size());
+
+	// Each window starts empty.
+	EXPECT_FALSE(aggregator.IsWindowElapsed(1999));
+	EXPECT_TRUE(aggregator.IsWindowElapsed(2000));
+	EXPECT_TRUE(TakeAggregates(aggregator, 1500).empty());
+
+	aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", 5, true);
+	aggregator.TryAdd(EventCategory::Design, 0, "Kill:Orc", 6, true);
+
+	auto aggregates = TakeAggregates(aggregator, 2500);
+	auto & orc = aggregates[AggregateKey(EventCategory::Design, 0, "Kill:Orc")];
+
+	EXPECT_EQ(2u, orc.count);
+	EXPECT_EQ(5, orc.min);
+	EXPECT_EQ(11, orc.sum);
+	EXPECT_FALSE(aggregator.IsWindowElapsed(3499));
+}
+
+TEST(EventAggregatorTests, RefusesTooManyPrefixes)
+{
+	EventAggregator aggregator;
+
+	for (size_t i = 0; i < EventAggregator::MaxPrefixes; ++i)
+	{
+		aggregator.AddPrefix("Prefix" + std::to_string(i) + ":");
+	}
+
+	// Adding a prefix again is fine.
+	EXPECT_NO_THROW(aggregator.AddPrefix("Prefix0:"));
+	EXPECT_THROW(aggregator.AddPrefix("Prefix:"), std::length_error);
+}
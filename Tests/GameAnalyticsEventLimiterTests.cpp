@@ -0,0 +1,51 @@
+#include "GameAnalyticsEventLimiter.h"
+
+#include <gtest/gtest.h>
+
+using namespace GameAnalytics;
+
+
+TEST(EventLimiterTests, LimitsEventIds)
+{
+	EventLimiter limiter;
+	limiter.SetEventIdRateLimit(1, 2);
+
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+	EXPECT_FALSE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+
+	// Other ids have their own limit, and tokens are refilled over time.
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Troll", 0));
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 1000));
+
+	EXPECT_EQ(1u, limiter.GetDroppedEvents(EventCategory::Design));
+}
+
+TEST(EventLimiterTests, LimitsSubtypesSeparately)
+{
+	EventLimiter limiter;
+	limiter.SetEventIdRateLimit(1, 1);
+
+	const uint8_t start = 1;
+	const uint8_t complete = 2;
+
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Progression, start, "World01:Level01", 0));
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Progression, complete, "World01:Level01", 0));
+	EXPECT_FALSE(limiter.TryAcquire(EventCategory::Progression, start, "World01:Level01", 0));
+}
+
+TEST(EventLimiterTests, GivesBackEventIdTokenIfCategoryIsLimited)
+{
+	EventLimiter limiter;
+	limiter.SetEventIdRateLimit(1, 2);
+	limiter.SetRateLimit(EventCategory::Design, 1, 1);
+
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+	EXPECT_FALSE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+	EXPECT_FALSE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+
+	// Events dropped by the category limit haven't used up the limit of their id.
+	limiter.SetRateLimit(EventCategory::Design, 0, 1);
+	EXPECT_TRUE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+	EXPECT_FALSE(limiter.TryAcquire(EventCategory::Design, 0, "Kill:Orc", 0));
+}
@@ -0,0 +1,103 @@
+#include "GameAnalyticsEventQueue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	EventRecord GetDesignEvent()
+	{
+		EventRecord record = {};
+		record.category = EventCategory::Design;
+		record.eventId = "Kill:Sword:Robot";
+		return record;
+	}
+
+	void EnqueueEvents(EventQueue & queue, const int count)
+	{
+		for (auto i = 0; i < count; ++i)
+		{
+			bool full;
+			queue.TryEnqueue(GetDesignEvent(), 32, full);
+		}
+	}
+
+	size_t TakeEvents(EventQueue & queue)
+	{
+		size_t count = 0;
+		queue.TakeEvents([&count](EventRing & events) { count += events.GetCount(); });
+		return count;
+	}
+}
+
+
+TEST(EventQueueTests, TakesEventsOfExitedThreads)
+{
+	MemoryBudget budget;
+	EventQueue queue(64, 1 << 20, budget);
+
+	std::thread([&queue]() { EnqueueEvents(queue, 3); }).join();
+
+	EXPECT_EQ(3u, TakeEvents(queue));
+	EXPECT_EQ(3u, queue.GetEnqueuedEvents());
+}
+
+TEST(EventQueueTests, ReusesProducersOfExitedThreads)
+{
+	MemoryBudget budget;
+	EventQueue queue(64, 1 << 20, budget);
+
+	std::thread([&queue]() { EnqueueEvents(queue, 10); }).join();
+	TakeEvents(queue);
+
+	auto usedBytes = budget.GetUsedBytes();
+
+	size_t taken = 0;
+
+	for (auto i = 0; i < 1000; ++i)
+	{
+		std::thread([&queue]() { EnqueueEvents(queue, 10); }).join();
+		taken += TakeEvents(queue);
+	}
+
+	EXPECT_EQ(10000u, taken);
+	EXPECT_EQ(usedBytes, budget.GetUsedBytes());
+	EXPECT_EQ(10010u, queue.GetEnqueuedEvents());
+}
+
+TEST(EventQueueTests, KeepsProducersOfConcurrentThreads)
+{
+	MemoryBudget budget;
+	EventQueue queue(64, 1 << 20, budget);
+
+	const auto threadCount = 8;
+	const auto eventsPerThread = 1000;
+
+	for (auto round = 0; round < 4; ++round)
+	{
+		std::vector<std::thread> threads;
+
+		for (auto i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back([&queue]() { EnqueueEvents(queue, eventsPerThread); });
+		}
+
+		size_t taken = 0;
+
+		for (auto & thread : threads)
+		{
+			taken += TakeEvents(queue);
+			thread.join();
+		}
+
+		taken += TakeEvents(queue);
+		EXPECT_EQ(static_cast<size_t>(threadCount * eventsPerThread), taken);
+	}
+
+	EXPECT_EQ(4u * threadCount * eventsPerThread, queue.GetEnqueuedEvents());
+	EXPECT_EQ(0u, queue.GetDroppedEvents());
+}
@@ -0,0 +1,131 @@
+#include "GameAnalyticsEventSchema.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	constexpr uint32_t CategoryBit(const EventCategory::EventCategory category)
+	{
+		return 1u << category;
+	}
+
+	// Typed ids declared constexpr are checked and hashed by the compiler.
+	constexpr DesignEventId PickedUpShotgunAmmo("PickedUpAmmo:Shotgun");
+	static_assert(PickedUpShotgunAmmo.GetHash() == HashString("PickedUpAmmo:Shotgun"), "Typed ids have to be hashed at compile time.");
+	static_assert(EventSchema::IsValidEventId(EventCategory::Resource, "Gold:Weapon:Sword"), "Event ids have to be checked at compile time.");
+	static_assert(!EventSchema::IsValidEventId(EventCategory::Design, "Kill::Orc"), "Event ids have to be checked at compile time.");
+}
+
+
+TEST(EventSchemaTests, CountsParts)
+{
+	EXPECT_EQ(CategoryBit(EventCategory::Design) | CategoryBit(EventCategory::Progression), EventSchema::GetValidCategories("Kill"));
+	EXPECT_EQ(CategoryBit(EventCategory::Design) | CategoryBit(EventCategory::Business) | CategoryBit(EventCategory::Progression),
+		EventSchema::GetValidCategories("Weapon:Sword"));
+	EXPECT_EQ(CategoryBit(EventCategory::Design) | CategoryBit(EventCategory::Progression) | CategoryBit(EventCategory::Resource),
+		EventSchema::GetValidCategories("Gold:Weapon:Sword"));
+	EXPECT_EQ(CategoryBit(EventCategory::Design), EventSchema::GetValidCategories("World1:Chapter2:Level3:Wave4:Boss"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("World1:Chapter2:Level3:Wave4:Boss:Kill"));
+}
+
+TEST(EventSchemaTests, RejectsEmptyParts)
+{
+	EXPECT_EQ(0u, EventSchema::GetValidCategories(""));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories(":Kill"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill:"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill::Orc"));
+}
+
+TEST(EventSchemaTests, LimitsPartLength)
+{
+	std::string longest(EventSchema::MaxPartLength, 'a');
+	std::string tooLong(EventSchema::MaxPartLength + 1, 'a');
+
+	EXPECT_NE(0u, EventSchema::GetValidCategories(longest + ":Kill"));
+	EXPECT_NE(0u, EventSchema::GetValidCategories("Kill:" + longest));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories(tooLong + ":Kill"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill:" + tooLong));
+}
+
+TEST(EventSchemaTests, RejectsCharactersToEscape)
+{
+	EXPECT_NE(0u, EventSchema::GetValidCategories("Kill (Boss)!?_-. 2"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill/Orc"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill:\"Orc\""));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill\\Orc"));
+	EXPECT_EQ(0u, EventSchema::GetValidCategories("Kill\xc3\xb6rc"));
+}
+
+TEST(EventSchemaTests, RequiresLettersForCurrencies)
+{
+	EXPECT_TRUE(EventSchema::IsValidEventId(EventCategory::Resource, "Gold:Weapon:Sword 2"));
+	EXPECT_FALSE(EventSchema::IsValidEventId(EventCategory::Resource, "G0ld:Weapon:Sword"));
+	EXPECT_FALSE(EventSchema::IsValidEventId(EventCategory::Resource, "Gold Coins:Weapon:Sword"));
+
+	EXPECT_TRUE(EventSchema::IsValidCurrency("USD"));
+	EXPECT_FALSE(EventSchema::IsValidCurrency("usd"));
+	EXPECT_FALSE(EventSchema::IsValidCurrency("US"));
+
+	EXPECT_TRUE(EventSchema::IsValidCartType(std::string(EventSchema::MaxCartTypeLength, 'a')));
+	EXPECT_FALSE(EventSchema::IsValidCartType(std::string(EventSchema::MaxCartTypeLength + 1, 'a')));
+}
+
+TEST(EventSchemaTests, ThrowsForInvalidTypedIds)
+{
+	EXPECT_NO_THROW(ProgressionEventId("World1:Level2"));
+	EXPECT_THROW(ProgressionEventId("World1:Chapter2:Level3:Wave4"), std::invalid_argument);
+	EXPECT_THROW(BusinessEventId("Sword"), std::invalid_argument);
+	EXPECT_THROW(DesignEventId("Kill::Orc"), std::invalid_argument);
+}
+
+TEST(EventSchemaTests, CoreDropsInvalidEvents)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+	core->Init([](const InitResult &) {});
+
+	constexpr BusinessEventId sword("Weapon:Sword");
+	constexpr ProgressionEventId level("World1:Level2");
+	constexpr ResourceEventId goldForSword("Gold:Weapon:Sword");
+
+	// Valid events.
+	core->SendBusinessEvent(sword, "USD", 99);
+	core->SendBusinessEvent(sword, "EUR", 99, "menu_shop");
+	core->SendProgressionEvent(ProgressionStatus::Start, level);
+	core->SendProgressionEvent(ProgressionStatus::Complete, level, 10);
+	core->SendResourceEvent(FlowType::Sink, goldForSword, 5);
+	core->SendResourceEvent(FlowType::Source, "Gold", "Weapon", "Axe", 5);
+	core->SendDesignEvent("Kill:Orc", 1.0f);
+
+	// Invalid events, each of which would get its whole batch rejected by the backend.
+	core->SendBusinessEvent(sword, "usd", 99);
+	core->SendResourceEvent(FlowType::Source, "G0ld", "Weapon", "Axe", 5);
+	core->SendDesignEvent("Kill::Orc", 1.0f);
+	core->SendDesignEvent("Kill/Orc", 1.0f);
+	core->SendDesignEvent("Kill:Orc:Sword:Fire:Critical:Hit", 1.0f);
+
+	// Registered ids are checked once, for all categories.
+	auto registered = core->RegisterEventId("Gold:Weapon:Sword");
+	core->SendResourceEvent(FlowType::Sink, registered, 1);
+	core->SendDesignEvent(registered);
+	core->SendBusinessEvent(registered, "USD", 1);
+
+	core->Flush();
+
+	auto statistics = transport->GetStatistics();
+	EXPECT_EQ(9u, statistics.eventsReceived);
+	EXPECT_EQ(0u, statistics.rejectedRequests);
+	EXPECT_EQ(6u, core->GetMetrics().invalidEvents);
+}
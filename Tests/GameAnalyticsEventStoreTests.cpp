@@ -0,0 +1,507 @@
+#include "GameAnalyticsEventStore.h"
+#include "GameAnalyticsTestDirectory.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const uint64_t MaxSegmentBytes = 64 * 1024;
+	const uint64_t MaxTotalBytes = 1024 * 1024;
+
+	// Each record consists of an 8 byte header and the event itself.
+	const uint64_t RecordHeaderSize = 8;
+
+	std::string GetEvent(const int index)
+	{
+		return "{\"index\":" + std::to_string(index) + "}";
+	}
+
+	void AppendEvents(EventStore & store, const int first, const int count)
+	{
+		EventBatch batch;
+
+		for (auto i = first; i < first + count; ++i)
+		{
+			auto event = GetEvent(i);
+			batch.Add(event.data(), event.size());
+		}
+
+		ASSERT_EQ(static_cast<size_t>(count), store.Append(batch));
+	}
+
+	// Reads all unacknowledged events from the specified store as single JSON array.
+	std::string ReadAll(const EventStore & store)
+	{
+		std::string batch;
+		EventStore::Position end;
+		store.ReadBatch(EventStore::Position{ 0, 0 }, 1 << 20, 1 << 30, batch, end);
+		return batch;
+	}
+
+	std::string GetExpectedBatch(const int first, const int count)
+	{
+		if (count == 0)
+		{
+			return "";
+		}
+
+		std::string batch;
+
+		for (auto i = first; i < first + count; ++i)
+		{
+			batch += i == first ? '[' : ',';
+			batch += GetEvent(i);
+		}
+
+		return batch + "]";
+	}
+
+	std::vector<std::filesystem::path> GetSegments(const std::filesystem::path & directory)
+	{
+		std::vector<std::filesystem::path> segments;
+
+		for (auto & entry : std::filesystem::directory_iterator(directory))
+		{
+			if (entry.path().extension() == ".log")
+			{
+				segments.push_back(entry.path());
+			}
+		}
+
+		std::sort(segments.begin(), segments.end());
+		return segments;
+	}
+
+	void AppendBytes(const std::filesystem::path & path, const std::string & bytes)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::app);
+		file.write(bytes.data(), bytes.size());
+	}
+}
+
+
+TEST(EventStoreTests, ReplaysEventsAfterReopen)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 3);
+	}
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(0, 3), ReadAll(store));
+	EXPECT_FALSE(store.IsEmpty());
+}
+
+TEST(EventStoreTests, ReadsBatchesWithinLimits)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	AppendEvents(store, 0, 10);
+
+	std::string batch;
+	EventStore::Position end;
+
+	EXPECT_EQ(4u, store.ReadBatch(EventStore::Position{ 0, 0 }, 4, 1 << 20, batch, end));
+	EXPECT_EQ(GetExpectedBatch(0, 4), batch);
+
+	EXPECT_EQ(6u, store.ReadBatch(end, 100, 1 << 20, batch, end));
+	EXPECT_EQ(GetExpectedBatch(4, 6), batch);
+
+	// Oversized events are still read on their own.
+	EXPECT_EQ(1u, store.ReadBatch(EventStore::Position{ 0, 0 }, 100, 1, batch, end));
+	EXPECT_EQ(GetExpectedBatch(0, 1), batch);
+}
+
+TEST(EventStoreTests, DiscardsTornRecordAtEndOfLog)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 2);
+	}
+
+	// Simulate crash while writing a record: Header claims more bytes than have been written.
+	auto segments = GetSegments(directory.GetPath());
+	ASSERT_EQ(1u, segments.size());
+
+	auto validSize = std::filesystem::file_size(segments.back());
+	AppendBytes(segments.back(), std::string("\x64\x00\x00\x00\x12\x34\x56\x78{\"ind", 13));
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		EXPECT_EQ(validSize, store.GetSize());
+		EXPECT_EQ(GetExpectedBatch(0, 2), ReadAll(store));
+
+		// Events appended after recovery must not be hidden behind the torn record.
+		AppendEvents(store, 2, 1);
+	}
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(0, 3), ReadAll(store));
+}
+
+TEST(EventStoreTests, DiscardsRecordWithInvalidChecksum)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 3);
+	}
+
+	// Corrupt the last byte of the last event.
+	auto segment = GetSegments(directory.GetPath()).back();
+	auto size = std::filesystem::file_size(segment);
+
+	{
+		std::fstream file(segment, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(static_cast<std::streamoff>(size - 1));
+		file.put('#');
+	}
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(0, 2), ReadAll(store));
+	EXPECT_EQ(size - RecordHeaderSize - GetEvent(2).size(), store.GetSize());
+}
+
+TEST(EventStoreTests, RecoversFromCrashAtAnyByte)
+{
+	TestDirectory source;
+	const auto count = 5;
+
+	{
+		EventStore store(source.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, count);
+	}
+
+	auto segment = GetSegments(source.GetPath()).back();
+	auto size = std::filesystem::file_size(segment);
+
+	// Simulate the operating system having written only the first bytes of the segment to disk.
+	for (uint64_t length = 0; length <= size; ++length)
+	{
+		TestDirectory directory;
+		auto truncated = directory.GetPath() / segment.filename();
+		std::filesystem::copy_file(segment, truncated);
+		std::filesystem::resize_file(truncated, length);
+
+		// Count events written completely.
+		uint64_t completeSize = 0;
+		auto complete = 0;
+
+		while (complete < count && completeSize + RecordHeaderSize + GetEvent(complete).size() <= length)
+		{
+			completeSize += RecordHeaderSize + GetEvent(complete).size();
+			++complete;
+		}
+
+		{
+			EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+			EXPECT_EQ(GetExpectedBatch(0, complete), ReadAll(store)) << "Segment truncated to " << length << " bytes.";
+			EXPECT_EQ(completeSize, store.GetSize()) << "Segment truncated to " << length << " bytes.";
+
+			AppendEvents(store, complete, count - complete);
+		}
+
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		EXPECT_EQ(GetExpectedBatch(0, count), ReadAll(store)) << "Segment truncated to " << length << " bytes.";
+	}
+}
+
+TEST(EventStoreTests, DiscardsTornRecordsOfEarlierSegments)
+{
+	TestDirectory directory;
+	const auto count = 40;
+
+	{
+		EventStore store(directory.GetPath(), 256, MaxTotalBytes);
+		AppendEvents(store, 0, count);
+	}
+
+	auto segments = GetSegments(directory.GetPath());
+	ASSERT_GE(segments.size(), 3u);
+
+	// Full segments are flushed to disk only with the next sync, so a crash may leave any of them incomplete.
+	// Simulate the last record of the first segment having been cut off, and the one of the second segment never having been written.
+	std::vector<int> lost;
+	auto first = 0;
+
+	for (size_t i = 0; i < 2; ++i)
+	{
+		auto size = std::filesystem::file_size(segments[i]);
+		uint64_t offset = 0;
+		auto last = first;
+
+		while (offset + RecordHeaderSize + GetEvent(last).size() < size)
+		{
+			offset += RecordHeaderSize + GetEvent(last).size();
+			++last;
+		}
+
+		lost.push_back(last);
+		first = last + 1;
+
+		if (i == 0)
+		{
+			std::filesystem::resize_file(segments[i], size - 3);
+		}
+		else
+		{
+			std::fstream file(segments[i], std::ios::binary | std::ios::in | std::ios::out);
+			file.seekp(static_cast<std::streamoff>(offset));
+			file.write(std::string(static_cast<size_t>(size - offset), '\0').data(), static_cast<std::streamsize>(size - offset));
+		}
+	}
+
+	std::string expected;
+
+	for (auto i = 0; i < count; ++i)
+	{
+		if (std::find(lost.begin(), lost.end(), i) == lost.end())
+		{
+			expected += expected.empty() ? '[' : ',';
+			expected += GetEvent(i);
+		}
+	}
+
+	expected += ']';
+
+	{
+		EventStore store(directory.GetPath(), 256, MaxTotalBytes);
+		EXPECT_EQ(expected, ReadAll(store));
+
+		uint64_t size = 0;
+
+		for (auto & segment : GetSegments(directory.GetPath()))
+		{
+			size += std::filesystem::file_size(segment);
+		}
+
+		EXPECT_EQ(size, store.GetSize());
+	}
+
+	// Segments have been truncated, so reopening doesn't find anything else to discard.
+	EventStore store(directory.GetPath(), 256, MaxTotalBytes);
+	EXPECT_EQ(expected, ReadAll(store));
+}
+
+TEST(EventStoreTests, KeepsAcknowledgedPositionAfterReopen)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 5);
+
+		std::string batch;
+		EventStore::Position end;
+		store.ReadBatch(store.GetAcknowledged(), 3, 1 << 20, batch, end);
+		store.Acknowledge(end);
+	}
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		EXPECT_EQ(GetExpectedBatch(3, 2), ReadAll(store));
+
+		std::string batch;
+		EventStore::Position end;
+		store.ReadBatch(store.GetAcknowledged(), 100, 1 << 20, batch, end);
+		store.Acknowledge(end);
+		EXPECT_TRUE(store.IsEmpty());
+	}
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_TRUE(store.IsEmpty());
+	EXPECT_EQ("", ReadAll(store));
+}
+
+TEST(EventStoreTests, SendsEventsAgainIfCursorIsCorrupt)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 5);
+
+		std::string batch;
+		EventStore::Position end;
+		store.ReadBatch(store.GetAcknowledged(), 3, 1 << 20, batch, end);
+		store.Acknowledge(end);
+	}
+
+	// Sending events twice is better than losing them.
+	std::filesystem::resize_file(directory.GetPath() / "cursor", 10);
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(0, 5), ReadAll(store));
+}
+
+TEST(EventStoreTests, IgnoresIncompleteCursorReplacement)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 5);
+
+		std::string batch;
+		EventStore::Position end;
+		store.ReadBatch(store.GetAcknowledged(), 2, 1 << 20, batch, end);
+		store.Acknowledge(end);
+	}
+
+	// Simulate crash while writing the next cursor.
+	AppendBytes(directory.GetPath() / "cursor.tmp", "\x0c\x00");
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(2, 3), ReadAll(store));
+}
+
+TEST(EventStoreTests, SendsEventsAppendedAfterCursorBeyondRecoveredEnd)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 5);
+
+		std::string batch;
+		EventStore::Position end;
+		store.ReadBatch(store.GetAcknowledged(), 5, 1 << 20, batch, end);
+		store.Acknowledge(end);
+	}
+
+	// Simulate power loss after the cursor has been synced, but before the last events of the segment have been.
+	auto segment = GetSegments(directory.GetPath()).back();
+	std::filesystem::resize_file(segment, RecordHeaderSize + GetEvent(0).size());
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		EXPECT_TRUE(store.IsEmpty());
+
+		AppendEvents(store, 5, 2);
+		EXPECT_EQ(GetExpectedBatch(5, 2), ReadAll(store));
+	}
+
+	// Events appended after recovery must not be hidden behind the cursor.
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(5, 2), ReadAll(store));
+}
+
+TEST(EventStoreTests, RotatesAndDeletesAcknowledgedSegments)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 256, MaxTotalBytes);
+
+	AppendEvents(store, 0, 100);
+	EXPECT_GT(GetSegments(directory.GetPath()).size(), 5u);
+	EXPECT_EQ(GetExpectedBatch(0, 100), ReadAll(store));
+
+	std::string batch;
+	EventStore::Position end;
+	store.ReadBatch(store.GetAcknowledged(), 100, 1 << 20, batch, end);
+	store.Acknowledge(end);
+
+	EXPECT_TRUE(store.IsEmpty());
+	EXPECT_EQ(1u, GetSegments(directory.GetPath()).size());
+}
+
+TEST(EventStoreTests, EvictsOldestEventsFirst)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), 256, 1024);
+		AppendEvents(store, 0, 200);
+		EXPECT_LE(store.GetSize(), 1024u + 256u);
+	}
+
+	EventStore store(directory.GetPath(), 256, 1024);
+	auto batch = ReadAll(store);
+
+	EXPECT_EQ(std::string::npos, batch.find(GetEvent(0)));
+	EXPECT_NE(std::string::npos, batch.find(GetEvent(199) + "]"));
+}
+
+TEST(EventStoreTests, EvictsOldestEventsWhenReopenedWithSmallerSize)
+{
+	TestDirectory directory;
+
+	{
+		EventStore store(directory.GetPath(), 256, MaxTotalBytes);
+		AppendEvents(store, 0, 200);
+		EXPECT_GT(store.GetSize(), 1024u + 256u);
+	}
+
+	EventStore store(directory.GetPath(), 256, 1024);
+	EXPECT_LE(store.GetSize(), 1024u + 256u);
+
+	auto batch = ReadAll(store);
+	EXPECT_EQ(std::string::npos, batch.find(GetEvent(0)));
+	EXPECT_NE(std::string::npos, batch.find(GetEvent(199) + "]"));
+}
+
+#ifndef _WIN32
+TEST(EventStoreTests, RollsBackFailedWrites)
+{
+	TestDirectory directory;
+	uint64_t sizeBeforeFailure;
+
+	{
+		EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+		AppendEvents(store, 0, 10);
+		sizeBeforeFailure = store.GetSize();
+
+		// Simulate full disk by limiting the file size, which makes writes fail instead of raising SIGXFSZ.
+		rlimit previousLimit;
+		getrlimit(RLIMIT_FSIZE, &previousLimit);
+
+		rlimit limit = previousLimit;
+		limit.rlim_cur = sizeBeforeFailure + 100;
+
+		auto previousHandler = signal(SIGXFSZ, SIG_IGN);
+		setrlimit(RLIMIT_FSIZE, &limit);
+
+		EventBatch batch;
+
+		for (auto i = 10; i < 1000; ++i)
+		{
+			auto event = GetEvent(i);
+			batch.Add(event.data(), event.size());
+		}
+
+		auto appended = store.Append(batch);
+
+		setrlimit(RLIMIT_FSIZE, &previousLimit);
+		signal(SIGXFSZ, previousHandler);
+
+		// Records are buffered, so the whole batch is discarded.
+		EXPECT_EQ(0u, appended);
+		EXPECT_EQ(sizeBeforeFailure, store.GetSize());
+		EXPECT_EQ(sizeBeforeFailure, std::filesystem::file_size(GetSegments(directory.GetPath()).back()));
+
+		// Appending works again as soon as there's space.
+		AppendEvents(store, 10, 1);
+	}
+
+	EventStore store(directory.GetPath(), MaxSegmentBytes, MaxTotalBytes);
+	EXPECT_EQ(GetExpectedBatch(0, 11), ReadAll(store));
+}
+#endif
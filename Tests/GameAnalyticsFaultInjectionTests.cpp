@@ -0,0 +1,155 @@
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Core sending events to a loopback transport that answers immediately, with a clock advanced by the test.
+	class FaultInjectionTests : public testing::Test
+	{
+	protected:
+		FaultInjectionTests()
+			: transport(std::make_shared<LoopbackTransport>()),
+			clock(std::make_shared<ManualClock>())
+		{
+			this->transport->SetSecretKey(TestSecretKey);
+
+			this->core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(this->transport, this->directory.GetPath(), this->clock));
+			this->core->Init([](const InitResult &) {});
+		}
+
+		void SendEvents(const int count)
+		{
+			for (auto i = 0; i < count; ++i)
+			{
+				this->core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+			}
+		}
+
+		// Lets the specified time pass in steps of a second, updating the core after each.
+		void Wait(const int64_t milliseconds)
+		{
+			for (int64_t waited = 0; waited < milliseconds; waited += 1000)
+			{
+				this->clock->Advance(1000);
+				this->core->Update();
+			}
+		}
+
+		TestDirectory directory;
+		std::shared_ptr<LoopbackTransport> transport;
+		std::shared_ptr<ManualClock> clock;
+		std::shared_ptr<GameAnalyticsCore> core;
+	};
+}
+
+
+TEST_F(FaultInjectionTests, DropsOnlyRejectedEvents)
+{
+	this->transport->SetRejectedText("Poison");
+
+	for (auto i = 0; i < 64; ++i)
+	{
+		this->core->SendDesignEvent(i == 37 || i == 38 ? "Poison:Orc" : "Kill:Orc", static_cast<float>(i));
+	}
+
+	this->core->Flush();
+
+	auto statistics = this->transport->GetStatistics();
+	EXPECT_EQ(62u, statistics.eventsReceived);
+
+	// The backend tells which events it has rejected, so the other ones are sent again at once.
+	EXPECT_EQ(2u, statistics.eventsRequests);
+	EXPECT_EQ(1u, statistics.rejectedRequests);
+}
+
+TEST_F(FaultInjectionTests, RetriesFailedBatchesAfterBackoff)
+{
+	this->transport->ScriptEventsResponses({ 503, 0, 500 });
+
+	SendEvents(10);
+	this->core->Flush();
+
+	auto statistics = this->transport->GetStatistics();
+	EXPECT_EQ(1u, statistics.eventsRequests);
+	EXPECT_EQ(0u, statistics.eventsReceived);
+
+	// No retry before the minimum backoff of a second has passed, even if asked to flush.
+	this->core->Flush();
+	this->core->Update();
+	EXPECT_EQ(1u, this->transport->GetStatistics().eventsRequests);
+
+	// Each failure at most doubles the backoff: 1, 2 and 4 seconds.
+	Wait(1000 + 2000 + 4000);
+
+	statistics = this->transport->GetStatistics();
+	EXPECT_EQ(4u, statistics.eventsRequests);
+	EXPECT_EQ(10u, statistics.eventsReceived);
+}
+
+TEST_F(FaultInjectionTests, DropsBatchesAfterRetryBudget)
+{
+	this->core->SetMaxBatchRetries(2);
+	this->transport->ScriptEventsResponses({ 500, 500, 500 });
+
+	SendEvents(10);
+	this->core->Flush();
+	Wait(1000 + 2000 + 4000);
+
+	// Batch is given up after the third server error, so it doesn't block later events.
+	auto statistics = this->transport->GetStatistics();
+	EXPECT_EQ(3u, statistics.eventsRequests);
+	EXPECT_EQ(0u, statistics.eventsReceived);
+
+	SendEvents(5);
+	this->core->Flush();
+	Wait(8000);
+
+	statistics = this->transport->GetStatistics();
+	EXPECT_EQ(4u, statistics.eventsRequests);
+	EXPECT_EQ(5u, statistics.eventsReceived);
+}
+
+TEST_F(FaultInjectionTests, KeepsEventsWhileOffline)
+{
+	// Network errors don't use up the retry budget.
+	this->core->SetMaxBatchRetries(1);
+	this->transport->ScriptEventsResponses({ 0, 0, 0, 0, 0 });
+
+	SendEvents(10);
+	this->core->Flush();
+	Wait(10 * 60 * 1000);
+
+	auto statistics = this->transport->GetStatistics();
+	EXPECT_EQ(6u, statistics.eventsRequests);
+	EXPECT_EQ(10u, statistics.eventsReceived);
+}
+
+TEST_F(FaultInjectionTests, StopsSendingWhenUnauthorized)
+{
+	this->transport->ScriptEventsResponses({ 401 });
+
+	SendEvents(10);
+	this->core->Flush();
+	Wait(10 * 60 * 1000);
+
+	// Sending again with the same keys won't help.
+	auto statistics = this->transport->GetStatistics();
+	EXPECT_EQ(1u, statistics.eventsRequests);
+	EXPECT_EQ(0u, statistics.eventsReceived);
+
+	// Events are kept, and sent after the next successful init.
+	this->core->Init([](const InitResult &) {});
+	Wait(1000);
+
+	statistics = this->transport->GetStatistics();
+	EXPECT_EQ(2u, statistics.eventsRequests);
+	EXPECT_EQ(10u, statistics.eventsReceived);
+}
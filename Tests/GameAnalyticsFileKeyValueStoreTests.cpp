@@ -0,0 +1,85 @@
+#include "GameAnalyticsFileKeyValueStore.h"
+#include "GameAnalyticsTestDirectory.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <system_error>
+
+using namespace GameAnalytics;
+
+
+TEST(FileKeyValueStoreTests, LoadsCommittedValues)
+{
+	TestDirectory directory;
+	auto path = directory.GetPath() / "settings";
+
+	{
+		FileKeyValueStore store(path);
+
+		EXPECT_EQ(0, store.GetInt32OrDefault("GameAnalytics::Session"));
+
+		store.SetInt32("GameAnalytics::Session", 3);
+		store.SetInt32("GameAnalytics::Transaction", -200);
+
+		EXPECT_TRUE(store.Commit());
+	}
+
+	FileKeyValueStore store(path);
+
+	EXPECT_EQ(3, store.GetInt32OrDefault("GameAnalytics::Session"));
+	EXPECT_EQ(-200, store.GetInt32OrDefault("GameAnalytics::Transaction"));
+	EXPECT_EQ(0, store.GetInt32OrDefault("GameAnalytics::Unknown"));
+}
+
+TEST(FileKeyValueStoreTests, KeepsPreviousFileIfCommitFails)
+{
+	TestDirectory directory;
+	auto path = directory.GetPath() / "settings";
+	auto temporaryPath = directory.GetPath() / "settings.tmp";
+
+	FileKeyValueStore store(path);
+	store.SetInt32("GameAnalytics::Transaction", 100);
+	ASSERT_TRUE(store.Commit());
+
+	// Temporary file can't be created where a directory is in the way.
+	std::filesystem::create_directory(temporaryPath);
+
+	store.SetInt32("GameAnalytics::Transaction", 200);
+	EXPECT_FALSE(store.Commit());
+	EXPECT_EQ(100, FileKeyValueStore(path).GetInt32OrDefault("GameAnalytics::Transaction"));
+
+	// Values that couldn't be written are written with the next commit.
+	std::filesystem::remove(temporaryPath);
+
+	EXPECT_TRUE(store.Commit());
+	EXPECT_EQ(200, FileKeyValueStore(path).GetInt32OrDefault("GameAnalytics::Transaction"));
+}
+
+#ifndef _WIN32
+TEST(FileKeyValueStoreTests, KeepsPreviousFileIfDiskIsFull)
+{
+	std::error_code error;
+
+	if (!std::filesystem::exists("/dev/full", error))
+	{
+		GTEST_SKIP() << "No /dev/full to simulate a full disk with.";
+	}
+
+	TestDirectory directory;
+	auto path = directory.GetPath() / "settings";
+	auto temporaryPath = directory.GetPath() / "settings.tmp";
+
+	FileKeyValueStore store(path);
+	store.SetInt32("GameAnalytics::Transaction", 100);
+	ASSERT_TRUE(store.Commit());
+
+	// Writes to /dev/full fail with ENOSPC once flushed, like writes to a full disk.
+	std::filesystem::create_symlink("/dev/full", temporaryPath);
+
+	store.SetInt32("GameAnalytics::Transaction", 200);
+	EXPECT_FALSE(store.Commit());
+	EXPECT_EQ(100, FileKeyValueStore(path).GetInt32OrDefault("GameAnalytics::Transaction"));
+	EXPECT_FALSE(std::filesystem::is_symlink(temporaryPath, error));
+}
+#endif
@@ -0,0 +1,270 @@
+#include "GameAnalyticsGzip.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(GAMEANALYTICS_TEST_ZLIB)
+#include <zlib.h>
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Gzip stream of "Kill:Orc,Kill:Orc,Kill:Orc" written by zlib with fixed Huffman codes and matches.
+	const std::vector<uint8_t> ZlibFixedStream =
+	{
+		0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xF3, 0xCE, 0xCC, 0xC9, 0xB1, 0xF2,
+		0x2F, 0x4A, 0xD6, 0xF1, 0x46, 0x67, 0x00, 0x00, 0xB8, 0x66, 0xB6, 0xE6, 0x1A, 0x00, 0x00, 0x00
+	};
+
+	// Gzip stream of "Kill:Orc" written by zlib as stored block.
+	const std::vector<uint8_t> ZlibStoredStream =
+	{
+		0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x03, 0x01, 0x08, 0x00, 0xF7, 0xFF, 0x4B,
+		0x69, 0x6C, 0x6C, 0x3A, 0x4F, 0x72, 0x63, 0x27, 0xA4, 0xED, 0x01, 0x08, 0x00, 0x00, 0x00
+	};
+
+	// Gzip stream of 20 times "a" and 69 times "b" written by zlib with dynamic Huffman codes.
+	const std::vector<uint8_t> ZlibDynamicStream =
+	{
+		0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x05, 0xC1, 0x01, 0x01, 0x00, 0x00,
+		0x00, 0x80, 0x90, 0xAD, 0xF9, 0x3F, 0x22, 0xAA, 0xAA, 0xAA, 0xAA, 0xAA, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0xC0, 0x16, 0x64, 0x46, 0x23, 0x59, 0x00, 0x00, 0x00
+	};
+
+	// Compresses the specified data, passing it in pieces of the specified size.
+	std::vector<uint8_t> Compress(const std::string & data, const size_t pieceSize)
+	{
+		GzipCompressor compressor;
+
+		for (size_t offset = 0; offset < data.size(); offset += pieceSize)
+		{
+			compressor.Write(data.data() + offset, std::min(pieceSize, data.size() - offset));
+		}
+
+		return compressor.Finish();
+	}
+
+	// Decompresses the specified gzip stream with an inflater independent of the compressor, zlib if available.
+	bool Decompress(const std::vector<uint8_t> & compressed, std::string & output)
+	{
+#if defined(GAMEANALYTICS_TEST_ZLIB)
+		z_stream stream = {};
+
+		// Accept gzip streams only.
+		if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK)
+		{
+			return false;
+		}
+
+		stream.next_in = const_cast<Bytef *>(compressed.data());
+		stream.avail_in = static_cast<uInt>(compressed.size());
+
+		output.clear();
+		char buffer[16384];
+		int result;
+
+		do
+		{
+			stream.next_out = reinterpret_cast<Bytef *>(buffer);
+			stream.avail_out = sizeof(buffer);
+
+			result = inflate(&stream, Z_NO_FLUSH);
+			output.append(buffer, sizeof(buffer) - stream.avail_out);
+		}
+		while (result == Z_OK);
+
+		// The stream must end exactly where its data ends.
+		auto complete = result == Z_STREAM_END && stream.avail_in == 0;
+		inflateEnd(&stream);
+		return complete;
+#else
+		return GzipDecompress(compressed.data(), compressed.size(), output);
+#endif
+	}
+
+	// Event batch like the core sends, repeating keys and annotations.
+	std::string GetEventBatch(const size_t bytes)
+	{
+		std::string batch = "[";
+
+		for (auto i = 0; batch.size() < bytes; ++i)
+		{
+			batch += "{\"category\":\"design\",\"event_id\":\"Kill:Sword:Robot" + std::to_string(i % 17) + "\",\"value\":" + std::to_string(i)
+				+ ",\"v\":2,\"user_id\":\"f8b6b08d-ba04-4f2a-9f6b-a3b8f71d9d55\",\"session_num\":1,\"client_ts\":" + std::to_string(1700000000 + i / 10) + "},";
+		}
+
+		batch.back() = ']';
+		return batch;
+	}
+
+	// Random bytes, which can't be compressed.
+	std::string GetRandomBytes(const size_t bytes)
+	{
+		std::minstd_rand random(42);
+		std::string data(bytes, '\0');
+
+		for (auto & c : data)
+		{
+			c = static_cast<char>(random() & 0xFF);
+		}
+
+		return data;
+	}
+
+	void ExpectRoundTrip(const std::string & data, const size_t pieceSize)
+	{
+		auto compressed = Compress(data, pieceSize);
+
+		std::string decompressed;
+		ASSERT_TRUE(Decompress(compressed, decompressed)) << data.size() << " bytes in pieces of " << pieceSize;
+		EXPECT_TRUE(decompressed == data) << data.size() << " bytes in pieces of " << pieceSize;
+
+		// The decompressor of the loopback transport must accept the stream as well.
+		ASSERT_TRUE(GzipDecompress(compressed.data(), compressed.size(), decompressed));
+		EXPECT_TRUE(decompressed == data);
+	}
+}
+
+
+TEST(GzipTests, CompressesEmptyInputToKnownStream)
+{
+	GzipCompressor compressor;
+
+	// Header without modification time and unknown OS, a final fixed Huffman block with nothing but its end, and a checksum and size of 0.
+	const std::vector<uint8_t> expected =
+	{
+		0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+		0x03, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+
+	EXPECT_EQ(compressor.Finish(), expected);
+
+	std::string decompressed = "x";
+	ASSERT_TRUE(Decompress(compressor.GetOutput(), decompressed));
+	EXPECT_TRUE(decompressed.empty());
+}
+
+TEST(GzipTests, CompressesLiteralsToKnownDeflateData)
+{
+	// Same fixed Huffman block as written by zlib for input without matches.
+	const std::vector<uint8_t> expected = { 0x4B, 0x4C, 0x4A, 0x06, 0x00 };
+
+	auto compressed = Compress("abc", 3);
+	ASSERT_EQ(compressed.size(), 10u + expected.size() + 8u);
+	EXPECT_EQ(std::vector<uint8_t>(compressed.begin() + 10, compressed.end() - 8), expected);
+
+	// CRC-32 of "abc", and its size, little-endian.
+	const std::vector<uint8_t> trailer = { 0xC2, 0x41, 0x24, 0x35, 0x03, 0x00, 0x00, 0x00 };
+	EXPECT_EQ(std::vector<uint8_t>(compressed.end() - 8, compressed.end()), trailer);
+}
+
+TEST(GzipTests, RoundTripsShortInputs)
+{
+	ExpectRoundTrip("a", 1);
+	ExpectRoundTrip("Kill:Orc", 8);
+	ExpectRoundTrip("Kill:Orc,Kill:Orc,Kill:Orc", 26);
+}
+
+TEST(GzipTests, RoundTripsEventBatchesLargerThanTheWindow)
+{
+	auto batch = GetEventBatch(200 * 1024);
+
+	ExpectRoundTrip(batch, batch.size());
+
+	auto compressed = Compress(batch, batch.size());
+	EXPECT_LT(compressed.size(), batch.size() / 4);
+}
+
+TEST(GzipTests, RoundTripsMatchesAtTheEdgeOfTheWindow)
+{
+	// Repeats blocks just within and just beyond the window of 32 KB.
+	auto block = GetRandomBytes(1000);
+	auto filler = GetRandomBytes(32768 - 1000);
+
+	ExpectRoundTrip(block + filler + block, 1 << 20);
+	ExpectRoundTrip(block + filler + "x" + block, 1 << 20);
+}
+
+TEST(GzipTests, RoundTripsLongRuns)
+{
+	// Matches of the maximum length at a distance of one byte.
+	ExpectRoundTrip(std::string(100000, 'a'), 100000);
+}
+
+TEST(GzipTests, RoundTripsIncompressibleInput)
+{
+	auto data = GetRandomBytes(100 * 1024);
+
+	ExpectRoundTrip(data, data.size());
+
+	// Fixed Huffman codes take up to nine bits per literal.
+	auto compressed = Compress(data, data.size());
+	EXPECT_LT(compressed.size(), data.size() * 9 / 8 + 64);
+}
+
+TEST(GzipTests, RoundTripsChunkedWrites)
+{
+	auto batch = GetEventBatch(70 * 1024);
+
+	// Pieces smaller and larger than the longest match, and not dividing the window size.
+	for (auto pieceSize : { 1, 7, 257, 258, 259, 1000, 32768, 40000 })
+	{
+		ExpectRoundTrip(batch, static_cast<size_t>(pieceSize));
+	}
+}
+
+TEST(GzipTests, StartsNewStreamAfterReset)
+{
+	auto first = GetEventBatch(40 * 1024);
+	auto second = GetEventBatch(10 * 1024);
+
+	GzipCompressor compressor;
+	compressor.Write(first.data(), first.size());
+	compressor.Finish();
+
+	compressor.Reset();
+	EXPECT_EQ(0u, compressor.GetInputSize());
+
+	compressor.Write(second.data(), second.size());
+	EXPECT_EQ(second.size(), compressor.GetInputSize());
+
+	std::string decompressed;
+	ASSERT_TRUE(Decompress(compressor.Finish(), decompressed));
+	EXPECT_TRUE(decompressed == second);
+}
+
+TEST(GzipTests, DecompressesStreamsOfZlib)
+{
+	std::string decompressed;
+
+	ASSERT_TRUE(GzipDecompress(ZlibFixedStream.data(), ZlibFixedStream.size(), decompressed));
+	EXPECT_EQ(decompressed, "Kill:Orc,Kill:Orc,Kill:Orc");
+
+	ASSERT_TRUE(GzipDecompress(ZlibStoredStream.data(), ZlibStoredStream.size(), decompressed));
+	EXPECT_EQ(decompressed, "Kill:Orc");
+}
+
+TEST(GzipTests, RejectsUnsupportedAndCorruptStreams)
+{
+	std::string decompressed;
+
+	// Dynamic Huffman codes are not supported.
+	EXPECT_FALSE(GzipDecompress(ZlibDynamicStream.data(), ZlibDynamicStream.size(), decompressed));
+
+	// Wrong checksum.
+	auto corrupt = ZlibFixedStream;
+	corrupt[corrupt.size() - 8] ^= 0x01;
+	EXPECT_FALSE(GzipDecompress(corrupt.data(), corrupt.size(), decompressed));
+
+	// Truncated.
+	EXPECT_FALSE(GzipDecompress(ZlibFixedStream.data(), ZlibFixedStream.size() - 1, decompressed));
+	EXPECT_FALSE(GzipDecompress(ZlibFixedStream.data(), 10, decompressed));
+}
@@ -0,0 +1,391 @@
+#include "GameAnalyticsHttp.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#endif
+
+using namespace GameAnalytics;
+
+namespace
+{
+#ifdef _WIN32
+	const Socket::Handle InvalidHandle = INVALID_SOCKET;
+
+	// Initializes Winsock once for the whole process.
+	void StartUp()
+	{
+		static struct WinsockInitializer
+		{
+			WinsockInitializer()
+			{
+				WSADATA data;
+				WSAStartup(MAKEWORD(2, 2), &data);
+			}
+
+			~WinsockInitializer()
+			{
+				WSACleanup();
+			}
+		} initializer;
+	}
+
+	void CloseHandle(const Socket::Handle handle)
+	{
+		closesocket(handle);
+	}
+
+	const int NoSignal = 0;
+	const int ShutdownBoth = SD_BOTH;
+#else
+	const Socket::Handle InvalidHandle = -1;
+
+	void StartUp()
+	{
+	}
+
+	void CloseHandle(const Socket::Handle handle)
+	{
+		close(handle);
+	}
+
+	// Lost connections make sending fail instead of raising SIGPIPE.
+	const int NoSignal = MSG_NOSIGNAL;
+	const int ShutdownBoth = SHUT_RDWR;
+#endif
+
+	const size_t MaxHeaderBytes = 64 * 1024;
+
+	const char * const WeekDays[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+	const char * const Months[] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+
+	sockaddr_in GetLoopbackAddress(const uint16_t port)
+	{
+		sockaddr_in address = {};
+		address.sin_family = AF_INET;
+		address.sin_port = htons(port);
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		return address;
+	}
+
+	// Sends small requests and responses right away instead of waiting for the acknowledgement of the previous ones.
+	void DisableNagle(const Socket::Handle handle)
+	{
+		int noDelay = 1;
+		setsockopt(handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char *>(&noDelay), sizeof(noDelay));
+	}
+
+	// Converts days since the epoch to a date of the proleptic Gregorian calendar, and back.
+	void GetDate(int64_t days, int64_t & year, int & month, int & day)
+	{
+		days += 719468;
+
+		auto era = (days >= 0 ? days : days - 146096) / 146097;
+		auto dayOfEra = days - era * 146097;
+		auto yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+		auto dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+		auto shiftedMonth = (5 * dayOfYear + 2) / 153;
+
+		day = static_cast<int>(dayOfYear - (153 * shiftedMonth + 2) / 5 + 1);
+		month = static_cast<int>(shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9);
+		year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+	}
+
+	int64_t GetDays(int64_t year, const int month, const int day)
+	{
+		year -= month <= 2 ? 1 : 0;
+
+		auto era = (year >= 0 ? year : year - 399) / 400;
+		auto yearOfEra = year - era * 400;
+		auto dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+		auto dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+
+		return era * 146097 + dayOfEra - 719468;
+	}
+}
+
+
+Socket::Socket()
+	: handle(InvalidHandle)
+{
+}
+
+Socket::Socket(const Handle handle)
+	: handle(handle)
+{
+}
+
+Socket::Socket(Socket && other)
+	: handle(other.handle)
+{
+	other.handle = InvalidHandle;
+}
+
+Socket::~Socket()
+{
+	this->Close();
+}
+
+Socket & Socket::operator=(Socket && other)
+{
+	if (this != &other)
+	{
+		this->Close();
+		this->handle = other.handle;
+		other.handle = InvalidHandle;
+	}
+
+	return *this;
+}
+
+Socket Socket::Listen(uint16_t & port)
+{
+	StartUp();
+
+	Socket socket(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+
+	if (!socket.IsValid())
+	{
+		throw std::runtime_error("Failed to create socket.");
+	}
+
+	auto address = GetLoopbackAddress(0);
+
+	if (bind(socket.handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0
+		|| listen(socket.handle, SOMAXCONN) != 0)
+	{
+		throw std::runtime_error("Failed to listen on loopback interface.");
+	}
+
+	// Get the port chosen by the system.
+	socklen_t addressLength = sizeof(address);
+
+	if (getsockname(socket.handle, reinterpret_cast<sockaddr *>(&address), &addressLength) != 0)
+	{
+		throw std::runtime_error("Failed to get listening port.");
+	}
+
+	port = ntohs(address.sin_port);
+	return socket;
+}
+
+Socket Socket::Connect(const uint16_t port)
+{
+	StartUp();
+
+	Socket socket(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+
+	if (!socket.IsValid())
+	{
+		return socket;
+	}
+
+	auto address = GetLoopbackAddress(port);
+
+	if (connect(socket.handle, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0)
+	{
+		socket.Close();
+		return socket;
+	}
+
+	DisableNagle(socket.handle);
+	return socket;
+}
+
+bool Socket::IsValid() const
+{
+	return this->handle != InvalidHandle;
+}
+
+Socket Socket::Accept() const
+{
+	Socket connection(accept(this->handle, nullptr, nullptr));
+
+	if (connection.IsValid())
+	{
+		DisableNagle(connection.handle);
+	}
+
+	return connection;
+}
+
+bool Socket::Send(const std::string & data) const
+{
+	size_t sent = 0;
+
+	while (sent < data.size())
+	{
+		auto length = static_cast<int>(std::min<size_t>(data.size() - sent, 1 << 20));
+		auto result = send(this->handle, data.data() + sent, length, NoSignal);
+
+		if (result <= 0)
+		{
+			return false;
+		}
+
+		sent += static_cast<size_t>(result);
+	}
+
+	return true;
+}
+
+size_t Socket::Receive(char * buffer, const size_t length) const
+{
+	auto result = recv(this->handle, buffer, static_cast<int>(length), 0);
+	return result > 0 ? static_cast<size_t>(result) : 0;
+}
+
+void Socket::Shutdown() const
+{
+	shutdown(this->handle, ShutdownBoth);
+}
+
+void Socket::Close()
+{
+	if (this->handle != InvalidHandle)
+	{
+		CloseHandle(this->handle);
+		this->handle = InvalidHandle;
+	}
+}
+
+std::string HttpMessage::GetHeader(const char * name) const
+{
+	for (auto & header : this->headers)
+	{
+		if (header.first == name)
+		{
+			return header.second;
+		}
+	}
+
+	return std::string();
+}
+
+bool GameAnalytics::ReceiveHttpMessage(const Socket & socket, std::string & buffer, HttpMessage & message)
+{
+	char chunk[64 * 1024];
+
+	// Receive header.
+	size_t headerEnd;
+
+	while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos)
+	{
+		if (buffer.size() > MaxHeaderBytes)
+		{
+			return false;
+		}
+
+		auto received = socket.Receive(chunk, sizeof(chunk));
+
+		if (received == 0)
+		{
+			return false;
+		}
+
+		buffer.append(chunk, received);
+	}
+
+	// Parse start line and header fields.
+	message.headers.clear();
+
+	auto lineStart = buffer.find("\r\n");
+	message.startLine = buffer.substr(0, lineStart);
+
+	while (lineStart < headerEnd)
+	{
+		lineStart += 2;
+
+		auto lineEnd = buffer.find("\r\n", lineStart);
+		auto colon = buffer.find(':', lineStart);
+
+		if (colon == std::string::npos || colon > lineEnd)
+		{
+			return false;
+		}
+
+		auto name = buffer.substr(lineStart, colon - lineStart);
+		std::transform(name.begin(), name.end(), name.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+		auto valueStart = std::min(buffer.find_first_not_of(' ', colon + 1), lineEnd);
+		message.headers.emplace_back(name, buffer.substr(valueStart, lineEnd - valueStart));
+
+		lineStart = lineEnd;
+	}
+
+	// Receive body.
+	auto bodyStart = headerEnd + 4;
+	auto contentLength = static_cast<size_t>(std::strtoull(message.GetHeader("content-length").c_str(), nullptr, 10));
+
+	while (buffer.size() < bodyStart + contentLength)
+	{
+		auto received = socket.Receive(chunk, std::min(sizeof(chunk), bodyStart + contentLength - buffer.size()));
+
+		if (received == 0)
+		{
+			return false;
+		}
+
+		buffer.append(chunk, received);
+	}
+
+	message.body.assign(buffer, bodyStart, contentLength);
+	buffer.erase(0, bodyStart + contentLength);
+	return true;
+}
+
+std::string GameAnalytics::FormatHttpDate(const int64_t time)
+{
+	auto days = (time >= 0 ? time : time - 86399) / 86400;
+	auto seconds = time - days * 86400;
+
+	int64_t year;
+	int month;
+	int day;
+	GetDate(days, year, month, day);
+
+	auto weekDay = ((days % 7) + 11) % 7;
+
+	char date[64];
+	std::snprintf(date, sizeof(date), "%s, %02d %s %04lld %02d:%02d:%02d GMT", WeekDays[weekDay], day, Months[month - 1], static_cast<long long>(year),
+		static_cast<int>(seconds / 3600), static_cast<int>(seconds / 60 % 60), static_cast<int>(seconds % 60));
+
+	return date;
+}
+
+int64_t GameAnalytics::ParseHttpDate(const std::string & date)
+{
+	char weekDay[4];
+	char monthName[4];
+	int day;
+	int year;
+	int hours;
+	int minutes;
+	int seconds;
+
+	if (std::sscanf(date.c_str(), "%3s, %d %3s %d %d:%d:%d GMT", weekDay, &day, monthName, &year, &hours, &minutes, &seconds) != 7)
+	{
+		return 0;
+	}
+
+	for (auto month = 0; month < 12; ++month)
+	{
+		if (std::strcmp(monthName, Months[month]) == 0)
+		{
+			return GetDays(year, month + 1, day) * 86400 + hours * 3600 + minutes * 60 + seconds;
+		}
+	}
+
+	return 0;
+}
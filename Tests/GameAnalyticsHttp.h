@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+namespace GameAnalytics
+{
+	// TCP socket on the loopback interface, closed on destruction.
+	class Socket
+	{
+	public:
+#ifdef _WIN32
+		typedef SOCKET Handle;
+#else
+		typedef int Handle;
+#endif
+
+		Socket();
+		explicit Socket(const Handle handle);
+		Socket(Socket && other);
+		~Socket();
+
+		Socket & operator=(Socket && other);
+
+		Socket(const Socket &) = delete;
+		Socket & operator=(const Socket &) = delete;
+
+		// Starts listening on an ephemeral port of 127.0.0.1, and gets the port. Throws std::runtime_error on failure.
+		static Socket Listen(uint16_t & port);
+
+		// Connects to the specified port of 127.0.0.1. Returns an invalid socket on failure.
+		static Socket Connect(const uint16_t port);
+
+		bool IsValid() const;
+
+		// Waits for the next connection. Returns an invalid socket on failure.
+		Socket Accept() const;
+
+		// Sends all of the specified data. Returns false if the connection has been lost.
+		bool Send(const std::string & data) const;
+
+		// Receives at most the specified number of bytes. Returns the number of bytes received, or 0 if the connection has been closed or lost.
+		size_t Receive(char * buffer, const size_t length) const;
+
+		// Stops sending and receiving, making threads waiting for data return.
+		void Shutdown() const;
+
+		void Close();
+
+	private:
+		Handle handle;
+	};
+
+	// HTTP/1.1 request or response, with a body of the length given by its Content-Length header.
+	struct HttpMessage
+	{
+		// Request line, e.g. "POST /v2/<game key>/events HTTP/1.1", or status line.
+		std::string startLine;
+
+		// Header names in lower case, and their values.
+		std::vector<std::pair<std::string, std::string>> headers;
+
+		std::string body;
+
+		// Gets the value of the header with the specified name in lower case, or an empty string if missing.
+		std::string GetHeader(const char * name) const;
+	};
+
+	// Receives the next message from the specified connection. Bytes received beyond the message are kept in the specified buffer
+	// for the next call, so it has to be the same for all messages of the connection. Returns false if the connection has been closed,
+	// lost, or the message is malformed.
+	bool ReceiveHttpMessage(const Socket & socket, std::string & buffer, HttpMessage & message);
+
+	// Formats the specified time in seconds since the epoch for the Date header, e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+	std::string FormatHttpDate(const int64_t time);
+
+	// Parses the specified value of the Date header, returning seconds since the epoch, or 0 if it's malformed.
+	int64_t ParseHttpDate(const std::string & date);
+}
@@ -0,0 +1,144 @@
+#include "GameAnalyticsHttpCollector.h"
+
+#include <future>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const char * GetReasonPhrase(const int statusCode)
+	{
+		switch (statusCode)
+		{
+		case 200: return "OK";
+		case 400: return "Bad Request";
+		case 401: return "Unauthorized";
+		case 404: return "Not Found";
+		case 405: return "Method Not Allowed";
+		case 413: return "Payload Too Large";
+		case 500: return "Internal Server Error";
+		case 503: return "Service Unavailable";
+		default: return "Unknown";
+		}
+	}
+}
+
+
+HttpCollector::HttpCollector(const std::shared_ptr<LoopbackTransport> & backend)
+	: backend(backend),
+	port(0),
+	stopping(false)
+{
+	this->listener = Socket::Listen(this->port);
+	this->acceptor = std::thread(&HttpCollector::Accept, this);
+}
+
+HttpCollector::~HttpCollector()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		this->stopping = true;
+
+		for (auto & connection : this->connections)
+		{
+			connection->Shutdown();
+		}
+	}
+
+	// Wake up the acceptor by connecting, which works on all platforms, unlike closing the listening socket.
+	Socket::Connect(this->port);
+	this->acceptor.join();
+
+	for (auto & thread : this->connectionThreads)
+	{
+		thread.join();
+	}
+}
+
+uint16_t HttpCollector::GetPort() const
+{
+	return this->port;
+}
+
+void HttpCollector::Accept()
+{
+	while (true)
+	{
+		auto connection = std::make_shared<Socket>(this->listener.Accept());
+
+		std::lock_guard<std::mutex> lock(this->mutex);
+
+		if (this->stopping)
+		{
+			return;
+		}
+
+		if (connection->IsValid())
+		{
+			this->connections.push_back(connection);
+			this->connectionThreads.emplace_back(&HttpCollector::Serve, this, connection);
+		}
+	}
+}
+
+void HttpCollector::Serve(const std::shared_ptr<Socket> connection)
+{
+	std::string buffer;
+	HttpMessage request;
+
+	while (ReceiveHttpMessage(*connection, buffer, request))
+	{
+		auto response = this->Answer(request);
+
+		// Simulate the request not getting through.
+		if (response.statusCode == 0)
+		{
+			break;
+		}
+
+		std::string message = "HTTP/1.1 " + std::to_string(response.statusCode) + " " + GetReasonPhrase(response.statusCode) + "\r\n"
+			+ "Content-Type: application/json\r\n"
+			+ "Content-Length: " + std::to_string(response.body.size()) + "\r\n"
+			+ "Date: " + FormatHttpDate(response.serverTime) + "\r\n"
+			+ "\r\n"
+			+ response.body;
+
+		if (!connection->Send(message) || request.GetHeader("connection") == "close")
+		{
+			break;
+		}
+	}
+
+	// Let the client notice the connection is gone, but keep the socket open until the collector is destroyed,
+	// so shutting down connections can't hit a handle reused by another one.
+	connection->Shutdown();
+}
+
+TransportResponse HttpCollector::Answer(const HttpMessage & request)
+{
+	auto methodEnd = request.startLine.find(' ');
+	auto pathEnd = request.startLine.find(' ', methodEnd + 1);
+
+	if (methodEnd == std::string::npos || pathEnd == std::string::npos || request.startLine.compare(0, methodEnd, "POST") != 0)
+	{
+		TransportResponse response;
+		response.statusCode = 405;
+		return response;
+	}
+
+	TransportRequest backendRequest;
+	backendRequest.url = "http://127.0.0.1:" + std::to_string(this->port) + request.startLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+	backendRequest.body = request.body;
+	backendRequest.authorization = request.GetHeader("authorization");
+	backendRequest.compressed = request.GetHeader("content-encoding") == "gzip";
+
+	// Loopback transport answers later if latency is simulated.
+	auto response = std::make_shared<std::promise<TransportResponse>>();
+
+	this->backend->Post(backendRequest, [response](const TransportResponse & backendResponse)
+	{
+		response->set_value(backendResponse);
+	});
+
+	return response->get_future().get();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GameAnalyticsHttp.h"
+#include "GameAnalyticsLoopbackTransport.h"
+
+namespace GameAnalytics
+{
+	// Serves the init and events routes of the GameAnalytics backend over HTTP on a port of 127.0.0.1,
+	// for measuring uploads over real sockets without network access.
+	// Passes each request on to the specified loopback transport, which verifies its Authorization header if a secret key is set,
+	// decompresses it if sent with Content-Encoding gzip, and rejects events batches with invalid events with status code 400.
+	// Requests answered with status code 0 by the loopback transport, e.g. for simulating being offline, close the connection instead.
+	// Keeps connections alive, serving each one on a thread of its own.
+	class HttpCollector
+	{
+	public:
+		// Starts listening. Throws std::runtime_error if no port is available.
+		explicit HttpCollector(const std::shared_ptr<LoopbackTransport> & backend);
+		~HttpCollector();
+
+		HttpCollector(const HttpCollector &) = delete;
+		HttpCollector & operator=(const HttpCollector &) = delete;
+
+		uint16_t GetPort() const;
+
+	private:
+		std::shared_ptr<LoopbackTransport> backend;
+
+		uint16_t port;
+		Socket listener;
+		std::thread acceptor;
+
+		std::mutex mutex;
+		std::vector<std::shared_ptr<Socket>> connections;
+		std::vector<std::thread> connectionThreads;
+		bool stopping;
+
+		// Accepts connections until stopped.
+		void Accept();
+
+		// Answers requests of the specified connection until it is closed.
+		void Serve(const std::shared_ptr<Socket> connection);
+
+		// Gets the response of the backend to the specified request.
+		TransportResponse Answer(const HttpMessage & request);
+	};
+}
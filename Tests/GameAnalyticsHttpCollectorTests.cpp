@@ -0,0 +1,187 @@
+#include "GameAnalyticsBase64.h"
+#include "GameAnalyticsHttpCollector.h"
+#include "GameAnalyticsHttpTransport.h"
+#include "GameAnalyticsSha256.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	const char * const ValidEvents = "[{\"category\":\"design\",\"event_id\":\"Kill:Orc\",\"v\":2,\"user_id\":\"user\",\"session_id\":\"session\",\"session_num\":1,\"client_ts\":1}]";
+
+	std::string GetUrl(const char * route)
+	{
+		return std::string("http://api.gameanalytics.com/v2/") + TestGameKey + "/" + route;
+	}
+
+	// Gets the Authorization header of the specified body, like the core does.
+	std::string Sign(const std::string & body)
+	{
+		HmacSha256 signer(TestSecretKey);
+		signer.Update(body.data(), body.size());
+
+		uint8_t mac[Sha256::DigestSize];
+		signer.Finish(mac);
+
+		return Base64Encode(mac, sizeof(mac));
+	}
+
+	// Waits at most ten seconds for the specified condition.
+	bool WaitFor(const std::function<bool()> & condition)
+	{
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+		while (!condition())
+		{
+			if (std::chrono::steady_clock::now() > deadline)
+			{
+				return false;
+			}
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		return true;
+	}
+
+	// Collector checking signatures with the test secret key, and a transport sending requests to it.
+	class HttpCollectorTests : public testing::Test
+	{
+	protected:
+		HttpCollectorTests()
+			: backend(std::make_shared<LoopbackTransport>()),
+			collector(backend),
+			transport(std::make_shared<HttpTransport>(collector.GetPort()))
+		{
+			this->backend->SetSecretKey(TestSecretKey);
+		}
+
+		// Posts the specified body, signed with the specified authorization, and waits for the response.
+		TransportResponse Post(const char * route, const std::string & body, const std::string & authorization)
+		{
+			TransportRequest request;
+			request.url = GetUrl(route);
+			request.body = body;
+			request.authorization = authorization;
+			request.compressed = false;
+
+			auto response = std::make_shared<std::promise<TransportResponse>>();
+			auto future = response->get_future();
+
+			this->transport->Post(request, [response](const TransportResponse & transportResponse)
+			{
+				response->set_value(transportResponse);
+			});
+
+			return future.get();
+		}
+
+		TransportResponse Post(const char * route, const std::string & body)
+		{
+			return this->Post(route, body, Sign(body));
+		}
+
+		std::shared_ptr<LoopbackTransport> backend;
+		HttpCollector collector;
+		std::shared_ptr<HttpTransport> transport;
+	};
+}
+
+
+TEST_F(HttpCollectorTests, ReceivesEventsOfCore)
+{
+	TestDirectory directory;
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(this->transport, directory.GetPath()));
+	core->Init([](const InitResult &) {});
+
+	ASSERT_TRUE(WaitFor([&core]() { return core->IsInitialized(); }));
+
+	for (auto i = 0; i < 1000; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	// Large batches are compressed.
+	core->Flush();
+
+	EXPECT_TRUE(WaitFor([this, &core]()
+	{
+		core->Update();
+		return this->backend->GetStatistics().eventsReceived == 1000;
+	}));
+
+	auto statistics = this->backend->GetStatistics();
+	EXPECT_EQ(1u, statistics.initRequests);
+	EXPECT_EQ(0u, statistics.unauthorizedRequests);
+	EXPECT_EQ(0u, statistics.rejectedRequests);
+
+	core.reset();
+}
+
+TEST_F(HttpCollectorTests, AnswersInitWithServerTime)
+{
+	auto response = this->Post("init", "{\"platform\":\"windows\"}");
+
+	EXPECT_EQ(200, response.statusCode);
+	EXPECT_NE(std::string::npos, response.body.find("\"server_ts\""));
+
+	// Date header is parsed back.
+	auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	EXPECT_NEAR(static_cast<double>(now), static_cast<double>(response.serverTime), 60.0);
+}
+
+TEST_F(HttpCollectorTests, ChecksAuthorization)
+{
+	EXPECT_EQ(200, this->Post("events", ValidEvents).statusCode);
+	EXPECT_EQ(401, this->Post("events", ValidEvents, Sign("[]")).statusCode);
+	EXPECT_EQ(401, this->Post("init", "{}", "").statusCode);
+
+	auto statistics = this->backend->GetStatistics();
+	EXPECT_EQ(1u, statistics.eventsReceived);
+	EXPECT_EQ(2u, statistics.unauthorizedRequests);
+}
+
+TEST_F(HttpCollectorTests, RejectsInvalidEvents)
+{
+	auto response = this->Post("events", "[{\"category\":\"design\"}]");
+
+	EXPECT_EQ(400, response.statusCode);
+	EXPECT_NE(std::string::npos, response.body.find("\"required\""));
+
+	EXPECT_EQ(400, this->Post("events", "not json").statusCode);
+	EXPECT_EQ(404, this->Post("unknown", ValidEvents).statusCode);
+
+	EXPECT_EQ(2u, this->backend->GetStatistics().rejectedRequests);
+}
+
+TEST_F(HttpCollectorTests, DropsConnectionWhenOffline)
+{
+	this->backend->ScriptEventsResponses({ 0, 503 });
+
+	EXPECT_EQ(0, this->Post("events", ValidEvents).statusCode);
+	EXPECT_EQ(503, this->Post("events", ValidEvents).statusCode);
+	EXPECT_EQ(200, this->Post("events", ValidEvents).statusCode);
+
+	EXPECT_EQ(1u, this->backend->GetStatistics().eventsReceived);
+}
+
+TEST(HttpTests, FormatsAndParsesDates)
+{
+	EXPECT_EQ("Sun, 06 Nov 1994 08:49:37 GMT", FormatHttpDate(784111777));
+	EXPECT_EQ(784111777, ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT"));
+
+	EXPECT_EQ("Thu, 01 Jan 1970 00:00:00 GMT", FormatHttpDate(0));
+	EXPECT_EQ(951782400, ParseHttpDate(FormatHttpDate(951782400)));
+	EXPECT_EQ(0, ParseHttpDate("yesterday"));
+}
@@ -0,0 +1,154 @@
+#include "GameAnalyticsHttpTransport.h"
+
+#include <cstdlib>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Splits the specified absolute URL into host and path.
+	void SplitUrl(const std::string & url, std::string & host, std::string & path)
+	{
+		auto hostStart = url.find("://");
+		hostStart = hostStart == std::string::npos ? 0 : hostStart + 3;
+
+		auto pathStart = url.find('/', hostStart);
+		pathStart = pathStart == std::string::npos ? url.size() : pathStart;
+
+		host = url.substr(hostStart, pathStart - hostStart);
+		path = pathStart < url.size() ? url.substr(pathStart) : "/";
+	}
+}
+
+
+HttpTransport::HttpTransport(const uint16_t port)
+	: state(std::make_shared<State>())
+{
+	this->state->port = port;
+	this->state->stopping = false;
+
+	this->SetMaxConcurrentRequests(1);
+}
+
+HttpTransport::~HttpTransport()
+{
+	{
+		std::lock_guard<std::mutex> lock(this->state->mutex);
+		this->state->stopping = true;
+	}
+
+	this->state->pendingChanged.notify_all();
+
+	for (auto & worker : this->workers)
+	{
+		// Can't wait for the worker invoking the callback that destroys this transport.
+		if (worker.get_id() == std::this_thread::get_id())
+		{
+			worker.detach();
+		}
+		else
+		{
+			worker.join();
+		}
+	}
+}
+
+void HttpTransport::Post(const TransportRequest & request, const Callback & callback)
+{
+	{
+		std::lock_guard<std::mutex> lock(this->state->mutex);
+
+		PendingRequest pendingRequest;
+		pendingRequest.request = request;
+		pendingRequest.callback = callback;
+
+		this->state->pending.push_back(std::move(pendingRequest));
+	}
+
+	this->state->pendingChanged.notify_one();
+}
+
+void HttpTransport::SetMaxConcurrentRequests(const size_t maxConcurrentRequests)
+{
+	std::lock_guard<std::mutex> lock(this->state->mutex);
+
+	while (this->workers.size() < maxConcurrentRequests)
+	{
+		this->workers.emplace_back(&HttpTransport::Run, this->state);
+	}
+}
+
+void HttpTransport::Run(const std::shared_ptr<State> state)
+{
+	Socket connection;
+	std::string buffer;
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+
+	while (!state->stopping)
+	{
+		if (state->pending.empty())
+		{
+			state->pendingChanged.wait(lock);
+			continue;
+		}
+
+		auto pendingRequest = std::move(state->pending.front());
+		state->pending.pop_front();
+
+		lock.unlock();
+
+		auto response = Send(pendingRequest.request, state->port, connection, buffer);
+
+		// Callbacks may post new requests.
+		pendingRequest.callback(response);
+		pendingRequest.callback = nullptr;
+
+		lock.lock();
+	}
+}
+
+TransportResponse HttpTransport::Send(const TransportRequest & request, const uint16_t port, Socket & connection, std::string & buffer)
+{
+	std::string host;
+	std::string path;
+	SplitUrl(request.url, host, path);
+
+	auto message = "POST " + path + " HTTP/1.1\r\n"
+		+ "Host: " + host + "\r\n"
+		+ "Authorization: " + request.authorization + "\r\n"
+		+ "Content-Type: application/json\r\n"
+		+ (request.compressed ? "Content-Encoding: gzip\r\n" : "")
+		+ "Content-Length: " + std::to_string(request.body.size()) + "\r\n"
+		+ "\r\n"
+		+ request.body;
+
+	TransportResponse response;
+
+	if (!connection.IsValid())
+	{
+		connection = Socket::Connect(port);
+		buffer.clear();
+	}
+
+	// Requests are not retried, since the collector may have received them before the connection was lost.
+	HttpMessage responseMessage;
+
+	if (!connection.IsValid() || !connection.Send(message) || !ReceiveHttpMessage(connection, buffer, responseMessage))
+	{
+		connection.Close();
+		return response;
+	}
+
+	// Status line is "HTTP/1.1 200 OK".
+	auto statusStart = responseMessage.startLine.find(' ');
+
+	if (statusStart != std::string::npos)
+	{
+		response.statusCode = std::atoi(responseMessage.startLine.c_str() + statusStart + 1);
+	}
+
+	response.body = std::move(responseMessage.body);
+	response.serverTime = ParseHttpDate(responseMessage.GetHeader("date"));
+	return response;
+}
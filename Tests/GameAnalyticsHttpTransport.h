@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "GameAnalyticsHttp.h"
+#include "GameAnalyticsTransport.h"
+
+namespace GameAnalytics
+{
+	// Sends requests via HTTP/1.1 to the specified port of 127.0.0.1 instead of the host of their URL, like a hosts file entry would,
+	// e.g. for sending them to an HttpCollector. Keeps as many connections alive as requests may be sent at the same time,
+	// each served by a thread of its own. Requests whose connection is lost are answered with status code 0, without retrying them.
+	class HttpTransport : public Transport
+	{
+	public:
+		explicit HttpTransport(const uint16_t port);
+		~HttpTransport();
+
+		void Post(const TransportRequest & request, const Callback & callback) override;
+
+		void SetMaxConcurrentRequests(const size_t maxConcurrentRequests) override;
+
+	private:
+		struct PendingRequest
+		{
+			TransportRequest request;
+			Callback callback;
+		};
+
+		// State shared with the workers, which may outlive the transport if a callback releases the last reference to it.
+		struct State
+		{
+			uint16_t port;
+
+			std::mutex mutex;
+			std::deque<PendingRequest> pending;
+			std::condition_variable pendingChanged;
+			bool stopping;
+		};
+
+		std::shared_ptr<State> state;
+		std::vector<std::thread> workers;
+
+		// Sends pending requests one after another on a connection of its own, until stopped.
+		static void Run(const std::shared_ptr<State> state);
+
+		// Sends the specified request to the specified port on the specified connection, connecting first if required.
+		static TransportResponse Send(const TransportRequest & request, const uint16_t port, Socket & connection, std::string & buffer);
+	};
+}
@@ -0,0 +1,130 @@
+#include "GameAnalyticsJsonWriter.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	std::string WriteString(const std::string & value)
+	{
+		JsonWriter writer;
+		writer.WriteString(value);
+		return writer.GetString();
+	}
+
+	std::string WriteNumber(const double value)
+	{
+		JsonWriter writer;
+		writer.WriteNumber(value);
+		return writer.GetString();
+	}
+}
+
+
+TEST(JsonWriterTests, EscapesQuotesAndBackslashes)
+{
+	EXPECT_EQ(WriteString("Kill:\"Orc\""), "\"Kill:\\\"Orc\\\"\"");
+	EXPECT_EQ(WriteString("C:\\Games\\"), "\"C:\\\\Games\\\\\"");
+	EXPECT_EQ(WriteString("/"), "\"/\"");
+}
+
+TEST(JsonWriterTests, EscapesControlCharacters)
+{
+	EXPECT_EQ(WriteString("\b\f\n\r\t"), "\"\\b\\f\\n\\r\\t\"");
+	EXPECT_EQ(WriteString(std::string("a\0b", 3)), "\"a\\u0000b\"");
+	EXPECT_EQ(WriteString("\x01\x1F"), "\"\\u0001\\u001f\"");
+
+	// Delete and multi-byte UTF-8 characters are valid within JSON strings.
+	EXPECT_EQ(WriteString("\x7F" "\xE2\x82\xAC"), "\"\x7F" "\xE2\x82\xAC\"");
+}
+
+TEST(JsonWriterTests, EscapesStringParts)
+{
+	JsonWriter writer;
+	writer.BeginString();
+	writer.WriteStringPart("Kill");
+	writer.WriteStringPart("\n");
+	writer.WriteEscapedStringPart("\\\"");
+	writer.EndString();
+
+	EXPECT_EQ(writer.GetString(), "\"Kill\\n\\\"\"");
+}
+
+TEST(JsonWriterTests, WritesIntegralNumbersWithoutFraction)
+{
+	EXPECT_EQ(WriteNumber(0.0), "0");
+	EXPECT_EQ(WriteNumber(-42.0), "-42");
+	EXPECT_EQ(WriteNumber(9007199254740991.0), "9007199254740991");
+	EXPECT_EQ(WriteNumber(-9007199254740991.0), "-9007199254740991");
+}
+
+TEST(JsonWriterTests, WritesIntegralNumbersFromTwoToTheFiftyThirdExactly)
+{
+	const double values[] = { 9007199254740992.0, 9007199254740994.0, -9007199254740994.0, 18446744073709551616.0, 1e20, 1.7976931348623157e308 };
+
+	for (auto value : values)
+	{
+		// Written with all digits or in scientific notation, but without rounding.
+		auto json = WriteNumber(value);
+		EXPECT_EQ(value, std::stod(json)) << json;
+	}
+
+	EXPECT_EQ(WriteNumber(9007199254740992.0), "9007199254740992");
+	EXPECT_EQ(WriteNumber(9007199254740994.0), "9007199254740994");
+}
+
+TEST(JsonWriterTests, WritesFifteenSignificantDigits)
+{
+	EXPECT_EQ(WriteNumber(0.5), "0.5");
+	EXPECT_EQ(WriteNumber(-1.25), "-1.25");
+	EXPECT_EQ(WriteNumber(3.14159265358979323), "3.14159265358979");
+	EXPECT_EQ(WriteNumber(0.1), "0.1");
+
+	// Values of floats, e.g. design event values, keep the digits of the float, rounded to 15 digits.
+	EXPECT_EQ(WriteNumber(static_cast<double>(0.1f)), "0.100000001490116");
+	EXPECT_EQ(WriteNumber(1e-7), "1e-07");
+}
+
+TEST(JsonWriterTests, WritesNonFiniteNumbersAsNull)
+{
+	EXPECT_EQ(WriteNumber(std::numeric_limits<double>::quiet_NaN()), "null");
+	EXPECT_EQ(WriteNumber(std::numeric_limits<double>::infinity()), "null");
+	EXPECT_EQ(WriteNumber(-std::numeric_limits<double>::infinity()), "null");
+}
+
+TEST(JsonWriterTests, SkipsNonFiniteMembers)
+{
+	JsonWriter writer;
+	writer.BeginObject();
+	writer.WriteMember("category", "design");
+	writer.WriteMember("value", std::numeric_limits<double>::quiet_NaN());
+	writer.WriteMember("amount", -std::numeric_limits<double>::infinity());
+	writer.WriteMember("score", static_cast<int64_t>(10));
+	writer.EndObject();
+
+	EXPECT_EQ(writer.GetString(), "{\"category\":\"design\",\"score\":10}");
+}
+
+TEST(JsonWriterTests, SeparatesMembersAndElements)
+{
+	JsonWriter writer;
+	writer.BeginArray();
+	writer.BeginObject();
+	writer.WriteMember("a", static_cast<int64_t>(1));
+	writer.WriteMembers("\"b\":2,\"c\":3");
+	writer.WriteMember("d", 0.5);
+	writer.EndObject();
+	writer.BeginObject();
+	writer.EndObject();
+	writer.WriteBoolean(true);
+	writer.WriteNumber(std::numeric_limits<double>::quiet_NaN());
+	writer.EndArray();
+
+	EXPECT_EQ(writer.GetString(), "[{\"a\":1,\"b\":2,\"c\":3,\"d\":0.5},{},true,null]");
+}
@@ -0,0 +1,124 @@
+#include "GameAnalyticsLatencyHistogram.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Relative error of quantiles promised by the histogram.
+	const double RelativeAccuracy = 1.0 / 32;
+}
+
+
+TEST(LatencyHistogramTests, SummarizesNothingAsZero)
+{
+	LatencyHistogram histogram;
+	auto summary = histogram.GetSummary();
+
+	EXPECT_EQ(0u, summary.count);
+	EXPECT_EQ(0, summary.mean);
+	EXPECT_EQ(0, summary.p99);
+	EXPECT_EQ(0, summary.max);
+}
+
+TEST(LatencyHistogramTests, CountsSmallDurationsExactly)
+{
+	// Durations below 32 ns get a bucket each.
+	LatencyHistogram histogram;
+
+	for (uint64_t i = 0; i < 100; ++i)
+	{
+		histogram.Record(i % 20);
+	}
+
+	auto summary = histogram.GetSummary();
+
+	EXPECT_EQ(100u, summary.count);
+	EXPECT_DOUBLE_EQ(0.0095, summary.mean);
+	EXPECT_DOUBLE_EQ(0.009, summary.p50);
+	EXPECT_DOUBLE_EQ(0.017, summary.p90);
+	EXPECT_DOUBLE_EQ(0.019, summary.p99);
+	EXPECT_DOUBLE_EQ(0.019, summary.max);
+}
+
+TEST(LatencyHistogramTests, EstimatesQuantilesWithinBucketWidth)
+{
+	// Durations from 1 to 10000 microseconds.
+	LatencyHistogram histogram;
+
+	for (uint64_t i = 1; i <= 10000; ++i)
+	{
+		histogram.Record(i * 1000);
+	}
+
+	auto summary = histogram.GetSummary();
+
+	EXPECT_EQ(10000u, summary.count);
+	EXPECT_DOUBLE_EQ(5000.5, summary.mean);
+	EXPECT_DOUBLE_EQ(10000, summary.max);
+	EXPECT_NEAR(5000, summary.p50, 5000 * RelativeAccuracy);
+	EXPECT_NEAR(9000, summary.p90, 9000 * RelativeAccuracy);
+	EXPECT_NEAR(9900, summary.p99, 9900 * RelativeAccuracy);
+}
+
+TEST(LatencyHistogramTests, NeverEstimatesBeyondMaximum)
+{
+	// Middle of the bucket of a single duration would be larger than the duration itself.
+	LatencyHistogram histogram;
+	histogram.Record(1000);
+
+	auto summary = histogram.GetSummary();
+
+	EXPECT_DOUBLE_EQ(1, summary.p50);
+	EXPECT_DOUBLE_EQ(1, summary.p99);
+	EXPECT_DOUBLE_EQ(1, summary.max);
+}
+
+TEST(LatencyHistogramTests, RecordsLargestDurations)
+{
+	LatencyHistogram histogram;
+	histogram.Record(std::numeric_limits<uint64_t>::max());
+
+	auto summary = histogram.GetSummary();
+
+	EXPECT_EQ(1u, summary.count);
+	EXPECT_DOUBLE_EQ(std::numeric_limits<uint64_t>::max() / 1000.0, summary.max);
+	EXPECT_NEAR(summary.max, summary.p99, summary.max * RelativeAccuracy);
+}
+
+TEST(LatencyHistogramTests, CountsDurationsOfAllThreads)
+{
+	const auto Threads = 4;
+	const uint64_t DurationsPerThread = 100000;
+
+	LatencyHistogram histogram;
+	std::vector<std::thread> threads;
+
+	for (auto t = 0; t < Threads; ++t)
+	{
+		threads.emplace_back([&histogram, t]()
+		{
+			for (uint64_t i = 0; i < DurationsPerThread; ++i)
+			{
+				histogram.Record(1000 * (t + 1));
+			}
+		});
+	}
+
+	for (auto & thread : threads)
+	{
+		thread.join();
+	}
+
+	auto summary = histogram.GetSummary();
+
+	EXPECT_EQ(Threads * DurationsPerThread, summary.count);
+	EXPECT_DOUBLE_EQ(2.5, summary.mean);
+	EXPECT_DOUBLE_EQ(4, summary.max);
+}
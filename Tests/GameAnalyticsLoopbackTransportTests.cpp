@@ -0,0 +1,33 @@
+#include "GameAnalyticsLoopbackTransport.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <future>
+#include <memory>
+
+using namespace GameAnalytics;
+
+
+TEST(LoopbackTransportTests, CanBeDestroyedByCallback)
+{
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetLatency(std::chrono::milliseconds(1));
+
+	TransportRequest request;
+	request.url = "http://api.gameanalytics.com/v2/game/init";
+	request.compressed = false;
+
+	std::promise<int> statusCode;
+	auto & poster = *transport;
+
+	// Answered on the worker thread, which releases the last reference, like a core being destroyed meanwhile.
+	poster.Post(request, [&transport, &statusCode](const TransportResponse & response)
+	{
+		transport.reset();
+		statusCode.set_value(response.statusCode);
+	});
+
+	EXPECT_EQ(200, statusCode.get_future().get());
+	EXPECT_EQ(nullptr, transport);
+}
@@ -0,0 +1,172 @@
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsMemoryBudget.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Loopback transport counting the events of each category it has been sent.
+	class CountingTransport : public LoopbackTransport
+	{
+	public:
+		CountingTransport()
+			: businessEvents(0),
+			progressionEvents(0),
+			designEvents(0)
+		{
+		}
+
+		void Post(const TransportRequest & request, const Callback & callback) override
+		{
+			this->businessEvents += Count(request.body, "\"category\":\"business\"");
+			this->progressionEvents += Count(request.body, "\"category\":\"progression\"");
+			this->designEvents += Count(request.body, "\"category\":\"design\"");
+
+			LoopbackTransport::Post(request, callback);
+		}
+
+		std::atomic<uint64_t> businessEvents;
+		std::atomic<uint64_t> progressionEvents;
+		std::atomic<uint64_t> designEvents;
+
+	private:
+		static uint64_t Count(const std::string & body, const char * text)
+		{
+			uint64_t count = 0;
+
+			for (auto position = body.find(text); position != std::string::npos; position = body.find(text, position + 1))
+			{
+				++count;
+			}
+
+			return count;
+		}
+	};
+}
+
+
+TEST(MemoryBudgetTests, RefusesLowPriorityFirst)
+{
+	MemoryBudget budget;
+	budget.SetLimitBytes(1000);
+
+	EXPECT_TRUE(budget.TryReserve(400, MemoryPriority::Low));
+	EXPECT_FALSE(budget.TryReserve(200, MemoryPriority::Low));
+	EXPECT_TRUE(budget.TryReserve(300, MemoryPriority::Normal));
+	EXPECT_TRUE(budget.IsUnderPressure());
+
+	EXPECT_FALSE(budget.TryReserve(100, MemoryPriority::Normal));
+	EXPECT_TRUE(budget.TryReserve(300, MemoryPriority::High));
+	EXPECT_FALSE(budget.TryReserve(1, MemoryPriority::High));
+
+	budget.Release(1000);
+
+	EXPECT_EQ(0u, budget.GetUsedBytes());
+	EXPECT_EQ(1000u, budget.GetHighWaterBytes());
+	EXPECT_FALSE(budget.IsUnderPressure());
+}
+
+// Floods the core with design and error events from several threads, while the backend answers slowly.
+// Memory never exceeds the budget by more than the few allocations that can't be refused, and no business or progression event is lost.
+TEST(MemoryBudgetTests, CapHoldsUnderFlood)
+{
+	const size_t budgetBytes = 256 * 1024;
+	const int floodingThreads = 4;
+	const int designEventsPerThread = 50000;
+	const int businessEvents = 2000;
+
+	TestDirectory directory;
+	auto transport = std::make_shared<CountingTransport>();
+	transport->SetLatency(std::chrono::milliseconds(20));
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+	core->SetMemoryBudget(budgetBytes);
+	core->SetMaxStoreBytes(1ull << 30);
+
+	// Count business events in request bodies.
+	core->SetCompressionThreshold(1u << 30);
+
+	core->Init([](const InitResult &) {});
+
+	std::vector<std::thread> threads;
+
+	for (auto i = 0; i < floodingThreads; ++i)
+	{
+		threads.emplace_back([&core, i]()
+		{
+			for (auto j = 0; j < designEventsPerThread; ++j)
+			{
+				core->SendDesignEvent("Kill:Sword:" + std::to_string(j % 1000), 1.0f);
+
+				if (j % 10 == 0)
+				{
+					core->SendErrorEvent("Index out of range in thread " + std::to_string(i), Severity::Error);
+				}
+			}
+		});
+	}
+
+	threads.emplace_back([&core]()
+	{
+		for (auto i = 0; i < businessEvents; ++i)
+		{
+			core->SendBusinessEvent("Gems:Pack", "USD", 99);
+			core->SendProgressionEvent(ProgressionStatus::Start, "World" + std::to_string(i % 10));
+
+			if (i % 20 == 0)
+			{
+				core->Update();
+			}
+
+			std::this_thread::yield();
+		}
+	});
+
+	for (auto & thread : threads)
+	{
+		thread.join();
+	}
+
+	// Send everything left, until the backend has received all events stored.
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+		core->Flush();
+
+		auto metrics = core->GetMetrics();
+
+		if (metrics.pendingEvents == 0 && transport->GetStatistics().eventsReceived >= metrics.storedEvents)
+		{
+			break;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	auto metrics = core->GetMetrics();
+
+	// Each thread may get a ring of a single event without asking, and request bodies may grow a little while being compressed.
+	EXPECT_LE(metrics.memoryHighWaterBytes, budgetBytes + 16 * 1024);
+	EXPECT_GT(metrics.memoryHighWaterBytes, budgetBytes / 2);
+
+	// Design events have been dropped first.
+	EXPECT_GT(metrics.droppedEvents, 0u);
+	EXPECT_LT(transport->designEvents.load(), static_cast<uint64_t>(floodingThreads) * designEventsPerThread);
+
+	EXPECT_EQ(static_cast<uint64_t>(businessEvents), transport->businessEvents.load());
+	EXPECT_EQ(static_cast<uint64_t>(businessEvents), transport->progressionEvents.load());
+
+	core.reset();
+}
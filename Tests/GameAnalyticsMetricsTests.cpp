@@ -0,0 +1,177 @@
+#include "GameAnalyticsJson.h"
+#include "GameAnalyticsLoopbackTransport.h"
+#include "GameAnalyticsMetrics.h"
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	std::string ReadFile(const std::filesystem::path & path)
+	{
+		std::ifstream file(path, std::ios::binary);
+		return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// Gets the number of the specified member of the specified JSON object, or -1 if there is none.
+	double GetNumber(const std::string & json, const std::string & name)
+	{
+		double value;
+		return Json::TryGetNumber(json, name, value) ? value : -1;
+	}
+}
+
+
+TEST(MetricsTests, CountsEventsAndRequests)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(transport, directory.GetPath(), std::make_shared<ManualClock>()));
+	core->SetRateLimit(EventCategory::Design, 1, 100);
+	core->Init([](const InitResult &) {});
+
+	for (auto i = 0; i < 150; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	core->SendDesignEvent("Kill:");
+
+	auto metrics = core->GetMetrics();
+
+	EXPECT_EQ(100u, metrics.queuedEvents);
+	EXPECT_EQ(100u, metrics.pendingEvents);
+	EXPECT_EQ(50u, metrics.limitedEvents);
+	EXPECT_EQ(1u, metrics.invalidEvents);
+	EXPECT_EQ(0u, metrics.storedEvents);
+
+	core->Flush();
+	metrics = core->GetMetrics();
+
+	auto statistics = transport->GetStatistics();
+
+	EXPECT_EQ(100u, metrics.storedEvents);
+	EXPECT_EQ(0u, metrics.pendingEvents);
+	EXPECT_EQ(0u, metrics.droppedEvents);
+	EXPECT_EQ(0u, metrics.inFlightBatches);
+	EXPECT_EQ(0u, metrics.failedRequests);
+	EXPECT_EQ(statistics.initRequests + statistics.eventsRequests, metrics.requests);
+	EXPECT_EQ(statistics.bytesReceived, metrics.sentBytes);
+	EXPECT_LT(metrics.sentBytes, metrics.uncompressedBytes);
+
+	// Latencies are only measured if enabled.
+	EXPECT_EQ(0u, metrics.serialize.count);
+	EXPECT_EQ(0u, metrics.upload.count);
+}
+
+TEST(MetricsTests, MeasuresLatenciesIfEnabled)
+{
+	TestDirectory directory;
+	auto transport = std::make_shared<LoopbackTransport>();
+	transport->SetSecretKey(TestSecretKey);
+
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey, CreateTestEnvironment(transport, directory.GetPath()));
+	core->SetMetricsEnabled(true);
+	core->Init([](const InitResult &) {});
+
+	// Queueing is measured for every 64th event of each thread.
+	for (auto i = 0; i < 640; ++i)
+	{
+		core->SendDesignEvent("Kill:Orc", static_cast<float>(i));
+	}
+
+	core->Flush();
+
+	auto metrics = core->GetMetrics();
+	auto statistics = transport->GetStatistics();
+
+	// Every request is signed, but only events requests are compressed and measured until their response.
+	EXPECT_EQ(10u, metrics.enqueue.count);
+	EXPECT_GE(metrics.serialize.count, 1u);
+	EXPECT_EQ(metrics.requests, metrics.sign.count);
+	EXPECT_EQ(statistics.eventsRequests, metrics.compress.count);
+	EXPECT_EQ(statistics.eventsRequests, metrics.upload.count);
+	EXPECT_GT(metrics.serialize.max, 0);
+	EXPECT_LE(metrics.enqueue.p50, metrics.enqueue.max);
+}
+
+TEST(MetricsTests, WritesMetricsAsJson)
+{
+	Metrics metrics = {};
+	metrics.queuedEvents = 12;
+	metrics.sentBytes = 3456;
+	metrics.upload.count = 2;
+	metrics.upload.p99 = 20.5;
+
+	auto json = MetricsToJson(metrics);
+	std::string upload;
+
+	EXPECT_EQ(12, GetNumber(json, "queued_events"));
+	EXPECT_EQ(3456, GetNumber(json, "sent_bytes"));
+	EXPECT_EQ(0, GetNumber(json, "failed_requests"));
+	ASSERT_TRUE(Json::TryGetMember(json, "upload", upload));
+	EXPECT_EQ(2, GetNumber(upload, "count"));
+	EXPECT_EQ(20.5, GetNumber(upload, "p99"));
+}
+
+TEST(MetricsTests, ReplacesMetricsFile)
+{
+	TestDirectory directory;
+	auto path = directory.GetPath() / "metrics.json";
+
+	Metrics metrics = {};
+	metrics.requests = 1;
+	ASSERT_TRUE(WriteMetricsFile(path, metrics));
+
+	metrics.requests = 2;
+	ASSERT_TRUE(WriteMetricsFile(path, metrics));
+
+	EXPECT_EQ(2, GetNumber(ReadFile(path), "requests"));
+	EXPECT_FALSE(std::filesystem::exists(directory.GetPath() / "metrics.json.tmp"));
+
+	// Directory doesn't exist.
+	EXPECT_FALSE(WriteMetricsFile(directory.GetPath() / "missing" / "metrics.json", metrics));
+}
+
+TEST(MetricsTests, WritesMetricsFileAfterEachInterval)
+{
+	TestDirectory directory;
+	auto path = directory.GetPath() / "metrics.json";
+
+	auto clock = std::make_shared<ManualClock>();
+	auto core = std::make_shared<GameAnalyticsCore>(TestGameKey, TestSecretKey,
+		CreateTestEnvironment(std::make_shared<LoopbackTransport>(), directory.GetPath(), clock));
+	core->Init([](const InitResult &) {});
+	core->SetMetricsFile(path, 10);
+
+	core->SendDesignEvent("Kill:Orc");
+	clock->Advance(10 * 1000);
+	core->Update();
+
+	EXPECT_EQ(1, GetNumber(ReadFile(path), "queued_events"));
+
+	// Not written again before the interval has passed.
+	core->SendDesignEvent("Kill:Orc");
+	clock->Advance(5 * 1000);
+	core->Update();
+
+	EXPECT_EQ(1, GetNumber(ReadFile(path), "queued_events"));
+
+	clock->Advance(5 * 1000);
+	core->Update();
+
+	EXPECT_EQ(2, GetNumber(ReadFile(path), "queued_events"));
+}
@@ -0,0 +1,281 @@
+#include "GameAnalyticsFileKeyValueStore.h"
+#include "GameAnalyticsMemoryKeyValueStore.h"
+#include "GameAnalyticsPersistentCounter.h"
+#include "GameAnalyticsTestDirectory.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Key-value store counting commits, which can be made to fail, or to block until released.
+	class TestKeyValueStore : public MemoryKeyValueStore
+	{
+	public:
+		TestKeyValueStore()
+			: commits(0),
+			failing(false),
+			blocking(false)
+		{
+		}
+
+		bool Commit() override
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+
+			++this->commits;
+			this->changed.notify_all();
+			this->changed.wait(lock, [this]() { return !this->blocking; });
+
+			return !this->failing;
+		}
+
+		int GetCommits()
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			return this->commits;
+		}
+
+		void SetFailing(const bool failing)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->failing = failing;
+		}
+
+		void SetBlocking(const bool blocking)
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->blocking = blocking;
+			this->changed.notify_all();
+		}
+
+		// Waits until the specified number of commits has been started.
+		void WaitForCommits(const int commits)
+		{
+			std::unique_lock<std::mutex> lock(this->mutex);
+			this->changed.wait(lock, [this, commits]() { return this->commits >= commits; });
+		}
+
+	private:
+		std::mutex mutex;
+		std::condition_variable changed;
+
+		int commits;
+		bool failing;
+		bool blocking;
+	};
+}
+
+
+TEST(PersistentCounterTests, KeepsNumbersUniqueAcrossCrashes)
+{
+	TestDirectory directory;
+	auto path = directory.GetPath() / "settings";
+
+	// Stores of crashed sessions are never destroyed, so they don't commit anything after their crash.
+	std::vector<std::shared_ptr<FileKeyValueStore>> crashedStores;
+	std::set<int> numbers;
+	auto highest = 0;
+
+	for (auto session = 0; session < 4; ++session)
+	{
+		auto store = std::make_shared<FileKeyValueStore>(path);
+		crashedStores.push_back(store);
+
+		PersistentCounter counter(store, "GameAnalytics::Transaction", 10);
+		counter.Load();
+
+		for (auto i = 0; i < 25; ++i)
+		{
+			auto number = counter.Next();
+
+			EXPECT_GT(number, highest);
+			EXPECT_TRUE(numbers.insert(number).second);
+			highest = number;
+
+			if (i % 7 == 6)
+			{
+				counter.ReserveAhead();
+			}
+		}
+	}
+
+	EXPECT_EQ(100u, numbers.size());
+}
+
+TEST(PersistentCounterTests, ReservesAheadWithoutWritingOnNext)
+{
+	auto store = std::make_shared<TestKeyValueStore>();
+
+	PersistentCounter counter(store, "Counter", 10);
+	counter.Load();
+
+	// First range is reserved by Next, because nothing has been reserved ahead.
+	EXPECT_EQ(1, counter.Next());
+	EXPECT_EQ(1, store->GetCommits());
+
+	for (auto i = 2; i <= 5; ++i)
+	{
+		EXPECT_EQ(i, counter.Next());
+	}
+
+	EXPECT_FALSE(counter.IsLow());
+	EXPECT_EQ(6, counter.Next());
+	EXPECT_TRUE(counter.IsLow());
+
+	EXPECT_TRUE(counter.ReserveAhead());
+	EXPECT_EQ(2, store->GetCommits());
+	EXPECT_EQ(16, store->GetInt32OrDefault("Counter"));
+
+	// Reserved numbers are handed out from memory, across the boundary of the previous range.
+	for (auto i = 7; i <= 12; ++i)
+	{
+		EXPECT_EQ(i, counter.Next());
+	}
+
+	EXPECT_EQ(2, store->GetCommits());
+
+	EXPECT_TRUE(counter.ReserveAhead());
+	EXPECT_EQ(3, store->GetCommits());
+	EXPECT_EQ(22, store->GetInt32OrDefault("Counter"));
+}
+
+TEST(PersistentCounterTests, WaitsForReservationInProgress)
+{
+	auto store = std::make_shared<TestKeyValueStore>();
+	store->SetInt32("Counter", 100);
+
+	PersistentCounter counter(store, "Counter", 4);
+	counter.Load();
+
+	// Have the first range reserved ahead by a thread that is slow to write, e.g. on a busy disk.
+	store->SetBlocking(true);
+	std::thread reserving([&counter]() { EXPECT_TRUE(counter.ReserveAhead()); });
+	store->WaitForCommits(1);
+
+	std::atomic<int> number(0);
+	std::thread sending([&counter, &number]() { number = counter.Next(); });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	EXPECT_EQ(0, number);
+	EXPECT_EQ(1, store->GetCommits());
+
+	store->SetBlocking(false);
+	reserving.join();
+	sending.join();
+
+	EXPECT_EQ(101, number);
+	EXPECT_EQ(1, store->GetCommits());
+	EXPECT_EQ(104, store->GetInt32OrDefault("Counter"));
+}
+
+TEST(PersistentCounterTests, HandsOutUniqueNumbersUnderContention)
+{
+	const auto Threads = 4;
+	const auto NumbersPerThread = 5000;
+
+	auto store = std::make_shared<TestKeyValueStore>();
+
+	PersistentCounter counter(store, "Counter", 16);
+	counter.Load();
+
+	// Reserve ahead concurrently, like the worker flushing events while the game sends business events.
+	std::atomic<bool> done(false);
+	std::thread reserving([&counter, &done]()
+	{
+		while (!done)
+		{
+			counter.ReserveAhead();
+			std::this_thread::yield();
+		}
+	});
+
+	std::vector<std::vector<int>> numbers(Threads);
+	std::vector<std::thread> sending;
+
+	for (auto t = 0; t < Threads; ++t)
+	{
+		sending.emplace_back([&counter, &numbers, t]()
+		{
+			for (auto i = 0; i < NumbersPerThread; ++i)
+			{
+				numbers[t].push_back(counter.Next());
+			}
+		});
+	}
+
+	for (auto & thread : sending)
+	{
+		thread.join();
+	}
+
+	done = true;
+	reserving.join();
+
+	std::vector<int> all;
+
+	for (auto & threadNumbers : numbers)
+	{
+		// Numbers of each thread increase.
+		EXPECT_TRUE(std::is_sorted(threadNumbers.begin(), threadNumbers.end()));
+		all.insert(all.end(), threadNumbers.begin(), threadNumbers.end());
+	}
+
+	std::sort(all.begin(), all.end());
+
+	ASSERT_EQ(static_cast<size_t>(Threads * NumbersPerThread), all.size());
+
+	for (size_t i = 0; i < all.size(); ++i)
+	{
+		EXPECT_EQ(static_cast<int>(i) + 1, all[i]);
+	}
+
+	EXPECT_GE(store->GetInt32OrDefault("Counter"), Threads * NumbersPerThread);
+}
+
+TEST(PersistentCounterTests, StoresRangeAgainAfterFailedCommit)
+{
+	auto store = std::make_shared<TestKeyValueStore>();
+
+	PersistentCounter counter(store, "Counter", 10);
+	counter.Load();
+
+	// Numbers are still handed out while the store fails, without trying to write it with every one of them.
+	store->SetFailing(true);
+
+	for (auto i = 1; i <= 9; ++i)
+	{
+		EXPECT_EQ(i, counter.Next());
+	}
+
+	EXPECT_EQ(1, store->GetCommits());
+	EXPECT_FALSE(counter.ReserveAhead());
+	EXPECT_FALSE(counter.ReserveAhead());
+	EXPECT_EQ(3, store->GetCommits());
+
+	store->SetFailing(false);
+
+	EXPECT_TRUE(counter.ReserveAhead());
+	EXPECT_GE(store->GetInt32OrDefault("Counter"), 9);
+
+	// Range has been stored, so there's nothing left to write.
+	EXPECT_TRUE(counter.ReserveAhead());
+	EXPECT_EQ(4, store->GetCommits());
+
+	PersistentCounter restarted(store, "Counter", 10);
+	restarted.Load();
+
+	EXPECT_GT(restarted.Next(), 9);
+}
@@ -0,0 +1,123 @@
+#include "GameAnalyticsQuantileSketch.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Relative accuracy promised by the sketch.
+	const double RelativeAccuracy = 0.01;
+
+	const double Quantiles[] = { 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1.0 };
+
+	// Checks the estimates of the specified sketch against the exact quantiles of the specified values.
+	void ExpectQuantilesWithinBounds(const QuantileSketch & sketch, std::vector<double> values, const double minQuantile = 0)
+	{
+		std::sort(values.begin(), values.end());
+
+		for (auto quantile : Quantiles)
+		{
+			if (quantile < minQuantile)
+			{
+				continue;
+			}
+
+			auto exact = values[static_cast<size_t>(quantile * (values.size() - 1))];
+			auto estimate = sketch.GetQuantile(quantile);
+
+			EXPECT_LE(std::abs(estimate - exact), std::abs(exact) * RelativeAccuracy) << "quantile " << quantile;
+		}
+	}
+}
+
+
+TEST(QuantileSketchTests, EstimatesZeroWithoutValues)
+{
+	QuantileSketch sketch;
+
+	EXPECT_EQ(0u, sketch.GetCount());
+	EXPECT_EQ(0, sketch.GetQuantile(0.5));
+}
+
+TEST(QuantileSketchTests, EstimatesUniformValuesWithinBounds)
+{
+	QuantileSketch sketch;
+	std::vector<double> values;
+
+	for (auto i = 1; i <= 10000; ++i)
+	{
+		values.push_back(i);
+		sketch.Add(i);
+	}
+
+	EXPECT_EQ(10000u, sketch.GetCount());
+	ExpectQuantilesWithinBounds(sketch, values);
+}
+
+TEST(QuantileSketchTests, EstimatesSkewedValuesWithinBounds)
+{
+	// Latencies or damage values are usually spread over orders of magnitude.
+	std::mt19937 random(42);
+	std::lognormal_distribution<double> distribution(3.0, 2.0);
+
+	QuantileSketch sketch;
+	std::vector<double> values;
+
+	for (auto i = 0; i < 20000; ++i)
+	{
+		auto value = distribution(random);
+		values.push_back(value);
+		sketch.Add(value);
+	}
+
+	ExpectQuantilesWithinBounds(sketch, values);
+}
+
+TEST(QuantileSketchTests, EstimatesNegativeValuesAndZeroWithinBounds)
+{
+	QuantileSketch sketch;
+	std::vector<double> values;
+
+	for (auto i = -1000; i <= 1000; ++i)
+	{
+		values.push_back(i * 0.5);
+		sketch.Add(i * 0.5);
+	}
+
+	ExpectQuantilesWithinBounds(sketch, values);
+	EXPECT_EQ(0, sketch.GetQuantile(0.5));
+}
+
+TEST(QuantileSketchTests, KeepsHighQuantilesWithinBoundsWhenCollapsing)
+{
+	// Values spread over 20 orders of magnitude need more buckets than kept, so the smallest ones are merged.
+	QuantileSketch sketch;
+	std::vector<double> values;
+
+	for (auto i = 0; i < 20000; ++i)
+	{
+		auto value = std::pow(10.0, -5 + i * 20.0 / 20000);
+		values.push_back(value);
+		sketch.Add(value);
+	}
+
+	ExpectQuantilesWithinBounds(sketch, values, 0.5);
+}
+
+TEST(QuantileSketchTests, ForgetsValuesWhenCleared)
+{
+	QuantileSketch sketch;
+	sketch.Add(1000);
+	sketch.Clear();
+	sketch.Add(2);
+
+	EXPECT_EQ(1u, sketch.GetCount());
+	EXPECT_NEAR(2, sketch.GetQuantile(1.0), 2 * RelativeAccuracy);
+}
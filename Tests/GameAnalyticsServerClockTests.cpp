@@ -0,0 +1,99 @@
+#include "GameAnalyticsServerClock.h"
+#include "GameAnalyticsTestEnvironment.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Server time of the first synchronization, in milliseconds since the epoch.
+	const int64_t ServerMilliseconds = 1700000000000;
+
+	int64_t GetSystemMilliseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	}
+}
+
+
+TEST(ServerClockTests, MeasuresLocalTimeSinceCreation)
+{
+	auto clock = std::make_shared<ManualClock>();
+	ServerClock serverClock(clock);
+
+	EXPECT_EQ(0, serverClock.GetLocalMilliseconds());
+
+	clock->Advance(250);
+
+	EXPECT_EQ(250, serverClock.GetLocalMilliseconds());
+	EXPECT_EQ(250000000, serverClock.GetLocalNanoseconds());
+}
+
+TEST(ServerClockTests, FallsBackToSystemClockBeforeFirstSynchronization)
+{
+	auto clock = std::make_shared<ManualClock>();
+	ServerClock serverClock(clock);
+
+	auto before = GetSystemMilliseconds();
+	clock->Advance(5000);
+	auto serverTime = serverClock.ToServerMilliseconds(serverClock.GetLocalMilliseconds());
+
+	EXPECT_FALSE(serverClock.IsSynchronized());
+	EXPECT_GE(serverTime, before + 5000 - 1000);
+	EXPECT_LE(serverTime, GetSystemMilliseconds() + 5000 + 1000);
+}
+
+TEST(ServerClockTests, AppliesFirstSynchronizationAtOnce)
+{
+	auto clock = std::make_shared<ManualClock>();
+	ServerClock serverClock(clock);
+
+	// Server time is taken halfway through the round trip, and lies in the middle of its precision.
+	serverClock.Synchronize(ServerMilliseconds, 1000, 100, 140);
+
+	EXPECT_TRUE(serverClock.IsSynchronized());
+	EXPECT_EQ(ServerMilliseconds + 500, serverClock.ToServerMilliseconds(120));
+	EXPECT_EQ(ServerMilliseconds + 500 + 60000, serverClock.ToServerMilliseconds(120 + 60000));
+}
+
+TEST(ServerClockTests, SmoothsSmallCorrectionsByOneEighth)
+{
+	auto clock = std::make_shared<ManualClock>();
+	ServerClock serverClock(clock);
+	serverClock.Synchronize(ServerMilliseconds, 0, 0, 0);
+
+	// Server appears 800 ms ahead.
+	serverClock.Synchronize(ServerMilliseconds + 1000 + 800, 0, 1000, 1000);
+	EXPECT_EQ(ServerMilliseconds + 100, serverClock.ToServerMilliseconds(0));
+
+	// Remaining 700 ms.
+	serverClock.Synchronize(ServerMilliseconds + 2000 + 800, 0, 2000, 2000);
+	EXPECT_EQ(ServerMilliseconds + 100 + 87, serverClock.ToServerMilliseconds(0));
+
+	// Server appears behind.
+	serverClock.Synchronize(ServerMilliseconds + 3000 - 8000 + 187, 0, 3000, 3000);
+	EXPECT_EQ(ServerMilliseconds + 187 - 1000, serverClock.ToServerMilliseconds(0));
+}
+
+TEST(ServerClockTests, AppliesCorrectionsAboveTenSecondsAtOnce)
+{
+	auto clock = std::make_shared<ManualClock>();
+	ServerClock serverClock(clock);
+	serverClock.Synchronize(ServerMilliseconds, 0, 0, 0);
+
+	// Corrections of up to 10 s are still smoothed.
+	serverClock.Synchronize(ServerMilliseconds + 10000, 0, 0, 0);
+	EXPECT_EQ(ServerMilliseconds + 1250, serverClock.ToServerMilliseconds(0));
+
+	// E.g. after the device has been suspended.
+	serverClock.Synchronize(ServerMilliseconds + 1250 + 10001, 0, 0, 0);
+	EXPECT_EQ(ServerMilliseconds + 1250 + 10001, serverClock.ToServerMilliseconds(0));
+
+	serverClock.Synchronize(ServerMilliseconds - 60000, 0, 0, 0);
+	EXPECT_EQ(ServerMilliseconds - 60000, serverClock.ToServerMilliseconds(0));
+}
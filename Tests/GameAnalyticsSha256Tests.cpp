@@ -0,0 +1,233 @@
+#include "GameAnalyticsBase64.h"
+#include "GameAnalyticsRequestBuilder.h"
+#include "GameAnalyticsSha256.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	struct HashVector
+	{
+		std::string message;
+		const char * digest;
+	};
+
+	// Vectors of FIPS 180-4, as published in the NIST examples for SHA-256.
+	const HashVector HashVectors[] =
+	{
+		{ "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+		{ "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+		{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+		{ "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+			"cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" }
+	};
+
+	struct MacVector
+	{
+		std::string key;
+		std::string data;
+		const char * mac;
+	};
+
+	// Test cases 1 to 7 of RFC 4231. Test case 5 is truncated to 128 bits.
+	const MacVector MacVectors[] =
+	{
+		{ std::string(20, '\x0b'), "Hi There", "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7" },
+		{ "Jefe", "what do ya want for nothing?", "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+		{ std::string(20, '\xaa'), std::string(50, '\xdd'), "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe" },
+		{ "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f\x10\x11\x12\x13\x14\x15\x16\x17\x18\x19", std::string(50, '\xcd'),
+			"82558a389a443c0ea4cc819899f2083a85f0faa3e578f8077a2e3ff46729665b" },
+		{ std::string(20, '\x0c'), "Test With Truncation", "a3b6167473100ee06e0c796c2955552b" },
+		{ std::string(131, '\xaa'), "Test Using Larger Than Block-Size Key - Hash Key First",
+			"60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+		{ std::string(131, '\xaa'), "This is a test using a larger than block-size key and a larger than block-size data. The key needs to be hashed before being used by the HMAC algorithm.",
+			"9b09ffa71b942fcb27635fbcd5b0e944bfdc63644f0713938a7f51535c3a35e2" }
+	};
+
+	std::string ToHex(const uint8_t * data, const size_t length)
+	{
+		static const char Digits[] = "0123456789abcdef";
+
+		std::string hex;
+
+		for (size_t i = 0; i < length; ++i)
+		{
+			hex.push_back(Digits[data[i] >> 4]);
+			hex.push_back(Digits[data[i] & 0xF]);
+		}
+
+		return hex;
+	}
+
+	std::vector<uint8_t> FromHex(const std::string & hex)
+	{
+		std::vector<uint8_t> data;
+
+		for (size_t i = 0; i + 1 < hex.size(); i += 2)
+		{
+			data.push_back(static_cast<uint8_t>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+		}
+
+		return data;
+	}
+
+	std::string Hash(const std::string & message, const size_t pieceLength)
+	{
+		Sha256 sha;
+
+		for (size_t i = 0; i < message.size(); i += pieceLength)
+		{
+			sha.Update(message.data() + i, std::min(pieceLength, message.size() - i));
+		}
+
+		uint8_t digest[Sha256::DigestSize];
+		sha.Finish(digest);
+		return ToHex(digest, sizeof(digest));
+	}
+
+	std::string Sign(const HmacSha256 & prepared, const std::string & data)
+	{
+		// Prepared signers are copied for each message.
+		auto signer = prepared;
+		signer.Update(data.data(), data.size());
+
+		uint8_t mac[Sha256::DigestSize];
+		signer.Finish(mac);
+		return ToHex(mac, sizeof(mac));
+	}
+
+	// Builds the specified request body, signing it while compressing it, if specified.
+	TransportRequest Build(const std::string & body, const std::string & key, const bool compress)
+	{
+		RequestBuilder builder("http://api.gameanalytics.com/v2/game/events", body, HmacSha256(key), compress, nullptr);
+
+		while (!builder.Continue())
+		{
+		}
+
+		return builder.GetRequest();
+	}
+
+	// Runs each test with the SHA extensions of the processor, if supported, and with the portable implementation.
+	class Sha256Tests : public testing::TestWithParam<bool>
+	{
+	protected:
+		void SetUp() override
+		{
+			if (this->GetParam() && !Sha256::IsAccelerationSupported())
+			{
+				GTEST_SKIP() << "Processor doesn't support the SHA extensions.";
+			}
+
+			Sha256::SetAccelerationEnabled(this->GetParam());
+		}
+
+		void TearDown() override
+		{
+			Sha256::SetAccelerationEnabled(true);
+		}
+	};
+}
+
+
+TEST_P(Sha256Tests, HashesFipsVectors)
+{
+	for (auto & vector : HashVectors)
+	{
+		EXPECT_EQ(vector.digest, Hash(vector.message, vector.message.size() + 1)) << vector.message;
+
+		// Pieces not aligned to blocks are buffered.
+		for (size_t pieceLength = 1; pieceLength < 70; pieceLength += 3)
+		{
+			EXPECT_EQ(vector.digest, Hash(vector.message, pieceLength)) << vector.message << " in pieces of " << pieceLength << " bytes";
+		}
+	}
+}
+
+TEST_P(Sha256Tests, HashesMillionCharacters)
+{
+	std::string message(1000000, 'a');
+	const char * digest = "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0";
+
+	EXPECT_EQ(digest, Hash(message, message.size()));
+	EXPECT_EQ(digest, Hash(message, 1000));
+	EXPECT_EQ(digest, Hash(message, 4099));
+}
+
+TEST_P(Sha256Tests, SignsRfcVectors)
+{
+	for (auto & vector : MacVectors)
+	{
+		std::string expected(vector.mac);
+		HmacSha256 signer(vector.key);
+
+		EXPECT_EQ(expected, Sign(signer, vector.data).substr(0, expected.size()));
+
+		// Resetting starts over with the same key.
+		signer.Update("discarded", 9);
+		signer.Reset();
+
+		EXPECT_EQ(expected, Sign(signer, vector.data).substr(0, expected.size()));
+	}
+}
+
+TEST_P(Sha256Tests, SignsRequestsInPieces)
+{
+	for (auto & vector : MacVectors)
+	{
+		std::string expected(vector.mac);
+
+		if (expected.size() < 2 * Sha256::DigestSize)
+		{
+			continue;
+		}
+
+		auto mac = FromHex(expected);
+		auto request = Build(vector.data, vector.key, false);
+
+		EXPECT_FALSE(request.compressed);
+		EXPECT_EQ(Base64Encode(mac.data(), mac.size()), request.authorization);
+	}
+}
+
+TEST_P(Sha256Tests, SignsLargeBodiesInPieces)
+{
+	std::string body = "[";
+
+	for (auto i = 0; body.size() < 100 * 1024; ++i)
+	{
+		body += "{\"category\":\"design\",\"event_id\":\"Kill:Sword:Robot\",\"value\":" + std::to_string(i) + "},";
+	}
+
+	body.back() = ']';
+
+	// Signatures are computed a piece at a time, and have to match signing the body at once.
+	auto uncompressed = Build(body, MacVectors[1].key, false);
+	ASSERT_FALSE(uncompressed.compressed);
+
+	auto uncompressedMac = FromHex(Sign(HmacSha256(MacVectors[1].key), body));
+	EXPECT_EQ(Base64Encode(uncompressedMac.data(), uncompressedMac.size()), uncompressed.authorization);
+
+	// Compressed bodies are signed while being compressed, as sent.
+	auto request = Build(body, MacVectors[1].key, true);
+	ASSERT_TRUE(request.compressed);
+
+	auto mac = FromHex(Sign(HmacSha256(MacVectors[1].key), request.body));
+	EXPECT_EQ(Base64Encode(mac.data(), mac.size()), request.authorization);
+
+	// Both implementations sign the same compressed body alike.
+	Sha256::SetAccelerationEnabled(!this->GetParam());
+	EXPECT_EQ(request.authorization, Build(body, MacVectors[1].key, true).authorization);
+}
+
+INSTANTIATE_TEST_SUITE_P(Transforms, Sha256Tests, testing::Bool(), [](const testing::TestParamInfo<bool> & info)
+{
+	return info.param ? "ShaNi" : "Portable";
+});
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+namespace GameAnalytics
+{
+	// Empty temporary directory that is deleted with all of its contents when destroyed.
+	class TestDirectory
+	{
+	public:
+		TestDirectory()
+		{
+			static std::atomic<unsigned int> count(0);
+
+			auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+			this->path = std::filesystem::temp_directory_path()
+				/ ("GameAnalyticsTests-" + std::to_string(now) + "-" + std::to_string(count++));
+
+			std::filesystem::create_directories(this->path);
+		}
+
+		~TestDirectory()
+		{
+			std::error_code error;
+			std::filesystem::remove_all(this->path, error);
+		}
+
+		TestDirectory(const TestDirectory &) = delete;
+		TestDirectory & operator=(const TestDirectory &) = delete;
+
+		const std::filesystem::path & GetPath() const
+		{
+			return this->path;
+		}
+
+	private:
+		std::filesystem::path path;
+	};
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+#include "GameAnalyticsCore.h"
+#include "GameAnalyticsMemoryKeyValueStore.h"
+#include "GameAnalyticsStaticDeviceInfo.h"
+#include "GameAnalyticsSteadyClock.h"
+
+namespace GameAnalytics
+{
+	const char * const TestGameKey = "5c6bcb5402204249437fb5a7a80a4959";
+	const char * const TestSecretKey = "16813a12f718bc5c620f56944e1abc3ea13ccbac";
+
+	// Clock that only advances when told to, for testing timeouts and backoff without waiting.
+	class ManualClock : public Clock
+	{
+	public:
+		ManualClock()
+			: milliseconds(1000)
+		{
+		}
+
+		int64_t GetTicks() const override
+		{
+			return this->milliseconds;
+		}
+
+		int64_t GetTicksPerSecond() const override
+		{
+			return 1000;
+		}
+
+		void Advance(const int64_t milliseconds)
+		{
+			this->milliseconds += milliseconds;
+		}
+
+	private:
+		std::atomic<int64_t> milliseconds;
+	};
+
+	// Gets services for running the core against the specified transport, storing events in the specified directory.
+	inline Environment CreateTestEnvironment(const std::shared_ptr<Transport> & transport, const std::filesystem::path & storeDirectory,
+		const std::shared_ptr<Clock> & clock = std::make_shared<SteadyClock>())
+	{
+		Environment environment;
+		environment.transport = transport;
+		environment.clock = clock;
+		environment.keyValueStore = std::make_shared<MemoryKeyValueStore>();
+		environment.deviceInfo = std::make_shared<StaticDeviceInfo>("windows", "windows 10.0.10586", "pc", "unknown", "1.0", "test-hardware-id");
+		environment.storeDirectory = storeDirectory;
+		return environment;
+	}
+}
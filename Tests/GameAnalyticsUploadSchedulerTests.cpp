@@ -0,0 +1,253 @@
+#include "GameAnalyticsTestDirectory.h"
+#include "GameAnalyticsUploadScheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	void AppendEvents(EventStore & store, const int count)
+	{
+		EventBatch batch;
+
+		for (auto i = 0; i < count; ++i)
+		{
+			auto event = "{\"index\":" + std::to_string(i) + "}";
+			batch.Add(event.data(), event.size());
+		}
+
+		store.Append(batch);
+	}
+
+	// Gets the time the next retry is due, after the specified time.
+	int64_t GetRetryDelay(const UploadScheduler & uploads, const int64_t now, const int64_t maxDelay)
+	{
+		int64_t low = 0;
+		int64_t high = maxDelay + 1;
+
+		while (low < high)
+		{
+			auto middle = (low + high) / 2;
+
+			if (uploads.IsRetryDue(now + middle))
+			{
+				high = middle;
+			}
+			else
+			{
+				low = middle + 1;
+			}
+		}
+
+		return low;
+	}
+}
+
+
+TEST(UploadSchedulerTests, BacksOffExponentiallyWithJitter)
+{
+	const int64_t minDelay = 1000;
+	const int64_t maxDelay = 16000;
+
+	std::set<int64_t> fourthDelays;
+
+	for (auto run = 0; run < 20; ++run)
+	{
+		TestDirectory directory;
+		EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+		UploadScheduler uploads(store, 1);
+		uploads.SetRetryDelay(minDelay, maxDelay);
+
+		AppendEvents(store, 10);
+
+		int64_t now = 0;
+
+		for (auto failure = 0; failure < 8; ++failure)
+		{
+			UploadScheduler::Batch batch;
+			ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, now, batch));
+
+			uploads.Complete(batch.id, UploadResult::ServerError, now);
+
+			// Retries are delayed between the minimum and the doubled, capped delay.
+			auto delay = GetRetryDelay(uploads, now, maxDelay);
+			EXPECT_GE(delay, minDelay);
+			EXPECT_LE(delay, std::min(maxDelay, minDelay << failure));
+
+			if (failure == 3)
+			{
+				fourthDelays.insert(delay);
+			}
+
+			// Nothing is sent before the retry is due.
+			EXPECT_FALSE(uploads.TryNextBatch(100, 1 << 20, now + delay - 1, batch));
+
+			now += delay;
+		}
+	}
+
+	// Devices failing at the same time don't retry at the same time.
+	EXPECT_GT(fourthDelays.size(), 5u);
+}
+
+TEST(UploadSchedulerTests, DropsBatchAfterMaxRetries)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+	UploadScheduler uploads(store, 1);
+	uploads.SetMaxRetries(2);
+	uploads.SetRetryDelay(1, 1);
+
+	AppendEvents(store, 10);
+
+	int64_t now = 0;
+
+	for (auto attempt = 0; attempt < 3; ++attempt)
+	{
+		UploadScheduler::Batch batch;
+		ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, now, batch));
+
+		uploads.Complete(batch.id, UploadResult::ServerError, now);
+		now += 1;
+	}
+
+	UploadScheduler::Batch batch;
+	EXPECT_FALSE(uploads.TryNextBatch(100, 1 << 20, now, batch));
+	EXPECT_TRUE(store.IsEmpty());
+}
+
+TEST(UploadSchedulerTests, IsolatesRejectedEvents)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+	UploadScheduler uploads(store, 1);
+
+	AppendEvents(store, 16);
+
+	size_t accepted = 0;
+	auto requests = 0;
+	UploadScheduler::Batch batch;
+
+	while (uploads.TryNextBatch(100, 1 << 20, 0, batch))
+	{
+		++requests;
+
+		// Reject all batches containing the event with index 5.
+		if (batch.body.find("{\"index\":5}") != std::string::npos)
+		{
+			uploads.Complete(batch.id, UploadResult::Rejected, 0);
+		}
+		else
+		{
+			accepted += std::count(batch.body.begin(), batch.body.end(), '{');
+			uploads.Complete(batch.id, UploadResult::Accepted, 0);
+		}
+	}
+
+	EXPECT_EQ(15u, accepted);
+	EXPECT_LE(requests, 2 * 4 + 1);
+	EXPECT_TRUE(store.IsEmpty());
+}
+
+TEST(UploadSchedulerTests, DropsRejectedEventsByIndex)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+	UploadScheduler uploads(store, 1);
+
+	AppendEvents(store, 16);
+
+	UploadScheduler::Batch batch;
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	uploads.Complete(batch.id, std::vector<size_t>{ 3, 5 });
+
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	EXPECT_EQ(std::string::npos, batch.body.find("{\"index\":3}"));
+	EXPECT_EQ(std::string::npos, batch.body.find("{\"index\":5}"));
+	EXPECT_EQ(14, std::count(batch.body.begin(), batch.body.end(), '{'));
+
+	// Indices refer to the body sent, without the events dropped before.
+	uploads.Complete(batch.id, std::vector<size_t>{ 0, 13 });
+
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	EXPECT_EQ("[{\"index\":1},{\"index\":2},{\"index\":4},{\"index\":6},{\"index\":7},{\"index\":8},{\"index\":9},"
+		"{\"index\":10},{\"index\":11},{\"index\":12},{\"index\":13},{\"index\":14}]", batch.body);
+
+	uploads.Complete(batch.id, UploadResult::Accepted, 0);
+
+	EXPECT_FALSE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	EXPECT_TRUE(store.IsEmpty());
+}
+
+TEST(UploadSchedulerTests, KeepsDroppedEventsOutWhenSplitting)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+	UploadScheduler uploads(store, 1);
+
+	AppendEvents(store, 8);
+
+	UploadScheduler::Batch batch;
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	uploads.Complete(batch.id, std::vector<size_t>{ 1, 6 });
+
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	uploads.Complete(batch.id, UploadResult::TooLarge, 0);
+
+	std::string bodies;
+
+	while (uploads.TryNextBatch(100, 1 << 20, 0, batch))
+	{
+		bodies += batch.body;
+		uploads.Complete(batch.id, UploadResult::Accepted, 0);
+	}
+
+	EXPECT_EQ("[{\"index\":0},{\"index\":2},{\"index\":3}][{\"index\":4},{\"index\":5},{\"index\":7}]", bodies);
+	EXPECT_TRUE(store.IsEmpty());
+}
+
+TEST(UploadSchedulerTests, SplitsRejectedBatchesForUnknownIndices)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+	UploadScheduler uploads(store, 1);
+
+	AppendEvents(store, 8);
+
+	UploadScheduler::Batch batch;
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+
+	// The batch has no event with index 8.
+	uploads.Complete(batch.id, std::vector<size_t>{ 2, 8 });
+
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	EXPECT_EQ("[{\"index\":0},{\"index\":1},{\"index\":2},{\"index\":3}]", batch.body);
+}
+
+TEST(UploadSchedulerTests, StopsSendingWhenUnauthorized)
+{
+	TestDirectory directory;
+	EventStore store(directory.GetPath(), 1 << 20, 1 << 24);
+	UploadScheduler uploads(store, 1);
+
+	AppendEvents(store, 10);
+
+	UploadScheduler::Batch batch;
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 0, batch));
+	uploads.Complete(batch.id, UploadResult::Unauthorized, 0);
+
+	EXPECT_FALSE(uploads.IsRetryDue(1000000));
+	EXPECT_FALSE(uploads.TryNextBatch(100, 1 << 20, 1000000, batch));
+
+	uploads.Resume();
+
+	ASSERT_TRUE(uploads.TryNextBatch(100, 1 << 20, 1000000, batch));
+	uploads.Complete(batch.id, UploadResult::Accepted, 1000000);
+	EXPECT_TRUE(store.IsEmpty());
+}
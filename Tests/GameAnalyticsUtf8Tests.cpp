@@ -0,0 +1,208 @@
+#include "GameAnalyticsUtf8.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace GameAnalytics;
+
+namespace
+{
+	// Encodes the specified code points as UTF-16, keeping unpaired surrogates as they are.
+	std::u16string ToUtf16(const std::vector<uint32_t> & codePoints)
+	{
+		std::u16string s;
+
+		for (auto c : codePoints)
+		{
+			if (c >= 0x10000)
+			{
+				s.push_back(static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10)));
+				s.push_back(static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)));
+			}
+			else
+			{
+				s.push_back(static_cast<char16_t>(c));
+			}
+		}
+
+		return s;
+	}
+
+	// Encodes the specified code points as wide string, UTF-16 or UTF-32 depending on the size of wchar_t.
+	std::wstring ToWide(const std::vector<uint32_t> & codePoints)
+	{
+		std::wstring s;
+
+		if (sizeof(wchar_t) == 2)
+		{
+			for (auto c : ToUtf16(codePoints))
+			{
+				s.push_back(static_cast<wchar_t>(c));
+			}
+		}
+		else
+		{
+			for (auto c : codePoints)
+			{
+				s.push_back(static_cast<wchar_t>(c));
+			}
+		}
+
+		return s;
+	}
+
+	std::string ToUtf8FromUtf16(const std::u16string & s)
+	{
+		std::string result;
+		ToUtf8(s, result);
+		return result;
+	}
+
+	std::string ToUtf8FromWide(const std::wstring & s)
+	{
+		std::string result;
+		ToUtf8(s, result);
+		return result;
+	}
+
+	// Strings shorter and longer than a block of eight code units, with multi-byte characters at every position of a block.
+	const std::vector<uint32_t> Texts[] =
+	{
+		{ },
+		{ 'a' },
+		{ 'l', 'e', 'v', 'e', 'l', '_', '0', '1' },
+		{ 'S', 't', 'a', 'r', 't', ':', 'W', 'o', 'r', 'l', 'd', '0', '1', ':', 'L', 'e', 'v', 'e', 'l', '0', '1' },
+		{ 'g', 'o', 'l', 'd', 0xE9, 'c', 'o', 'i', 'n', 's', 0x20AC },
+		{ 'a', 'b', 'c', 'd', 'e', 'f', 'g', 0x1F600, 'h', 'i', 'j' },
+		{ 0x1F600, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 0x10FFFF, 0x10000 },
+		{ 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000, 0xD7FF, 0xE000 }
+	};
+}
+
+
+TEST(Utf8Tests, ConvertsUtf16LikeWideStrings)
+{
+	for (auto & text : Texts)
+	{
+		EXPECT_EQ(ToUtf8FromUtf16(ToUtf16(text)), ToUtf8FromWide(ToWide(text)));
+	}
+}
+
+TEST(Utf8Tests, ConvertsAsciiBlocks)
+{
+	EXPECT_EQ(ToUtf8FromUtf16(u"Start:World01:Level01"), "Start:World01:Level01");
+	EXPECT_EQ(ToUtf8FromWide(L"Start:World01:Level01"), "Start:World01:Level01");
+}
+
+TEST(Utf8Tests, EncodesEveryLength)
+{
+	EXPECT_EQ(ToUtf8FromUtf16(ToUtf16({ 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000, 0x10FFFF })),
+		"\x7F" "\xC2\x80" "\xDF\xBF" "\xE0\xA0\x80" "\xEF\xBF\xBF" "\xF0\x90\x80\x80" "\xF4\x8F\xBF\xBF");
+}
+
+TEST(Utf8Tests, CombinesSurrogatePairsAcrossBlocks)
+{
+	// The high surrogate is the last code unit of the first block, the low surrogate the first of the second one.
+	EXPECT_EQ(ToUtf8FromUtf16(u"abcdefg\xD83D\xDE00hijklmn"), "abcdefg\xF0\x9F\x98\x80hijklmn");
+}
+
+TEST(Utf8Tests, ReplacesUnpairedSurrogates)
+{
+	EXPECT_EQ(ToUtf8FromUtf16(std::u16string(1, 0xD83D)), "\xEF\xBF\xBD");
+	EXPECT_EQ(ToUtf8FromUtf16(std::u16string(1, 0xDE00)), "\xEF\xBF\xBD");
+	EXPECT_EQ(ToUtf8FromUtf16(ToUtf16({ 0xD83D, 'a' })), "\xEF\xBF\xBD" "a");
+	EXPECT_EQ(ToUtf8FromUtf16(ToUtf16({ 0xDE00, 0xD83D })), "\xEF\xBF\xBD\xEF\xBF\xBD");
+	EXPECT_EQ(ToUtf8FromWide(ToWide({ 0xD83D })), "\xEF\xBF\xBD");
+}
+
+TEST(Utf8Tests, ReplacesPreviousResult)
+{
+	std::string result(100, 'x');
+
+	ToUtf8(std::u16string_view(u"gold"), result);
+	EXPECT_EQ(result, "gold");
+
+	ToUtf8(std::wstring_view(L"gems"), result);
+	EXPECT_EQ(result, "gems");
+}
+
+TEST(Utf8Tests, RoundTripsWideStrings)
+{
+	for (auto & text : Texts)
+	{
+		auto wide = ToWide(text);
+		EXPECT_EQ(FromUtf8(ToUtf8(wide)), wide);
+	}
+}
+
+TEST(Utf8Tests, ReplacesInvalidSequences)
+{
+	EXPECT_EQ(FromUtf8("a\xFF" "b"), std::wstring(L"a\xFFFD" L"b"));
+	EXPECT_EQ(FromUtf8("\xE2\x82"), std::wstring(L"\xFFFD\xFFFD"));
+}
+
+TEST(Utf8Tests, ConvertsStringsLongerThanAChunk)
+{
+	// Multi-byte characters and surrogate pairs at every position, across the chunks converted at a time.
+	std::vector<uint32_t> text;
+
+	for (auto i = 0; i < 1000; ++i)
+	{
+		text.push_back(i % 7 == 0 ? 0x1F600 : i % 5 == 0 ? 0x20AC : i % 3 == 0 ? 0xE9 : 'a' + i % 26);
+	}
+
+	auto wide = ToWide(text);
+	auto utf8 = ToUtf8FromWide(wide);
+
+	EXPECT_EQ(utf8, ToUtf8FromUtf16(ToUtf16(text)));
+	EXPECT_EQ(FromUtf8(utf8), wide);
+}
+
+TEST(Utf8Tests, ReplacesValuesBeyondUnicode)
+{
+	if (sizeof(wchar_t) == 4)
+	{
+		EXPECT_EQ(ToUtf8FromWide(std::wstring(1, static_cast<wchar_t>(0x110000))), "\xEF\xBF\xBD");
+		EXPECT_EQ(ToUtf8FromWide(std::wstring(L"a") + static_cast<wchar_t>(0x7FFFFFFF) + L"b"), "a\xEF\xBF\xBD" "b");
+	}
+}
+
+TEST(Utf8Tests, ReusesMemoryOfPreviousResult)
+{
+	std::string result;
+	ToUtf8(std::wstring_view(L"Start:World01:Level01:Checkpoint01"), result);
+
+	auto data = result.data();
+	auto capacity = result.capacity();
+
+	ToUtf8(std::wstring_view(L"gold"), result);
+	EXPECT_EQ(result, "gold");
+	EXPECT_EQ(result.data(), data);
+	EXPECT_EQ(result.capacity(), capacity);
+}
+
+TEST(Utf8Tests, RejectsOverlongEncodings)
+{
+	EXPECT_EQ(FromUtf8("\xC0\xAF"), std::wstring(2, L'\xFFFD'));
+	EXPECT_EQ(FromUtf8("\xC1\xBF"), std::wstring(2, L'\xFFFD'));
+	EXPECT_EQ(FromUtf8("\xE0\x80\xAF"), std::wstring(3, L'\xFFFD'));
+	EXPECT_EQ(FromUtf8("\xF0\x80\x80\xAF"), std::wstring(4, L'\xFFFD'));
+
+	// Shortest encodings of the same lengths are still accepted.
+	EXPECT_EQ(FromUtf8("\xC2\x80" "\xE0\xA0\x80"), std::wstring(L"\x80\x800"));
+	EXPECT_EQ(FromUtf8("\xF0\x90\x80\x80"), ToWide({ 0x10000 }));
+}
+
+TEST(Utf8Tests, RejectsEncodedSurrogatesAndValuesBeyondUnicode)
+{
+	EXPECT_EQ(FromUtf8("\xED\xA0\x80"), std::wstring(3, L'\xFFFD'));
+	EXPECT_EQ(FromUtf8("\xED\xBF\xBF"), std::wstring(3, L'\xFFFD'));
+	EXPECT_EQ(FromUtf8("\xF4\x90\x80\x80"), std::wstring(4, L'\xFFFD'));
+
+	// Neighbours of the surrogates and the last code point are still accepted.
+	EXPECT_EQ(FromUtf8("\xED\x9F\xBF" "\xEE\x80\x80"), std::wstring(L"\xD7FF\xE000"));
+	EXPECT_EQ(FromUtf8("\xF4\x8F\xBF\xBF"), ToWide({ 0x10FFFF }));
+}